@@ -75,6 +75,16 @@ MACRO (ADD_TR_SUBFOLDERS)
         SET (TR_VERSION_AVAILABLE "YES")
     ENDIF ()
 
+    IF (TR_LOG_VIEW)
+        ADD_SUBDIRECTORY (src/trLogView)
+        SET (TR_LOG_VIEW_AVAILABLE "YES")
+    ENDIF ()
+
+    IF (TR_MPEG_BENCH)
+        ADD_SUBDIRECTORY (src/trMPEGBench)
+        SET (TR_MPEG_BENCH_AVAILABLE "YES")
+    ENDIF ()
+
 # Examples folders
     MESSAGE (STATUS "Creating Selected Example Folders")
     
@@ -130,6 +140,11 @@ MACRO (ADD_TR_SUBFOLDERS)
         ADD_SUBDIRECTORY (Tests/TrManager)
         SET (TESTS_TR_MANAGER_AVAILABLE "YES")
     ENDIF ()
+
+    IF (TESTS_TR_UTIL)
+        ADD_SUBDIRECTORY (Tests/TrUtil)
+        SET (TESTS_TR_UTIL_AVAILABLE "YES")
+    ENDIF ()
 ENDMACRO ()
 
 # *****************************************************************************
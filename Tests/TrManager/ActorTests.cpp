@@ -24,13 +24,20 @@
 #include "TestActor1.h"
 #include "TestActor2.h"
 #include "TestActor3.h"
+#include "TestActor4.h"
 #include "TestMessage.h"
 
 #include <trCore/MessageSystemControl.h>
 #include <trCore/SystemControls.h>
 #include <trManager/DirectorPriority.h>
+#include <trManager/MessageTick.h>
+#include <trManager/ReplicationDirector.h>
+#include <trManager/NetTransportUdp.h>
+#include <trManager/TickScheduler.h>
 
 #include <iostream>
+#include <chrono>
+#include <thread>
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -305,4 +312,349 @@ TEST_F(ActorTests, Listener)
 
     //We should have no message in the system
     EXPECT_EQ(TestMessage::GetInstCount(), 0);
+}
+
+/**
+ * @fn    TEST_F(ActorTests, TickRate)
+ *
+ * @brief    Tests the level of detail scheduling of the Tick message. 
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ActorTests, TickRate)
+{
+    //Add two TestActor1 instances to the system
+    trBase::SmrtPtr<TestActor1> actor = new TestActor1();
+    EXPECT_EQ(mSysMan->RegisterActor(*actor), true);
+    trBase::SmrtPtr<TestActor1> slowActor = new TestActor1("SlowActor");
+    EXPECT_EQ(mSysMan->RegisterActor(*slowActor), true);
+
+    //Tick the second actor only every third frame
+    mSysMan->SetTickRate(*slowActor, 3);
+    EXPECT_EQ(mSysMan->GetTickRate(*slowActor), 3u);
+    EXPECT_EQ(mSysMan->GetTickRate(*actor), 1u);
+
+    //Advance System Manager one frame at a time
+    for (int i = 0; i < 6; ++i)
+    {
+        mSysDirector->RunOnce();
+    }
+
+    //Check the number of ticks each actor received
+    EXPECT_EQ(actor->GetTickMsgNum(), 6);
+    EXPECT_EQ(slowActor->GetTickMsgNum(), 2);
+
+    //Change the rate back at runtime
+    mSysMan->SetTickRate(*slowActor, 1);
+    mSysDirector->RunOnce();
+    mSysDirector->RunOnce();
+
+    EXPECT_EQ(actor->GetTickMsgNum(), 8);
+    EXPECT_EQ(slowActor->GetTickMsgNum(), 4);
+
+    //Unregister the actors
+    EXPECT_EQ(mSysMan->UnregisterActor(slowActor->GetUUID()), true);
+    EXPECT_EQ(mSysMan->UnregisterActor(actor->GetUUID()), true);
+
+    //Release ownership of this pointer
+    slowActor.Release();
+    actor.Release();
+
+    //Advance System Manager one frame at a time
+    mSysDirector->RunOnce();
+
+    //Make sure we dont have any instances of the actor
+    EXPECT_EQ(TestActor1::GetInstCount(), 0);
+}
+
+/**
+ * @fn    TEST_F(ActorTests, TickScheduleOnce)
+ *
+ * @brief    Tests that scheduling the same Tick again for an entity does not accumulate its time twice. 
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ActorTests, TickScheduleOnce)
+{
+    trManager::TickScheduler scheduler;
+    trBase::UniqueId id;
+    scheduler.SetTickRate(id, 2);
+
+    //The Tick reads the timing structure, so it can be reused for every frame
+    trManager::TimingStructure timeStruct;
+    timeStruct.deltaSimTime = 0.5;
+    timeStruct.deltaRealTime = 0.5;
+    trBase::SmrtPtr<trManager::MessageTick> tick = new trManager::MessageTick(&mSysMan->GetUUID(), timeStruct);
+
+    //The first entity gets the even frames
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        timeStruct.frameNumber = frame;
+        const trManager::MessageTick* scheduled = scheduler.Schedule(*tick, id);
+        EXPECT_EQ(scheduler.Schedule(*tick, id), scheduled);
+        if (frame % 2 == 0)
+        {
+            ASSERT_NE(scheduled, nullptr);
+            EXPECT_EQ(scheduled->GetDeltaSimTime(), frame == 0 ? 0.5 : 1.0);
+            EXPECT_EQ(scheduled->GetDeltaRealTime(), frame == 0 ? 0.5 : 1.0);
+        }
+        else
+        {
+            EXPECT_EQ(scheduled, nullptr);
+        }
+    }
+}
+
+/**
+ * @fn    TEST_F(ActorTests, InterestArea)
+ *
+ * @brief    Tests the area of interest registrations for messages about entities. 
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ActorTests, InterestArea)
+{
+    //Add a listener, and two actors to listen about
+    trBase::SmrtPtr<TestActor3> listener = new TestActor3();
+    EXPECT_EQ(mSysMan->RegisterActor(*listener), true);
+    trBase::SmrtPtr<TestActor2> nearActor = new TestActor2("NearActor");
+    EXPECT_EQ(mSysMan->RegisterActor(*nearActor), true);
+    trBase::SmrtPtr<TestActor2> farActor = new TestActor2("FarActor");
+    EXPECT_EQ(mSysMan->RegisterActor(*farActor), true);
+
+    //Publish the positions, and listen to everything within 10 units of the listener
+    listener->SetPosition(trBase::Vec3(0.0, 0.0, 0.0));
+    nearActor->SetPosition(trBase::Vec3(5.0, 0.0, 0.0));
+    farActor->SetPosition(trBase::Vec3(50.0, 0.0, 0.0));
+    listener->RegisterForMessagesInArea(10.0, TestActor3::ON_TEST_ACTOR_2_INVOKABLE);
+
+    //The areas are updated at the end of the frame
+    mSysDirector->RunOnce();
+
+    //Only the message about the near actor should arrive
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &nearActor->GetUUID())), true);
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &farActor->GetUUID())), true);
+    mSysDirector->RunOnce();
+    EXPECT_EQ(listener->GetTestMsgCount(), 1);
+
+    //Swap the actors around
+    nearActor->SetPosition(trBase::Vec3(100.0, 0.0, 0.0));
+    farActor->SetPosition(trBase::Vec3(0.0, 8.0, 0.0));
+    mSysDirector->RunOnce();
+
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &nearActor->GetUUID())), true);
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &farActor->GetUUID())), true);
+    mSysDirector->RunOnce();
+    EXPECT_EQ(listener->GetTestMsgCount(), 2);
+
+    //A direct registration about an actor in the area should not double the messages
+    mSysMan->RegisterForMessagesAboutEntity(*listener, farActor->GetUUID(), TestActor3::ON_TEST_ACTOR_2_INVOKABLE);
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &farActor->GetUUID())), true);
+    mSysDirector->RunOnce();
+    EXPECT_EQ(listener->GetTestMsgCount(), 3);
+
+    //A direct registration through another invokable gets the message too, and can unregister while it is sent
+    mSysMan->UnregisterFromMessagesAboutEntity(*listener, farActor->GetUUID());
+    mSysMan->RegisterForMessagesAboutEntity(*listener, farActor->GetUUID(), TestActor3::ON_LAST_ABOUT_INVOKABLE);
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &farActor->GetUUID())), true);
+    mSysDirector->RunOnce();
+    EXPECT_EQ(listener->GetTestMsgCount(), 5);
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &farActor->GetUUID())), true);
+    mSysDirector->RunOnce();
+    EXPECT_EQ(listener->GetTestMsgCount(), 6);
+
+    //Without the area, only the direct registration is left
+    mSysMan->RegisterForMessagesAboutEntity(*listener, farActor->GetUUID(), TestActor3::ON_TEST_ACTOR_2_INVOKABLE);
+    listener->UnregisterFromMessagesInArea();
+    mSysMan->UnregisterFromMessagesAboutEntity(*listener, farActor->GetUUID());
+    EXPECT_EQ(mSysMan->SendMessage(*new TestMessage(&mSysMan->GetUUID(), &farActor->GetUUID())), true);
+    mSysDirector->RunOnce();
+    EXPECT_EQ(listener->GetTestMsgCount(), 6);
+
+    //Unregistered actors leave the spatial index
+    EXPECT_EQ(mSysMan->GetSpatialIndex().GetSize(), 3u);
+    EXPECT_EQ(mSysMan->UnregisterActor(farActor->GetUUID()), true);
+    EXPECT_EQ(mSysMan->UnregisterActor(nearActor->GetUUID()), true);
+    EXPECT_EQ(mSysMan->UnregisterActor(listener->GetUUID()), true);
+    EXPECT_EQ(mSysMan->GetSpatialIndex().GetSize(), 0u);
+
+    //Release ownership of this pointer
+    farActor.Release();
+    nearActor.Release();
+    listener.Release();
+
+    //Advance System Manager one frame at a time
+    mSysDirector->RunOnce();
+
+    //Make sure we dont have any instances of the actors
+    EXPECT_EQ(TestActor3::GetInstCount(), 0);
+    EXPECT_EQ(TestActor2::GetInstCount(), 0);
+    EXPECT_EQ(TestMessage::GetInstCount(), 0);
+}
+
+/**
+ * @fn    TEST_F(ActorTests, ReplicatedFields)
+ *
+ * @brief    Tests the quantization and delta compression of replicated fields. 
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ActorTests, ReplicatedFields)
+{
+    trBase::SmrtPtr<TestActor4> actor = new TestActor4();
+    actor->mPosition.Set(12.5, -300.25, 999.0);
+    actor->mRotation.MakeRotate(0.75, trBase::Vec3(0.0, 0.0, 1.0));
+    actor->mHealth = 42;
+
+    trManager::ReplicatedFields& fields = *actor->GetReplicatedFields();
+    EXPECT_EQ(fields.GetFieldCount(), 3u);
+
+    //A full delta rebuilds the values within the quantization error
+    std::vector<char> baseline;
+    fields.WriteSnapshot(baseline);
+    EXPECT_EQ(baseline.size(), fields.GetSnapshotSize());
+
+    trManager::JournalData fullDelta;
+    EXPECT_EQ(fields.WriteDelta(std::vector<char>(), baseline, fullDelta), true);
+
+    trBase::SmrtPtr<TestActor4> proxy = new TestActor4(true);
+    std::vector<char> rebuilt;
+    trManager::JournalData fullRead(fullDelta.GetData(), fullDelta.GetSize());
+    EXPECT_EQ(proxy->GetReplicatedFields()->ReadDelta(std::vector<char>(), fullRead, rebuilt), true);
+    EXPECT_EQ(rebuilt, baseline);
+    EXPECT_EQ(proxy->GetReplicatedFields()->ReadSnapshot(rebuilt), true);
+    EXPECT_NEAR(proxy->mPosition.X(), 12.5, 0.01);
+    EXPECT_NEAR(proxy->mPosition.Y(), -300.25, 0.01);
+    EXPECT_NEAR(proxy->mPosition.Z(), 999.0, 0.01);
+    EXPECT_NEAR(proxy->mRotation.Z(), actor->mRotation.Z(), 0.001);
+    EXPECT_NEAR(proxy->mRotation.W(), actor->mRotation.W(), 0.001);
+    EXPECT_EQ(proxy->mHealth, 42);
+
+    //Unchanged fields are left out of the delta
+    trManager::JournalData emptyDelta;
+    EXPECT_EQ(fields.WriteDelta(baseline, baseline, emptyDelta), false);
+
+    actor->mHealth = 41;
+    std::vector<char> snapshot;
+    fields.WriteSnapshot(snapshot);
+    trManager::JournalData delta;
+    EXPECT_EQ(fields.WriteDelta(baseline, snapshot, delta), true);
+    EXPECT_EQ(delta.GetSize(), 1u + sizeof(int));
+
+    trManager::JournalData deltaRead(delta.GetData(), delta.GetSize());
+    EXPECT_EQ(fields.ReadDelta(baseline, deltaRead, rebuilt), true);
+    EXPECT_EQ(rebuilt, snapshot);
+
+    proxy.Release();
+    actor.Release();
+    EXPECT_EQ(TestActor4::GetInstCount(), 0);
+}
+
+/**
+ * @fn    TEST_F(ActorTests, Replication)
+ *
+ * @brief    Tests replicating actors from a server world to a client world over the loopback interface. 
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ActorTests, Replication)
+{
+    const int actorCount = 10;
+    const int frameCount = 30;
+
+    //The server world, where only the first actor moves
+    trBase::SmrtPtr<trManager::SystemManager> serverWorld = new trManager::SystemManager("ServerWorld");
+    trBase::SmrtPtr<trCore::SystemDirector> serverSysDirector = new trCore::SystemDirector();
+    serverSysDirector->SetFixedDeltaTime(0.1);
+    EXPECT_EQ(serverWorld->RegisterDirector(*serverSysDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<trManager::ReplicationDirector> server = new trManager::ReplicationDirector();
+    server->SetSnapshotRate(0.0);
+    EXPECT_EQ(serverWorld->RegisterDirector(*server, trManager::DirectorPriority::LOWEST), true);
+
+    //The client world, with a proxy for each server actor
+    trBase::SmrtPtr<trManager::SystemManager> clientWorld = new trManager::SystemManager("ClientWorld");
+    trBase::SmrtPtr<trCore::SystemDirector> clientSysDirector = new trCore::SystemDirector();
+    clientSysDirector->SetFixedDeltaTime(0.1);
+    EXPECT_EQ(clientWorld->RegisterDirector(*clientSysDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<trManager::ReplicationDirector> client = new trManager::ReplicationDirector();
+    EXPECT_EQ(clientWorld->RegisterDirector(*client, trManager::DirectorPriority::HIGHEST), true);
+
+    std::vector<trBase::SmrtPtr<TestActor4>> actors;
+    std::vector<trBase::SmrtPtr<TestActor4>> proxies;
+    for (int i = 0; i < actorCount; ++i)
+    {
+        actors.push_back(new TestActor4());
+        actors.back()->mPosition.Set(i * 10.0, 0.0, 0.0);
+        EXPECT_EQ(serverWorld->RegisterActor(*actors.back()), true);
+        EXPECT_EQ(server->AddReplicatedActor(*actors.back()), true);
+
+        proxies.push_back(new TestActor4(true));
+        proxies.back()->SetUUID(actors.back()->GetUUID());
+        proxies.back()->GetReplicatedFields()->SetInterpolationDelay(0.0);
+        EXPECT_EQ(clientWorld->RegisterActor(*proxies.back()), true);
+    }
+    actors[0]->mVelocity.Set(10.0, 0.0, 0.0);
+
+    //Connect the worlds
+    trBase::SmrtPtr<trManager::NetTransportUdp> clientUdp = new trManager::NetTransportUdp();
+    EXPECT_EQ(clientUdp->Listen(0), true);
+    trBase::SmrtPtr<trManager::NetTransportUdp> serverUdp = new trManager::NetTransportUdp();
+    EXPECT_EQ(serverUdp->Connect("127.0.0.1", clientUdp->GetLocalPort()), true);
+    server->AddClient(*serverUdp);
+    client->SetServerTransport(clientUdp.Get());
+
+    //The server sends the positions from before the actors moved in the frame
+    std::vector<double> sentPositions(actorCount);
+    for (int i = 0; i < frameCount; ++i)
+    {
+        for (int j = 0; j < actorCount; ++j)
+        {
+            sentPositions[j] = actors[j]->mPosition.X();
+        }
+        serverSysDirector->RunOnce();
+
+        //Run the client until the snapshot arrived and was acknowledged
+        std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (client->GetReceivedSnapshotCount() < static_cast<unsigned long long>(i + 1) && std::chrono::steady_clock::now() < timeout)
+        {
+            clientSysDirector->RunOnce();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    clientSysDirector->RunOnce();
+
+    //Every snapshot arrived, and the proxies caught up with the server
+    EXPECT_EQ(server->GetSentSnapshotCount(), static_cast<unsigned long long>(frameCount));
+    EXPECT_EQ(client->GetReceivedSnapshotCount(), static_cast<unsigned long long>(frameCount));
+    EXPECT_EQ(client->GetDroppedSnapshotCount(), 0u);
+    for (int i = 0; i < actorCount; ++i)
+    {
+        EXPECT_NEAR(proxies[i]->mPosition.X(), sentPositions[i], 0.01);
+        EXPECT_EQ(proxies[i]->mHealth, actors[i]->mHealth);
+    }
+    EXPECT_GT(proxies[0]->mPosition.X(), 0.0);
+
+    //Only the moving actor is sent after the first snapshot
+    EXPECT_LT(server->GetSentBytes() * 5, server->GetFullSnapshotBytes());
+
+    //Shut down the worlds
+    actors.clear();
+    proxies.clear();
+    server.Release();
+    client.Release();
+
+    trBase::SmrtPtr<trManager::SystemManager> worlds[2] = { serverWorld, clientWorld };
+    trBase::SmrtPtr<trCore::SystemDirector> sysDirectors[2] = { serverSysDirector, clientSysDirector };
+    for (int i = 0; i < 2; ++i)
+    {
+        trBase::SmrtPtr<trCore::MessageSystemControl> msg = new trCore::MessageSystemControl(NULL, trCore::SystemControls::SHUT_DOWN);
+        worlds[i]->SendMessage(*msg);
+        worlds[i]->UnregisterAllDirectors();
+        sysDirectors[i]->RunOnce();
+    }
 }
\ No newline at end of file
@@ -23,14 +23,39 @@
 
 #include "TestDirector1.h"
 #include "TestDirector2.h"
+#include "TestMessage.h"
 
 #include <gtest/gtest.h>
 
 #include <trCore/MessageSystemControl.h>
 #include <trCore/SystemControls.h>
 #include <trManager/DirectorPriority.h>
+#include <trManager/JournalRecorder.h>
+#include <trManager/JournalPlayer.h>
+#include <trManager/MessageTick.h>
+#include <trManager/NetworkDirector.h>
+#include <trManager/NetTransportTcp.h>
+#include <trManager/NetTransportUdp.h>
+#include <trUtil/ExceptionInvalidParameter.cpp.h>
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/Metrics/MetricsRegistry.h>
+#include <trUtil/Metrics/MetricsServer.h>
 
 #include <iostream>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+#ifdef TR_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 DirectorTests::DirectorTests()
@@ -331,4 +356,417 @@ TEST_F(DirectorTests, SendReceiveMsg)
 
     //We should have no director2 in the system of this type
     EXPECT_EQ(TestDirector2::GetInstCount(), 0);
+}
+
+/**
+ * @fn  TEST_F(DirectorTests, MessageTimeBudget)
+ *
+ * @brief   Tests the deferral of messages that do not fit into the message time budget. 
+ *
+ * @param   parameter1  The first parameter.
+ * @param   parameter2  The second parameter.
+ */
+TEST_F(DirectorTests, MessageTimeBudget)
+{
+    //Add a Directors to the system
+    trBase::SmrtPtr<TestDirector1> director = new TestDirector1();
+    EXPECT_EQ(mSysMan->RegisterDirector(*director, trManager::DirectorPriority::NORMAL), true);
+    trBase::SmrtPtr<TestDirector2> director2 = new TestDirector2();
+    EXPECT_EQ(mSysMan->RegisterDirector(*director2, trManager::DirectorPriority::NORMAL), true);
+
+    //Flush out the registration messages
+    mSysDirector->RunOnce();
+    mSysMan->ResetDeferredMessageStats();
+
+    //Set a budget that is too small to fit more than one message per frame
+    mSysMan->SetMessageTimeBudget(0.000000001);
+
+    //Send a few test messages
+    EXPECT_EQ(director2->SendTestMessage(), true);
+    EXPECT_EQ(director2->SendTestMessage(), true);
+    EXPECT_EQ(director2->SendTestMessage(), true);
+    EXPECT_EQ(director2->SendTestMessage(), true);
+
+    //Advance System Manager one frame at a time
+    mSysDirector->RunOnce();
+
+    //System messages are never deferred, but some of the test messages should be
+    EXPECT_EQ(director->GetTickMsgNumber(), 2);
+    EXPECT_LT(director->GetTestMessageNum(), 4);
+    EXPECT_GT(mSysMan->GetMessageBacklog(), 0u);
+
+    //Disable the budget, and let the rest of the messages through
+    mSysMan->SetMessageTimeBudget(0.0);
+    mSysDirector->RunOnce();
+
+    EXPECT_EQ(director->GetTestMessageNum(), 4);
+    EXPECT_EQ(mSysMan->GetMessageBacklog(), 0u);
+    EXPECT_GT(mSysMan->GetDeferredMessageCount(), 0u);
+    EXPECT_GT(mSysMan->GetTotalDeferredMessages(), 0u);
+    EXPECT_EQ(mSysMan->GetDeferredFrameCount(), 1u);
+
+    //Unregister the director. 
+    EXPECT_EQ(mSysMan->UnregisterDirector(*director2.Release()), true);
+    EXPECT_EQ(mSysMan->UnregisterDirector(*director.Release()), true);
+
+    //Advance System Manager one frame at a time  
+    mSysDirector->RunOnce();
+}
+
+/**
+ * @fn  TEST_F(DirectorTests, MultipleWorlds)
+ *
+ * @brief   Tests independent System Manager worlds, running side by side on separate threads. 
+ *
+ * @param   parameter1  The first parameter.
+ * @param   parameter2  The second parameter.
+ */
+TEST_F(DirectorTests, MultipleWorlds)
+{
+    const int frameCount = 50;
+
+    //Create two independent worlds, each with its own System Director
+    trBase::SmrtPtr<trManager::SystemManager> worlds[2] = { new trManager::SystemManager("World1"), new trManager::SystemManager("World2") };
+    trBase::SmrtPtr<trCore::SystemDirector> sysDirectors[2];
+    trBase::SmrtPtr<TestDirector1> directors[2];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        sysDirectors[i] = new trCore::SystemDirector();
+        EXPECT_EQ(worlds[i]->RegisterDirector(*sysDirectors[i], trManager::DirectorPriority::HIGHEST), true);
+
+        //The same Director name can be used in each world
+        directors[i] = new TestDirector1();
+        EXPECT_EQ(worlds[i]->RegisterDirector(*directors[i], trManager::DirectorPriority::NORMAL), true);
+    }
+
+    //Run each world on its own thread
+    std::thread worldThread([&]()
+    {
+        for (int i = 0; i < frameCount; ++i)
+        {
+            sysDirectors[1]->RunOnce();
+        }
+    });
+
+    for (int i = 0; i < frameCount / 2; ++i)
+    {
+        sysDirectors[0]->RunOnce();
+    }
+    worldThread.join();
+
+    //Each world only ticked its own Directors, and the default world did not tick at all
+    EXPECT_EQ(directors[0]->GetTickMsgNumber(), frameCount / 2);
+    EXPECT_EQ(directors[1]->GetTickMsgNumber(), frameCount);
+    EXPECT_EQ(mSysDirector->GetTimeStructure().frameNumber, 0);
+
+    //Shut down the worlds
+    for (int i = 0; i < 2; ++i)
+    {
+        trBase::SmrtPtr<trCore::MessageSystemControl> msg = new trCore::MessageSystemControl(NULL, trCore::SystemControls::SHUT_DOWN);
+        worlds[i]->SendMessage(*msg);
+        directors[i].Release();
+        worlds[i]->UnregisterAllDirectors();
+        sysDirectors[i]->RunOnce();
+    }
+}
+
+/**
+ * @fn  TEST_F(DirectorTests, MessageJournal)
+ *
+ * @brief   Tests recording the message traffic of a world, and replaying it into another one. 
+ *
+ * @param   parameter1  The first parameter.
+ * @param   parameter2  The second parameter.
+ */
+TEST_F(DirectorTests, MessageJournal)
+{
+    const std::string journalFile = "MessageJournalTest.trj";
+    const int frameCount = 10;
+
+    //Record a world where a Director sends a test message every frame
+    trBase::SmrtPtr<trManager::SystemManager> recordWorld = new trManager::SystemManager("RecordWorld");
+    trBase::SmrtPtr<trCore::SystemDirector> sysDirector = new trCore::SystemDirector();
+    EXPECT_EQ(recordWorld->RegisterDirector(*sysDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<TestDirector2> sender = new TestDirector2();
+    EXPECT_EQ(recordWorld->RegisterDirector(*sender, trManager::DirectorPriority::NORMAL), true);
+    trBase::SmrtPtr<trManager::JournalRecorder> recorder = new trManager::JournalRecorder();
+    EXPECT_EQ(recordWorld->RegisterDirector(*recorder, trManager::DirectorPriority::LOWEST), true);
+    EXPECT_EQ(recorder->Open(journalFile), true);
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        EXPECT_EQ(sender->SendTestMessage(), true);
+        sysDirector->RunOnce();
+    }
+
+    EXPECT_EQ(recorder->GetRecordedFrameCount(), static_cast<unsigned long long>(frameCount));
+    EXPECT_GT(recorder->GetRecordedMessageCount(), static_cast<unsigned long long>(frameCount * 2));
+    recorder->Close();
+
+    //Replay the journal into a world with a listening Director, and a live sender
+    trBase::SmrtPtr<trManager::SystemManager> replayWorld = new trManager::SystemManager("ReplayWorld");
+    trBase::SmrtPtr<TestDirector1> listener = new TestDirector1();
+    EXPECT_EQ(replayWorld->RegisterDirector(*listener, trManager::DirectorPriority::NORMAL), true);
+    trBase::SmrtPtr<TestDirector2> liveSender = new TestDirector2();
+    EXPECT_EQ(replayWorld->RegisterDirector(*liveSender, trManager::DirectorPriority::NORMAL), true);
+
+    {
+        //The live sender sends again what was recorded, which should be dropped during the replay
+        trManager::JournalPlayer player(*replayWorld);
+        player.RegisterMessageType(TestMessage::MESSAGE_TYPE, [&liveSender](const trManager::JournalPlayer::MessageInfo& info)
+        {
+            EXPECT_EQ(liveSender->SendTestMessage(), false);
+            return trBase::SmrtPtr<trManager::MessageBase>(new TestMessage(info.fromActorID, info.aboutActorID));
+        });
+
+        EXPECT_EQ(player.Open(journalFile), true);
+        EXPECT_EQ(player.GetFrameCount(), static_cast<unsigned int>(frameCount));
+
+        //Play everything, the Ticks and test messages should arrive like they did when recorded
+        EXPECT_EQ(player.PlayAll(), static_cast<unsigned int>(frameCount));
+        EXPECT_EQ(listener->GetTickMsgNumber(), frameCount);
+        EXPECT_EQ(listener->GetTestMessageNum(), frameCount);
+        EXPECT_EQ(replayWorld->GetSuppressedMessageCount(), static_cast<unsigned long long>(frameCount));
+        EXPECT_EQ(replayWorld->GetSuppressSentMessages(), false);
+        EXPECT_EQ(player.GetTimeStructure().frameNumber, frameCount - 1);
+        EXPECT_GT(player.GetSkippedMessageCount(), 0u);
+
+        //Seek back, and play a single frame again
+        EXPECT_EQ(player.Seek(frameCount / 2), true);
+        EXPECT_EQ(player.PlayFrame(), true);
+        EXPECT_EQ(player.GetTimeStructure().frameNumber, frameCount / 2);
+        EXPECT_EQ(listener->GetTickMsgNumber(), frameCount + 1);
+        EXPECT_EQ(listener->GetTestMessageNum(), frameCount + 1);
+        EXPECT_EQ(player.Seek(frameCount), false);
+    }
+
+    //Shut down the worlds
+    trBase::SmrtPtr<trCore::MessageSystemControl> msg = new trCore::MessageSystemControl(NULL, trCore::SystemControls::SHUT_DOWN);
+    recordWorld->SendMessage(*msg);
+    sender.Release();
+    recorder.Release();
+    recordWorld->UnregisterAllDirectors();
+    sysDirector->RunOnce();
+
+    listener.Release();
+    liveSender.Release();
+    replayWorld->UnregisterAllDirectors();
+    replayWorld->ShutDown();
+
+    std::remove(journalFile.c_str());
+}
+
+/**
+ * @fn  TEST_F(DirectorTests, NetworkLoopback)
+ *
+ * @brief   Tests sending network messages between two worlds over the loopback interface. 
+ *
+ * @param   parameter1  The first parameter.
+ * @param   parameter2  The second parameter.
+ */
+TEST_F(DirectorTests, NetworkLoopback)
+{
+    auto createTestMessage = [](const trManager::NetworkDirector::MessageInfo& info)
+    {
+        return trBase::SmrtPtr<trManager::MessageBase>(new TestMessage(info.fromActorID, info.aboutActorID));
+    };
+
+    //The sending world
+    trBase::SmrtPtr<trManager::SystemManager> sendWorld = new trManager::SystemManager("SendWorld");
+    trBase::SmrtPtr<trCore::SystemDirector> sendSysDirector = new trCore::SystemDirector();
+    EXPECT_EQ(sendWorld->RegisterDirector(*sendSysDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<trManager::NetworkDirector> sendNetDirector = new trManager::NetworkDirector();
+    EXPECT_EQ(sendWorld->RegisterDirector(*sendNetDirector, trManager::DirectorPriority::LOWEST), true);
+    EXPECT_EQ(sendWorld->GetNetworkDirector(), sendNetDirector.Get());
+
+    //The receiving world
+    trBase::SmrtPtr<trManager::SystemManager> receiveWorld = new trManager::SystemManager("ReceiveWorld");
+    trBase::SmrtPtr<trCore::SystemDirector> receiveSysDirector = new trCore::SystemDirector();
+    EXPECT_EQ(receiveWorld->RegisterDirector(*receiveSysDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<trManager::NetworkDirector> receiveNetDirector = new trManager::NetworkDirector();
+    EXPECT_EQ(receiveWorld->RegisterDirector(*receiveNetDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<TestDirector1> listener = new TestDirector1();
+    EXPECT_EQ(receiveWorld->RegisterDirector(*listener, trManager::DirectorPriority::NORMAL), true);
+
+    //Connect the worlds over UDP and TCP
+    trBase::SmrtPtr<trManager::NetTransportUdp> receiveUdp = new trManager::NetTransportUdp();
+    trBase::SmrtPtr<trManager::NetTransportTcp> receiveTcp = new trManager::NetTransportTcp();
+    EXPECT_EQ(receiveUdp->Listen(0), true);
+    EXPECT_EQ(receiveTcp->Listen(0), true);
+
+    trBase::SmrtPtr<trManager::NetTransportUdp> sendUdp = new trManager::NetTransportUdp();
+    trBase::SmrtPtr<trManager::NetTransportTcp> sendTcp = new trManager::NetTransportTcp();
+    EXPECT_EQ(sendUdp->Connect("127.0.0.1", receiveUdp->GetLocalPort()), true);
+    EXPECT_EQ(sendTcp->Connect("127.0.0.1", receiveTcp->GetLocalPort()), true);
+
+    sendNetDirector->SetUnreliableTransport(sendUdp.Get());
+    sendNetDirector->SetReliableTransport(sendTcp.Get());
+    sendNetDirector->RegisterMessageType(TestMessage::MESSAGE_TYPE, createTestMessage);
+    EXPECT_EQ(sendNetDirector->Start(), true);
+
+    receiveNetDirector->SetUnreliableTransport(receiveUdp.Get());
+    receiveNetDirector->SetReliableTransport(receiveTcp.Get());
+    receiveNetDirector->RegisterMessageType(TestMessage::MESSAGE_TYPE, createTestMessage);
+    EXPECT_EQ(receiveNetDirector->Start(), true);
+
+    //Runs the receiving world until the expected number of messages arrived, or it times out
+    auto waitForMessages = [&](int count)
+    {
+        std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (listener->GetTestMessageNum() < count && std::chrono::steady_clock::now() < timeout)
+        {
+            receiveSysDirector->RunOnce();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return listener->GetTestMessageNum();
+    };
+
+    //Send an unreliable message, it is batched and sent on the senders Tick
+    trBase::SmrtPtr<trBase::UniqueId> aboutId = new trBase::UniqueId();
+    trBase::SmrtPtr<TestMessage> msg = new TestMessage(&sendNetDirector->GetUUID(), aboutId.Get());
+    EXPECT_EQ(sendWorld->SendNetworkMessage(*msg), true);
+    sendSysDirector->RunOnce();
+
+    EXPECT_EQ(waitForMessages(1), 1);
+    EXPECT_EQ(sendNetDirector->GetSentMessageCount(), 1u);
+    EXPECT_EQ(receiveNetDirector->GetReceivedMessageCount(), 1u);
+
+    //Send the same type reliably
+    sendNetDirector->RegisterMessageType(TestMessage::MESSAGE_TYPE, createTestMessage, true);
+    EXPECT_EQ(sendWorld->SendNetworkMessage(*msg), true);
+    sendSysDirector->RunOnce();
+
+    EXPECT_EQ(waitForMessages(2), 2);
+    EXPECT_EQ(sendNetDirector->GetSentPacketCount(), 2u);
+    EXPECT_EQ(receiveNetDirector->GetDroppedPacketCount(), 0u);
+    EXPECT_EQ(receiveNetDirector->GetUnknownMessageCount(), 0u);
+
+    //Unregistered types are not sent
+    trBase::SmrtPtr<trManager::MessageTick> tick = new trManager::MessageTick(&sendNetDirector->GetUUID(), sendSysDirector->GetTimeStructure());
+    EXPECT_EQ(sendWorld->SendNetworkMessage(*tick), false);
+
+    //Shut down the worlds
+    sendNetDirector->Stop();
+    receiveNetDirector->Stop();
+    EXPECT_EQ(receiveNetDirector->IsRunning(), false);
+
+    trBase::SmrtPtr<trManager::SystemManager> worlds[2] = { sendWorld, receiveWorld };
+    trBase::SmrtPtr<trCore::SystemDirector> sysDirectors[2] = { sendSysDirector, receiveSysDirector };
+    sendNetDirector.Release();
+    receiveNetDirector.Release();
+    listener.Release();
+    for (int i = 0; i < 2; ++i)
+    {
+        trBase::SmrtPtr<trCore::MessageSystemControl> shutDownMsg = new trCore::MessageSystemControl(NULL, trCore::SystemControls::SHUT_DOWN);
+        worlds[i]->SendMessage(*shutDownMsg);
+        worlds[i]->UnregisterAllDirectors();
+        sysDirectors[i]->RunOnce();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+static std::string HttpGet(unsigned short port, const std::string& path)
+{
+    auto connection = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+    std::string response;
+    if (connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+    {
+        std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(connection, request.c_str(), static_cast<int>(request.size()), 0);
+
+        char buffer[4096];
+        int received = 0;
+        while ((received = static_cast<int>(recv(connection, buffer, sizeof(buffer), 0))) > 0)
+        {
+            response.append(buffer, received);
+        }
+    }
+
+#ifdef TR_WIN
+    closesocket(connection);
+#else
+    close(connection);
+#endif
+    return response;
+}
+
+/**
+ * @fn  TEST_F(DirectorTests, EngineMetrics)
+ *
+ * @brief   Tests the engine metrics of a world, and serving them over HTTP on localhost. 
+ *
+ * @param   parameter1  The first parameter.
+ * @param   parameter2  The second parameter.
+ */
+TEST_F(DirectorTests, EngineMetrics)
+{
+    trUtil::Metrics::MetricsRegistry& registry = trUtil::Metrics::MetricsRegistry::GetInstance();
+
+    trBase::SmrtPtr<trManager::SystemManager> world = new trManager::SystemManager("MetricsWorld");
+    trBase::SmrtPtr<trCore::SystemDirector> sysDirector = new trCore::SystemDirector();
+    EXPECT_EQ(world->RegisterDirector(*sysDirector, trManager::DirectorPriority::HIGHEST), true);
+    trBase::SmrtPtr<TestDirector1> listener = new TestDirector1();
+    EXPECT_EQ(world->RegisterDirector(*listener, trManager::DirectorPriority::NORMAL), true);
+
+    //A second world with the same name, which should not share the metrics of the first one
+    trBase::SmrtPtr<trManager::SystemManager> sameNameWorld = new trManager::SystemManager("MetricsWorld");
+    const std::string worldId = world->GetUUID().ToString();
+    const std::string sameNameWorldId = sameNameWorld->GetUUID().ToString();
+    EXPECT_NE(&registry.GetGauge("tr_registered_actors", "", { { "world", "MetricsWorld" }, { "world_id", worldId } }),
+        &registry.GetGauge("tr_registered_actors", "", { { "world", "MetricsWorld" }, { "world_id", sameNameWorldId } }));
+
+    //Destroying a world removes its metrics
+    EXPECT_NE(registry.GetPrometheusText().find(sameNameWorldId), std::string::npos);
+    sameNameWorld.Release();
+    EXPECT_EQ(registry.GetPrometheusText().find(sameNameWorldId), std::string::npos);
+
+    //Processed messages are counted per type
+    trUtil::Metrics::Counter& testMessages = registry.GetCounter("tr_messages_processed_total", "", { { "world", "MetricsWorld" }, { "world_id", worldId }, { "type", TestMessage::MESSAGE_TYPE } });
+    trUtil::Metrics::Histogram& framePhase = registry.GetHistogram("tr_frame_phase_seconds", "", trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, { { "world", "MetricsWorld" }, { "world_id", worldId }, { "phase", "frame" } });
+    EXPECT_EQ(framePhase.GetCount(), 0u);
+    for (int i = 0; i < 3; ++i)
+    {
+        trBase::SmrtPtr<TestMessage> msg = new TestMessage(&listener->GetUUID(), nullptr);
+        world->SendMessage(*msg);
+    }
+    sysDirector->RunOnce();
+
+    EXPECT_EQ(testMessages.GetValue(), 3u);
+    EXPECT_EQ(registry.GetGauge("tr_message_queue_depth", "", { { "world", "MetricsWorld" }, { "world_id", worldId } }).GetValue(), 0.0);
+    EXPECT_EQ(framePhase.GetCount(), 1u);
+    EXPECT_EQ(registry.GetHistogram("tr_frame_seconds", "", trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, { { "world", "MetricsWorld" }, { "world_id", worldId } }).GetCount(), 1u);
+
+    //A name can only be used by one type of metric
+    EXPECT_THROW(registry.GetGauge("tr_messages_processed_total", ""), trUtil::ExceptionInvalidParameter);
+
+    //Serve the metrics on a free port
+    trUtil::Metrics::MetricsServer server;
+    EXPECT_EQ(server.Start(0), true);
+    EXPECT_NE(server.GetPort(), 0);
+
+    std::string response = HttpGet(server.GetPort(), "/metrics");
+    EXPECT_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+    EXPECT_NE(response.find("# TYPE tr_messages_processed_total counter"), std::string::npos);
+    EXPECT_NE(response.find("tr_messages_processed_total{type=\"" + TestMessage::MESSAGE_TYPE.Get() + "\",world=\"MetricsWorld\",world_id=\"" + worldId + "\"} 3"), std::string::npos);
+    EXPECT_NE(response.find("tr_frame_phase_seconds_bucket{phase=\"frame\",world=\"MetricsWorld\",world_id=\"" + worldId + "\",le=\"+Inf\"}"), std::string::npos);
+
+    EXPECT_EQ(HttpGet(server.GetPort(), "/nothing").compare(0, 22, "HTTP/1.1 404 Not Found"), 0);
+
+    server.Stop();
+    EXPECT_EQ(server.IsRunning(), false);
+
+    //Shut down the world
+    listener.Release();
+    trBase::SmrtPtr<trCore::MessageSystemControl> shutDownMsg = new trCore::MessageSystemControl(NULL, trCore::SystemControls::SHUT_DOWN);
+    world->SendMessage(*shutDownMsg);
+    world->UnregisterAllDirectors();
+    sysDirector->RunOnce();
 }
\ No newline at end of file
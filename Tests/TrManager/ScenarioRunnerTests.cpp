@@ -0,0 +1,104 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include "ScenarioRunnerTests.h"
+
+#include <trStart/ScenarioRunner.h>
+
+#include <cstdio>
+#include <fstream>
+
+//////////////////////////////////////////////////////////////////////////
+ScenarioRunnerTests::ScenarioRunnerTests()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+ScenarioRunnerTests::~ScenarioRunnerTests()
+{
+    std::remove(mFileName.c_str());
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ScenarioRunnerTests::WriteScenario(const std::string& text)
+{
+    std::ofstream file(mFileName.c_str());
+    file << text;
+}
+
+/**
+ * @fn    TEST_F(ScenarioRunnerTests, ScenarioLimits)
+ *
+ * @brief    Tests that the frame and sim time limits of a scenario file both end the run.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ScenarioRunnerTests, ScenarioLimits)
+{
+    WriteScenario("{ \"Frames\": 10, \"SimSeconds\": 1.0, \"FixedDeltaTime\": 0.25 }");
+
+    trStart::ScenarioRunner runner;
+    ASSERT_EQ(runner.LoadScenario(mFileName), true);
+
+    //The sim time limit comes first
+    trStart::ScenarioRunner::Report report = runner.Run();
+    EXPECT_EQ(report.frames, 4u);
+    EXPECT_DOUBLE_EQ(report.simTime, 1.0);
+
+    //The frame limit comes first
+    runner.SetSimTimeLimit(10.0);
+    report = runner.Run();
+    EXPECT_EQ(report.frames, 10u);
+    EXPECT_DOUBLE_EQ(report.simTime, 2.5);
+
+    //Without any limit the default number of frames is run
+    runner.SetRunLimits(0, 0.);
+    report = runner.Run();
+    EXPECT_EQ(report.frames, trStart::ScenarioRunner::DEFAULT_FRAMES);
+}
+
+/**
+ * @fn    TEST_F(ScenarioRunnerTests, OverrideLimits)
+ *
+ * @brief    Tests that a sim time limit set over the scenario file is not cut short by the frame
+ *           limit of the file.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(ScenarioRunnerTests, OverrideLimits)
+{
+    WriteScenario("{ \"Frames\": 10, \"FixedDeltaTime\": 0.25 }");
+
+    trStart::ScenarioRunner runner;
+    ASSERT_EQ(runner.LoadScenario(mFileName), true);
+
+    runner.SetRunLimits(0, 5.0);
+    trStart::ScenarioRunner::Report report = runner.Run();
+    EXPECT_EQ(report.frames, 20u);
+    EXPECT_DOUBLE_EQ(report.simTime, 5.0);
+
+    //Both limits from the command line still apply together
+    runner.SetRunLimits(6, 5.0);
+    report = runner.Run();
+    EXPECT_EQ(report.frames, 6u);
+}
\ No newline at end of file
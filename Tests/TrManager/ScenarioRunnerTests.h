@@ -0,0 +1,62 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+/**
+ * @class    ScenarioRunnerTests
+ *
+ * @brief    Sets up the unit test environment for the headless scenario runner.
+ */
+class ScenarioRunnerTests : public ::testing::Test
+{
+public:
+
+    /** @brief   The scenario file written by the tests. */
+    const std::string mFileName = "ScenarioRunnerTests.json";
+
+    /**
+     * @fn  public::ScenarioRunnerTests();
+     *
+     * @brief   Default constructor.
+     */
+    ScenarioRunnerTests();
+
+    /**
+     * @fn  public::~ScenarioRunnerTests();
+     *
+     * @brief   Destructor. Deletes the scenario file.
+     */
+    ~ScenarioRunnerTests();
+
+    /**
+     * @fn  void ScenarioRunnerTests::WriteScenario(const std::string& text);
+     *
+     * @brief   Writes the scenario file.
+     *
+     * @param   text    The JSON text of the scenario.
+     */
+    void WriteScenario(const std::string& text);
+};
\ No newline at end of file
@@ -0,0 +1,382 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include "SpatialIndexTests.h"
+
+#include <trBase/SmrtPtr.h>
+#include <trManager/SpatialIndexGrid.h>
+#include <trManager/SpatialIndexOctree.h>
+#include <trUtil/Timer.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////
+SpatialIndexTests::SpatialIndexTests()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+SpatialIndexTests::~SpatialIndexTests()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+void SpatialIndexTests::CreatePoints(size_t count, double halfSize)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> distribution(-halfSize, halfSize);
+
+    mIds.resize(count);
+    mPositions.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        mPositions[i] = trBase::Vec3(distribution(random), distribution(random), distribution(random));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void SpatialIndexTests::CheckQueries(trManager::SpatialIndex& index)
+{
+    std::mt19937 random(2);
+    std::uniform_real_distribution<double> distribution(-500.0, 500.0);
+    std::vector<trBase::UniqueId> results;
+    std::vector<trBase::UniqueId> expected;
+    std::vector<trManager::SpatialIndex::Neighbor> neighbors;
+    std::vector<double> distances;
+
+    for (int query = 0; query < 20; ++query)
+    {
+        trBase::Vec3 center(distribution(random), distribution(random), distribution(random));
+        double radius = std::abs(distribution(random)) * 0.3;
+
+        //Radius
+        expected.clear();
+        for (size_t i = 0; i < mIds.size(); ++i)
+        {
+            if ((mPositions[i] - center).Length2() <= radius * radius)
+            {
+                expected.push_back(mIds[i]);
+            }
+        }
+        index.QueryRadius(center, radius, results);
+        std::sort(results.begin(), results.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(results, expected);
+
+        //Box
+        trBase::Vec3 boxMin = center - trBase::Vec3(radius, radius, radius);
+        trBase::Vec3 boxMax = center + trBase::Vec3(radius, 2.0 * radius, radius);
+        expected.clear();
+        for (size_t i = 0; i < mIds.size(); ++i)
+        {
+            const trBase::Vec3& position = mPositions[i];
+            if (position[0] >= boxMin[0] && position[0] <= boxMax[0] &&
+                position[1] >= boxMin[1] && position[1] <= boxMax[1] &&
+                position[2] >= boxMin[2] && position[2] <= boxMax[2])
+            {
+                expected.push_back(mIds[i]);
+            }
+        }
+        index.QueryBox(boxMin, boxMax, results);
+        std::sort(results.begin(), results.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(results, expected);
+
+        //Nearest neighbors
+        distances.clear();
+        for (const trBase::Vec3& position : mPositions)
+        {
+            distances.push_back((position - center).Length2());
+        }
+        std::sort(distances.begin(), distances.end());
+        index.QueryNearest(center, 7, neighbors);
+        ASSERT_EQ(neighbors.size(), 7u);
+        for (size_t i = 0; i < neighbors.size(); ++i)
+        {
+            EXPECT_DOUBLE_EQ(neighbors[i].distance2, distances[i]);
+        }
+    }
+
+    //A frustum made of the six faces of a box has to find the same points as the box
+    trManager::SpatialIndex::Frustum frustum;
+    const double planes[6][4] = { { 1, 0, 0, 100 }, { -1, 0, 0, 100 }, { 0, 1, 0, 100 }, { 0, -1, 0, 100 }, { 0, 0, 1, 100 }, { 0, 0, -1, 100 } };
+    std::copy(&planes[0][0], &planes[0][0] + 24, &frustum.planes[0][0]);
+
+    index.QueryBox(trBase::Vec3(-100.0, -100.0, -100.0), trBase::Vec3(100.0, 100.0, 100.0), expected);
+    index.QueryFrustum(frustum, results);
+    std::sort(results.begin(), results.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(results, expected);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void SpatialIndexTests::RunBenchmark(trManager::SpatialIndex& index, size_t count)
+{
+    CreatePoints(count, 500.0);
+
+    trUtil::Timer timer;
+    trUtil::TimeTicks start = timer.Tick();
+    for (size_t i = 0; i < count; ++i)
+    {
+        index.Update(mIds[i], mPositions[i]);
+    }
+    index.ApplyUpdates();
+    trUtil::TimeTicks built = timer.Tick();
+
+    //Move every point a little, like a frame of movement
+    for (size_t i = 0; i < count; ++i)
+    {
+        index.Update(mIds[i], mPositions[i] + trBase::Vec3(0.5, 0.5, 0.5));
+    }
+    index.ApplyUpdates();
+    trUtil::TimeTicks moved = timer.Tick();
+
+    const size_t queryCount = 1000;
+    std::vector<trBase::UniqueId> results;
+    for (size_t i = 0; i < queryCount; ++i)
+    {
+        index.QueryRadius(mPositions[i], 20.0, results);
+    }
+    trUtil::TimeTicks radiusDone = timer.Tick();
+
+    std::vector<trManager::SpatialIndex::Neighbor> neighbors;
+    for (size_t i = 0; i < queryCount; ++i)
+    {
+        index.QueryNearest(mPositions[i], 8, neighbors);
+    }
+    trUtil::TimeTicks nearestDone = timer.Tick();
+
+    //Kept in the test report instead of the output, property names can't have spaces or colons
+    const std::string& type = index.GetType();
+    std::string prefix = type.substr(type.rfind(':') + 1) + "_" + std::to_string(count) + "_";
+    RecordProperty(prefix + "build_ms", std::to_string(timer.DeltaMil(start, built)));
+    RecordProperty(prefix + "move_ms", std::to_string(timer.DeltaMil(built, moved)));
+    RecordProperty(prefix + "radius_query_us", std::to_string(timer.DeltaMicro(moved, radiusDone) / queryCount));
+    RecordProperty(prefix + "nearest_query_us", std::to_string(timer.DeltaMicro(radiusDone, nearestDone) / queryCount));
+
+    EXPECT_EQ(index.GetSize(), count);
+}
+
+/**
+ * @fn    TEST_F(SpatialIndexTests, BatchUpdates)
+ *
+ * @brief    Tests that position updates are only seen after they are applied.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(SpatialIndexTests, BatchUpdates)
+{
+    trBase::SmrtPtr<trManager::SpatialIndex> index = new trManager::SpatialIndexGrid(10.0);
+    trBase::UniqueId id;
+    trBase::Vec3 position;
+
+    index->Update(id, trBase::Vec3(1.0, 2.0, 3.0));
+    EXPECT_EQ(index->GetSize(), 0u);
+    EXPECT_EQ(index->GetPendingUpdateCount(), 1u);
+
+    index->ApplyUpdates();
+    EXPECT_EQ(index->GetSize(), 1u);
+    EXPECT_EQ(index->GetPendingUpdateCount(), 0u);
+    EXPECT_TRUE(index->GetPosition(id, position));
+    EXPECT_EQ(position, trBase::Vec3(1.0, 2.0, 3.0));
+
+    //The last queued position wins
+    index->Update(id, trBase::Vec3(50.0, 0.0, 0.0));
+    index->Update(id, trBase::Vec3(60.0, 0.0, 0.0));
+    index->ApplyUpdates();
+    EXPECT_TRUE(index->GetPosition(id, position));
+    EXPECT_EQ(position, trBase::Vec3(60.0, 0.0, 0.0));
+
+    //Removing drops the queued updates too
+    index->Update(id, trBase::Vec3(70.0, 0.0, 0.0));
+    EXPECT_TRUE(index->Remove(id));
+    index->ApplyUpdates();
+    EXPECT_EQ(index->GetSize(), 0u);
+    EXPECT_FALSE(index->GetPosition(id, position));
+    EXPECT_FALSE(index->Remove(id));
+}
+
+/**
+ * @fn    TEST_F(SpatialIndexTests, GridQueries)
+ *
+ * @brief    Tests the queries of the hash grid against going through all the points.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(SpatialIndexTests, GridQueries)
+{
+    trBase::SmrtPtr<trManager::SpatialIndex> index = new trManager::SpatialIndexGrid(50.0);
+    CreatePoints(3000, 500.0);
+    for (size_t i = 0; i < mIds.size(); ++i)
+    {
+        index->Update(mIds[i], mPositions[i]);
+    }
+    index->ApplyUpdates();
+    CheckQueries(*index);
+
+    //Move half of the points, remove some, and check again
+    for (size_t i = 0; i < mIds.size(); i += 2)
+    {
+        mPositions[i] += trBase::Vec3(30.0, -20.0, 10.0);
+        index->Update(mIds[i], mPositions[i]);
+    }
+    index->ApplyUpdates();
+    for (size_t i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(index->Remove(mIds.back()));
+        mIds.pop_back();
+        mPositions.pop_back();
+    }
+    EXPECT_EQ(index->GetSize(), mIds.size());
+    CheckQueries(*index);
+}
+
+/**
+ * @fn    TEST_F(SpatialIndexTests, OctreeQueries)
+ *
+ * @brief    Tests the queries of the loose octree against going through all the points, including
+ *           points outside of the initial root.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(SpatialIndexTests, OctreeQueries)
+{
+    trBase::SmrtPtr<trManager::SpatialIndexOctree> index = new trManager::SpatialIndexOctree(trBase::Vec3(0.0, 0.0, 0.0), 100.0, 8);
+    CreatePoints(3000, 500.0);
+    for (size_t i = 0; i < mIds.size(); ++i)
+    {
+        index->Update(mIds[i], mPositions[i]);
+    }
+    index->ApplyUpdates();
+    EXPECT_GE(index->GetHalfSize(), 500.0);
+    EXPECT_GT(index->GetNodeCount(), 1u);
+    CheckQueries(*index);
+
+    for (size_t i = 0; i < mIds.size(); i += 2)
+    {
+        mPositions[i] += trBase::Vec3(30.0, -20.0, 10.0);
+        index->Update(mIds[i], mPositions[i]);
+    }
+    index->ApplyUpdates();
+    for (size_t i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(index->Remove(mIds.back()));
+        mIds.pop_back();
+        mPositions.pop_back();
+    }
+    EXPECT_EQ(index->GetSize(), mIds.size());
+    CheckQueries(*index);
+
+    //Clearing leaves only the root
+    index->Clear();
+    EXPECT_EQ(index->GetNodeCount(), 1u);
+}
+
+/**
+ * @fn    TEST_F(SpatialIndexTests, OctreeLooseSplit)
+ *
+ * @brief    Tests that a leaf splitting keeps finding an entry that moved out to the edge of the
+ *           leaf's loose bounds, past the loose bounds of its octant's child.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(SpatialIndexTests, OctreeLooseSplit)
+{
+    trBase::SmrtPtr<trManager::SpatialIndexOctree> index = new trManager::SpatialIndexOctree(trBase::Vec3(0.0, 0.0, 0.0), 100.0, 8);
+    CreatePoints(8, 50.0);
+    for (size_t i = 0; i < mIds.size(); ++i)
+    {
+        index->Update(mIds[i], mPositions[i]);
+    }
+    index->ApplyUpdates();
+
+    //1.9 times the root's half size is still inside its loose bounds, so the entry stays in the root
+    mPositions[0] = trBase::Vec3(190.0, 20.0, -30.0);
+    index->Update(mIds[0], mPositions[0]);
+    index->ApplyUpdates();
+    EXPECT_EQ(index->GetNodeCount(), 1u);
+
+    //One more point splits the root
+    mIds.push_back(trBase::UniqueId());
+    mPositions.push_back(trBase::Vec3(10.0, 10.0, 10.0));
+    index->Update(mIds.back(), mPositions.back());
+    index->ApplyUpdates();
+    EXPECT_GT(index->GetNodeCount(), 1u);
+
+    std::vector<trBase::UniqueId> results;
+    index->QueryRadius(mPositions[0], 1.0, results);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0], mIds[0]);
+
+    index->QueryBox(mPositions[0] - trBase::Vec3(1.0, 1.0, 1.0), mPositions[0] + trBase::Vec3(1.0, 1.0, 1.0), results);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0], mIds[0]);
+
+    std::vector<trManager::SpatialIndex::Neighbor> neighbors;
+    index->QueryNearest(mPositions[0], 1, neighbors);
+    ASSERT_EQ(neighbors.size(), 1u);
+    EXPECT_EQ(neighbors[0].id, mIds[0]);
+
+    CheckQueries(*index);
+}
+
+/**
+ * @fn    TEST_F(SpatialIndexTests, DISABLED_Benchmark)
+ *
+ * @brief    Times both indexes with 10k and 100k points. Run with --gtest_also_run_disabled_tests.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(SpatialIndexTests, DISABLED_Benchmark)
+{
+    for (size_t count : { 10000u, 100000u })
+    {
+        trBase::SmrtPtr<trManager::SpatialIndex> grid = new trManager::SpatialIndexGrid(10.0);
+        RunBenchmark(*grid, count);
+
+        trBase::SmrtPtr<trManager::SpatialIndex> octree = new trManager::SpatialIndexOctree(trBase::Vec3(0.0, 0.0, 0.0), 500.0);
+        RunBenchmark(*octree, count);
+    }
+}
+
+/**
+ * @fn    TEST_F(SpatialIndexTests, DISABLED_BenchmarkLarge)
+ *
+ * @brief    Times both indexes with 1M points. Run with --gtest_also_run_disabled_tests.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(SpatialIndexTests, DISABLED_BenchmarkLarge)
+{
+    trBase::SmrtPtr<trManager::SpatialIndex> grid = new trManager::SpatialIndexGrid(10.0);
+    RunBenchmark(*grid, 1000000);
+
+    trBase::SmrtPtr<trManager::SpatialIndex> octree = new trManager::SpatialIndexOctree(trBase::Vec3(0.0, 0.0, 0.0), 500.0);
+    RunBenchmark(*octree, 1000000);
+}
\ No newline at end of file
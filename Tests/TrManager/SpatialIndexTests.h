@@ -0,0 +1,90 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <trBase/UniqueId.h>
+#include <trBase/Vec3.h>
+#include <trManager/SpatialIndex.h>
+
+#include <vector>
+
+/**
+ * @class    SpatialIndexTests
+ *
+ * @brief    Sets up the unit test environment for the spatial indexes.
+ */
+class SpatialIndexTests : public ::testing::Test
+{
+public:
+
+    /** @brief   IDs of the test points. */
+    std::vector<trBase::UniqueId> mIds;
+
+    /** @brief   Positions of the test points. */
+    std::vector<trBase::Vec3> mPositions;
+
+    /**
+     * @fn  public::SpatialIndexTests();
+     *
+     * @brief   Default constructor.
+     */
+    SpatialIndexTests();
+
+    /**
+     * @fn  public::~SpatialIndexTests();
+     *
+     * @brief   Destructor.
+     */
+    ~SpatialIndexTests();
+
+    /**
+     * @fn  void SpatialIndexTests::CreatePoints(size_t count, double halfSize);
+     *
+     * @brief   Creates random test points inside a cube.
+     *
+     * @param   count       The number of points.
+     * @param   halfSize    Half of the edge length of the cube.
+     */
+    void CreatePoints(size_t count, double halfSize);
+
+    /**
+     * @fn  void SpatialIndexTests::CheckQueries(trManager::SpatialIndex& index);
+     *
+     * @brief   Compares the queries of an index against going through all the test points.
+     *
+     * @param [in,out]  index   The index.
+     */
+    void CheckQueries(trManager::SpatialIndex& index);
+
+    /**
+     * @fn  void SpatialIndexTests::RunBenchmark(trManager::SpatialIndex& index, size_t count);
+     *
+     * @brief   Times publishing, moving and querying a number of points, and records the results
+     *          as test properties.
+     *
+     * @param [in,out]  index   The index.
+     * @param           count   The number of points.
+     */
+    void RunBenchmark(trManager::SpatialIndex& index, size_t count);
+};
\ No newline at end of file
@@ -33,6 +33,7 @@
 const trUtil::RefStr TestActor3::CLASS_TYPE("TestActor3");
 
 const trUtil::RefStr TestActor3::ON_TEST_ACTOR_2_INVOKABLE("OnTestActor2");
+const trUtil::RefStr TestActor3::ON_LAST_ABOUT_INVOKABLE("OnLastAbout");
 
 int TestActor3::mInstCount = 0;
 
@@ -59,6 +60,7 @@ TestActor3::~TestActor3()
 void TestActor3::BuildInvokables()
 {
     AddInvokable(*new trManager::Invokable(TestActor3::ON_TEST_ACTOR_2_INVOKABLE, trUtil::MakeFunctor(&TestActor3::AboutTestActor2, this)));
+    AddInvokable(*new trManager::Invokable(TestActor3::ON_LAST_ABOUT_INVOKABLE, trUtil::MakeFunctor(&TestActor3::LastAboutTestActor2, this)));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -72,6 +74,13 @@ void TestActor3::AboutTestActor2(const trManager::MessageBase& msg)
     ++mTestMsgCount;
 }
 
+//////////////////////////////////////////////////////////////////////////
+void TestActor3::LastAboutTestActor2(const trManager::MessageBase& msg)
+{
+    ++mTestMsgCount;
+    UnregisterFromMessagesAboutEntity(*msg.GetAboutActorID());
+}
+
 //////////////////////////////////////////////////////////////////////////
 void TestActor3::OnAddedToSysMan()
 {
@@ -34,6 +34,7 @@ public:
     const static trUtil::RefStr CLASS_TYPE;                 /// Holds the class type name for efficient comparisons
 
     const static trUtil::RefStr ON_TEST_ACTOR_2_INVOKABLE;  /// Invokable for messages going to TestActor2
+    const static trUtil::RefStr ON_LAST_ABOUT_INVOKABLE;    /// Invokable that stops listening after the first message
 
     /**
      * @fn  TestActor3::TestActor3(const std::string& name = CLASS_TYPE);
@@ -78,6 +79,15 @@ public:
      */
     virtual void AboutTestActor2(const trManager::MessageBase& msg);
 
+    /**
+     * @fn  virtual void TestActor3::LastAboutTestActor2(const trManager::MessageBase& msg);
+     *
+     * @brief   Handles a message about an entity, and unregisters from the messages about it.
+     *
+     * @param   msg The message.
+     */
+    virtual void LastAboutTestActor2(const trManager::MessageBase& msg);
+
     /**
     * @fn  virtual void TestActor3::OnAddedToSysMan() override;
     *
@@ -0,0 +1,73 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include "TestActor4.h"
+
+#include <trManager/MessageTick.h>
+
+const trUtil::RefStr TestActor4::CLASS_TYPE("TestActor4");
+
+int TestActor4::mInstCount = 0;
+
+//////////////////////////////////////////////////////////////////////////
+TestActor4::TestActor4(bool isRemote, const std::string& name) : BaseClass(name)
+    , mPosition(0.0, 0.0, 0.0)
+    , mVelocity(0.0, 0.0, 0.0)
+    , mIsRemote(isRemote)
+{
+    mReplicatedFields.AddField("Position", mPosition, trManager::ReplicatedFields::Quantization(-1000.0, 1000.0, 20));
+    mReplicatedFields.AddField("Rotation", mRotation, 12);
+    mReplicatedFields.AddField("Health", mHealth);
+    ++mInstCount;
+}
+
+//////////////////////////////////////////////////////////////////////////
+TestActor4::~TestActor4()
+{
+    --mInstCount;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void TestActor4::OnTick(const trManager::MessageBase& msg)
+{
+    const trManager::MessageTick& tick = static_cast<const trManager::MessageTick&>(msg);
+    mPosition += mVelocity * tick.GetDeltaSimTime();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void TestActor4::OnAddedToSysMan()
+{
+    BaseClass::OnAddedToSysMan();
+
+    RegisterForMessage(trManager::MessageTick::MESSAGE_TYPE, mIsRemote ? ON_TICK_REMOTE_INVOKABLE : ON_TICK_INVOKABLE);
+}
+
+//////////////////////////////////////////////////////////////////////////
+trManager::ReplicatedFields* TestActor4::GetReplicatedFields()
+{
+    return &mReplicatedFields;
+}
+
+//////////////////////////////////////////////////////////////////////////
+int TestActor4::GetInstCount()
+{
+    return mInstCount;
+}
\ No newline at end of file
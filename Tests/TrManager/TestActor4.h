@@ -0,0 +1,118 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+
+#include <trManager/MessageBase.h>
+#include <trManager/ActorBase.h>
+#include <trManager/ReplicatedFields.h>
+#include <trUtil/RefStr.h>
+#include <trBase/Quat.h>
+#include <trBase/Vec3.h>
+
+#include <string>
+
+/**
+ * @class   TestActor4
+ *
+ * @brief   A replicated test actor. The local instance moves with a constant velocity, and the remote
+ *          instance interpolates the replicated position.
+ */
+class TestActor4 : public trManager::ActorBase
+{
+public:
+    using BaseClass = trManager::ActorBase;                         /// Adds an easy and swappable access to the base class
+
+    const static trUtil::RefStr CLASS_TYPE;                         /// Holds the class type name for efficient comparisons
+
+    /**
+     * @fn  TestActor4::TestActor4(bool isRemote = false, const std::string& name = CLASS_TYPE);
+     *
+     * @brief   Constructor.
+     *
+     * @param   isRemote    (Optional) True if this is a proxy of an actor on a server.
+     * @param   name        (Optional) The name.
+     */
+    TestActor4(bool isRemote = false, const std::string& name = CLASS_TYPE);
+
+    /**
+     * @fn  virtual const std::string& TestActor4::GetType() const override
+     *
+     * @brief   Gets the class type.
+     *
+     * @return  The type.
+     */
+    virtual const std::string& GetType() const override { return CLASS_TYPE; }
+
+    /**
+     * @fn  virtual void TestActor4::OnTick(const trManager::MessageBase& msg);
+     *
+     * @brief   Moves the actor.
+     *
+     * @param   msg The message.
+     */
+    virtual void OnTick(const trManager::MessageBase& msg);
+
+    /**
+     * @fn  virtual void TestActor4::OnAddedToSysMan() override;
+     *
+     * @brief   Registers for the Tick message, or for the remote Tick on a proxy.
+     */
+    virtual void OnAddedToSysMan() override;
+
+    /**
+     * @fn  virtual trManager::ReplicatedFields* TestActor4::GetReplicatedFields() override;
+     *
+     * @brief   Returns the replicated fields.
+     *
+     * @return  The replicated fields.
+     */
+    virtual trManager::ReplicatedFields* GetReplicatedFields() override;
+
+    /**
+     * @fn  static int TestActor4::GetInstCount();
+     *
+     * @brief   Gets instance count for this class type. Used for error checking, and Unit Testing.
+     *
+     * @return  The instance count.
+     */
+    static int GetInstCount();
+
+    trBase::Vec3 mPosition;
+    trBase::Vec3 mVelocity;
+    trBase::Quat mRotation;
+    int mHealth = 100;
+
+protected:
+
+    static int mInstCount;
+
+    /**
+     * @fn  TestActor4::~TestActor4();
+     *
+     * @brief   Destructor.
+     */
+    ~TestActor4();
+
+private:
+
+    trManager::ReplicatedFields mReplicatedFields;
+    bool mIsRemote;
+};
\ No newline at end of file
@@ -0,0 +1,129 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include "LogQueueTests.h"
+
+#include <trUtil/Logging/LogManager.h>
+#include <trUtil/Logging/LogQueue.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+void CountingLogWriter::LogMessage(const LogData& logData)
+{
+    mMessageCount.fetch_add(1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+LogQueueTests::LogQueueTests()
+    : mLog(trUtil::Logging::Log::GetInstance("LogQueueTests"))
+    , mWriter(new CountingLogWriter())
+{
+    mLog.SetOutputStreamBit(trUtil::Logging::Log::TO_WRITER);
+    mLog.SetLogLevel(trUtil::Logging::LogLevel::LOG_DEBUG);
+    mLog.AddWriter(*mWriter);
+}
+
+//////////////////////////////////////////////////////////////////////////
+LogQueueTests::~LogQueueTests()
+{
+    trUtil::Logging::Log::SetAsync(false);
+    mLog.RemoveWriter(*mWriter);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LogQueueTests::LogFromThreads(size_t threadCount, size_t messageCount)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([this, messageCount]()
+        {
+            for (size_t j = 0; j < messageCount; ++j)
+            {
+                mLog.LogMessage(__FILE__, __FUNCTION__, __LINE__, "Queued message " + std::to_string(j), trUtil::Logging::LogLevel::LOG_INFO);
+            }
+        });
+    }
+
+    //The writer thread goes through the Log instances while new ones are added
+    threads.emplace_back([]()
+    {
+        for (size_t i = 0; i < 200; ++i)
+        {
+            trUtil::Logging::Log::GetInstance("LogQueueTests" + std::to_string(i));
+        }
+    });
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * @fn    TEST_F(LogQueueTests, DropWhenFull)
+ *
+ * @brief    Tests that every message is either written or counted as dropped when the queue is full.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogQueueTests, DropWhenFull)
+{
+    const size_t threadCount = 4;
+    const size_t messageCount = 5000;
+    trUtil::Logging::Log::SetAsync(true, trUtil::Logging::Log::ASYNC_DROP, 16, false);
+
+    LogFromThreads(threadCount, messageCount);
+    trUtil::Logging::Log::Flush();
+
+    trUtil::Logging::LogQueue* logQueue = mLog.GetLogManagerRef().GetLogQueue();
+    ASSERT_NE(logQueue, nullptr);
+    EXPECT_EQ(logQueue->GetWrittenCount() + logQueue->GetDroppedCount(), threadCount * messageCount);
+    EXPECT_EQ(mWriter->mMessageCount.load(), logQueue->GetWrittenCount());
+}
+
+/**
+ * @fn    TEST_F(LogQueueTests, BlockWhenFull)
+ *
+ * @brief    Tests that no message is lost when threads wait for room in the queue.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogQueueTests, BlockWhenFull)
+{
+    const size_t threadCount = 4;
+    const size_t messageCount = 5000;
+    trUtil::Logging::Log::SetAsync(true, trUtil::Logging::Log::ASYNC_BLOCK, 16, false);
+
+    LogFromThreads(threadCount, messageCount);
+    trUtil::Logging::Log::Flush();
+
+    trUtil::Logging::LogQueue* logQueue = mLog.GetLogManagerRef().GetLogQueue();
+    ASSERT_NE(logQueue, nullptr);
+    EXPECT_EQ(logQueue->GetDroppedCount(), 0u);
+    EXPECT_EQ(logQueue->GetWrittenCount(), threadCount * messageCount);
+    EXPECT_EQ(mWriter->mMessageCount.load(), threadCount * messageCount);
+}
\ No newline at end of file
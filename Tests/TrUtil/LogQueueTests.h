@@ -0,0 +1,93 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <trUtil/Logging/Log.h>
+#include <trUtil/Logging/LogWriter.h>
+
+#include <osg/ref_ptr>
+
+#include <atomic>
+
+/**
+ * @class    CountingLogWriter
+ *
+ * @brief    A log writer that counts the messages it receives.
+ */
+class CountingLogWriter : public trUtil::Logging::LogWriter
+{
+public:
+
+    /** @brief   Number of messages received. */
+    std::atomic<unsigned long long> mMessageCount = { 0 };
+
+    /**
+     * @fn  virtual void CountingLogWriter::LogMessage(const LogData& logData) override;
+     *
+     * @brief   Counts the message.
+     *
+     * @param   logData Information describing the log.
+     */
+    virtual void LogMessage(const LogData& logData) override;
+};
+
+/**
+ * @class    LogQueueTests
+ *
+ * @brief    Sets up the unit test environment for the asynchronous log queue.
+ */
+class LogQueueTests : public ::testing::Test
+{
+public:
+
+    /** @brief   The log the test threads write to, it only sends to mWriter. */
+    trUtil::Logging::Log& mLog;
+
+    /** @brief   Counts what the queue wrote out. */
+    osg::ref_ptr<CountingLogWriter> mWriter;
+
+    /**
+     * @fn  public::LogQueueTests();
+     *
+     * @brief   Default constructor.
+     */
+    LogQueueTests();
+
+    /**
+     * @fn  public::~LogQueueTests();
+     *
+     * @brief   Destructor. Goes back to synchronous logging.
+     */
+    ~LogQueueTests();
+
+    /**
+     * @fn  void LogQueueTests::LogFromThreads(size_t threadCount, size_t messageCount);
+     *
+     * @brief   Logs from several threads at once, while another thread keeps creating Log instances.
+     *
+     * @param   threadCount     The number of threads that log.
+     * @param   messageCount    The number of messages each thread logs.
+     */
+    void LogFromThreads(size_t threadCount, size_t messageCount);
+};
\ No newline at end of file
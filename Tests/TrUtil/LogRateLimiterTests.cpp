@@ -0,0 +1,147 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include "LogRateLimiterTests.h"
+
+#include <trUtil/Logging/LogRateLimiter.h>
+
+#include <chrono>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////
+void RecordingLogWriter::LogMessage(const LogData& logData)
+{
+    mMessages.push_back(logData);
+}
+
+//////////////////////////////////////////////////////////////////////////
+LogRateLimiterTests::LogRateLimiterTests()
+    : mLog(trUtil::Logging::Log::GetInstance("LogRateLimiterTests"))
+    , mWriter(new RecordingLogWriter())
+{
+    mLog.SetOutputStreamBit(trUtil::Logging::Log::TO_WRITER);
+    mLog.SetLogLevel(trUtil::Logging::LogLevel::LOG_DEBUG);
+    mLog.AddWriter(*mWriter);
+}
+
+//////////////////////////////////////////////////////////////////////////
+LogRateLimiterTests::~LogRateLimiterTests()
+{
+    mLog.RemoveWriter(*mWriter);
+}
+
+/**
+ * @fn    TEST_F(LogRateLimiterTests, Window)
+ *
+ * @brief    Tests that the limit applies per window, and the count restarts with the next window.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogRateLimiterTests, Window)
+{
+    trUtil::Logging::LogRateLimiter limiter(3);
+    long long now = trUtil::Logging::LogRateLimiter::GetTimeMilliseconds();
+    unsigned long long suppressedCount = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(limiter.Allow(suppressedCount, now), true);
+        EXPECT_EQ(suppressedCount, 0u);
+    }
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), false);
+    EXPECT_EQ(limiter.Allow(suppressedCount, now + trUtil::Logging::LogRateLimiter::WINDOW_LENGTH_MS - 1), false);
+
+    //The first message of the next window notes the held back ones
+    now += trUtil::Logging::LogRateLimiter::WINDOW_LENGTH_MS;
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), true);
+    EXPECT_EQ(suppressedCount, 2u);
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), true);
+    EXPECT_EQ(suppressedCount, 0u);
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), true);
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), false);
+}
+
+/**
+ * @fn    TEST_F(LogRateLimiterTests, SuppressedCount)
+ *
+ * @brief    Tests that the held back count is taken once the window is over, and only once.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogRateLimiterTests, SuppressedCount)
+{
+    trUtil::Logging::LogRateLimiter limiter(1);
+    long long now = trUtil::Logging::LogRateLimiter::GetTimeMilliseconds();
+    unsigned long long suppressedCount = 0;
+
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), true);
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(limiter.Allow(suppressedCount, now), false);
+    }
+
+    //The storm stops, the count is only final once the window is over
+    EXPECT_EQ(limiter.TakeSuppressedCount(now + trUtil::Logging::LogRateLimiter::WINDOW_LENGTH_MS / 2), 0u);
+    now += trUtil::Logging::LogRateLimiter::WINDOW_LENGTH_MS;
+    EXPECT_EQ(limiter.TakeSuppressedCount(now), 4u);
+    EXPECT_EQ(limiter.TakeSuppressedCount(now), 0u);
+
+    //The next message does not note them again
+    EXPECT_EQ(limiter.Allow(suppressedCount, now), true);
+    EXPECT_EQ(suppressedCount, 0u);
+}
+
+/**
+ * @fn    TEST_F(LogRateLimiterTests, Summary)
+ *
+ * @brief    Tests that a rate limited call site writes a summary when its storm stops.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogRateLimiterTests, Summary)
+{
+    int line = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        line = __LINE__ + 1;
+        LOG_FULL_RATE_LIMITED(trUtil::Logging::LogLevel::LOG_WARNING, "LogRateLimiterTests", 1, "Storm message")
+    }
+    ASSERT_EQ(mWriter->mMessages.size(), 1u);
+    EXPECT_EQ(mWriter->mMessages[0].msg, "Storm message");
+
+    //Nothing is written before the window is over
+    trUtil::Logging::Log::Flush();
+    EXPECT_EQ(mWriter->mMessages.size(), 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(trUtil::Logging::LogRateLimiter::WINDOW_LENGTH_MS + 100));
+    trUtil::Logging::Log::Flush();
+    ASSERT_EQ(mWriter->mMessages.size(), 2u);
+    EXPECT_EQ(mWriter->mMessages[1].msg, "Suppressed 2 similar messages");
+    EXPECT_EQ(mWriter->mMessages[1].logLevel, trUtil::Logging::LogLevel::LOG_WARNING);
+    EXPECT_EQ(mWriter->mMessages[1].line, line);
+
+    //The summary is only written once
+    trUtil::Logging::Log::Flush();
+    EXPECT_EQ(mWriter->mMessages.size(), 2u);
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <trUtil/Logging/Log.h>
+#include <trUtil/Logging/LogWriter.h>
+
+#include <osg/ref_ptr>
+
+#include <string>
+#include <vector>
+
+/**
+ * @class    RecordingLogWriter
+ *
+ * @brief    A log writer that keeps the messages it receives.
+ */
+class RecordingLogWriter : public trUtil::Logging::LogWriter
+{
+public:
+
+    /** @brief   The messages received. */
+    std::vector<LogData> mMessages;
+
+    /**
+     * @fn  virtual void RecordingLogWriter::LogMessage(const LogData& logData) override;
+     *
+     * @brief   Keeps the message.
+     *
+     * @param   logData Information describing the log.
+     */
+    virtual void LogMessage(const LogData& logData) override;
+};
+
+/**
+ * @class    LogRateLimiterTests
+ *
+ * @brief    Sets up the unit test environment for the rate limited log macros.
+ */
+class LogRateLimiterTests : public ::testing::Test
+{
+public:
+
+    /** @brief   The log the rate limited messages go to, it only sends to mWriter. */
+    trUtil::Logging::Log& mLog;
+
+    /** @brief   Keeps what was written to the log. */
+    osg::ref_ptr<RecordingLogWriter> mWriter;
+
+    /**
+     * @fn  public::LogRateLimiterTests();
+     *
+     * @brief   Default constructor.
+     */
+    LogRateLimiterTests();
+
+    /**
+     * @fn  public::~LogRateLimiterTests();
+     *
+     * @brief   Destructor.
+     */
+    ~LogRateLimiterTests();
+};
\ No newline at end of file
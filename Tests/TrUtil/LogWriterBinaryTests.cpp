@@ -0,0 +1,248 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include "LogWriterBinaryTests.h"
+
+#include <trUtil/Logging/LogFile.h>
+#include <trUtil/Logging/LogReaderBinary.h>
+#include <trUtil/Logging/LogWriterBinary.h>
+
+#include <osg/ref_ptr>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+//////////////////////////////////////////////////////////////////////////
+LogWriterBinaryTests::LogWriterBinaryTests()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+LogWriterBinaryTests::~LogWriterBinaryTests()
+{
+    std::remove(mFileName.c_str());
+}
+
+//////////////////////////////////////////////////////////////////////////
+trUtil::Logging::LogWriter::LogData LogWriterBinaryTests::CreateLogData(const std::string& msg, unsigned day, unsigned hour, unsigned minute, float second) const
+{
+    trUtil::Logging::LogWriter::LogData logData;
+    logData.logLevel = trUtil::Logging::LogLevel::LOG_INFO;
+    logData.time.SetTime(2026, 10, day, hour, minute, second);
+    logData.frameNumber = 7;
+    logData.logName = "LogWriterBinaryTests";
+    logData.file = "LogWriterBinaryTests.cpp";
+    logData.method = "CreateLogData";
+    logData.line = 42;
+    logData.msg = msg;
+    return logData;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool LogWriterBinaryTests::ReadMessages(std::vector<trUtil::Logging::LogWriter::LogData>& messages) const
+{
+    trUtil::Logging::LogReaderBinary reader;
+    if (!reader.Open(mFileName))
+    {
+        return false;
+    }
+
+    trUtil::Logging::LogWriter::LogData logData;
+    trUtil::Logging::LogReaderBinary::EntryType entry;
+    while ((entry = reader.ReadNext(logData)) != trUtil::Logging::LogReaderBinary::ENTRY_END)
+    {
+        if (entry == trUtil::Logging::LogReaderBinary::ENTRY_MESSAGE)
+        {
+            messages.push_back(logData);
+        }
+    }
+    return !reader.IsCorrupt();
+}
+
+/**
+ * @fn    TEST_F(LogWriterBinaryTests, RoundTrip)
+ *
+ * @brief    Tests that every field of a message survives writing and reading, across a date change.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogWriterBinaryTests, RoundTrip)
+{
+    std::vector<trUtil::Logging::LogWriter::LogData> written;
+    written.push_back(CreateLogData("Repeating message", 18, 23, 59, 58.5f));
+    written.push_back(CreateLogData("Repeating message", 18, 23, 59, 59.25f));
+    written.push_back(CreateLogData("Next day", 19, 0, 0, 1.75f));
+    written.back().logLevel = trUtil::Logging::LogLevel::LOG_WARNING;
+    written.back().frameNumber = 1234567;
+    written.back().method = "RoundTrip";
+    written.back().line = -1;
+
+    {
+        osg::ref_ptr<trUtil::Logging::LogWriterBinary> writer = new trUtil::Logging::LogWriterBinary(mFileName);
+        for (const trUtil::Logging::LogWriter::LogData& logData : written)
+        {
+            writer->LogMessage(logData);
+        }
+        writer->LogHorizRule();
+    }
+
+    trUtil::Logging::LogReaderBinary reader;
+    ASSERT_EQ(reader.Open(mFileName), true);
+    EXPECT_EQ(reader.GetTitle(), trUtil::Logging::LogFile::GetTitle());
+
+    trUtil::Logging::LogWriter::LogData logData;
+    for (const trUtil::Logging::LogWriter::LogData& expected : written)
+    {
+        ASSERT_EQ(reader.ReadNext(logData), trUtil::Logging::LogReaderBinary::ENTRY_MESSAGE);
+        EXPECT_EQ(logData.logLevel, expected.logLevel);
+        EXPECT_EQ(logData.time.GetYear(), expected.time.GetYear());
+        EXPECT_EQ(logData.time.GetMonth(), expected.time.GetMonth());
+        EXPECT_EQ(logData.time.GetDay(), expected.time.GetDay());
+        EXPECT_EQ(logData.time.GetHour(), expected.time.GetHour());
+        EXPECT_EQ(logData.time.GetMinute(), expected.time.GetMinute());
+        EXPECT_FLOAT_EQ(logData.time.GetSecond(), expected.time.GetSecond());
+        EXPECT_EQ(logData.frameNumber, expected.frameNumber);
+        EXPECT_EQ(logData.logName, expected.logName);
+        EXPECT_EQ(logData.file, expected.file);
+        EXPECT_EQ(logData.method, expected.method);
+        EXPECT_EQ(logData.line, expected.line);
+        EXPECT_EQ(logData.msg, expected.msg);
+    }
+    EXPECT_EQ(reader.ReadNext(logData), trUtil::Logging::LogReaderBinary::ENTRY_HORIZ_RULE);
+    EXPECT_EQ(reader.ReadNext(logData), trUtil::Logging::LogReaderBinary::ENTRY_END);
+    EXPECT_EQ(reader.IsCorrupt(), false);
+}
+
+/**
+ * @fn    TEST_F(LogWriterBinaryTests, InlineMessages)
+ *
+ * @brief    Tests that messages past the interning limit are stored inline, while the interned
+ *           ones keep being referred to by id.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogWriterBinaryTests, InlineMessages)
+{
+    std::vector<std::string> written;
+    for (size_t i = 0; i < trUtil::Logging::LogWriterBinary::MAX_INTERNED_MESSAGES + 2; ++i)
+    {
+        written.push_back("Message " + std::to_string(i));
+    }
+    written.push_back(written.front());
+    written.push_back(written.back());
+    written.push_back("");
+
+    {
+        osg::ref_ptr<trUtil::Logging::LogWriterBinary> writer = new trUtil::Logging::LogWriterBinary(mFileName);
+        writer->SetFlushEachMessage(false);
+        for (const std::string& msg : written)
+        {
+            writer->LogMessage(CreateLogData(msg, 19, 12, 0, 0.0f));
+        }
+    }
+
+    std::vector<trUtil::Logging::LogWriter::LogData> messages;
+    EXPECT_EQ(ReadMessages(messages), true);
+    ASSERT_EQ(messages.size(), written.size());
+    for (size_t i = 0; i < written.size(); ++i)
+    {
+        EXPECT_EQ(messages[i].msg, written[i]);
+    }
+}
+
+/**
+ * @fn    TEST_F(LogWriterBinaryTests, Truncated)
+ *
+ * @brief    Tests that a file that ends in the middle of a record, like the log of a crashed
+ *           application, gives back the records before it and is reported as corrupt.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogWriterBinaryTests, Truncated)
+{
+    {
+        osg::ref_ptr<trUtil::Logging::LogWriterBinary> writer = new trUtil::Logging::LogWriterBinary(mFileName);
+        writer->LogMessage(CreateLogData("First", 19, 12, 0, 0.0f));
+        writer->LogMessage(CreateLogData("Second", 19, 12, 0, 1.0f));
+        writer->LogMessage(CreateLogData("Cut off", 19, 12, 0, 2.0f));
+    }
+
+    std::string data;
+    {
+        std::ifstream file(mFileName.c_str(), std::ios::in | std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    ASSERT_GT(data.size(), 1u);
+    {
+        std::ofstream file(mFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size() - 1);
+    }
+
+    std::vector<trUtil::Logging::LogWriter::LogData> messages;
+    EXPECT_EQ(ReadMessages(messages), false);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].msg, "First");
+    EXPECT_EQ(messages[1].msg, "Second");
+}
+
+/**
+ * @fn    TEST_F(LogWriterBinaryTests, FlushEachMessage)
+ *
+ * @brief    Tests that every message reaches the file by default, and that with flushing each
+ *           message turned off, the way the log queue runs, they wait for Flush.
+ *
+ * @param    parameter1    The first parameter.
+ * @param    parameter2    The second parameter.
+ */
+TEST_F(LogWriterBinaryTests, FlushEachMessage)
+{
+    osg::ref_ptr<trUtil::Logging::LogWriterBinary> writer = new trUtil::Logging::LogWriterBinary(mFileName);
+    writer->LogMessage(CreateLogData("Flushed", 19, 12, 0, 0.0f));
+
+    std::vector<trUtil::Logging::LogWriter::LogData> messages;
+    EXPECT_EQ(ReadMessages(messages), true);
+    EXPECT_EQ(messages.size(), 1u);
+
+    writer->SetFlushEachMessage(false);
+    writer->LogMessage(CreateLogData("Buffered", 19, 12, 0, 1.0f));
+    messages.clear();
+    EXPECT_EQ(ReadMessages(messages), true);
+    EXPECT_EQ(messages.size(), 1u);
+
+    //Errors are written right away either way
+    trUtil::Logging::LogWriter::LogData error = CreateLogData("Error", 19, 12, 0, 2.0f);
+    error.logLevel = trUtil::Logging::LogLevel::LOG_ERROR;
+    writer->LogMessage(error);
+    messages.clear();
+    EXPECT_EQ(ReadMessages(messages), true);
+    EXPECT_EQ(messages.size(), 3u);
+
+    writer->LogMessage(CreateLogData("Buffered again", 19, 12, 0, 3.0f));
+    writer->Flush();
+    messages.clear();
+    EXPECT_EQ(ReadMessages(messages), true);
+    ASSERT_EQ(messages.size(), 4u);
+    EXPECT_EQ(messages[3].msg, "Buffered again");
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <trUtil/Logging/LogWriter.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @class    LogWriterBinaryTests
+ *
+ * @brief    Sets up the unit test environment for writing binary logs and reading them back.
+ */
+class LogWriterBinaryTests : public ::testing::Test
+{
+public:
+
+    /** @brief   The binary log written by the tests. */
+    const std::string mFileName = "LogWriterBinaryTests.trlog";
+
+    /**
+     * @fn  public::LogWriterBinaryTests();
+     *
+     * @brief   Default constructor.
+     */
+    LogWriterBinaryTests();
+
+    /**
+     * @fn  public::~LogWriterBinaryTests();
+     *
+     * @brief   Destructor. Deletes the log file.
+     */
+    ~LogWriterBinaryTests();
+
+    /**
+     * @fn  trUtil::Logging::LogWriter::LogData LogWriterBinaryTests::CreateLogData(const std::string& msg, unsigned day, unsigned hour, unsigned minute, float second) const;
+     *
+     * @brief   Creates a message of the test log, dated in October 2026.
+     *
+     * @param   msg     The message.
+     * @param   day     The day of the month.
+     * @param   hour    The hour.
+     * @param   minute  The minute.
+     * @param   second  The second.
+     *
+     * @return  The log data.
+     */
+    trUtil::Logging::LogWriter::LogData CreateLogData(const std::string& msg, unsigned day, unsigned hour, unsigned minute, float second) const;
+
+    /**
+     * @fn  bool LogWriterBinaryTests::ReadMessages(std::vector<trUtil::Logging::LogWriter::LogData>& messages) const;
+     *
+     * @brief   Reads all the messages in the log file, skipping horizontal rules.
+     *
+     * @param [out] messages    The messages read.
+     *
+     * @return  False if the file could not be opened or ended in bad data.
+     */
+    bool ReadMessages(std::vector<trUtil::Logging::LogWriter::LogData>& messages) const;
+};
\ No newline at end of file
@@ -43,13 +43,15 @@ namespace trApp
         const static trUtil::RefStr CLASS_TYPE;         /// Holds the class type name for efficient comparisons
 
         /**
-         * @fn  AppBase::AppBase(const std::string& name = CLASS_TYPE);
+         * @fn  AppBase::AppBase(const std::string& name = CLASS_TYPE, trManager::SystemManager* sysMan = nullptr);
          *
          * @brief   Default constructor.
          *
-         * @param   name    (Optional) The name of the class.
+         * @param           name    (Optional) The name of the class.
+         * @param [in,out]  sysMan  (Optional) The System Manager world to run the application in. If
+         *                          NULL, the default System Manager instance is used.
          */
-        AppBase(const std::string& name = CLASS_TYPE);
+        AppBase(const std::string& name = CLASS_TYPE, trManager::SystemManager* sysMan = nullptr);
 
         /**
          * @fn  virtual const std::string& AppBase::GetType() const override;
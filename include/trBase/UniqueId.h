@@ -49,6 +49,7 @@ namespace trBase
         using BaseClass = trBase::SmrtClass;            /// Adds an easy and swappable access to the base class
 
         const static trUtil::RefStr CLASS_TYPE;         /// Holds the class type name for efficient comparisons
+        const static unsigned int BYTE_SIZE = 16;       /// Size of the raw GUID in bytes
 
         /**
         * @param createNewId if true, generates a new id.  If not, it sets the id to empty.
@@ -88,6 +89,17 @@ namespace trBase
         */
         void FromString(std::string& idString);
 
+        /**
+        * Copies the raw GUID into the passed in buffer, which has to hold BYTE_SIZE bytes. 
+        * Used for compact binary formats. 
+        */
+        void ToBytes(unsigned char* bytes) const;
+
+        /**
+        * Assigns the GUID value to this instance from a raw buffer of BYTE_SIZE bytes. 
+        */
+        void FromBytes(const unsigned char* bytes);
+
         /**
         * Returns true if the GUID is equal to 00000000-0000-0000-0000-000000000000
         */
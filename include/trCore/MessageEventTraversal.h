@@ -63,6 +63,16 @@ namespace trCore
          */
         virtual const std::string& GetMessageType() const override;
 
+        /**
+         * @fn  virtual const trManager::MessagePriority& MessageEventTraversal::GetMessagePriority() const override;
+         *
+         * @brief   Returns the priority class of the message. This is a SYSTEM message, so it is never
+         *          deferred.
+         *
+         * @return  The message priority.
+         */
+        virtual const trManager::MessagePriority& GetMessagePriority() const override;
+
     protected:
 
         /**
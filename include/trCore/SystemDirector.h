@@ -27,6 +27,9 @@
 #include <trManager/MessageBase.h>
 #include <trUtil/RefStr.h>
 #include <trUtil/Timer.h>
+#include <trUtil/Metrics/Histogram.h>
+
+#include <vector>
 
 namespace trCore
 {
@@ -73,6 +76,13 @@ namespace trCore
          */
         virtual void OnMessage(const trManager::MessageBase& msg);
 
+        /**
+         * @fn  virtual void SystemDirector::OnAddedToSysMan() override;
+         *
+         * @brief   Looks up the frame metrics of the world the director was added to.
+         */
+        virtual void OnAddedToSysMan() override;
+
         /**
          * @fn  virtual void SystemDirector::Run();
          *
@@ -112,6 +122,26 @@ namespace trCore
          */
         trManager::TimingStructure GetTimeStructure();
 
+        /**
+         * @fn  void SystemDirector::SetFixedDeltaTime(double dt);
+         *
+         * @brief   Sets a fixed, synthetic time step that is used for every frame instead of the
+         *          measured time between frames. Useful to run the system deterministically and
+         *          faster than real time. A value of 0 goes back to the measured frame time.
+         *
+         * @param   dt  The fixed frame time in seconds.
+         */
+        void SetFixedDeltaTime(double dt);
+
+        /**
+         * @fn  double SystemDirector::GetFixedDeltaTime() const;
+         *
+         * @brief   Returns the fixed, synthetic time step.
+         *
+         * @return  The fixed frame time in seconds. 0 if the measured frame time is used.
+         */
+        double GetFixedDeltaTime() const;
+
     protected:
 
         /**
@@ -227,10 +257,21 @@ namespace trCore
 
     private:
 
+        /**
+         * @fn  void SystemDirector::RunFramePhases();
+         * @brief   Runs all the phases of one frame, from the Event Traversal to the Post Frame, and
+         *          records how long each one took in the metrics registry.
+         */
+        void RunFramePhases();
+
         bool mIsRunning = false;
         bool mIsShuttingDown = false;
         bool mIsPaused = false;
         trUtil::Timer mSystemTimer;
+        double mFixedDeltaTime = 0.;
+
+        std::vector<trUtil::Metrics::Histogram*> mPhaseHistograms;     //Time spent in each frame phase, in the current world
+        trUtil::Metrics::Histogram* mFrameHistogram = nullptr;          //Time between frames, in the current world
 
         trManager::TimingStructure mTimeStruct;
     };
@@ -0,0 +1,164 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+namespace trMPEG
+{
+    /**
+     * @class   AdaptiveRateController
+     *
+     * @brief   Decides the bit rate, frame rate and output resolution of a live stream from how the
+     *          encoder and the network are keeping up. Network congestion (a filling packet queue, or
+     *          dropped packets) lowers the bit rate first, then the frame rate. An encoder that can't
+     *          keep up lowers the resolution first, then the frame rate. Once the stream has been
+     *          healthy for a while the settings are raised again one step at a time. The controller
+     *          only makes the decisions, the StreamServer applies them.
+     */
+    class TR_MPEG_EXPORT AdaptiveRateController
+    {
+    public:
+
+        /**
+         * @struct  Settings
+         *
+         * @brief   Bounds and timing of the controller.
+         */
+        struct Settings
+        {
+            int minBitRate = 0;                 /// 0 uses a quarter of the stream's bit rate
+            int maxBitRate = 0;                 /// 0 uses the stream's bit rate
+            int minFrameRate = 0;               /// 0 uses a quarter of the stream's frame rate
+            int maxFrameRate = 0;               /// 0 uses the stream's frame rate
+            bool scaleResolution = false;       /// Allow lowering the output resolution, receivers have to follow size changes mid stream
+            double minScale = 0.5;              /// Smallest output resolution, as a fraction of the input
+            double evaluationInterval = 1.0;    /// Seconds between decisions
+            double recoveryTime = 5.0;          /// Seconds without pressure before a setting is raised again
+        };
+
+        /**
+         * @fn  AdaptiveRateController::AdaptiveRateController();
+         *
+         * @brief   Default constructor.
+         */
+        AdaptiveRateController();
+
+        /**
+         * @fn  void AdaptiveRateController::Reset(const Settings& settings, int bitRate, int frameRate);
+         *
+         * @brief   Starts the controller over at full quality. Unset bounds are filled in from the
+         *          stream's own bit rate and frame rate.
+         *
+         * @param   settings    The settings.
+         * @param   bitRate     The stream's bit rate.
+         * @param   frameRate   The stream's frame rate.
+         */
+        void Reset(const Settings& settings, int bitRate, int frameRate);
+
+        /**
+         * @fn  void AdaptiveRateController::AddFrame(double workTime);
+         *
+         * @brief   Records how long the encoder worked on one frame.
+         *
+         * @param   workTime    Conversion and encoding time of the frame, in seconds.
+         */
+        void AddFrame(double workTime);
+
+        /**
+         * @fn  bool AdaptiveRateController::Update(double time, double queueFill, unsigned long long congestionEvents);
+         *
+         * @brief   Makes a decision if the evaluation interval has passed since the last one.
+         *
+         * @param   time                Current time in seconds, from any steady clock.
+         * @param   queueFill           How full the packet queue is, from 0 to 1.
+         * @param   congestionEvents    Running total of times the packet queue was full or dropped a
+         *                              packet.
+         *
+         * @return  True if any of the settings changed.
+         */
+        bool Update(double time, double queueFill, unsigned long long congestionEvents);
+
+        /**
+         * @fn  const Settings& AdaptiveRateController::GetSettings() const;
+         *
+         * @brief   Gets the settings with all the bounds filled in.
+         *
+         * @return  The settings.
+         */
+        const Settings& GetSettings() const;
+
+        /**
+         * @fn  int AdaptiveRateController::GetBitRate() const;
+         *
+         * @brief   Gets the bit rate the stream should use.
+         *
+         * @return  The bit rate.
+         */
+        int GetBitRate() const;
+
+        /**
+         * @fn  int AdaptiveRateController::GetFrameRate() const;
+         *
+         * @brief   Gets the frame rate the stream should use.
+         *
+         * @return  The frame rate.
+         */
+        int GetFrameRate() const;
+
+        /**
+         * @fn  double AdaptiveRateController::GetScale() const;
+         *
+         * @brief   Gets the output resolution the stream should use, as a fraction of the input.
+         *
+         * @return  The scale.
+         */
+        double GetScale() const;
+
+        /**
+         * @fn  void AdaptiveRateController::SetCurrent(int bitRate, int frameRate, double scale);
+         *
+         * @brief   Goes back to the settings the stream still uses, when the StreamServer could not
+         *          apply the last decision. The next decision starts from these.
+         *
+         * @param   bitRate     The bit rate the stream uses.
+         * @param   frameRate   The frame rate the stream uses.
+         * @param   scale       The output resolution the stream uses, as a fraction of the input.
+         */
+        void SetCurrent(int bitRate, int frameRate, double scale);
+
+        const static double SCALE_STEP;
+
+    private:
+
+        Settings mSettings;
+        int mBitRate = 0;
+        int mFrameRate = 0;
+        double mScale = 1.0;
+
+        double mWorkTimeSum = 0.0;
+        int mWorkFrameCount = 0;
+        double mLastEvaluation = -1.0;
+        double mHoldUntil = 0.0;
+        unsigned long long mLastCongestionEvents = 0;
+    };
+}
\ No newline at end of file
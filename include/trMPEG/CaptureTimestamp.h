@@ -0,0 +1,122 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+#include <cstdint>
+
+namespace trMPEG
+{
+    /**
+     * @class   CaptureTimestamp
+     *
+     * @brief   Carries the wall clock time a frame was captured inside an H.264 or H.265 stream, as a
+     *          user data SEI message in front of the frame's first slice. Decoders skip the message, and
+     *          a StreamSlave reading the stream can compute the true capture to display latency when
+     *          both ends share a clock, for example over loopback.
+     */
+    class TR_MPEG_EXPORT CaptureTimestamp
+    {
+    public:
+
+        /**
+         * @fn  static bool CaptureTimestamp::IsCodecSupported(AVCodecID codecId);
+         *
+         * @brief   Query if the capture time can be embedded in streams of the given codec.
+         *
+         * @param   codecId Identifier for the codec.
+         *
+         * @return  True if supported, false if not.
+         */
+        static bool IsCodecSupported(AVCodecID codecId);
+
+        /**
+         * @fn  static int64_t CaptureTimestamp::GetWallClockTime();
+         *
+         * @brief   Gets the current wall clock time in the format that is embedded in the stream.
+         *
+         * @return  Microseconds since the epoch.
+         */
+        static int64_t GetWallClockTime();
+
+        /**
+         * @fn  static bool CaptureTimestamp::Insert(AVPacket* packet, AVCodecID codecId, int64_t captureTime);
+         *
+         * @brief   Inserts the capture time into an Annex B encoded packet, right before its first
+         *          slice.
+         *
+         * @param [in,out]  packet      The encoded packet.
+         * @param           codecId     Identifier for the codec that encoded the packet.
+         * @param           captureTime The capture time, in microseconds since the epoch.
+         *
+         * @return  True if it succeeds, false if the codec is not supported or the packet has no slice.
+         */
+        static bool Insert(AVPacket* packet, AVCodecID codecId, int64_t captureTime);
+
+        /**
+         * @fn  static bool CaptureTimestamp::Find(const uint8_t* data, int size, int64_t& captureTime);
+         *
+         * @brief   Looks for a capture time in an encoded packet.
+         *
+         * @param           data        The packet data.
+         * @param           size        The packet size.
+         * @param [out]     captureTime The capture time, in microseconds since the epoch.
+         *
+         * @return  True if one was found, false if not.
+         */
+        static bool Find(const uint8_t* data, int size, int64_t& captureTime);
+
+        /**
+         * @fn  static int BuildMessage(AVCodecID codecId, int64_t captureTime, uint8_t* message);
+         *
+         * @brief   Writes the complete SEI NAL unit, start code included, holding the capture time.
+         *
+         * @param           codecId     Identifier for the codec.
+         * @param           captureTime The capture time, in microseconds since the epoch.
+         * @param [out]     message     Buffer of at least MAX_MESSAGE_SIZE bytes.
+         *
+         * @return  The message size in bytes, 0 if the codec is not supported.
+         */
+        static int BuildMessage(AVCodecID codecId, int64_t captureTime, uint8_t* message);
+
+        /**
+         * @fn  static int FindFirstSlice(const uint8_t* data, int size, AVCodecID codecId);
+         *
+         * @brief   Finds the start code of the first slice NAL unit in an Annex B packet.
+         *
+         * @param   data    The packet data.
+         * @param   size    The packet size.
+         * @param   codecId Identifier for the codec.
+         *
+         * @return  The offset of the slice's start code, -1 if the packet has no slice.
+         */
+        static int FindFirstSlice(const uint8_t* data, int size, AVCodecID codecId);
+
+        const static int MAX_MESSAGE_SIZE = 40;
+    };
+}
\ No newline at end of file
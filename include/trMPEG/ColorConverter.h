@@ -0,0 +1,106 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <cstdint>
+
+namespace trMPEG
+{
+    /**
+     * @class   ColorConverter
+     *
+     * @brief   In-tree RGBA to I420 (YUV420P) conversion, used by the StreamServer as a faster
+     *          alternative to swscale. Uses BT.601 limited range, same as swscale's default, but its
+     *          rounding differs slightly. The SSE4.1 and AVX2 kernels give the exact same output as
+     *          the scalar one, and are only used if the CPU supports them.
+     */
+    class TR_MPEG_EXPORT ColorConverter
+    {
+    public:
+
+        /**
+         * @enum    Kernel
+         *
+         * @brief   Values that represent the available conversion implementations.
+         */
+        enum class Kernel
+        {
+            SWSCALE,    /// Use FFMPEG's swscale, the ColorConverter itself does not implement this one
+            AUTO,       /// Fastest in-tree kernel the CPU supports
+            SCALAR,
+            SSE41,
+            AVX2
+        };
+
+        /**
+         * @fn  static bool ColorConverter::IsKernelSupported(Kernel kernel);
+         *
+         * @brief   Query if the given in-tree kernel can run on this CPU.
+         *
+         * @param   kernel  The kernel.
+         *
+         * @return  True if supported, false if not. Always false for SWSCALE.
+         */
+        static bool IsKernelSupported(Kernel kernel);
+
+        /**
+         * @fn  static Kernel ColorConverter::GetBestKernel();
+         *
+         * @brief   Gets the fastest in-tree kernel the CPU supports.
+         *
+         * @return  The best kernel.
+         */
+        static Kernel GetBestKernel();
+
+        /**
+         * @fn  static const char* ColorConverter::GetKernelName(Kernel kernel);
+         *
+         * @brief   Gets a printable name of the kernel.
+         *
+         * @param   kernel  The kernel.
+         *
+         * @return  The kernel name.
+         */
+        static const char* GetKernelName(Kernel kernel);
+
+        /**
+         * @fn  static bool ColorConverter::RGBAToI420(Kernel kernel, const uint8_t* rgba, int rgbaStride, uint8_t* const yuv[3], const int yuvStride[3], int width, int height);
+         *
+         * @brief   Converts an RGBA image to I420. The alpha channel is ignored. A negative rgbaStride
+         *          with rgba pointing at the last row reads the image upside down, the same trick
+         *          swscale supports.
+         *
+         * @param           kernel      The kernel to use. AUTO picks the best supported one.
+         * @param           rgba        The first row of the source image.
+         * @param           rgbaStride  The byte offset between source rows.
+         * @param [in,out]  yuv         The Y, U and V destination planes.
+         * @param           yuvStride   The byte offset between rows of each destination plane.
+         * @param           width       The image width.
+         * @param           height      The image height.
+         *
+         * @return  False if the kernel is SWSCALE or not supported on this CPU, nothing is converted.
+         */
+        static bool RGBAToI420(Kernel kernel, const uint8_t* rgba, int rgbaStride, uint8_t* const yuv[3], const int yuvStride[3], int width, int height);
+    };
+}
\ No newline at end of file
@@ -33,6 +33,8 @@
 #include <osg/Texture>
 
 #include <iostream>
+#include <memory>
+#include <vector>
 
 namespace trMPEG
 {
@@ -301,6 +303,112 @@ namespace trMPEG
          */
         int GetFrameRate();
 
+        /**
+         * @fn  void EncodingCallback::SetEncoderThreadCount(int count);
+         *
+         * @brief   Sets the number of threads the codec encodes with. 0 lets the codec pick.
+         *
+         * @param   count   Number of threads.
+         */
+        void SetEncoderThreadCount(int count);
+
+        /**
+         * @fn  int EncodingCallback::GetEncoderThreadCount();
+         *
+         * @brief   Gets the number of threads the codec encodes with.
+         *
+         * @return  The encoder thread count.
+         */
+        int GetEncoderThreadCount();
+
+        /**
+         * @fn  void EncodingCallback::SetEncoderThreadType(StreamServer::EncoderThreadType type);
+         *
+         * @brief   Sets how the codec splits the work between its threads.
+         *
+         * @param   type    The type.
+         */
+        void SetEncoderThreadType(StreamServer::EncoderThreadType type);
+
+        /**
+         * @fn  StreamServer::EncoderThreadType EncodingCallback::GetEncoderThreadType();
+         *
+         * @brief   Gets how the codec splits the work between its threads.
+         *
+         * @return  The encoder thread type.
+         */
+        StreamServer::EncoderThreadType GetEncoderThreadType();
+
+        /**
+         * @fn  void EncodingCallback::SetEncoderCpuAffinity(const std::vector<int>& cpus);
+         *
+         * @brief   Pins the encoding threads to the given CPU cores. An empty list does not pin them.
+         *
+         * @param   cpus    The CPU core indices.
+         */
+        void SetEncoderCpuAffinity(const std::vector<int>& cpus);
+
+        /**
+         * @fn  void EncodingCallback::SetEmbedCaptureTime(bool embed);
+         *
+         * @brief   Sets if the capture time of each frame is embedded in the stream, so a StreamSlave
+         *          can measure the end to end latency. H.264 and H.265 only.
+         *
+         * @param   embed   True to embed.
+         */
+        void SetEmbedCaptureTime(bool embed);
+
+        /**
+         * @fn  void EncodingCallback::SetAdaptiveRateControl(bool enable);
+         *
+         * @brief   Sets if the bit rate, frame rate and resolution of a broadcast adapt to the
+         *          network and the encoder load.
+         *
+         * @param   enable  True to enable.
+         */
+        void SetAdaptiveRateControl(bool enable);
+
+        /**
+         * @fn  void EncodingCallback::SetKeepAliveInterval(unsigned int intervalMs);
+         *
+         * @brief   Sets how often the last frame is sent again while the scene is not rendered.
+         *          0 sends nothing until the next frame.
+         *
+         * @param   intervalMs  The interval in milliseconds.
+         */
+        void SetKeepAliveInterval(unsigned int intervalMs);
+
+        /**
+         * @fn  void EncodingCallback::SetAdaptiveRateSettings(const AdaptiveRateController::Settings& settings);
+         *
+         * @brief   Sets the limits the adaptive rate control works within.
+         *
+         * @param   settings    The settings.
+         */
+        void SetAdaptiveRateSettings(const AdaptiveRateController::Settings& settings);
+
+        /**
+         * @fn  const trUtil::Metrics::Histogram* EncodingCallback::GetLatencyHistogram(StreamServer::LatencyStage stage) const;
+         *
+         * @brief   Gets the timings of one stage of the frames' way from the capture to the output.
+         *
+         * @param   stage   The stage.
+         *
+         * @return  Null if the stream is not initialized, else the histogram.
+         */
+        const trUtil::Metrics::Histogram* GetLatencyHistogram(StreamServer::LatencyStage stage) const;
+
+        /**
+         * @fn  StreamServer& EncodingCallback::AddSimulcastOutput();
+         *
+         * @brief   Adds another output that encodes the same rendered frames. Configure the returned
+         *          stream (resolution, codec, bit rate, destination) before calling Init. The output is
+         *          owned by this callback.
+         *
+         * @return  The new output stream.
+         */
+        StreamServer& AddSimulcastOutput();
+
         /**
          * @fn  virtual void EncodingCallback::operator()(osg::RenderInfo& renderInfo) const override;
          *
@@ -323,5 +431,6 @@ namespace trMPEG
 
         osg::Texture* mTexturePtr;
         trMPEG::StreamServer mStream;
+        std::vector<std::unique_ptr<trMPEG::StreamServer>> mSimulcastOutputs;
     };
 }
\ No newline at end of file
@@ -42,9 +42,16 @@ extern "C"
 }
 
 #include <trBase/SmrtPtr.h>
+#include <trMPEG/AdaptiveRateController.h>
 #include <trMPEG/CodecBase.h>
+#include <trMPEG/ColorConverter.h>
 #include <trMPEG/StreamBase.h>
 #include <trUtil/RefStr.h>
+#include <trUtil/Timer.h>
+#include <trUtil/TripleBuffer.h>
+#include <trUtil/Metrics/Counter.h>
+#include <trUtil/Metrics/Gauge.h>
+#include <trUtil/Metrics/Histogram.h>
 
 #include <osg/Matrix>
 #include <osg/Texture2D>
@@ -54,8 +61,10 @@ extern "C"
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace trMPEG
 {
@@ -102,7 +111,37 @@ namespace trMPEG
         enum class PixelFormat
         {
             RGB,
-            RGBA
+            RGBA,
+            YUV420P     /// Tightly packed Y, U and V planes, what a simulcast output gets from its source
+        };
+
+        /**
+         * @enum    EncoderThreadType
+         *
+         * @brief   Values that represent how FFMPEG spreads the encoding over its threads. Frame
+         *          threading scales better, but delays the output by a frame per thread.
+         */
+        enum class EncoderThreadType
+        {
+            FRAME,
+            SLICE,
+            FRAME_AND_SLICE
+        };
+
+        /**
+         * @enum    LatencyStage
+         *
+         * @brief   The stages a frame passes through on its way to the output, each one timed into
+         *          its own histogram.
+         */
+        enum class LatencyStage
+        {
+            CAPTURE,        /// From the start of the capture to the frame being handed to Encode
+            HANDOFF,        /// From Encode to the encoder thread picking the frame up, includes frame pacing
+            CONVERSION,     /// Color conversion of the frame to YUV
+            ENCODE,         /// From the frame being sent to the codec to its packet coming out
+            MUX,            /// From the packet being queued to it being written to the output
+            TOTAL           /// From the start of the capture to the packet being written to the output
         };
         
         const static trUtil::RefStr DEFAULT_TITLE;
@@ -114,6 +153,8 @@ namespace trMPEG
         const static int DEFAULT_FRAME_WIDTH;
         const static int DEFAULT_FRAME_HEIGHT;
         const static int DEFAULT_FRAME_RATE;
+        const static int DEFAULT_PACKET_QUEUE_SIZE;
+        const static int DEFAULT_GOP_SIZE;
 
         /**
          * @fn  StreamServer::StreamServer();
@@ -172,13 +213,26 @@ namespace trMPEG
         bool IsSilent();
 
         /**
-         * @fn  void StreamServer::Encode(const GLubyte* frameData) const;
+         * @fn  void StreamServer::Encode(const GLubyte* frameData, trUtil::TimeTicks captureTime = 0) const;
          *
-         * @brief   Encodes the given texture data.
+         * @brief   Hands the given texture data to the encoder thread. Never waits for the encoder, if
+         *          it has not picked up the previous frame yet, that frame is replaced by this one.
          *
          * @param   frameData   Frame Pixel Data
+         * @param   captureTime (Optional) trUtil::Timer::FastTick of when the capture of this frame
+         *                      started. 0 counts the capture as starting now.
          */
-        void Encode(const GLubyte* frameData) const;
+        void Encode(const GLubyte* frameData, trUtil::TimeTicks captureTime = 0) const;
+
+        /**
+         * @fn  int StreamServer::GetInputFrameSize() const;
+         *
+         * @brief   Gets the size in bytes of one frame passed to Encode, based on the resolution and the
+         *          input pixel format.
+         *
+         * @return  The input frame size.
+         */
+        int GetInputFrameSize() const;
 
         /**
          * @fn  void StreamServer::SetFileName(std::string fileName);
@@ -358,6 +412,277 @@ namespace trMPEG
          */
         int GetBitRate();
 
+        /**
+         * @fn  void StreamServer::SetGopSize(int gopSize);
+         *
+         * @brief   Sets the maximum number of frames between two key frames. Defaults to DEFAULT_GOP_SIZE.
+         *
+         * @param   gopSize The GOP size.
+         */
+        void SetGopSize(int gopSize);
+
+        /**
+         * @fn  int StreamServer::GetGopSize() const;
+         *
+         * @brief   Gets the maximum number of frames between two key frames.
+         *
+         * @return  The GOP size.
+         */
+        int GetGopSize() const;
+
+        /**
+         * @fn  void StreamServer::SetEncoderThreadCount(int count);
+         *
+         * @brief   Sets the number of threads FFMPEG encodes with. 0 lets FFMPEG pick one based on the
+         *          CPU core count. Defaults to 1.
+         *
+         * @param   count   Number of threads.
+         */
+        void SetEncoderThreadCount(int count);
+
+        /**
+         * @fn  int StreamServer::GetEncoderThreadCount() const;
+         *
+         * @brief   Gets the number of threads FFMPEG encodes with.
+         *
+         * @return  The encoder thread count.
+         */
+        int GetEncoderThreadCount() const;
+
+        /**
+         * @fn  void StreamServer::SetEncoderThreadType(EncoderThreadType type);
+         *
+         * @brief   Sets how FFMPEG spreads the encoding over its threads. Defaults to
+         *          EncoderThreadType::SLICE.
+         *
+         * @param   type    The type.
+         */
+        void SetEncoderThreadType(EncoderThreadType type);
+
+        /**
+         * @fn  EncoderThreadType StreamServer::GetEncoderThreadType() const;
+         *
+         * @brief   Gets how FFMPEG spreads the encoding over its threads.
+         *
+         * @return  The encoder thread type.
+         */
+        EncoderThreadType GetEncoderThreadType() const;
+
+        /**
+         * @fn  void StreamServer::SetEncoderCpuAffinity(const std::vector<int>& cpus);
+         *
+         * @brief   Pins the encoding and muxing threads, and the worker threads FFMPEG starts for the
+         *          codec, to the given CPU cores. An empty list, the default, leaves them to the OS.
+         *          Not supported on macOS.
+         *
+         * @param   cpus    The CPU core indexes.
+         */
+        void SetEncoderCpuAffinity(const std::vector<int>& cpus);
+
+        /**
+         * @fn  const std::vector<int>& StreamServer::GetEncoderCpuAffinity() const;
+         *
+         * @brief   Gets the CPU cores the encoding threads are pinned to.
+         *
+         * @return  The CPU core indexes.
+         */
+        const std::vector<int>& GetEncoderCpuAffinity() const;
+
+        /**
+         * @fn  void StreamServer::SetAdaptiveRateControl(bool enable);
+         *
+         * @brief   Lets the stream lower its bit rate, frame rate and output resolution on the fly when
+         *          the encoder or the network can't keep up, and raise them back once they can. The
+         *          set bit rate, frame rate and resolution are the upper bounds. Changes to the bit rate
+         *          and resolution restart the encoder at the next GOP boundary. Only used for
+         *          broadcasts. The resolution is only scaled when AdaptiveRateController::Settings
+         *          allows it, and never for streams with simulcast outputs.
+         *          Off by default. Needs to be set before Init.
+         *
+         * @param   enable  True to enable.
+         */
+        void SetAdaptiveRateControl(bool enable);
+
+        /**
+         * @fn  bool StreamServer::GetAdaptiveRateControl() const;
+         *
+         * @brief   Returns true if the adaptive rate control is enabled.
+         *
+         * @return  True if enabled.
+         */
+        bool GetAdaptiveRateControl() const;
+
+        /**
+         * @fn  void StreamServer::SetAdaptiveRateSettings(const AdaptiveRateController::Settings& settings);
+         *
+         * @brief   Sets the bounds and timing of the adaptive rate control. Needs to be set before Init.
+         *
+         * @param   settings    The settings.
+         */
+        void SetAdaptiveRateSettings(const AdaptiveRateController::Settings& settings);
+
+        /**
+         * @fn  const AdaptiveRateController::Settings& StreamServer::GetAdaptiveRateSettings() const;
+         *
+         * @brief   Gets the bounds and timing of the adaptive rate control.
+         *
+         * @return  The settings.
+         */
+        const AdaptiveRateController::Settings& GetAdaptiveRateSettings() const;
+
+        /**
+         * @fn  void StreamServer::SetKeepAliveInterval(unsigned int intervalMs);
+         *
+         * @brief   Sets how often the last frame is encoded again while no new frames come in, so
+         *          receivers that need a steady stream keep getting one. 0, the default, encodes
+         *          nothing until the next frame arrives. Needs to be set before Init.
+         *
+         * @param   intervalMs  The interval in milliseconds.
+         */
+        void SetKeepAliveInterval(unsigned int intervalMs);
+
+        /**
+         * @fn  unsigned int StreamServer::GetKeepAliveInterval() const;
+         *
+         * @brief   Gets how often the last frame is encoded again while no new frames come in.
+         *
+         * @return  The interval in milliseconds, 0 if frames are never repeated.
+         */
+        unsigned int GetKeepAliveInterval() const;
+
+        /**
+         * @fn  void StreamServer::SetFramePacing(bool pace);
+         *
+         * @brief   Sets if the encoder keeps to the frame rate, sleeping out the rest of each frame's
+         *          time slot. On by default. Off, each frame is encoded as soon as it comes in, which
+         *          is meant for offline encoding and throughput benchmarks. Needs to be set before Init.
+         *
+         * @param   pace    True to keep to the frame rate.
+         */
+        void SetFramePacing(bool pace);
+
+        /**
+         * @fn  bool StreamServer::GetFramePacing() const;
+         *
+         * @brief   Returns true if the encoder keeps to the frame rate.
+         *
+         * @return  True if pacing.
+         */
+        bool GetFramePacing() const;
+
+        /**
+         * @fn  int StreamServer::GetCurrentBitRate() const;
+         *
+         * @brief   Gets the bit rate the encoder is running at right now, lower than the set one if the
+         *          adaptive rate control has stepped it down.
+         *
+         * @return  The current bit rate.
+         */
+        int GetCurrentBitRate() const;
+
+        /**
+         * @fn  int StreamServer::GetCurrentFrameRate() const;
+         *
+         * @brief   Gets the frame rate the encoder is running at right now.
+         *
+         * @return  The current frame rate.
+         */
+        int GetCurrentFrameRate() const;
+
+        /**
+         * @fn  void StreamServer::GetCurrentResolution(int& width, int& height) const;
+         *
+         * @brief   Gets the resolution the encoder is running at right now.
+         *
+         * @param [out] width   The width.
+         * @param [out] height  The height.
+         */
+        void GetCurrentResolution(int& width, int& height) const;
+
+        /**
+         * @fn  void StreamServer::SetEmbedCaptureTime(bool embed);
+         *
+         * @brief   Sets if the wall clock capture time of each frame is embedded in the stream, so a
+         *          StreamSlave can measure the true end to end latency. Only H.264 and H.265 streams
+         *          can carry it. Off by default. Needs to be set before Init.
+         *
+         * @param   embed   True to embed.
+         */
+        void SetEmbedCaptureTime(bool embed);
+
+        /**
+         * @fn  bool StreamServer::GetEmbedCaptureTime() const;
+         *
+         * @brief   Returns true if the capture time of each frame is embedded in the stream.
+         *
+         * @return  True if embedding.
+         */
+        bool GetEmbedCaptureTime() const;
+
+        /**
+         * @fn  const trUtil::Metrics::Histogram* StreamServer::GetLatencyHistogram(LatencyStage stage) const;
+         *
+         * @brief   Gets the timings of one stage of the frames' way through the stream server, in
+         *          seconds. The same histograms are published through the metrics registry.
+         *
+         * @param   stage   The stage.
+         *
+         * @return  Null if the stream is not initialized, else the histogram.
+         */
+        const trUtil::Metrics::Histogram* GetLatencyHistogram(LatencyStage stage) const;
+
+        /**
+         * @fn  unsigned long long StreamServer::GetEncodedFrameCount() const;
+         *
+         * @brief   Gets the number of frames encoded since Init, repeated frames included.
+         *
+         * @return  The encoded frame count.
+         */
+        unsigned long long GetEncodedFrameCount() const;
+
+        /**
+         * @fn  unsigned long long StreamServer::GetDroppedFrameCount() const;
+         *
+         * @brief   Gets the number of frames replaced by a newer one before the encoder picked them up.
+         *
+         * @return  The dropped frame count.
+         */
+        unsigned long long GetDroppedFrameCount() const;
+
+        /**
+         * @fn  unsigned long long StreamServer::GetDuplicatedFrameCount() const;
+         *
+         * @brief   Gets the number of frames encoded again because no new frame arrived within the
+         *          keep alive interval.
+         *
+         * @return  The duplicated frame count.
+         */
+        unsigned long long GetDuplicatedFrameCount() const;
+
+        /**
+         * @fn  unsigned long long StreamServer::GetEncodedByteCount() const;
+         *
+         * @brief   Gets the number of encoded video bytes sent to the muxer since Init.
+         *
+         * @return  The encoded byte count.
+         */
+        unsigned long long GetEncodedByteCount() const;
+
+        /**
+         * @fn  void StreamServer::AddSimulcastOutput(StreamServer& output);
+         *
+         * @brief   Adds another output that encodes the same captured frames, with its own codec, bit
+         *          rate, resolution and destination. This stream converts each frame to YUV once, scales
+         *          it once per distinct output resolution, and hands it to the outputs, which then encode
+         *          in parallel on their own threads. The output is switched to PixelFormat::YUV420P
+         *          input, and it is initialized and shut down together with this stream. Call before
+         *          Init. The caller keeps ownership of the output, which has to outlive this stream's
+         *          ShutDown.
+         *
+         * @param [in,out]  output  The output.
+         */
+        void AddSimulcastOutput(StreamServer& output);
+
         /**
          * @fn  void StreamServer::SetInputPixelFormat(PixelFormat format);
          *
@@ -385,6 +710,46 @@ namespace trMPEG
          */
         virtual void SetFlipImageVertically(bool flip) override;
 
+        /**
+         * @fn  void StreamServer::SetColorConversionKernel(ColorConverter::Kernel kernel);
+         *
+         * @brief   Sets the implementation that converts the input frames to YUV. The in-tree kernels
+         *          only handle RGBA input, other formats and CPUs without the requested instruction set
+         *          fall back to swscale. Defaults to ColorConverter::Kernel::SWSCALE.
+         *
+         * @param   kernel  The kernel.
+         */
+        void SetColorConversionKernel(ColorConverter::Kernel kernel);
+
+        /**
+         * @fn  ColorConverter::Kernel StreamServer::GetColorConversionKernel() const;
+         *
+         * @brief   Gets the implementation that converts the input frames to YUV.
+         *
+         * @return  The kernel.
+         */
+        ColorConverter::Kernel GetColorConversionKernel() const;
+
+        /**
+         * @fn  void StreamServer::SetPacketQueueSize(int size);
+         *
+         * @brief   Sets how many encoded packets can wait for the muxing thread. When the queue is full
+         *          a broadcast drops its oldest packet, while a file stream makes the encoder wait.
+         *          Defaults to DEFAULT_PACKET_QUEUE_SIZE.
+         *
+         * @param   size    The queue size, at least 1.
+         */
+        void SetPacketQueueSize(int size);
+
+        /**
+         * @fn  int StreamServer::GetPacketQueueSize() const;
+         *
+         * @brief   Gets how many encoded packets can wait for the muxing thread.
+         *
+         * @return  The packet queue size.
+         */
+        int GetPacketQueueSize() const;
+
         /**
          * @fn  void StreamServer::operator()() const;
          *
@@ -394,6 +759,42 @@ namespace trMPEG
 
     protected:
 
+        /**
+         * @struct  InputFrame
+         *
+         * @brief   A frame handed to Encode, and when it was captured and handed over.
+         */
+        struct InputFrame
+        {
+            std::vector<uint8_t> data;
+            trUtil::TimeTicks captureTime = 0;
+            trUtil::TimeTicks handoffTime = 0;
+        };
+
+        /**
+         * @struct  EncoderFrame
+         *
+         * @brief   A frame the codec is encoding, matched to its packet by the presentation time stamp.
+         */
+        struct EncoderFrame
+        {
+            int64_t pts;
+            trUtil::TimeTicks captureTime;
+            trUtil::TimeTicks sendTime;
+        };
+
+        /**
+         * @struct  QueuedPacket
+         *
+         * @brief   An encoded packet waiting for the muxing thread.
+         */
+        struct QueuedPacket
+        {
+            AVPacket* packet;
+            trUtil::TimeTicks captureTime;
+            trUtil::TimeTicks queueTime;
+        };
+
         std::atomic<bool> mIsInit = { false };
         bool mSilent = true;
         bool mIsBroadcast = false;
@@ -406,6 +807,12 @@ namespace trMPEG
         int mFrameRate;
         int mPixFmtSize = 3;
         PixelFormat mPixFmt = PixelFormat::RGB;
+        ColorConverter::Kernel mConversionKernel = ColorConverter::Kernel::SWSCALE;
+        int mGopSize = DEFAULT_GOP_SIZE;
+        int mEncoderThreadCount = 1;
+        EncoderThreadType mEncoderThreadType = EncoderThreadType::SLICE;
+        std::vector<int> mEncoderCpuAffinity;
+        std::vector<StreamServer*> mSimulcastOutputs;
         AVRational mFrameRateRat;
         const AVRational mTimeBaseRat = { 1, 1000 };      
 
@@ -417,22 +824,59 @@ namespace trMPEG
         trBase::SmrtPtr<trMPEG::CodecBase> mCodecContainer;
 
         AVOutputFormat *mOutputFormatPtr = nullptr;
-        AVCodecContext *mCodecContextPtr = nullptr;
+        mutable AVCodecContext *mCodecContextPtr = nullptr;
         mutable AVFormatContext *mFormatContextPtr = nullptr;
 
-        mutable AVPacket mVidPkt = { 0 };
         mutable StreamContainer mVidStream = { 0 };
 
         //Variables used in encoding thread
         std::thread* mEncodeThreadPtr = nullptr;
         mutable std::mutex mEncodeThreadLock;
         std::atomic<bool> mMainThreadActive = { true };
-        mutable std::vector<uint8_t> mTextureData;
-        mutable std::atomic<bool> mNewFrameReady = { false };
+        mutable trUtil::TripleBuffer<InputFrame> mFrameBuffer;
+        mutable std::mutex mFrameSignalLock;
+        mutable std::condition_variable mFrameSignal;
         mutable double mFrameTimeLength = 0.01;
         mutable int mTotalFramePTSCounter = 0;
         mutable int mFramePTSLength = 0;
 
+        //Variables shared by the encoding and muxing threads
+        std::thread* mMuxThreadPtr = nullptr;
+        mutable std::mutex mPacketQueueLock;
+        mutable std::condition_variable mPacketQueueSignal;
+        mutable std::deque<QueuedPacket> mPacketQueue;
+        mutable bool mEncoderFinished = false;
+        int mPacketQueueSize = DEFAULT_PACKET_QUEUE_SIZE;
+
+        //Encoder metrics, published through the global trUtil::Metrics::MetricsRegistry once the stream is initialized
+        trUtil::Metrics::Counter* mEncodedFramesCounter = nullptr;
+        trUtil::Metrics::Counter* mDroppedFramesCounter = nullptr;
+        trUtil::Metrics::Counter* mDuplicatedFramesCounter = nullptr;
+        trUtil::Metrics::Counter* mEncodedBytesCounter = nullptr;
+        trUtil::Metrics::Gauge* mEncodeFpsGauge = nullptr;
+        trUtil::Metrics::Gauge* mBitRateGauge = nullptr;
+        trUtil::Metrics::Gauge* mPacketQueueDepthGauge = nullptr;
+        trUtil::Metrics::Counter* mPacketQueueFullCounter = nullptr;
+        trUtil::Metrics::Counter* mDroppedPacketsCounter = nullptr;
+        trUtil::Metrics::Histogram* mMuxWriteHistogram = nullptr;
+        trUtil::Metrics::Histogram* mLatencyHistograms[static_cast<int>(LatencyStage::TOTAL) + 1] = {};
+
+        //Encoding thread only, the frames the codec is still holding on to, in the order they were sent
+        mutable std::deque<EncoderFrame> mFramesInEncoder;
+        bool mEmbedCaptureTime = false;
+
+        //Adaptive rate control, the controller is only used by the encoding thread
+        bool mAdaptiveRateControl = false;
+        AdaptiveRateController::Settings mAdaptiveRateSettings;
+        mutable AdaptiveRateController mRateController;
+        mutable std::atomic<int> mCurrentBitRate = { 0 };
+        mutable std::atomic<int> mCurrentFrameRate = { 0 };
+        mutable std::atomic<int> mCurrentWidth = { 0 };
+        mutable std::atomic<int> mCurrentHeight = { 0 };
+        unsigned int mKeepAliveIntervalMs = 0;
+        bool mFramePacing = true;
+        trUtil::Metrics::Counter* mEncoderRestartsCounter = nullptr;
+
         /**
          * @fn  AVFrame* StreamServer::GenerateVideoFrame(AVCodecContext *codecContext, StreamContainer *strCont) const;
          *
@@ -457,6 +901,68 @@ namespace trMPEG
          */
         void ConfigureStream(StreamContainer *strCont, AVFormatContext *formatContext, AVCodec **codec, enum AVCodecID codecId);
 
+        /**
+         * @fn  void StreamServer::ConfigureCodecContext(AVCodecContext *codecContext, int bitRate, int width, int height) const;
+         *
+         * @brief   Sets up the encoding options of a codec context that is not opened yet.
+         *
+         * @param [in,out]  codecContext    Context for the codec.
+         * @param           bitRate         The bit rate.
+         * @param           width           The width.
+         * @param           height          The height.
+         */
+        void ConfigureCodecContext(AVCodecContext *codecContext, int bitRate, int width, int height) const;
+
+        /**
+         * @fn  int StreamServer::OpenCodecContext(AVCodecContext *codecContext, const AVCodec *codec, AVDictionary *optArg) const;
+         *
+         * @brief   Opens a codec context, with the encoder CPU affinity applied to its worker threads.
+         *
+         * @param [in,out]  codecContext    Context for the codec.
+         * @param           codec           The codec.
+         * @param [in,out]  optArg          If non-null, the options argument.
+         *
+         * @return  The avcodec_open2 result.
+         */
+        int OpenCodecContext(AVCodecContext *codecContext, const AVCodec *codec, AVDictionary *optArg) const;
+
+        /**
+         * @fn  bool StreamServer::RestartEncoder(int bitRate, int width, int height) const;
+         *
+         * @brief   Drains the encoder and replaces it with one using the given settings. Only call this
+         *          between GOPs, the new encoder starts with a key frame.
+         *
+         * @param   bitRate The bit rate.
+         * @param   width   The width.
+         * @param   height  The height.
+         *
+         * @return  False if the new encoder could not be opened, the old one keeps running.
+         */
+        bool RestartEncoder(int bitRate, int width, int height) const;
+
+        /**
+         * @fn  SwsContext* StreamServer::CreateConversionContext(int width, int height) const;
+         *
+         * @brief   Creates a swscale context that converts input frames to YUV420P at the given size.
+         *
+         * @param   width   The output width.
+         * @param   height  The output height.
+         *
+         * @return  Null if the input pixel format is invalid, else the context.
+         */
+        SwsContext* CreateConversionContext(int width, int height) const;
+
+        /**
+         * @fn  void StreamServer::GetScaledResolution(double scale, int& width, int& height) const;
+         *
+         * @brief   Scales the input resolution down, keeping it even as encoders need.
+         *
+         * @param           scale   The scale, 1 for the input resolution.
+         * @param [out]     width   The scaled width.
+         * @param [out]     height  The scaled height.
+         */
+        void GetScaledResolution(double scale, int& width, int& height) const;
+
         /**
          * @fn  void StreamServer::OpenVideoCodec(AVCodecContext *codecContext, AVCodec *codec, StreamContainer *strCont, AVDictionary *optArg);
          *
@@ -470,14 +976,45 @@ namespace trMPEG
         void OpenVideoCodec(AVCodecContext *codecContext, AVCodec *codec, StreamContainer *strCont, AVDictionary *optArg);
 
         /**
-         * @fn  void StreamServer::EncodeVideoFrame(AVCodecContext *codecContext, AVFormatContext *frmtCont, StreamContainer *strCont) const;
+         * @fn  void StreamServer::EncodeVideoFrame(AVCodecContext *codecContext, StreamContainer *strCont, trUtil::TimeTicks captureTime) const;
+         *
+         * @brief   Encode one video frame and queue its packets for the muxing thread.
+         *
+         * @param [in,out]  codecContext    If non-null, context for the codec.
+         * @param [in,out]  strCont         If non-null, the stream container.
+         * @param           captureTime     When the capture of the frame started.
+         */
+        void EncodeVideoFrame(AVCodecContext *codecContext, StreamContainer *strCont, trUtil::TimeTicks captureTime) const;
+
+        /**
+         * @fn  void StreamServer::SendFrameToEncoder(AVCodecContext *codecContext, StreamContainer *strCont, const AVFrame* frame, trUtil::TimeTicks captureTime) const;
          *
-         * @brief   Encode one video frame and send it to the muxer.
+         * @brief   Sends a frame to the encoder and queues every packet the encoder has ready.
          *
          * @param [in,out]  codecContext    If non-null, context for the codec.
-         * @param [in,out]  frmtCont        If non-null, context for the format.
          * @param [in,out]  strCont         If non-null, the stream container.
+         * @param           frame           The frame, or null to flush the encoder at the end of the stream.
+         * @param           captureTime     When the capture of the frame started, ignored when flushing.
+         */
+        void SendFrameToEncoder(AVCodecContext *codecContext, StreamContainer *strCont, const AVFrame* frame, trUtil::TimeTicks captureTime) const;
+
+        /**
+         * @fn  void StreamServer::QueuePacket(AVPacket* packet, trUtil::TimeTicks captureTime) const;
+         *
+         * @brief   Hands an encoded packet to the muxing thread. Applies the full queue policy described
+         *          in SetPacketQueueSize.
+         *
+         * @param [in,out]  packet      The packet. The queue takes ownership of it.
+         * @param           captureTime When the capture of the packet's frame started, 0 if unknown.
+         */
+        void QueuePacket(AVPacket* packet, trUtil::TimeTicks captureTime) const;
+
+        /**
+         * @fn  void StreamServer::MuxPackets() const;
+         *
+         * @brief   The muxing thread. Writes queued packets to the output until the encoder is finished
+         *          and the queue is empty.
          */
-        void EncodeVideoFrame(AVCodecContext *codecContext, AVFormatContext *frmtCont, StreamContainer *strCont) const;       
+        void MuxPackets() const;       
 	};
 }
\ No newline at end of file
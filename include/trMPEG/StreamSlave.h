@@ -25,6 +25,10 @@
 
 #include <trBase/SmrtPtr.h>
 #include <trMPEG/StreamBase.h>
+#include <trUtil/Timer.h>
+#include <trUtil/Metrics/Counter.h>
+#include <trUtil/Metrics/Gauge.h>
+#include <trUtil/Metrics/Histogram.h>
 
 #include <osg/Image>
 
@@ -36,19 +40,57 @@ extern "C"
 #include <libswscale/swscale.h>
 }
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace trMPEG
 {
     /**
      * @class   StreamSlave
      *
-     * @brief   This class is used to read in a UDP MPEG broadcast from a network or a file source
+     * @brief   This class is used to read in a UDP MPEG broadcast from a network or a file source.
+     *          The stream is read and decoded on a background thread into a small jitter buffer, so
+     *          Update never waits on the network.
      */
     class TR_MPEG_EXPORT StreamSlave : public trMPEG::StreamBase
     {
     public:
 
+        const static int DEFAULT_JITTER_BUFFER_SIZE;
+
+        /**
+         * @enum    ScalerQuality
+         *
+         * @brief   Filter used when converting the decoded frames to RGB. FAST_BILINEAR is the
+         *          cheapest and is usually good enough for live viewing.
+         */
+        enum class ScalerQuality 
+        { 
+            FAST_BILINEAR, 
+            BILINEAR, 
+            BICUBIC 
+        };
+
+        /**
+         * @enum    LatencyStage
+         *
+         * @brief   The stages a frame passes through from the network to the screen, each one timed
+         *          into its own histogram.
+         */
+        enum class LatencyStage
+        {
+            RECEIVE,        /// Reading one packet off the stream, including waiting for it to arrive
+            DECODE,         /// From the packet being read to its frame coming out of the decoder
+            PRESENT,        /// From the frame being decoded to Update showing it, the jitter buffer delay
+            END_TO_END      /// From the capture on the server to Update showing the frame. Needs a stream
+                            /// with embedded capture times, and a clock shared with the server
+        };
+
         /**
          * @fn  StreamSlave::StreamSlave();
          *
@@ -72,21 +114,148 @@ namespace trMPEG
          */
         virtual void SetUDPAddress(std::string address) override;
 
+        /**
+         * @fn  void StreamSlave::SetJitterBufferSize(int frames);
+         *
+         * @brief   Sets how many frames of delay the jitter buffer adds to absorb uneven network
+         *          arrival. Larger values play smoother over a bad network, smaller values lower the
+         *          latency. Needs to be set before Connect.
+         *
+         * @param   frames  The buffer size in frames.
+         */
+        void SetJitterBufferSize(int frames);
+
+        /**
+         * @fn  int StreamSlave::GetJitterBufferSize() const;
+         *
+         * @brief   Gets the jitter buffer size in frames.
+         *
+         * @return  The jitter buffer size.
+         */
+        int GetJitterBufferSize() const;
+
+        /**
+         * @fn  void StreamSlave::SetScalerQuality(ScalerQuality quality);
+         *
+         * @brief   Sets the filter used for the RGB conversion. Defaults to ScalerQuality::BICUBIC.
+         *          Needs to be set before Connect.
+         *
+         * @param   quality The quality.
+         */
+        void SetScalerQuality(ScalerQuality quality);
+
+        /**
+         * @fn  ScalerQuality StreamSlave::GetScalerQuality() const;
+         *
+         * @brief   Gets the filter used for the RGB conversion.
+         *
+         * @return  The scaler quality.
+         */
+        ScalerQuality GetScalerQuality() const;
+
+        /**
+         * @fn  void StreamSlave::SetConvertToRGB(bool convert);
+         *
+         * @brief   Sets if the decoded frames are converted to RGB for the target image. Turn this off
+         *          when the application converts the frames on its own, for example in a shader, and
+         *          read them with GetYUVFrame instead. On by default. Needs to be set before Connect.
+         *
+         * @param   convert True to convert.
+         */
+        void SetConvertToRGB(bool convert);
+
+        /**
+         * @fn  bool StreamSlave::GetConvertToRGB() const;
+         *
+         * @brief   Returns true if the decoded frames are converted to RGB for the target image.
+         *
+         * @return  True if converting.
+         */
+        bool GetConvertToRGB() const;
+
         /**
          * @fn  void StreamSlave::Connect(osg::Image* targetImage);
          *
-         * @brief   Connects to the network stream, and sets the target image 
+         * @brief   Connects to the network stream, sets the target image, and starts the decoding
+         *          thread.
          *
          * @param [in,out]  targetImage If non-null, the target image to connect.
          */
         void Connect(osg::Image* targetImage);
 
         /**
-         * @fn  void StreamSlave::Update();
+         * @fn  bool StreamSlave::Update();
+         *
+         * @brief   Updates the target image with the newest decoded frame that is due to be shown. Does
+         *          nothing if no such frame is ready, it never waits for the stream. The frame is
+         *          converted straight into one of two buffers that the target image takes turns
+         *          pointing at, so it is never copied again.
+         *
+         * @return  True if a new frame was taken.
+         */
+        bool Update();
+
+        /**
+         * @fn  const AVFrame* StreamSlave::GetYUVFrame() const;
+         *
+         * @brief   Gets the frame taken by the last Update in the decoder's own pixel format, usually
+         *          YUV420P. The planes stay valid until the next Update. When the image is flipped the
+         *          plane pointers start at the last row and the line sizes are negative.
+         *
+         * @return  Null if no frame was taken yet, else the frame.
+         */
+        const AVFrame* GetYUVFrame() const;
+
+        /**
+         * @fn  unsigned long long StreamSlave::GetDecodedFrameCount() const;
          *
-         * @brief   Updates the target image from connected stream data
+         * @brief   Gets the number of frames decoded since Connect.
+         *
+         * @return  The decoded frame count.
          */
-        void Update();
+        unsigned long long GetDecodedFrameCount() const;
+
+        /**
+         * @fn  unsigned long long StreamSlave::GetLateFrameCount() const;
+         *
+         * @brief   Gets the number of frames that were decoded after the time they should have been
+         *          shown. Those are shown as soon as possible.
+         *
+         * @return  The late frame count.
+         */
+        unsigned long long GetLateFrameCount() const;
+
+        /**
+         * @fn  unsigned long long StreamSlave::GetDroppedFrameCount() const;
+         *
+         * @brief   Gets the number of decoded frames that were never shown, either because Update was
+         *          not called in time or because the jitter buffer overflowed.
+         *
+         * @return  The dropped frame count.
+         */
+        unsigned long long GetDroppedFrameCount() const;
+
+        /**
+         * @fn  const trUtil::Metrics::Histogram* StreamSlave::GetLatencyHistogram(LatencyStage stage) const;
+         *
+         * @brief   Gets the timings of one stage of the frames' way to the screen, in seconds. The same
+         *          histograms are published through the metrics registry.
+         *
+         * @param   stage   The stage.
+         *
+         * @return  Null if not connected, else the histogram.
+         */
+        const trUtil::Metrics::Histogram* GetLatencyHistogram(LatencyStage stage) const;
+
+        /**
+         * @fn  double StreamSlave::GetAverageDecodeLatency() const;
+         *
+         * @brief   Gets the average time in seconds from a packet being read off the stream to its
+         *          frame coming out of the decoder.
+         *
+         * @return  The average decode latency.
+         */
+        double GetAverageDecodeLatency() const;
 
         /**
          * @fn  virtual void StreamSlave::SetFlipImageVertically(bool flip) override;
@@ -99,10 +268,43 @@ namespace trMPEG
 
     protected:
 
+        /**
+         * @struct  BufferedFrame
+         *
+         * @brief   A decoded frame waiting in the jitter buffer, and the time it is due to be shown.
+         */
+        struct BufferedFrame
+        {
+            AVFrame* frame;
+            int width;                      /// The frame's own size and format, the decoder can change them for later frames
+            int height;
+            AVPixelFormat format;
+            std::chrono::steady_clock::time_point presentTime;
+            trUtil::TimeTicks decodedTime;
+            int64_t captureTime;            /// Wall clock microseconds embedded by the server, 0 if none
+        };
+
+        /**
+         * @struct  DecoderPacket
+         *
+         * @brief   A packet the decoder is working on, matched to its frame by the presentation time stamp.
+         */
+        struct DecoderPacket
+        {
+            int64_t pts;
+            trUtil::TimeTicks readTime;
+            int64_t captureTime;
+        };
+
         trBase::SmrtPtr<osg::Image> mImageTarget;
 
-        AVFrame* mFrameYUV = nullptr;
-        AVFrame* mFrameRGB = nullptr;
+        AVFrame* mFrameYUV = nullptr;       /// The frame currently shown
+
+        //RGB storage the target image alternates between, the image never owns it
+        std::vector<unsigned char> mImageBuffers[2];
+        int mImageBufferIndex = 0;
+        ScalerQuality mScalerQuality = ScalerQuality::BICUBIC;
+        bool mConvertToRGB = true;
 
         AVStream* mInputStream = nullptr;
         AVFormatContext* mFrmtContext = nullptr;
@@ -111,6 +313,57 @@ namespace trMPEG
 
         SwsContext* mFrameConvertCtx = nullptr;
 
-        AVPacket mPacket;
+        //Variables shared by the decoding thread and Update
+        std::thread* mDecodeThreadPtr = nullptr;
+        std::atomic<bool> mDecodeThreadActive = { true };
+        std::mutex mJitterBufferLock;
+        std::deque<BufferedFrame> mJitterBuffer;
+        int mJitterBufferSize = DEFAULT_JITTER_BUFFER_SIZE;
+
+        //Decoding thread only, maps stream time stamps onto the local clock
+        std::chrono::steady_clock::duration mFramePeriod = std::chrono::milliseconds(33);
+        std::chrono::steady_clock::time_point mPlayoutStart;
+        int64_t mPlayoutStartPts = AV_NOPTS_VALUE;
+
+        //Decoder metrics, published through the global trUtil::Metrics::MetricsRegistry once connected
+        trUtil::Metrics::Counter* mDecodedFramesCounter = nullptr;
+        trUtil::Metrics::Counter* mLateFramesCounter = nullptr;
+        trUtil::Metrics::Counter* mDroppedFramesCounter = nullptr;
+        trUtil::Metrics::Gauge* mJitterBufferDepthGauge = nullptr;
+        trUtil::Metrics::Histogram* mLatencyHistograms[static_cast<int>(LatencyStage::END_TO_END) + 1] = {};
+
+        //Decoding thread only, the packets whose frames have not come out of the decoder yet
+        std::deque<DecoderPacket> mPacketsInDecoder;
+
+        /**
+         * @fn  void StreamSlave::DecodeFrames();
+         *
+         * @brief   Decoding thread loop. Reads packets off the stream, decodes them, and queues the
+         *          frames in the jitter buffer until the thread is stopped or the stream ends.
+         */
+        void DecodeFrames();
+
+        /**
+         * @fn  void StreamSlave::BufferFrame(AVFrame* frame, int64_t captureTime);
+         *
+         * @brief   Works out when a decoded frame is due and adds it to the jitter buffer, dropping
+         *          the oldest frame if the buffer is full. Takes ownership of the frame.
+         *
+         * @param [in,out]  frame       The decoded frame.
+         * @param           captureTime The capture time embedded in the frame's packet, 0 if none.
+         */
+        void BufferFrame(AVFrame* frame, int64_t captureTime);
+
+        /**
+         * @fn  static int StreamSlave::InterruptCallback(void* slave);
+         *
+         * @brief   FFMPEG interrupt callback, lets a blocking network read return once the decoding
+         *          thread is asked to stop.
+         *
+         * @param [in,out]  slave   The StreamSlave.
+         *
+         * @return  Non-zero to interrupt the read.
+         */
+        static int InterruptCallback(void* slave);
     };
 }
\ No newline at end of file
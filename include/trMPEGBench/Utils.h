@@ -0,0 +1,53 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+
+#include <string>
+
+static const std::string PROGRAM_NAME = "TrueReality";
+static const std::string EXE_NAME = "trMPEGBench";
+
+static const std::string BENCHMARK_CONVERSION = "conversion";
+static const std::string BENCHMARK_ENCODE = "encode";
+
+/**
+ * @struct  BenchSettings
+ *
+ * @brief   The benchmark options given on the command line.
+ */
+struct BenchSettings
+{
+    std::string benchmark = BENCHMARK_CONVERSION;
+    std::string outputFile;
+    int width = 1920;
+    int height = 1080;
+    bool hasResolution = false;
+    int iterations = 100;
+    int frameRate = 60;
+    bool unthrottled = false;
+    std::string codec;
+    std::string pixelFormat;
+};
+
+/*
+* Parses the command line variables that are passed in to the executable
+*/
+void ParseCmdLineArgs(int& argc, char** argv, BenchSettings& settings);
\ No newline at end of file
@@ -25,6 +25,7 @@
 
 #include <trManager/MessageBase.h>
 #include <trManager/EntityBase.h>
+#include <trManager/ReplicatedFields.h>
 #include <trBase/UniqueId.h>
 #include <trBase/SmrtPtr.h>
 
@@ -102,6 +103,34 @@ namespace trManager
          */
         virtual void UnregisterFromMessagesAboutEntity(const trBase::UniqueId& aboutEntityId);
 
+        /**
+         * @fn  virtual void ActorBase::RegisterForMessagesInArea(double radius, const std::string& invokableName);
+         *
+         * @brief   Registers for messages about all the actors within a radius of this actor. Needs
+         *          the actors position to be published with SetPosition.
+         *
+         * @param   radius          The radius of the area.
+         * @param   invokableName   Name of the invokable.
+         */
+        virtual void RegisterForMessagesInArea(double radius, const std::string& invokableName);
+
+        /**
+         * @fn  virtual void ActorBase::UnregisterFromMessagesInArea();
+         *
+         * @brief   Unregisters from messages about the actors in an area.
+         */
+        virtual void UnregisterFromMessagesInArea();
+
+        /**
+         * @fn  virtual void ActorBase::SetPosition(const trBase::Vec3& position);
+         *
+         * @brief   Publishes the position of this actor to the System Manager, for the area of
+         *          interest registrations.
+         *
+         * @param   position    The position.
+         */
+        virtual void SetPosition(const trBase::Vec3& position);
+
         /**
          * @fn  virtual void ActorBase::BuildInvokables();
          *
@@ -124,11 +153,24 @@ namespace trManager
          *
          * @brief   Convenience function that will receive a Network Tick Message from the System Manager
          *          This does not happen automatically, each class needs to register for the message.
+         *          By default it interpolates the replicated fields of a remote actor, so overrides
+         *          should call the base class.
          *
          * @param   msg The message.
          */
         virtual void OnTickRemote(const trManager::MessageBase& msg);
 
+        /**
+         * @fn  virtual trManager::ReplicatedFields* ActorBase::GetReplicatedFields();
+         *
+         * @brief   Returns the member variables that the ReplicationDirector sends from a server to its
+         *          clients. Actors that are replicated should add their fields to a ReplicatedFields
+         *          member, and return it here.
+         *
+         * @return  Null if the actor is not replicated, else the replicated fields.
+         */
+        virtual trManager::ReplicatedFields* GetReplicatedFields();
+
         /**
          * @fn  virtual bool ActorBase::SendMessage(const trManager::MessageBase& message);
          *
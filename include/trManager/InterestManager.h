@@ -0,0 +1,215 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/EntityBase.h>
+#include <trManager/SpatialIndex.h>
+#include <trUtil/HashMap.h>
+#include <trBase/UniqueId.h>
+#include <trBase/SmrtPtr.h>
+
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   InterestManager
+     *
+     * @brief   Area of interest subscriptions for messages about entities. A listener subscribes to a
+     *          radius around its own position in the SpatialIndex, and receives the messages about
+     *          every entity inside it. The members of each area are refreshed once per frame by
+     *          Update, and only the entities that entered or left an area change the lookup tables,
+     *          so delivering a message is a single lookup of the entity it is about.
+     */
+    class TR_MANAGER_EXPORT InterestManager
+    {
+    public:
+
+        /**
+         * @struct  Subscription
+         *
+         * @brief   An area subscription of a single listener.
+         */
+        struct Subscription
+        {
+            trBase::SmrtPtr<trManager::EntityBase> listener;
+            std::string invokableName;
+            double radius = 0.0;
+            std::vector<trBase::UniqueId> members;          //Sorted IDs of the entities inside the area
+        };
+
+        /**
+         * @fn  InterestManager::InterestManager();
+         *
+         * @brief   Default constructor.
+         */
+        InterestManager();
+
+        /**
+         * @fn  InterestManager::~InterestManager();
+         *
+         * @brief   Destructor.
+         */
+        ~InterestManager();
+
+        /**
+         * @fn  void InterestManager::AddSubscription(trManager::EntityBase& listener, double radius, const std::string& invokableName);
+         *
+         * @brief   Subscribes a listener to the messages about the entities within a radius of its
+         *          position. Subscribing again changes the radius and invokable. The members are
+         *          found on the next Update.
+         *
+         * @param [in,out]  listener        The listening entity.
+         * @param           radius          The radius of the area.
+         * @param           invokableName   The invokable that receives the messages.
+         */
+        void AddSubscription(trManager::EntityBase& listener, double radius, const std::string& invokableName);
+
+        /**
+         * @fn  bool InterestManager::RemoveSubscription(const trBase::UniqueId& listenerId);
+         *
+         * @brief   Removes the subscription of a listener.
+         *
+         * @param   listenerId  The listeners ID.
+         *
+         * @return  False if the listener had no subscription.
+         */
+        bool RemoveSubscription(const trBase::UniqueId& listenerId);
+
+        /**
+         * @fn  void InterestManager::RemoveEntity(const trBase::UniqueId& id);
+         *
+         * @brief   Removes an entity as a listener, and from all the areas it is in.
+         *
+         * @param   id  The entity ID.
+         */
+        void RemoveEntity(const trBase::UniqueId& id);
+
+        /**
+         * @fn  void InterestManager::Clear();
+         *
+         * @brief   Removes all subscriptions.
+         */
+        void Clear();
+
+        /**
+         * @fn  bool InterestManager::IsEmpty() const;
+         *
+         * @brief   Returns true if there are no subscriptions.
+         *
+         * @return  True if empty, false if not.
+         */
+        bool IsEmpty() const;
+
+        /**
+         * @fn  void InterestManager::Update(const trManager::SpatialIndex& index);
+         *
+         * @brief   Refreshes the members of every area from the current positions. Listeners without
+         *          a position have empty areas.
+         *
+         * @param   index   The positions of the entities.
+         */
+        void Update(const trManager::SpatialIndex& index);
+
+        /**
+         * @fn  const std::vector<Subscription*>* InterestManager::GetSubscriptions(const trBase::UniqueId& aboutId) const;
+         *
+         * @brief   Returns the subscriptions whose areas hold an entity.
+         *
+         * @param   aboutId The entity ID.
+         *
+         * @return  Null if the entity is in no area, else the subscriptions.
+         */
+        const std::vector<Subscription*>* GetSubscriptions(const trBase::UniqueId& aboutId) const;
+
+        /**
+         * @fn  const Subscription* InterestManager::FindSubscription(const trBase::UniqueId& listenerId) const;
+         *
+         * @brief   Returns the subscription of a listener.
+         *
+         * @param   listenerId  The listeners ID.
+         *
+         * @return  Null if the listener has no subscription, else the subscription.
+         */
+        const Subscription* FindSubscription(const trBase::UniqueId& listenerId) const;
+
+        /**
+         * @fn  void InterestManager::BeginWalk();
+         *
+         * @brief   Starts a walk over the subscriptions returned by GetSubscriptions. Until the
+         *          matching EndWalk, removals only clear the listener of a subscription, so the
+         *          returned vectors and subscriptions stay valid. Walks can be nested.
+         */
+        void BeginWalk();
+
+        /**
+         * @fn  void InterestManager::EndWalk();
+         *
+         * @brief   Ends a walk, and applies the removals made during it once the last walk ends.
+         */
+        void EndWalk();
+
+    private:
+
+        /**
+         * @fn  void InterestManager::EraseSubscription(const trBase::UniqueId& listenerId);
+         *
+         * @brief   Erases a subscription, and removes it from all the areas lookup tables.
+         */
+        void EraseSubscription(const trBase::UniqueId& listenerId);
+
+        /**
+         * @fn  void InterestManager::RemoveFromAreas(const trBase::UniqueId& id);
+         *
+         * @brief   Removes an entity from all the areas it is in.
+         */
+        void RemoveFromAreas(const trBase::UniqueId& id);
+
+        /**
+         * @fn  void InterestManager::AddMember(const trBase::UniqueId& id, Subscription& subscription);
+         *
+         * @brief   Records that an entity entered an area.
+         */
+        void AddMember(const trBase::UniqueId& id, Subscription& subscription);
+
+        /**
+         * @fn  void InterestManager::RemoveMember(const trBase::UniqueId& id, Subscription& subscription);
+         *
+         * @brief   Records that an entity left an area.
+         */
+        void RemoveMember(const trBase::UniqueId& id, Subscription& subscription);
+
+        using SubscriptionMap = trUtil::HashMap<const trBase::UniqueId, Subscription>;                       //<listener ID, subscription>
+        using MemberMap = trUtil::HashMap<const trBase::UniqueId, std::vector<Subscription*>>;        //<entity ID, areas it is in>
+        SubscriptionMap mSubscriptionMap;
+        MemberMap mMemberMap;
+
+        std::vector<trBase::UniqueId> mQueryResults;        //Reused buffer for the area queries
+
+        unsigned int mWalkDepth = 0;                        //Number of walks in progress
+        std::vector<trBase::UniqueId> mRemovedListeners;    //Subscriptions removed during a walk
+        std::vector<trBase::UniqueId> mRemovedEntities;     //Entities removed from the areas during a walk
+    };
+}
\ No newline at end of file
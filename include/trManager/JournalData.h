@@ -0,0 +1,201 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <type_traits>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   JournalData
+     *
+     * @brief   A flat binary buffer used by the message journal. Messages write their payload into it
+     *          when they are recorded, and read it back when they are recreated during a replay.
+     *          Values are stored in the native byte order, so journals are meant to be replayed on
+     *          the same platform they were recorded on.
+     */
+    class TR_MANAGER_EXPORT JournalData
+    {
+    public:
+
+        /**
+         * @fn  JournalData::JournalData();
+         *
+         * @brief   Creates an empty buffer for writing.
+         */
+        JournalData();
+
+        /**
+         * @fn  JournalData::JournalData(const char* data, size_t size);
+         *
+         * @brief   Creates a read only view of existing data. The data is not copied, and has to
+         *          outlive this object.
+         *
+         * @param   data    The data.
+         * @param   size    The size of the data in bytes.
+         */
+        JournalData(const char* data, size_t size);
+
+        /**
+         * @fn  JournalData::~JournalData();
+         *
+         * @brief   Destructor.
+         */
+        ~JournalData();
+
+        /**
+         * @fn  void JournalData::Write(const void* data, size_t size);
+         *
+         * @brief   Appends raw bytes to the buffer.
+         *
+         * @param   data    The data.
+         * @param   size    The size in bytes.
+         */
+        void Write(const void* data, size_t size);
+
+        /**
+         * @fn  template<typename T> void JournalData::Write(const T& value)
+         *
+         * @brief   Appends a trivially copyable value to the buffer.
+         *
+         * @param   value   The value.
+         */
+        template<typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+            Write(&value, sizeof(T));
+        }
+
+        /**
+         * @fn  void JournalData::WriteString(const std::string& value);
+         *
+         * @brief   Appends a length prefixed string to the buffer.
+         *
+         * @param   value   The value.
+         */
+        void WriteString(const std::string& value);
+
+        /**
+         * @fn  bool JournalData::Read(void* data, size_t size);
+         *
+         * @brief   Reads raw bytes from the current read position.
+         *
+         * @param [out] data    The destination.
+         * @param       size    The size in bytes.
+         *
+         * @return  False if there is not enough data left.
+         */
+        bool Read(void* data, size_t size);
+
+        /**
+         * @fn  template<typename T> bool JournalData::Read(T& value)
+         *
+         * @brief   Reads a trivially copyable value from the current read position.
+         *
+         * @param [out] value   The value.
+         *
+         * @return  False if there is not enough data left.
+         */
+        template<typename T>
+        bool Read(T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly");
+            return Read(&value, sizeof(T));
+        }
+
+        /**
+         * @fn  bool JournalData::ReadString(std::string& value);
+         *
+         * @brief   Reads a length prefixed string from the current read position.
+         *
+         * @param [out] value   The value.
+         *
+         * @return  False if there is not enough data left.
+         */
+        bool ReadString(std::string& value);
+
+        /**
+         * @fn  void JournalData::SetReadPosition(size_t position);
+         *
+         * @brief   Moves the read position. Positions past the end are clamped to the end.
+         *
+         * @param   position    The position in bytes from the start of the data.
+         */
+        void SetReadPosition(size_t position);
+
+        /**
+         * @fn  size_t JournalData::GetReadPosition() const;
+         *
+         * @brief   Returns the current read position.
+         *
+         * @return  The read position in bytes from the start of the data.
+         */
+        size_t GetReadPosition() const;
+
+        /**
+         * @fn  const char* JournalData::GetData() const;
+         *
+         * @brief   Returns the start of the data.
+         *
+         * @return  The data.
+         */
+        const char* GetData() const;
+
+        /**
+         * @fn  size_t JournalData::GetSize() const;
+         *
+         * @brief   Returns the size of the data in bytes.
+         *
+         * @return  The size.
+         */
+        size_t GetSize() const;
+
+        /**
+         * @fn  size_t JournalData::GetRemaining() const;
+         *
+         * @brief   Returns the number of bytes left to read.
+         *
+         * @return  The remaining byte count.
+         */
+        size_t GetRemaining() const;
+
+        /**
+         * @fn  void JournalData::Clear();
+         *
+         * @brief   Clears the written data and resets the read position. Keeps the allocated memory.
+         */
+        void Clear();
+
+    private:
+
+        std::vector<char> mBuffer;
+        const char* mReadData = nullptr;
+        size_t mReadSize = 0;
+        size_t mReadPos = 0;
+    };
+}
\ No newline at end of file
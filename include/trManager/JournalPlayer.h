@@ -0,0 +1,268 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/JournalData.h>
+#include <trManager/MessageBase.h>
+#include <trManager/SystemManager.h>
+#include <trManager/TimingStructure.h>
+#include <trUtil/HashMap.h>
+#include <trBase/UniqueId.h>
+#include <trBase/SmrtPtr.h>
+
+#include <functional>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   JournalPlayer
+     *
+     * @brief   Replays a message journal written by the JournalRecorder into a System Manager. The
+     *          journal is memory mapped and indexed when it is opened, so any frame can be sought to
+     *          directly. Each played frame re-injects the recorded messages through
+     *          SystemManager::ProcessMessage in their recorded order, with the recorded timing, as
+     *          fast as the receiving entities can handle them.
+     *          
+     *          Messages are recreated by creators registered per message type. The Tick message is
+     *          registered by default. Messages of unregistered types are skipped and counted.
+     *          Messages the replay world sends while a frame plays are dropped, since the journal
+     *          already holds what its entities sent in reaction to the recorded messages.
+     */
+    class TR_MANAGER_EXPORT JournalPlayer
+    {
+    public:
+
+        /**
+         * @struct  MessageInfo
+         *
+         * @brief   The recorded message header, passed to the message creators. All pointers stay
+         *          valid while the journal is open.
+         */
+        struct MessageInfo
+        {
+            const trBase::UniqueId* fromActorID = nullptr;
+            const trBase::UniqueId* aboutActorID = nullptr;
+            bool isDirect = false;
+            const std::string* messageFilter = nullptr;
+            const trManager::TimingStructure* timeStruct = nullptr;     //Timing of the frame being played
+            trManager::JournalData* data = nullptr;                     //Payload written by MessageBase::WriteJournalData
+        };
+
+        /** @brief   Recreates a recorded message of a registered type. Returns null if the payload is invalid. */
+        using MessageCreator = std::function<trBase::SmrtPtr<trManager::MessageBase>(const MessageInfo& info)>;
+
+        /**
+         * @fn  JournalPlayer::JournalPlayer(trManager::SystemManager& sysMan);
+         *
+         * @brief   Constructor.
+         *
+         * @param [in,out]  sysMan  The System Manager to replay the journal into.
+         */
+        JournalPlayer(trManager::SystemManager& sysMan);
+
+        /**
+         * @fn  JournalPlayer::~JournalPlayer();
+         *
+         * @brief   Destructor. Closes the journal.
+         */
+        ~JournalPlayer();
+
+        /**
+         * @fn  void JournalPlayer::RegisterMessageType(const std::string& type, MessageCreator creator);
+         *
+         * @brief   Registers a creator for a message type, so it can be replayed.
+         *
+         * @param   type    The message type.
+         * @param   creator The creator.
+         */
+        void RegisterMessageType(const std::string& type, MessageCreator creator);
+
+        /**
+         * @fn  bool JournalPlayer::Open(const std::string& fileName);
+         *
+         * @brief   Memory maps and indexes a journal file. A journal that was cut short, for example
+         *          by a crash, is played up to its last complete record.
+         *
+         * @param   fileName    The journal file name and path.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        bool Open(const std::string& fileName);
+
+        /**
+         * @fn  void JournalPlayer::Close();
+         *
+         * @brief   Closes the journal.
+         */
+        void Close();
+
+        /**
+         * @fn  bool JournalPlayer::IsOpen() const;
+         *
+         * @brief   Returns true if a journal is open.
+         *
+         * @return  True if open, false if not.
+         */
+        bool IsOpen() const;
+
+        /**
+         * @fn  unsigned int JournalPlayer::GetFrameCount() const;
+         *
+         * @brief   Returns the number of frames in the journal.
+         *
+         * @return  The frame count.
+         */
+        unsigned int GetFrameCount() const;
+
+        /**
+         * @fn  unsigned int JournalPlayer::GetCurrentFrame() const;
+         *
+         * @brief   Returns the index of the next frame to be played.
+         *
+         * @return  The current frame index.
+         */
+        unsigned int GetCurrentFrame() const;
+
+        /**
+         * @fn  bool JournalPlayer::Seek(unsigned int frameIndex);
+         *
+         * @brief   Moves the playback to the given frame index. Only moves the journal, the state of
+         *          the entities in the replay world is not rewound.
+         *
+         * @param   frameIndex  Zero-based index of the frame.
+         *
+         * @return  False if the index is out of range.
+         */
+        bool Seek(unsigned int frameIndex);
+
+        /**
+         * @fn  bool JournalPlayer::PlayFrame();
+         *
+         * @brief   Plays the current frame, and moves to the next one. Messages sent by the replay
+         *          world during the frame are dropped, the ones queued before it are flushed at its
+         *          end.
+         *
+         * @return  False if there are no more frames to play.
+         */
+        bool PlayFrame();
+
+        /**
+         * @fn  unsigned int JournalPlayer::PlayAll();
+         *
+         * @brief   Plays all the remaining frames.
+         *
+         * @return  The number of played frames.
+         */
+        unsigned int PlayAll();
+
+        /**
+         * @fn  const trManager::TimingStructure& JournalPlayer::GetTimeStructure() const;
+         *
+         * @brief   Returns the timing of the last played frame.
+         *
+         * @return  The time structure.
+         */
+        const trManager::TimingStructure& GetTimeStructure() const;
+
+        /**
+         * @fn  unsigned long long JournalPlayer::GetPlayedMessageCount() const;
+         *
+         * @brief   Returns the number of messages re-injected since the journal was opened.
+         *
+         * @return  The played message count.
+         */
+        unsigned long long GetPlayedMessageCount() const;
+
+        /**
+         * @fn  unsigned long long JournalPlayer::GetSkippedMessageCount() const;
+         *
+         * @brief   Returns the number of messages skipped since the journal was opened, because their
+         *          type had no registered creator, or their payload could not be read.
+         *
+         * @return  The skipped message count.
+         */
+        unsigned long long GetSkippedMessageCount() const;
+
+    private:
+
+        /**
+         * @fn  bool JournalPlayer::MapFile(const std::string& fileName);
+         *
+         * @brief   Memory maps the file for reading.
+         */
+        bool MapFile(const std::string& fileName);
+
+        /**
+         * @fn  void JournalPlayer::UnmapFile();
+         *
+         * @brief   Releases the file mapping.
+         */
+        void UnmapFile();
+
+        /**
+         * @fn  bool JournalPlayer::BuildIndex();
+         *
+         * @brief   Reads the string and ID tables, and the frame offsets from the whole journal.
+         */
+        bool BuildIndex();
+
+        /**
+         * @fn  void JournalPlayer::ResolveCreators();
+         *
+         * @brief   Matches the journals message types to the registered creators.
+         */
+        void ResolveCreators();
+
+        //Location and timing of a recorded frame
+        struct FrameEntry
+        {
+            size_t offset = 0;                      //Offset of the first record after the frame record
+            size_t end = 0;                         //Offset of the next frame record
+            trManager::TimingStructure timeStruct;
+        };
+
+        trBase::SmrtPtr<trManager::SystemManager> mSysMan;
+        trUtil::HashMap<std::string, MessageCreator> mCreatorMap;
+
+        //The memory mapped journal
+        const char* mMapData = nullptr;
+        size_t mMapSize = 0;
+        void* mFileHandle = nullptr;
+        void* mMapHandle = nullptr;
+
+        //Journal tables and index
+        std::vector<std::string> mStrings;
+        std::vector<const MessageCreator*> mStringCreators;             //Creator for each string used as a message type
+        std::vector<trBase::SmrtPtr<trBase::UniqueId>> mIds;
+        std::vector<FrameEntry> mFrames;
+
+        unsigned int mCurrentFrame = 0;
+        trManager::TimingStructure mTimeStruct;
+        unsigned long long mPlayedMessageCount = 0;
+        unsigned long long mSkippedMessageCount = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/DirectorBase.h>
+#include <trManager/JournalData.h>
+#include <trManager/MessageBase.h>
+#include <trManager/TimingStructure.h>
+#include <trUtil/HashMap.h>
+#include <trUtil/RefStr.h>
+#include <trBase/ObsrvrPtr.h>
+#include <trBase/UniqueId.h>
+
+#include <fstream>
+#include <string>
+#include <map>
+
+namespace trManager
+{
+    class SystemManager;
+
+    /**
+     * @class   JournalRecorder
+     *
+     * @brief   A Director that records every message processed by its System Manager into a compact
+     *          binary journal, which can later be replayed with the JournalPlayer. 
+     *          
+     *          The journal starts with FILE_ID and FILE_VERSION, followed by a stream of records, each
+     *          starting with a one byte RecordType. Message types, filters and entity IDs are written
+     *          once as STRING_RECORD or ID_RECORD, and referenced by their index afterwards. A
+     *          FRAME_RECORD with the frames TimingStructure is written before the first message of
+     *          every frame. A MESSAGE_RECORD holds the message header and the payload written by
+     *          MessageBase::WriteJournalData.
+     */
+    class TR_MANAGER_EXPORT JournalRecorder : public trManager::DirectorBase
+    {
+    public:
+        using BaseClass = trManager::DirectorBase;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static std::string FILE_ID;                   /// Identifies the file as a message journal
+        const static unsigned int FILE_VERSION;             /// Version of the journal format
+        const static unsigned int NULL_INDEX;               /// Index used for a missing ID
+
+        /** @brief   The journal record types. */
+        enum RecordType : char
+        {
+            STRING_RECORD = 'S',
+            ID_RECORD = 'I',
+            FRAME_RECORD = 'F',
+            MESSAGE_RECORD = 'M'
+        };
+
+        /**
+         * @fn  JournalRecorder::JournalRecorder(const std::string& name = CLASS_TYPE);
+         *
+         * @brief   Constructor.
+         *
+         * @param   name    (Optional) The name.
+         */
+        JournalRecorder(const std::string& name = CLASS_TYPE);
+
+        /**
+         * @fn  virtual const std::string& JournalRecorder::GetType() const override
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override { return CLASS_TYPE; }
+
+        /**
+         * @fn  virtual void JournalRecorder::OnAddedToSysMan() override;
+         *
+         * @brief   Attaches the recorder to the System Manager it was registered with.
+         */
+        virtual void OnAddedToSysMan() override;
+
+        /**
+         * @fn  virtual void JournalRecorder::OnRemovedFromSysMan() override;
+         *
+         * @brief   Detaches the recorder from its System Manager, and flushes the journal.
+         */
+        virtual void OnRemovedFromSysMan() override;
+
+        /**
+         * @fn  bool JournalRecorder::Open(const std::string& fileName);
+         *
+         * @brief   Creates a new journal file and starts recording into it. A previously opened
+         *          journal is closed first.
+         *
+         * @param   fileName    The journal file name and path.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        bool Open(const std::string& fileName);
+
+        /**
+         * @fn  void JournalRecorder::Close();
+         *
+         * @brief   Stops recording, and closes the journal file.
+         */
+        void Close();
+
+        /**
+         * @fn  bool JournalRecorder::IsRecording() const;
+         *
+         * @brief   Returns true if a journal file is open.
+         *
+         * @return  True if recording, false if not.
+         */
+        bool IsRecording() const;
+
+        /**
+         * @fn  void JournalRecorder::Flush();
+         *
+         * @brief   Writes all the buffered records out to the journal file.
+         */
+        void Flush();
+
+        /**
+         * @fn  void JournalRecorder::RecordMessage(const trManager::MessageBase& message);
+         *
+         * @brief   Appends the message to the journal. Called by the System Manager for every
+         *          processed message, and should not be called directly by the user.
+         *
+         * @param   message The message.
+         */
+        void RecordMessage(const trManager::MessageBase& message);
+
+        /**
+         * @fn  unsigned long long JournalRecorder::GetRecordedMessageCount() const;
+         *
+         * @brief   Returns the number of messages recorded into the current journal.
+         *
+         * @return  The recorded message count.
+         */
+        unsigned long long GetRecordedMessageCount() const;
+
+        /**
+         * @fn  unsigned long long JournalRecorder::GetRecordedFrameCount() const;
+         *
+         * @brief   Returns the number of frames recorded into the current journal.
+         *
+         * @return  The recorded frame count.
+         */
+        unsigned long long GetRecordedFrameCount() const;
+
+    protected:
+
+        /**
+         * @fn  JournalRecorder::~JournalRecorder();
+         *
+         * @brief   Destructor. Closes the journal.
+         */
+        ~JournalRecorder();
+
+    private:
+
+        /**
+         * @fn  unsigned int JournalRecorder::InternType(const std::string& type);
+         *
+         * @brief   Returns the string index of a message type, writing a STRING_RECORD the first time
+         *          the type is seen.
+         */
+        unsigned int InternType(const std::string& type);
+
+        /**
+         * @fn  unsigned int JournalRecorder::InternString(const std::string& value);
+         *
+         * @brief   Returns the index of a string, writing a STRING_RECORD the first time it is seen.
+         */
+        unsigned int InternString(const std::string& value);
+
+        /**
+         * @fn  unsigned int JournalRecorder::InternId(const trBase::UniqueId* id);
+         *
+         * @brief   Returns the index of an ID, writing an ID_RECORD the first time it is seen.
+         */
+        unsigned int InternId(const trBase::UniqueId* id);
+
+        /**
+         * @fn  void JournalRecorder::WriteFrame(const trManager::TimingStructure& timeStruct);
+         *
+         * @brief   Writes a FRAME_RECORD.
+         */
+        void WriteFrame(const trManager::TimingStructure& timeStruct);
+
+        std::ofstream mFile;
+        trManager::JournalData mBuffer;                                 //Records waiting to be written to the file
+        trManager::JournalData mPayload;                                //Reused message payload buffer
+        trBase::ObsrvrPtr<trManager::SystemManager> mRecordingSysMan;
+
+        trUtil::HashMap<const std::string*, unsigned int> mTypeIndexMap;    //Fast lookup by the message type RefStr
+        trUtil::HashMap<std::string, unsigned int> mStringIndexMap;
+        std::map<trBase::UniqueId, unsigned int> mIdIndexMap;
+        unsigned int mNextStringIndex = 0;
+        unsigned int mNextIdIndex = 0;
+
+        bool mFrameStarted = false;
+        int mLastFrameNumber = 0;
+        unsigned long long mRecordedMessageCount = 0;
+        unsigned long long mRecordedFrameCount = 0;
+    };
+}
\ No newline at end of file
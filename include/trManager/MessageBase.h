@@ -23,6 +23,8 @@
 
 #include <trManager/Export.h>
 
+#include <trManager/MessagePriority.h>
+#include <trManager/JournalData.h>
 #include <trUtil/StringUtils.h>
 #include <trUtil/RefStr.h>
 #include <trBase/ObsrvrPtr.h>
@@ -98,13 +100,34 @@ namespace trManager
         virtual const bool& GetIsDirect() const;
 
         /**
-         * @fn  virtual const std::string& MessageBase::GetMessageFilter();
+         * @fn  virtual const std::string& MessageBase::GetMessageFilter() const;
          *
          * @brief   Returns the custom Filter string.
          *
          * @return  The message filter.
          */
-        virtual const std::string& GetMessageFilter();
+        virtual const std::string& GetMessageFilter() const;
+
+        /**
+         * @fn  virtual const trManager::MessagePriority& MessageBase::GetMessagePriority() const;
+         *
+         * @brief   Returns the priority class of the message. Queued messages with a higher priority
+         *          class are delivered first. Override to change the default of NORMAL.
+         *
+         * @return  The message priority.
+         */
+        virtual const trManager::MessagePriority& GetMessagePriority() const;
+
+        /**
+         * @fn  virtual void MessageBase::WriteJournalData(trManager::JournalData& data) const;
+         *
+         * @brief   Writes the message specific data into the message journal. Override in messages
+         *          that carry data, and read it back in the creator registered with the JournalPlayer.
+         *          The header of the message is recorded automatically.
+         *
+         * @param [in,out]  data    The journal data to write to.
+         */
+        virtual void WriteJournalData(trManager::JournalData& data) const;
 
     protected:
 
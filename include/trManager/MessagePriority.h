@@ -0,0 +1,66 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trUtil/EnumerationNumeric.h>
+
+#include <string>
+
+namespace trManager
+{
+    /**
+     * @class   MessagePriority
+     *
+     * @brief   Sets the priority class of a message. The System Manager always delivers queued
+     *          messages of a higher priority class before the ones with the lower. Messages of the
+     *          SYSTEM class are never deferred by a message time budget.
+     */
+    class TR_MANAGER_EXPORT MessagePriority : public trUtil::EnumerationNumeric
+    {
+        DECLARE_ENUM(MessagePriority)
+    public:
+
+        /**
+         * @brief   System and control messages. These are delivered first, and are always delivered in
+         *          the frame they were sent in, regardless of the message time budget.
+         */
+        static MessagePriority SYSTEM;
+
+        /** @brief   High priority.  Messages of this class are delivered after SYSTEM, but before any others. */
+        static MessagePriority HIGH;
+
+        /** @brief   Normal priority.  The default priority class for all messages. */
+        static MessagePriority NORMAL;
+
+        /** @brief   Low priority.  Messages of this class are delivered after all others. */
+        static MessagePriority LOW;
+
+    protected:
+        /**
+        * ctor
+        * Protected to prevent creation of an instance.
+        */
+        MessagePriority(const std::string& name, unsigned int id);
+    };
+}
\ No newline at end of file
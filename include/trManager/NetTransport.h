@@ -0,0 +1,199 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trBase/SmrtClass.h>
+#include <trUtil/RefStr.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   NetTransport
+     *
+     * @brief   Base class for the packet transports used by the NetworkDirector. A transport binds to
+     *          a local port, connects to any number of peers, and moves whole packets. Send is called
+     *          from the main thread, while Receive is called from the directors IO thread, so
+     *          implementations have to allow both at the same time.
+     */
+    class TR_MANAGER_EXPORT NetTransport : public trBase::SmrtClass
+    {
+    public:
+
+        using BaseClass = trBase::SmrtClass;                /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        /**
+         * @fn  NetTransport::NetTransport();
+         *
+         * @brief   Default constructor. Initializes the socket library on platforms that need it.
+         */
+        NetTransport();
+
+        /**
+         * @fn  virtual const std::string& NetTransport::GetType() const override;
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override;
+
+        /**
+         * @fn  virtual bool NetTransport::Listen(unsigned short port) = 0;
+         *
+         * @brief   Binds the transport to a local port, and starts accepting packets from peers.
+         *
+         * @param   port    The local port. 0 picks a free port.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Listen(unsigned short port) = 0;
+
+        /**
+         * @fn  virtual bool NetTransport::Connect(const std::string& host, unsigned short port) = 0;
+         *
+         * @brief   Adds a remote peer that all packets are sent to.
+         *
+         * @param   host    The host name or address.
+         * @param   port    The port.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Connect(const std::string& host, unsigned short port) = 0;
+
+        /**
+         * @fn  virtual bool NetTransport::Send(const char* data, size_t size) = 0;
+         *
+         * @brief   Sends a packet to all peers.
+         *
+         * @param   data    The packet data.
+         * @param   size    The packet size in bytes.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Send(const char* data, size_t size) = 0;
+
+        /**
+         * @fn  virtual bool NetTransport::Receive(std::vector<char>& packet, unsigned int timeoutMs) = 0;
+         *
+         * @brief   Waits for the next packet from any peer.
+         *
+         * @param [out] packet      The received packet.
+         * @param       timeoutMs   The longest time to wait, in milliseconds.
+         *
+         * @return  False if no packet arrived in time.
+         */
+        virtual bool Receive(std::vector<char>& packet, unsigned int timeoutMs) = 0;
+
+        /**
+         * @fn  virtual void NetTransport::Close() = 0;
+         *
+         * @brief   Closes all the sockets of the transport.
+         */
+        virtual void Close() = 0;
+
+        /**
+         * @fn  virtual size_t NetTransport::GetMaxPacketSize() const = 0;
+         *
+         * @brief   Returns the largest packet the transport can send.
+         *
+         * @return  The maximum packet size in bytes.
+         */
+        virtual size_t GetMaxPacketSize() const = 0;
+
+        /**
+         * @fn  virtual unsigned short NetTransport::GetLocalPort() const = 0;
+         *
+         * @brief   Returns the port the transport is bound to.
+         *
+         * @return  The local port, or 0 if it is not bound.
+         */
+        virtual unsigned short GetLocalPort() const = 0;
+
+    protected:
+
+        using SocketHandle = std::intptr_t;                 /// Platform independent socket handle
+
+        const static SocketHandle INVALID_SOCKET_HANDLE;    /// Value of a socket handle that is not open
+
+        /**
+         * @fn  NetTransport::~NetTransport();
+         *
+         * @brief   Destructor.
+         */
+        ~NetTransport();
+
+        /**
+         * @fn  static void NetTransport::CloseSocket(SocketHandle& socket);
+         *
+         * @brief   Closes a socket, and resets the handle.
+         *
+         * @param [in,out]  socket  The socket.
+         */
+        static void CloseSocket(SocketHandle& socket);
+
+        /**
+         * @fn  static bool NetTransport::WaitForRead(const std::vector<SocketHandle>& sockets, unsigned int timeoutMs, std::vector<SocketHandle>& readySockets);
+         *
+         * @brief   Waits until at least one of the sockets has data to read.
+         *
+         * @param           sockets         The sockets to wait on.
+         * @param           timeoutMs       The longest time to wait, in milliseconds.
+         * @param [out]     readySockets    The sockets that can be read.
+         *
+         * @return  False if no socket became readable in time.
+         */
+        static bool WaitForRead(const std::vector<SocketHandle>& sockets, unsigned int timeoutMs, std::vector<SocketHandle>& readySockets);
+
+        /**
+         * @fn  static bool NetTransport::ResolveAddress(const std::string& host, unsigned short port, std::vector<char>& address);
+         *
+         * @brief   Resolves a host name and port into an IPv4 socket address.
+         *
+         * @param           host    The host name or address.
+         * @param           port    The port.
+         * @param [out]     address The raw sockaddr_in.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        static bool ResolveAddress(const std::string& host, unsigned short port, std::vector<char>& address);
+
+        /**
+         * @fn  static unsigned short NetTransport::GetSocketPort(SocketHandle socket);
+         *
+         * @brief   Returns the local port a socket is bound to.
+         *
+         * @param   socket  The socket.
+         *
+         * @return  The port, or 0 if it is not bound.
+         */
+        static unsigned short GetSocketPort(SocketHandle socket);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/NetTransport.h>
+#include <trUtil/RefStr.h>
+
+#include <mutex>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   NetTransportTcp
+     *
+     * @brief   Reliable TCP transport. Packets are framed with a length prefix on the stream, and sent
+     *          to every connection. A listening transport accepts any number of incoming connections,
+     *          and can also connect out to other peers.
+     */
+    class TR_MANAGER_EXPORT NetTransportTcp : public trManager::NetTransport
+    {
+    public:
+
+        using BaseClass = trManager::NetTransport;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static size_t DEFAULT_MAX_PACKET_SIZE;        /// Default packet size limit
+
+        /**
+         * @fn  NetTransportTcp::NetTransportTcp();
+         *
+         * @brief   Default constructor.
+         */
+        NetTransportTcp();
+
+        /**
+         * @fn  virtual const std::string& NetTransportTcp::GetType() const override;
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override;
+
+        /**
+         * @fn  virtual bool NetTransportTcp::Listen(unsigned short port) override;
+         *
+         * @brief   Starts accepting connections on a local port.
+         *
+         * @param   port    The local port. 0 picks a free port.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Listen(unsigned short port) override;
+
+        /**
+         * @fn  virtual bool NetTransportTcp::Connect(const std::string& host, unsigned short port) override;
+         *
+         * @brief   Opens a connection to a listening peer.
+         *
+         * @param   host    The host name or address.
+         * @param   port    The port.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Connect(const std::string& host, unsigned short port) override;
+
+        /**
+         * @fn  virtual bool NetTransportTcp::Send(const char* data, size_t size) override;
+         *
+         * @brief   Sends a packet on every connection. Sockets do not block, so data a connection
+         *          cannot take yet is buffered and sent on later calls to Send and Receive.
+         *          Connections that fail, or fall too far behind, are closed by the next Receive.
+         *
+         * @param   data    The packet data.
+         * @param   size    The packet size in bytes.
+         *
+         * @return  False if there is no connection, or a connection failed.
+         */
+        virtual bool Send(const char* data, size_t size) override;
+
+        /**
+         * @fn  virtual bool NetTransportTcp::Receive(std::vector<char>& packet, unsigned int timeoutMs) override;
+         *
+         * @brief   Waits for the next complete packet from any connection, accepting new connections
+         *          on the way.
+         *
+         * @param [out] packet      The received packet.
+         * @param       timeoutMs   The longest time to wait, in milliseconds.
+         *
+         * @return  False if no packet arrived in time.
+         */
+        virtual bool Receive(std::vector<char>& packet, unsigned int timeoutMs) override;
+
+        /**
+         * @fn  virtual void NetTransportTcp::Close() override;
+         *
+         * @brief   Closes the listening socket and all connections.
+         */
+        virtual void Close() override;
+
+        /**
+         * @fn  virtual size_t NetTransportTcp::GetMaxPacketSize() const override;
+         *
+         * @brief   Returns the largest packet that will be sent or accepted.
+         *
+         * @return  The maximum packet size in bytes.
+         */
+        virtual size_t GetMaxPacketSize() const override;
+
+        /**
+         * @fn  virtual unsigned short NetTransportTcp::GetLocalPort() const override;
+         *
+         * @brief   Returns the port the transport listens on.
+         *
+         * @return  The local port, or 0 if it is not listening.
+         */
+        virtual unsigned short GetLocalPort() const override;
+
+        /**
+         * @fn  size_t NetTransportTcp::GetConnectionCount() const;
+         *
+         * @brief   Returns the number of open connections.
+         *
+         * @return  The connection count.
+         */
+        size_t GetConnectionCount() const;
+
+    protected:
+
+        /**
+         * @fn  NetTransportTcp::~NetTransportTcp();
+         *
+         * @brief   Destructor. Closes all sockets.
+         */
+        ~NetTransportTcp();
+
+    private:
+
+        //An open connection, the part of the stream that is not a complete packet yet, and the data
+        //that is waiting to be sent. A failed connection is only marked, Receive may be waiting on its socket.
+        struct Connection
+        {
+            SocketHandle socket = INVALID_SOCKET_HANDLE;
+            std::vector<char> buffer;
+            std::vector<char> sendBuffer;
+            bool isFailed = false;
+        };
+
+        /**
+         * @fn  void NetTransportTcp::AddConnection(SocketHandle socket);
+         *
+         * @brief   Sets up and stores a new connection.
+         */
+        void AddConnection(SocketHandle socket);
+
+        /**
+         * @fn  static bool NetTransportTcp::SetNonBlocking(SocketHandle socket);
+         *
+         * @brief   Makes send and receive calls on a socket return right away.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        static bool SetNonBlocking(SocketHandle socket);
+
+        /**
+         * @fn  bool NetTransportTcp::ReadConnection(Connection& connection);
+         *
+         * @brief   Reads the available data of a connection, and queues its complete packets.
+         *
+         * @return  False if the connection was closed or failed.
+         */
+        bool ReadConnection(Connection& connection);
+
+        /**
+         * @fn  bool NetTransportTcp::FlushConnection(Connection& connection);
+         *
+         * @brief   Sends as much of the buffered data of a connection as the socket takes without
+         *          blocking.
+         *
+         * @return  False if the connection failed.
+         */
+        bool FlushConnection(Connection& connection);
+
+        /**
+         * @fn  bool NetTransportTcp::FlushConnections();
+         *
+         * @brief   Sends the buffered data of all the connections, and marks the ones that failed.
+         *          The connection lock has to be held.
+         *
+         * @return  False if a connection failed.
+         */
+        bool FlushConnections();
+
+        /**
+         * @fn  void NetTransportTcp::CloseFailedConnections();
+         *
+         * @brief   Closes and removes the connections that failed. Only called by Receive, so no
+         *          socket is closed while Receive waits on it. The connection lock has to be held.
+         */
+        void CloseFailedConnections();
+
+        SocketHandle mListenSocket = INVALID_SOCKET_HANDLE;
+
+        mutable std::mutex mConnectionLock;
+        std::vector<Connection> mConnections;
+        std::deque<std::vector<char>> mReceivedPackets;     //Complete packets waiting to be returned by Receive
+        std::vector<char> mReadBuffer;
+    };
+}
\ No newline at end of file
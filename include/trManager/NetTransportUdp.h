@@ -0,0 +1,184 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/NetTransport.h>
+#include <trUtil/RefStr.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   NetTransportUdp
+     *
+     * @brief   Unreliable UDP transport. Each packet is sent as a single datagram to every peer.
+     *          Senders that are not known peers yet are added when their first packet arrives, so a
+     *          listening side can answer its clients without connecting to them.
+     */
+    class TR_MANAGER_EXPORT NetTransportUdp : public trManager::NetTransport
+    {
+    public:
+
+        using BaseClass = trManager::NetTransport;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static size_t DEFAULT_MAX_PACKET_SIZE;        /// Default datagram size limit, safely below the usual MTU
+
+        /**
+         * @fn  NetTransportUdp::NetTransportUdp();
+         *
+         * @brief   Default constructor.
+         */
+        NetTransportUdp();
+
+        /**
+         * @fn  virtual const std::string& NetTransportUdp::GetType() const override;
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override;
+
+        /**
+         * @fn  virtual bool NetTransportUdp::Listen(unsigned short port) override;
+         *
+         * @brief   Binds the UDP socket to a local port.
+         *
+         * @param   port    The local port. 0 picks a free port.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Listen(unsigned short port) override;
+
+        /**
+         * @fn  virtual bool NetTransportUdp::Connect(const std::string& host, unsigned short port) override;
+         *
+         * @brief   Adds a peer. Binds the socket to a free port first, if Listen was not called.
+         *
+         * @param   host    The host name or address.
+         * @param   port    The port.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Connect(const std::string& host, unsigned short port) override;
+
+        /**
+         * @fn  virtual bool NetTransportUdp::Send(const char* data, size_t size) override;
+         *
+         * @brief   Sends a datagram to all peers.
+         *
+         * @param   data    The packet data.
+         * @param   size    The packet size in bytes.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        virtual bool Send(const char* data, size_t size) override;
+
+        /**
+         * @fn  virtual bool NetTransportUdp::Receive(std::vector<char>& packet, unsigned int timeoutMs) override;
+         *
+         * @brief   Waits for the next datagram.
+         *
+         * @param [out] packet      The received packet.
+         * @param       timeoutMs   The longest time to wait, in milliseconds.
+         *
+         * @return  False if no packet arrived in time.
+         */
+        virtual bool Receive(std::vector<char>& packet, unsigned int timeoutMs) override;
+
+        /**
+         * @fn  virtual void NetTransportUdp::Close() override;
+         *
+         * @brief   Closes the socket and forgets all peers.
+         */
+        virtual void Close() override;
+
+        /**
+         * @fn  virtual size_t NetTransportUdp::GetMaxPacketSize() const override;
+         *
+         * @brief   Returns the largest datagram that will be sent.
+         *
+         * @return  The maximum packet size in bytes.
+         */
+        virtual size_t GetMaxPacketSize() const override;
+
+        /**
+         * @fn  void NetTransportUdp::SetMaxPacketSize(size_t size);
+         *
+         * @brief   Sets the largest datagram that will be sent. Raise it only on networks that are known
+         *          to carry larger datagrams without fragmentation.
+         *
+         * @param   size    The maximum packet size in bytes.
+         */
+        void SetMaxPacketSize(size_t size);
+
+        /**
+         * @fn  virtual unsigned short NetTransportUdp::GetLocalPort() const override;
+         *
+         * @brief   Returns the port the transport is bound to.
+         *
+         * @return  The local port, or 0 if it is not bound.
+         */
+        virtual unsigned short GetLocalPort() const override;
+
+        /**
+         * @fn  size_t NetTransportUdp::GetPeerCount() const;
+         *
+         * @brief   Returns the number of known peers.
+         *
+         * @return  The peer count.
+         */
+        size_t GetPeerCount() const;
+
+    protected:
+
+        /**
+         * @fn  NetTransportUdp::~NetTransportUdp();
+         *
+         * @brief   Destructor. Closes the socket.
+         */
+        ~NetTransportUdp();
+
+    private:
+
+        /**
+         * @fn  void NetTransportUdp::AddPeer(const std::vector<char>& address);
+         *
+         * @brief   Adds a peer address, if it is not known yet.
+         */
+        void AddPeer(const std::vector<char>& address);
+
+        SocketHandle mSocket = INVALID_SOCKET_HANDLE;
+        size_t mMaxPacketSize = DEFAULT_MAX_PACKET_SIZE;
+
+        mutable std::mutex mPeerLock;
+        std::vector<std::vector<char>> mPeers;              //Raw peer socket addresses
+        std::vector<char> mReceiveBuffer;
+    };
+}
\ No newline at end of file
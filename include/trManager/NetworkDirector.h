@@ -0,0 +1,357 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/DirectorBase.h>
+#include <trManager/JournalData.h>
+#include <trManager/JournalPlayer.h>
+#include <trManager/MessageBase.h>
+#include <trManager/NetTransport.h>
+#include <trUtil/RingBuffer.h>
+#include <trUtil/HashMap.h>
+#include <trUtil/RefStr.h>
+#include <trBase/ObsrvrPtr.h>
+#include <trBase/UniqueId.h>
+#include <trBase/SmrtPtr.h>
+
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace trManager
+{
+    class SystemManager;
+
+    /**
+     * @class   NetworkDirector
+     *
+     * @brief   A Director that sends the messages passed to SystemManager::SendNetworkMessage to remote
+     *          worlds, and delivers the messages it receives from them into its own world. 
+     *          
+     *          Only registered message types are sent. Each type is identified on the wire by a hash of
+     *          its name, so both sides have to register the same types. Unreliable types are batched
+     *          into datagrams on the unreliable transport (UDP), reliable types go out on the reliable
+     *          transport (TCP). The batches are sent, and received messages are delivered, on every
+     *          Tick. A background IO thread receives the packets, and hands them to the main thread
+     *          through a lock-free queue.
+     *          
+     *          Packets start with PROTOCOL_ID and a 16 bit message count. Each message is written as a
+     *          32 bit type hash, a flags byte, the raw from and about IDs if present, a 16 bit payload
+     *          size, and the payload from MessageBase::WriteJournalData. Values are in the native byte
+     *          order, so all nodes have to share it. Message filters are not sent.
+     */
+    class TR_MANAGER_EXPORT NetworkDirector : public trManager::DirectorBase
+    {
+    public:
+        using BaseClass = trManager::DirectorBase;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static unsigned int PROTOCOL_ID;              /// Marks the start of every packet
+        const static unsigned int DEFAULT_INBOUND_QUEUE_SIZE;  /// Default number of packets the inbound queue holds
+
+        /** @brief   The recorded message header passed to the message creators. Shared with the JournalPlayer. */
+        using MessageInfo = trManager::JournalPlayer::MessageInfo;
+
+        /** @brief   Recreates a received message of a registered type. Shared with the JournalPlayer. */
+        using MessageCreator = trManager::JournalPlayer::MessageCreator;
+
+        /**
+         * @fn  NetworkDirector::NetworkDirector(const std::string& name = CLASS_TYPE);
+         *
+         * @brief   Constructor.
+         *
+         * @param   name    (Optional) The name.
+         */
+        NetworkDirector(const std::string& name = CLASS_TYPE);
+
+        /**
+         * @fn  virtual const std::string& NetworkDirector::GetType() const override
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override { return CLASS_TYPE; }
+
+        /**
+         * @fn  virtual void NetworkDirector::OnAddedToSysMan() override;
+         *
+         * @brief   Attaches the director to the network messages of its System Manager.
+         */
+        virtual void OnAddedToSysMan() override;
+
+        /**
+         * @fn  virtual void NetworkDirector::OnRemovedFromSysMan() override;
+         *
+         * @brief   Detaches the director from its System Manager, and stops the IO thread.
+         */
+        virtual void OnRemovedFromSysMan() override;
+
+        /**
+         * @fn  virtual void NetworkDirector::OnTick(const trManager::MessageBase& msg) override;
+         *
+         * @brief   Delivers the received messages, and sends out the batched ones.
+         *
+         * @param   msg The Tick message.
+         */
+        virtual void OnTick(const trManager::MessageBase& msg) override;
+
+        /**
+         * @fn  void NetworkDirector::SetUnreliableTransport(trManager::NetTransport* transport);
+         *
+         * @brief   Sets the transport used for unreliable message types. Can only be changed while the
+         *          director is stopped.
+         *
+         * @param [in,out]  transport   The transport, usually a NetTransportUdp.
+         */
+        void SetUnreliableTransport(trManager::NetTransport* transport);
+
+        /**
+         * @fn  void NetworkDirector::SetReliableTransport(trManager::NetTransport* transport);
+         *
+         * @brief   Sets the transport used for reliable message types. Can only be changed while the
+         *          director is stopped.
+         *
+         * @param [in,out]  transport   The transport, usually a NetTransportTcp.
+         */
+        void SetReliableTransport(trManager::NetTransport* transport);
+
+        /**
+         * @fn  void NetworkDirector::RegisterMessageType(const std::string& type, MessageCreator creator, bool isReliable = false);
+         *
+         * @brief   Registers a message type, so it can be sent and received. If only one transport is
+         *          set, all types go through it.
+         *
+         * @param   type        The message type.
+         * @param   creator     Recreates the message on the receiving side.
+         * @param   isReliable  (Optional) True to send the type on the reliable transport.
+         */
+        void RegisterMessageType(const std::string& type, MessageCreator creator, bool isReliable = false);
+
+        /**
+         * @fn  bool NetworkDirector::Start();
+         *
+         * @brief   Starts the IO thread. The transports should be listening or connected.
+         *
+         * @return  False if no transport is set.
+         */
+        bool Start();
+
+        /**
+         * @fn  void NetworkDirector::Stop();
+         *
+         * @brief   Sends the pending batches, and stops the IO thread.
+         */
+        void Stop();
+
+        /**
+         * @fn  bool NetworkDirector::IsRunning() const;
+         *
+         * @brief   Returns true if the IO thread is running.
+         *
+         * @return  True if running, false if not.
+         */
+        bool IsRunning() const;
+
+        /**
+         * @fn  bool NetworkDirector::SendNetworkMessage(const trManager::MessageBase& message);
+         *
+         * @brief   Adds the message to the outgoing batch of its transport. Called by the System
+         *          Manager, and should not be called directly by the user.
+         *
+         * @param   message The message.
+         *
+         * @return  False if the type is not registered, or the message does not fit into a packet.
+         */
+        bool SendNetworkMessage(const trManager::MessageBase& message);
+
+        /**
+         * @fn  void NetworkDirector::Flush();
+         *
+         * @brief   Sends out the outgoing batches right away.
+         */
+        void Flush();
+
+        /**
+         * @fn  void NetworkDirector::ProcessIncoming();
+         *
+         * @brief   Delivers all the received messages into the directors world right away.
+         */
+        void ProcessIncoming();
+
+        /**
+         * @fn  void NetworkDirector::SetInboundQueueSize(size_t size);
+         *
+         * @brief   Sets the number of received packets that can wait for the main thread. Packets that
+         *          arrive while the queue is full are dropped. Can only be changed while the director
+         *          is stopped.
+         *
+         * @param   size    The queue size in packets.
+         */
+        void SetInboundQueueSize(size_t size);
+
+        /**
+         * @fn  unsigned long long NetworkDirector::GetSentMessageCount() const;
+         *
+         * @brief   Returns the number of messages that were sent.
+         *
+         * @return  The sent message count.
+         */
+        unsigned long long GetSentMessageCount() const;
+
+        /**
+         * @fn  unsigned long long NetworkDirector::GetSentPacketCount() const;
+         *
+         * @brief   Returns the number of packets that were sent.
+         *
+         * @return  The sent packet count.
+         */
+        unsigned long long GetSentPacketCount() const;
+
+        /**
+         * @fn  unsigned long long NetworkDirector::GetReceivedMessageCount() const;
+         *
+         * @brief   Returns the number of received messages that were delivered.
+         *
+         * @return  The received message count.
+         */
+        unsigned long long GetReceivedMessageCount() const;
+
+        /**
+         * @fn  unsigned long long NetworkDirector::GetReceivedPacketCount() const;
+         *
+         * @brief   Returns the number of packets that were received.
+         *
+         * @return  The received packet count.
+         */
+        unsigned long long GetReceivedPacketCount() const;
+
+        /**
+         * @fn  unsigned long long NetworkDirector::GetDroppedPacketCount() const;
+         *
+         * @brief   Returns the number of received packets that were dropped, because the inbound queue
+         *          was full or the packet was invalid.
+         *
+         * @return  The dropped packet count.
+         */
+        unsigned long long GetDroppedPacketCount() const;
+
+        /**
+         * @fn  unsigned long long NetworkDirector::GetUnknownMessageCount() const;
+         *
+         * @brief   Returns the number of received messages of unregistered types.
+         *
+         * @return  The unknown message count.
+         */
+        unsigned long long GetUnknownMessageCount() const;
+
+    protected:
+
+        /**
+         * @fn  NetworkDirector::~NetworkDirector();
+         *
+         * @brief   Destructor. Stops the IO thread.
+         */
+        ~NetworkDirector();
+
+    private:
+
+        //A registered message type
+        struct MessageTypeEntry
+        {
+            unsigned int typeHash = 0;
+            bool isReliable = false;
+            MessageCreator creator;
+        };
+
+        //Messages waiting to be sent on a transport
+        struct Batch
+        {
+            trBase::SmrtPtr<trManager::NetTransport> transport;
+            std::vector<char> data;
+            unsigned short messageCount = 0;
+        };
+
+        /**
+         * @fn  static unsigned int NetworkDirector::HashMessageType(const std::string& type);
+         *
+         * @brief   Returns the platform independent wire ID of a message type.
+         */
+        static unsigned int HashMessageType(const std::string& type);
+
+        /**
+         * @fn  void NetworkDirector::FlushBatch(Batch& batch);
+         *
+         * @brief   Sends out a batch, and clears it.
+         */
+        void FlushBatch(Batch& batch);
+
+        /**
+         * @fn  void NetworkDirector::DecodePacket(const std::vector<char>& packet);
+         *
+         * @brief   Recreates the messages of a received packet, and sends them into the world.
+         */
+        void DecodePacket(const std::vector<char>& packet);
+
+        /**
+         * @fn  const trBase::UniqueId* NetworkDirector::GetRemoteId(const unsigned char* bytes);
+         *
+         * @brief   Returns a stored copy of a received ID, so messages can point to it.
+         */
+        const trBase::UniqueId* GetRemoteId(const unsigned char* bytes);
+
+        /**
+         * @fn  void NetworkDirector::IOThreadLoop();
+         *
+         * @brief   Receives packets from the transports until the director is stopped.
+         */
+        void IOThreadLoop();
+
+        trBase::ObsrvrPtr<trManager::SystemManager> mNetworkSysMan;
+
+        trUtil::HashMap<std::string, MessageTypeEntry> mTypeMap;
+        trUtil::HashMap<unsigned int, const MessageTypeEntry*> mTypeHashMap;
+        std::map<trBase::UniqueId, trBase::SmrtPtr<trBase::UniqueId>> mRemoteIds;
+
+        Batch mUnreliableBatch;
+        Batch mReliableBatch;
+        trManager::JournalData mEncodeBuffer;               //Reused buffer for a single encoded message
+        trManager::JournalData mPayload;                    //Reused buffer for a message payload
+
+        //Packets handed from the IO thread to the main thread
+        std::unique_ptr<trUtil::RingBuffer<std::vector<char>>> mInboundQueue;
+        std::thread mIOThread;
+        std::atomic<bool> mIsRunning = { false };
+
+        unsigned long long mSentMessageCount = 0;
+        unsigned long long mSentPacketCount = 0;
+        unsigned long long mReceivedMessageCount = 0;
+        unsigned long long mUnknownMessageCount = 0;
+        std::atomic<unsigned long long> mReceivedPacketCount = { 0 };
+        std::atomic<unsigned long long> mDroppedPacketCount = { 0 };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/JournalData.h>
+#include <trBase/Quat.h>
+#include <trBase/Vec3.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   ReplicatedFields
+     *
+     * @brief   The list of actor member variables that are replicated from a server to its clients.
+     *          Actors add their members in the constructor, and return the list from
+     *          ActorBase::GetReplicatedFields. 
+     *          
+     *          The values are encoded into a snapshot with a fixed layout, using the quantization
+     *          set for each field. Snapshots are delta compressed against a baseline one field at a
+     *          time, so an unchanged field only costs one bit. On a client the received snapshots are
+     *          buffered, and ActorBase::OnTickRemote interpolates between them a short delay behind
+     *          the newest one.
+     */
+    class TR_MANAGER_EXPORT ReplicatedFields
+    {
+    public:
+
+        const static double DEFAULT_INTERPOLATION_DELAY;    /// Default delay behind the newest snapshot in seconds
+        const static unsigned int MAX_BUFFERED_SNAPSHOTS;   /// Number of snapshots buffered for interpolation
+
+        /**
+         * @struct  Quantization
+         *
+         * @brief   Quantizes each component of a value to a number of bits within a range. The
+         *          default keeps the full precision.
+         */
+        struct Quantization
+        {
+            Quantization() : minValue(0.0), maxValue(0.0), bits(0) {}
+            Quantization(double min, double max, unsigned char numBits) : minValue(min), maxValue(max), bits(numBits) {}
+
+            double minValue;
+            double maxValue;
+            unsigned char bits;                             //0 keeps the full precision, else 1 to 32 bits
+        };
+
+        /**
+         * @fn  ReplicatedFields::ReplicatedFields();
+         *
+         * @brief   Default constructor.
+         */
+        ReplicatedFields();
+
+        /**
+         * @fn  ReplicatedFields::~ReplicatedFields();
+         *
+         * @brief   Destructor.
+         */
+        ~ReplicatedFields();
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, bool& value);
+         *
+         * @brief   Adds a boolean field. The value has to outlive this object.
+         *
+         * @param   name            The field name.
+         * @param [in,out]  value   The replicated value.
+         */
+        void AddField(const std::string& name, bool& value);
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, int& value);
+         *
+         * @brief   Adds an integer field. The value has to outlive this object.
+         *
+         * @param   name            The field name.
+         * @param [in,out]  value   The replicated value.
+         */
+        void AddField(const std::string& name, int& value);
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, float& value, const Quantization& quantization = Quantization());
+         *
+         * @brief   Adds a float field. The value has to outlive this object.
+         *
+         * @param   name            The field name.
+         * @param [in,out]  value   The replicated value.
+         * @param   quantization    (Optional) The quantization.
+         */
+        void AddField(const std::string& name, float& value, const Quantization& quantization = Quantization());
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, double& value, const Quantization& quantization = Quantization());
+         *
+         * @brief   Adds a double field. The value has to outlive this object.
+         *
+         * @param   name            The field name.
+         * @param [in,out]  value   The replicated value.
+         * @param   quantization    (Optional) The quantization.
+         */
+        void AddField(const std::string& name, double& value, const Quantization& quantization = Quantization());
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, trBase::Vec3& value, const Quantization& quantization = Quantization());
+         *
+         * @brief   Adds a vector field. The quantization is applied to each component. The value has
+         *          to outlive this object.
+         *
+         * @param   name            The field name.
+         * @param [in,out]  value   The replicated value.
+         * @param   quantization    (Optional) The quantization.
+         */
+        void AddField(const std::string& name, trBase::Vec3& value, const Quantization& quantization = Quantization());
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, trBase::Quat& value, unsigned char bits = 0);
+         *
+         * @brief   Adds a rotation field. When bits are given, the rotation is normalized and sent as
+         *          its three smallest components with the given number of bits each. The value has to
+         *          outlive this object.
+         *
+         * @param   name            The field name.
+         * @param [in,out]  value   The replicated value.
+         * @param   bits            (Optional) Bits per component from 2 to 20, or 0 for full precision.
+         */
+        void AddField(const std::string& name, trBase::Quat& value, unsigned char bits = 0);
+
+        /**
+         * @fn  size_t ReplicatedFields::GetFieldCount() const;
+         *
+         * @brief   Returns the number of fields.
+         *
+         * @return  The field count.
+         */
+        size_t GetFieldCount() const;
+
+        /**
+         * @fn  size_t ReplicatedFields::GetSnapshotSize() const;
+         *
+         * @brief   Returns the size of an encoded snapshot.
+         *
+         * @return  The snapshot size in bytes.
+         */
+        size_t GetSnapshotSize() const;
+
+        /**
+         * @fn  void ReplicatedFields::WriteSnapshot(std::vector<char>& snapshot) const;
+         *
+         * @brief   Encodes the current field values.
+         *
+         * @param [out] snapshot    The snapshot.
+         */
+        void WriteSnapshot(std::vector<char>& snapshot) const;
+
+        /**
+         * @fn  bool ReplicatedFields::ReadSnapshot(const std::vector<char>& snapshot);
+         *
+         * @brief   Sets the field values from a snapshot.
+         *
+         * @param   snapshot    The snapshot.
+         *
+         * @return  False if the snapshot does not match the fields.
+         */
+        bool ReadSnapshot(const std::vector<char>& snapshot);
+
+        /**
+         * @fn  bool ReplicatedFields::WriteDelta(const std::vector<char>& baseline, const std::vector<char>& snapshot, trManager::JournalData& data) const;
+         *
+         * @brief   Writes the fields of a snapshot that differ from a baseline. An empty baseline
+         *          writes all fields.
+         *
+         * @param   baseline        The baseline the receiver has.
+         * @param   snapshot        The new snapshot.
+         * @param [in,out]  data    The buffer the delta is appended to.
+         *
+         * @return  False if no field changed, in which case nothing is written.
+         */
+        bool WriteDelta(const std::vector<char>& baseline, const std::vector<char>& snapshot, trManager::JournalData& data) const;
+
+        /**
+         * @fn  bool ReplicatedFields::ReadDelta(const std::vector<char>& baseline, trManager::JournalData& data, std::vector<char>& snapshot) const;
+         *
+         * @brief   Rebuilds a snapshot from a baseline and a delta written by WriteDelta.
+         *
+         * @param   baseline        The baseline, or empty if the delta has all fields.
+         * @param [in,out]  data    The buffer to read the delta from.
+         * @param [out] snapshot    The rebuilt snapshot.
+         *
+         * @return  False if the delta is incomplete or does not match the baseline.
+         */
+        bool ReadDelta(const std::vector<char>& baseline, trManager::JournalData& data, std::vector<char>& snapshot) const;
+
+        /**
+         * @fn  void ReplicatedFields::AddRemoteSnapshot(double time, const std::vector<char>& snapshot);
+         *
+         * @brief   Buffers a received snapshot for interpolation. Snapshots older than the newest one
+         *          are ignored.
+         *
+         * @param   time        The simulation time of the snapshot on the server.
+         * @param   snapshot    The snapshot.
+         */
+        void AddRemoteSnapshot(double time, const std::vector<char>& snapshot);
+
+        /**
+         * @fn  void ReplicatedFields::Interpolate(double deltaTime);
+         *
+         * @brief   Advances the playback time, and sets the field values to the interpolation of the
+         *          buffered snapshots around it. Called by ActorBase::OnTickRemote.
+         *
+         * @param   deltaTime   The time since the last call.
+         */
+        void Interpolate(double deltaTime);
+
+        /**
+         * @fn  void ReplicatedFields::SetInterpolationDelay(double delay);
+         *
+         * @brief   Sets how far behind the newest snapshot the values are played back. Should cover a
+         *          few snapshot intervals, so a late or lost snapshot does not stall the playback.
+         *
+         * @param   delay   The delay in seconds.
+         */
+        void SetInterpolationDelay(double delay);
+
+        /**
+         * @fn  double ReplicatedFields::GetInterpolationDelay() const;
+         *
+         * @brief   Returns the interpolation delay.
+         *
+         * @return  The delay in seconds.
+         */
+        double GetInterpolationDelay() const;
+
+        /**
+         * @fn  double ReplicatedFields::GetPlaybackTime() const;
+         *
+         * @brief   Returns the server time the field values were last interpolated to.
+         *
+         * @return  The playback time.
+         */
+        double GetPlaybackTime() const;
+
+    private:
+
+        enum FieldType
+        {
+            BOOL_FIELD,
+            INT_FIELD,
+            FLOAT_FIELD,
+            DOUBLE_FIELD,
+            VEC3_FIELD,
+            QUAT_FIELD
+        };
+
+        struct Field
+        {
+            std::string name;
+            FieldType type;
+            void* value;
+            Quantization quantization;
+            size_t offset;
+            size_t size;
+        };
+
+        struct RemoteSnapshot
+        {
+            double time;
+            std::vector<char> data;
+        };
+
+        /**
+         * @fn  void ReplicatedFields::AddField(const std::string& name, FieldType type, void* value, const Quantization& quantization, size_t size);
+         *
+         * @brief   Adds a field at the end of the snapshot layout.
+         */
+        void AddField(const std::string& name, FieldType type, void* value, const Quantization& quantization, size_t size);
+
+        /**
+         * @fn  void ReplicatedFields::EncodeField(const Field& field, char* data) const;
+         *
+         * @brief   Encodes the current value of a field.
+         */
+        void EncodeField(const Field& field, char* data) const;
+
+        /**
+         * @fn  void ReplicatedFields::DecodeField(const Field& field, const char* data, double* values) const;
+         *
+         * @brief   Decodes a field into up to four components.
+         */
+        void DecodeField(const Field& field, const char* data, double* values) const;
+
+        /**
+         * @fn  void ReplicatedFields::SetField(const Field& field, const double* values);
+         *
+         * @brief   Sets the value of a field from its components.
+         */
+        void SetField(const Field& field, const double* values);
+
+        std::vector<Field> mFields;
+        size_t mSnapshotSize = 0;
+
+        std::deque<RemoteSnapshot> mRemoteSnapshots;
+        double mInterpolationDelay;
+        double mPlaybackTime = 0.0;
+        bool mIsPlaybackStarted = false;
+    };
+}
\ No newline at end of file
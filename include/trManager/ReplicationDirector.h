@@ -0,0 +1,314 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/ActorBase.h>
+#include <trManager/DirectorBase.h>
+#include <trManager/JournalData.h>
+#include <trManager/NetTransport.h>
+#include <trUtil/RefStr.h>
+#include <trBase/ObsrvrPtr.h>
+#include <trBase/UniqueId.h>
+#include <trBase/SmrtPtr.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   ReplicationDirector
+     *
+     * @brief   A Director that replicates the ReplicatedFields of actors from a server to its clients.
+     *          
+     *          On the server, replicated actors are added with AddReplicatedActor, and each client
+     *          is added with a transport that is connected to it. Every snapshot interval the server
+     *          sends each client only the fields that changed since the last snapshot the client
+     *          acknowledged, and only for the actors that changed. Snapshots that are lost are simply
+     *          covered by the next one, so an unreliable transport is enough. 
+     *          
+     *          On a client, the director receives the snapshots from its server transport, and hands
+     *          them to the local actors with the same IDs. Those proxy actors register for the Tick
+     *          message with ON_TICK_REMOTE_INVOKABLE, and interpolate between the snapshots in
+     *          ActorBase::OnTickRemote. Creating the proxy actors is up to the application.
+     */
+    class TR_MANAGER_EXPORT ReplicationDirector : public trManager::DirectorBase
+    {
+    public:
+        using BaseClass = trManager::DirectorBase;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static unsigned int PROTOCOL_ID;              /// Marks the start of every packet
+        const static unsigned int SNAPSHOT_HISTORY_SIZE;    /// Number of snapshots kept as possible baselines
+
+        /**
+         * @fn  ReplicationDirector::ReplicationDirector(const std::string& name = CLASS_TYPE);
+         *
+         * @brief   Constructor.
+         *
+         * @param   name    (Optional) The name.
+         */
+        ReplicationDirector(const std::string& name = CLASS_TYPE);
+
+        /**
+         * @fn  virtual const std::string& ReplicationDirector::GetType() const override
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override { return CLASS_TYPE; }
+
+        /**
+         * @fn  virtual void ReplicationDirector::OnAddedToSysMan() override;
+         *
+         * @brief   Registers for the Tick message.
+         */
+        virtual void OnAddedToSysMan() override;
+
+        /**
+         * @fn  virtual void ReplicationDirector::OnTick(const trManager::MessageBase& msg) override;
+         *
+         * @brief   Sends the snapshots on a server, and receives them on a client.
+         *
+         * @param   msg The Tick message.
+         */
+        virtual void OnTick(const trManager::MessageBase& msg) override;
+
+        /**
+         * @fn  bool ReplicationDirector::AddReplicatedActor(trManager::ActorBase& actor);
+         *
+         * @brief   Adds an actor that is replicated to the clients. 
+         *
+         * @param [in,out]  actor   The actor.
+         *
+         * @return  False if the actor has no replicated fields.
+         */
+        bool AddReplicatedActor(trManager::ActorBase& actor);
+
+        /**
+         * @fn  void ReplicationDirector::RemoveReplicatedActor(const trBase::UniqueId& id);
+         *
+         * @brief   Stops replicating an actor. Actors are also removed when they are deleted.
+         *
+         * @param   id  The actor ID.
+         */
+        void RemoveReplicatedActor(const trBase::UniqueId& id);
+
+        /**
+         * @fn  unsigned int ReplicationDirector::AddClient(trManager::NetTransport& transport);
+         *
+         * @brief   Adds a client on the server. The transport has to be connected to the client only.
+         *
+         * @param [in,out]  transport   The transport.
+         *
+         * @return  The client index.
+         */
+        unsigned int AddClient(trManager::NetTransport& transport);
+
+        /**
+         * @fn  void ReplicationDirector::RemoveClient(unsigned int clientIndex);
+         *
+         * @brief   Removes a client from the server.
+         *
+         * @param   clientIndex The client index.
+         */
+        void RemoveClient(unsigned int clientIndex);
+
+        /**
+         * @fn  void ReplicationDirector::SetServerTransport(trManager::NetTransport* transport);
+         *
+         * @brief   Makes the director a client, that receives the snapshots from the transport.
+         *
+         * @param [in,out]  transport   The transport, or null to stop receiving.
+         */
+        void SetServerTransport(trManager::NetTransport* transport);
+
+        /**
+         * @fn  void ReplicationDirector::SetSnapshotRate(double rate);
+         *
+         * @brief   Sets how many snapshots per second the server sends. 0 sends one every Tick.
+         *
+         * @param   rate    The rate in Hz.
+         */
+        void SetSnapshotRate(double rate);
+
+        /**
+         * @fn  double ReplicationDirector::GetSnapshotRate() const;
+         *
+         * @brief   Returns the snapshot rate.
+         *
+         * @return  The rate in Hz.
+         */
+        double GetSnapshotRate() const;
+
+        /**
+         * @fn  unsigned long long ReplicationDirector::GetSentSnapshotCount() const;
+         *
+         * @brief   Returns the number of snapshots sent to all clients.
+         *
+         * @return  The sent snapshot count.
+         */
+        unsigned long long GetSentSnapshotCount() const;
+
+        /**
+         * @fn  unsigned long long ReplicationDirector::GetSentBytes() const;
+         *
+         * @brief   Returns the number of bytes sent to all clients.
+         *
+         * @return  The sent bytes.
+         */
+        unsigned long long GetSentBytes() const;
+
+        /**
+         * @fn  unsigned long long ReplicationDirector::GetFullSnapshotBytes() const;
+         *
+         * @brief   Returns the number of bytes the sent snapshots would have taken without the delta
+         *          compression. Compare with GetSentBytes to see the savings.
+         *
+         * @return  The uncompressed bytes.
+         */
+        unsigned long long GetFullSnapshotBytes() const;
+
+        /**
+         * @fn  unsigned long long ReplicationDirector::GetReceivedSnapshotCount() const;
+         *
+         * @brief   Returns the number of snapshots a client received and applied.
+         *
+         * @return  The received snapshot count.
+         */
+        unsigned long long GetReceivedSnapshotCount() const;
+
+        /**
+         * @fn  unsigned long long ReplicationDirector::GetDroppedSnapshotCount() const;
+         *
+         * @brief   Returns the number of snapshots a client could not apply, because they were out of
+         *          order, invalid, or their baseline was missing.
+         *
+         * @return  The dropped snapshot count.
+         */
+        unsigned long long GetDroppedSnapshotCount() const;
+
+    protected:
+
+        /**
+         * @fn  ReplicationDirector::~ReplicationDirector();
+         *
+         * @brief   Destructor.
+         */
+        ~ReplicationDirector();
+
+    private:
+
+        //The encoded snapshot of each actor
+        using EntitySnapshots = std::map<trBase::UniqueId, std::vector<char>>;
+
+        struct SnapshotEntry
+        {
+            unsigned int sequence;
+            EntitySnapshots entities;
+        };
+
+        //A sent snapshot. Clients that received every record share the snapshot of the tick.
+        struct SentSnapshotEntry
+        {
+            unsigned int sequence;
+            std::shared_ptr<const EntitySnapshots> entities;
+        };
+
+        struct Client
+        {
+            trBase::SmrtPtr<trManager::NetTransport> transport;
+            unsigned int ackedSequence = 0;
+            std::deque<SentSnapshotEntry> history;          //What the client has for each sent sequence
+        };
+
+        /**
+         * @fn  void ReplicationDirector::SendSnapshots(double simTime);
+         *
+         * @brief   Sends the current snapshot to every client.
+         */
+        void SendSnapshots(double simTime);
+
+        /**
+         * @fn  void ReplicationDirector::SendSnapshot(Client& client, const std::shared_ptr<const EntitySnapshots>& current, double simTime);
+         *
+         * @brief   Sends a client the difference to its last acknowledged snapshot.
+         */
+        void SendSnapshot(Client& client, const std::shared_ptr<const EntitySnapshots>& current, double simTime);
+
+        /**
+         * @fn  void ReplicationDirector::ReceiveAcks(Client& client);
+         *
+         * @brief   Reads the acknowledged snapshots of a client.
+         */
+        void ReceiveAcks(Client& client);
+
+        /**
+         * @fn  void ReplicationDirector::ReceiveSnapshots();
+         *
+         * @brief   Receives, rebuilds, and applies the snapshots from the server.
+         */
+        void ReceiveSnapshots();
+
+        /**
+         * @fn  bool ReplicationDirector::ApplySnapshot(const std::vector<char>& packet);
+         *
+         * @brief   Rebuilds a received snapshot from its baseline, and hands it to the proxy actors.
+         */
+        bool ApplySnapshot(const std::vector<char>& packet);
+
+        /**
+         * @fn  trManager::ReplicatedFields* ReplicationDirector::FindFields(const trBase::UniqueId& id);
+         *
+         * @brief   Returns the replicated fields of a local actor.
+         */
+        trManager::ReplicatedFields* FindFields(const trBase::UniqueId& id);
+
+        std::map<trBase::UniqueId, trBase::ObsrvrPtr<trManager::ActorBase>> mReplicatedActors;
+        std::map<unsigned int, Client> mClients;
+        unsigned int mNextClientIndex = 0;
+        unsigned int mSequence = 0;
+        double mSnapshotRate = 20.0;
+        double mTimeSinceSnapshot = 0.0;
+
+        trBase::SmrtPtr<trManager::NetTransport> mServerTransport;
+        std::deque<SnapshotEntry> mReceivedSnapshots;
+        unsigned int mLatestSequence = 0;
+
+        trManager::JournalData mPacket;                     //Reused buffer for outgoing packets
+        trManager::JournalData mRecords;                    //Reused buffer for the entity records of a snapshot
+        std::vector<char> mReceiveBuffer;                   //Reused buffer for incoming packets
+
+        unsigned long long mSentSnapshotCount = 0;
+        unsigned long long mSentBytes = 0;
+        unsigned long long mFullSnapshotBytes = 0;
+        unsigned long long mReceivedSnapshotCount = 0;
+        unsigned long long mDroppedSnapshotCount = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,421 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trUtil/HashMap.h>
+#include <trUtil/RefStr.h>
+#include <trBase/SmrtClass.h>
+#include <trBase/UniqueId.h>
+#include <trBase/Matrix.h>
+#include <trBase/Vec3.h>
+
+#include <limits>
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   SpatialIndex
+     *
+     * @brief   Base class for the structures that index the positions of entities, so entities near a
+     *          point can be found without going through all of them. Position updates are queued,
+     *          and applied together by ApplyUpdates, which the System Manager calls once per frame.
+     *          Queries report their results through a Visitor, or into a vector whose capacity is
+     *          reused, so they do not allocate once the vector has grown.
+     */
+    class TR_MANAGER_EXPORT SpatialIndex : public trBase::SmrtClass
+    {
+    public:
+
+        using BaseClass = trBase::SmrtClass;                /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        /**
+         * @class   Visitor
+         *
+         * @brief   Receives the entities found by a query.
+         */
+        class TR_MANAGER_EXPORT Visitor
+        {
+        public:
+
+            virtual ~Visitor() {}
+
+            /**
+             * @fn  virtual void Visitor::Visit(const trBase::UniqueId& id, const trBase::Vec3& position) = 0;
+             *
+             * @brief   Called for every entity that matches the query.
+             *
+             * @param   id          The entity ID.
+             * @param   position    The position.
+             */
+            virtual void Visit(const trBase::UniqueId& id, const trBase::Vec3& position) = 0;
+        };
+
+        /**
+         * @struct  Neighbor
+         *
+         * @brief   An entity found by a nearest neighbor query.
+         */
+        struct Neighbor
+        {
+            trBase::UniqueId id;
+            double distance2;                               //Squared distance from the query point
+
+            bool operator<(const Neighbor& other) const { return distance2 < other.distance2; }
+        };
+
+        /**
+         * @struct  Frustum
+         *
+         * @brief   A view frustum as six planes, with the inside on the positive side of each plane.
+         */
+        struct TR_MANAGER_EXPORT Frustum
+        {
+            double planes[6][4];                            //a, b, c, d of ax + by + cz + d >= 0
+
+            /**
+             * @fn  void Frustum::Set(const trBase::Matrix& viewProjection);
+             *
+             * @brief   Extracts the planes from a combined view and projection matrix.
+             *
+             * @param   viewProjection  The view matrix multiplied by the projection matrix.
+             */
+            void Set(const trBase::Matrix& viewProjection);
+
+            /**
+             * @fn  bool Frustum::Contains(const trBase::Vec3& point) const;
+             *
+             * @brief   Checks if a point is inside the frustum.
+             *
+             * @param   point   The point.
+             *
+             * @return  True if inside, false if not.
+             */
+            bool Contains(const trBase::Vec3& point) const;
+
+            /**
+             * @fn  bool Frustum::Intersects(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax) const;
+             *
+             * @brief   Checks if an axis aligned box can overlap the frustum. Boxes near the corners of
+             *          the frustum can be reported as overlapping when they are not.
+             *
+             * @param   boxMin  The minimum corner of the box.
+             * @param   boxMax  The maximum corner of the box.
+             *
+             * @return  False if the box is outside the frustum.
+             */
+            bool Intersects(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax) const;
+        };
+
+        /**
+         * @fn  virtual const std::string& SpatialIndex::GetType() const override;
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override;
+
+        /**
+         * @fn  void SpatialIndex::Update(const trBase::UniqueId& id, const trBase::Vec3& position);
+         *
+         * @brief   Queues adding an entity, or moving it to a new position. The change is seen by the
+         *          queries after the next ApplyUpdates.
+         *
+         * @param   id          The entity ID.
+         * @param   position    The position.
+         */
+        void Update(const trBase::UniqueId& id, const trBase::Vec3& position);
+
+        /**
+         * @fn  void SpatialIndex::ApplyUpdates();
+         *
+         * @brief   Applies all the queued updates.
+         */
+        void ApplyUpdates();
+
+        /**
+         * @fn  void SpatialIndex::CopyFrom(const SpatialIndex& source);
+         *
+         * @brief   Queues updates for every entity in another index, so an index can be replaced by
+         *          one of a different kind.
+         *
+         * @param   source  The index to copy the positions from.
+         */
+        void CopyFrom(const SpatialIndex& source);
+
+        /**
+         * @fn  size_t SpatialIndex::GetPendingUpdateCount() const;
+         *
+         * @brief   Returns the number of queued updates.
+         *
+         * @return  The pending update count.
+         */
+        size_t GetPendingUpdateCount() const;
+
+        /**
+         * @fn  bool SpatialIndex::Remove(const trBase::UniqueId& id);
+         *
+         * @brief   Removes an entity right away, along with any of its queued updates.
+         *
+         * @param   id  The entity ID.
+         *
+         * @return  False if the entity was not in the index.
+         */
+        bool Remove(const trBase::UniqueId& id);
+
+        /**
+         * @fn  void SpatialIndex::Clear();
+         *
+         * @brief   Removes all entities and queued updates.
+         */
+        void Clear();
+
+        /**
+         * @fn  size_t SpatialIndex::GetSize() const;
+         *
+         * @brief   Returns the number of entities in the index.
+         *
+         * @return  The entity count.
+         */
+        size_t GetSize() const;
+
+        /**
+         * @fn  bool SpatialIndex::GetPosition(const trBase::UniqueId& id, trBase::Vec3& position) const;
+         *
+         * @brief   Returns the indexed position of an entity.
+         *
+         * @param           id          The entity ID.
+         * @param [out]     position    The position.
+         *
+         * @return  False if the entity is not in the index.
+         */
+        bool GetPosition(const trBase::UniqueId& id, trBase::Vec3& position) const;
+
+        /**
+         * @fn  void SpatialIndex::VisitAll(Visitor& visitor) const;
+         *
+         * @brief   Visits every entity in the index.
+         *
+         * @param [in,out]  visitor The visitor.
+         */
+        void VisitAll(Visitor& visitor) const;
+
+        /**
+         * @fn  virtual void SpatialIndex::VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const = 0;
+         *
+         * @brief   Visits the entities within a radius of a point.
+         *
+         * @param           center  The center.
+         * @param           radius  The radius.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const = 0;
+         *
+         * @brief   Visits the entities inside an axis aligned box.
+         *
+         * @param           boxMin  The minimum corner of the box.
+         * @param           boxMax  The maximum corner of the box.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::VisitFrustum(const Frustum& frustum, Visitor& visitor) const = 0;
+         *
+         * @brief   Visits the entities inside a view frustum.
+         *
+         * @param           frustum The frustum.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitFrustum(const Frustum& frustum, Visitor& visitor) const = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance = std::numeric_limits<double>::max()) const = 0;
+         *
+         * @brief   Finds the entities nearest to a point.
+         *
+         * @param           center      The query point.
+         * @param           count       The number of entities to find.
+         * @param [out]     results     The entities, nearest first. The vector is cleared first, and its
+         *                              capacity is reused.
+         * @param           maxDistance (Optional) Entities further away are ignored.
+         */
+        virtual void QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance = std::numeric_limits<double>::max()) const = 0;
+
+        /**
+         * @fn  void SpatialIndex::QueryRadius(const trBase::Vec3& center, double radius, std::vector<trBase::UniqueId>& results) const;
+         *
+         * @brief   Finds the entities within a radius of a point.
+         *
+         * @param           center  The center.
+         * @param           radius  The radius.
+         * @param [out]     results The IDs of the entities, in no particular order. The vector is
+         *                          cleared first, and its capacity is reused.
+         */
+        void QueryRadius(const trBase::Vec3& center, double radius, std::vector<trBase::UniqueId>& results) const;
+
+        /**
+         * @fn  void SpatialIndex::QueryBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, std::vector<trBase::UniqueId>& results) const;
+         *
+         * @brief   Finds the entities inside an axis aligned box.
+         *
+         * @param           boxMin  The minimum corner of the box.
+         * @param           boxMax  The maximum corner of the box.
+         * @param [out]     results The IDs of the entities, in no particular order. The vector is
+         *                          cleared first, and its capacity is reused.
+         */
+        void QueryBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, std::vector<trBase::UniqueId>& results) const;
+
+        /**
+         * @fn  void SpatialIndex::QueryFrustum(const Frustum& frustum, std::vector<trBase::UniqueId>& results) const;
+         *
+         * @brief   Finds the entities inside a view frustum.
+         *
+         * @param           frustum The frustum.
+         * @param [out]     results The IDs of the entities, in no particular order. The vector is
+         *                          cleared first, and its capacity is reused.
+         */
+        void QueryFrustum(const Frustum& frustum, std::vector<trBase::UniqueId>& results) const;
+
+    protected:
+
+        /**
+         * @struct  Entry
+         *
+         * @brief   An indexed entity. The location is owned by the derived class, and holds the cell or
+         *          node the entity is stored in.
+         */
+        struct Entry
+        {
+            trBase::UniqueId id;
+            trBase::Vec3 position;
+            long long location;
+        };
+
+        /**
+         * @fn  SpatialIndex::SpatialIndex();
+         *
+         * @brief   Default constructor.
+         */
+        SpatialIndex();
+
+        /**
+         * @fn  SpatialIndex::~SpatialIndex();
+         *
+         * @brief   Destructor.
+         */
+        ~SpatialIndex();
+
+        /**
+         * @fn  virtual void SpatialIndex::InsertEntry(size_t entryIndex) = 0;
+         *
+         * @brief   Stores a new entry in the derived structure, and sets its location.
+         *
+         * @param   entryIndex  Zero-based index of the entry.
+         */
+        virtual void InsertEntry(size_t entryIndex) = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition) = 0;
+         *
+         * @brief   Called after the position of an entry changed.
+         *
+         * @param   entryIndex  Zero-based index of the entry.
+         * @param   oldPosition The previous position.
+         */
+        virtual void MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition) = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::RemoveEntry(size_t entryIndex) = 0;
+         *
+         * @brief   Removes an entry from the derived structure.
+         *
+         * @param   entryIndex  Zero-based index of the entry.
+         */
+        virtual void RemoveEntry(size_t entryIndex) = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::RenumberEntry(size_t oldIndex, size_t newIndex) = 0;
+         *
+         * @brief   Called when an entry moves to a new index, after another entry was removed.
+         *
+         * @param   oldIndex    The old index.
+         * @param   newIndex    The new index.
+         */
+        virtual void RenumberEntry(size_t oldIndex, size_t newIndex) = 0;
+
+        /**
+         * @fn  virtual void SpatialIndex::ClearEntries() = 0;
+         *
+         * @brief   Removes all entries from the derived structure.
+         */
+        virtual void ClearEntries() = 0;
+
+        /**
+         * @fn  static void SpatialIndex::AddNeighbor(const Entry& entry, const trBase::Vec3& center, size_t count, double maxDistance2, std::vector<Neighbor>& heap);
+         *
+         * @brief   Adds an entry to a nearest neighbor search. The heap holds at most count
+         *          neighbors, with the furthest one at the front.
+         *
+         * @param           entry           The entry.
+         * @param           center          The query point.
+         * @param           count           The number of neighbors to keep.
+         * @param           maxDistance2    The squared search distance.
+         * @param [in,out]  heap            The neighbors found so far.
+         */
+        static void AddNeighbor(const Entry& entry, const trBase::Vec3& center, size_t count, double maxDistance2, std::vector<Neighbor>& heap);
+
+        /**
+         * @fn  static double SpatialIndex::GetMaxDistance2(double maxDistance);
+         *
+         * @brief   Squares a search distance, without overflowing for unlimited searches.
+         *
+         * @param   maxDistance The search distance.
+         *
+         * @return  The squared distance.
+         */
+        static double GetMaxDistance2(double maxDistance);
+
+        std::vector<Entry> mEntries;
+
+    private:
+
+        struct PendingUpdate
+        {
+            trBase::UniqueId id;
+            trBase::Vec3 position;
+        };
+
+        using EntryMap = trUtil::HashMap<trBase::UniqueId, size_t>;
+        EntryMap mEntryMap;
+
+        std::vector<PendingUpdate> mPendingUpdates;
+    };
+}
\ No newline at end of file
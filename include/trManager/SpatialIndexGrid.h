@@ -0,0 +1,232 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/SpatialIndex.h>
+#include <trUtil/HashMap.h>
+#include <trUtil/RefStr.h>
+
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   SpatialIndexGrid
+     *
+     * @brief   A spatial index that hashes entities into a uniform grid of cubic cells. Only the
+     *          occupied cells are stored, so the grid has no bounds. The cell size should be close to
+     *          the typical query radius. Works best when the entities are spread evenly.
+     */
+    class TR_MANAGER_EXPORT SpatialIndexGrid : public trManager::SpatialIndex
+    {
+    public:
+
+        using BaseClass = trManager::SpatialIndex;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static double DEFAULT_CELL_SIZE;              /// Default edge length of a grid cell
+
+        /**
+         * @fn  SpatialIndexGrid::SpatialIndexGrid(double cellSize = DEFAULT_CELL_SIZE);
+         *
+         * @brief   Constructor.
+         *
+         * @param   cellSize    (Optional) The edge length of a grid cell.
+         */
+        SpatialIndexGrid(double cellSize = DEFAULT_CELL_SIZE);
+
+        /**
+         * @fn  virtual const std::string& SpatialIndexGrid::GetType() const override;
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override;
+
+        /**
+         * @fn  void SpatialIndexGrid::SetCellSize(double cellSize);
+         *
+         * @brief   Sets the edge length of a grid cell, and rebuilds the grid.
+         *
+         * @param   cellSize    The cell size.
+         */
+        void SetCellSize(double cellSize);
+
+        /**
+         * @fn  double SpatialIndexGrid::GetCellSize() const;
+         *
+         * @brief   Returns the edge length of a grid cell.
+         *
+         * @return  The cell size.
+         */
+        double GetCellSize() const;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const override;
+         *
+         * @brief   Visits the entities within a radius of a point.
+         *
+         * @param           center  The center.
+         * @param           radius  The radius.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const override;
+         *
+         * @brief   Visits the entities inside an axis aligned box.
+         *
+         * @param           boxMin  The minimum corner of the box.
+         * @param           boxMax  The maximum corner of the box.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::VisitFrustum(const Frustum& frustum, Visitor& visitor) const override;
+         *
+         * @brief   Visits the entities inside a view frustum. Goes through the occupied cells, since a
+         *          frustum has no bounds that are cheap to walk.
+         *
+         * @param           frustum The frustum.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitFrustum(const Frustum& frustum, Visitor& visitor) const override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance = std::numeric_limits<double>::max()) const override;
+         *
+         * @brief   Finds the entities nearest to a point, by searching growing shells of cells around
+         *          it.
+         *
+         * @param           center      The query point.
+         * @param           count       The number of entities to find.
+         * @param [out]     results     The entities, nearest first.
+         * @param           maxDistance (Optional) Entities further away are ignored.
+         */
+        virtual void QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance = std::numeric_limits<double>::max()) const override;
+
+    protected:
+
+        /**
+         * @fn  SpatialIndexGrid::~SpatialIndexGrid();
+         *
+         * @brief   Destructor.
+         */
+        ~SpatialIndexGrid();
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::InsertEntry(size_t entryIndex) override;
+         *
+         * @brief   Puts a new entry in the cell that holds its position.
+         */
+        virtual void InsertEntry(size_t entryIndex) override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition) override;
+         *
+         * @brief   Moves an entry to a new cell when it crossed a cell border. Entries that did not
+         *          move are left alone without looking up their cell.
+         */
+        virtual void MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition) override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::RemoveEntry(size_t entryIndex) override;
+         *
+         * @brief   Removes an entry from its cell.
+         */
+        virtual void RemoveEntry(size_t entryIndex) override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::RenumberEntry(size_t oldIndex, size_t newIndex) override;
+         *
+         * @brief   Points the cell of a moved entry at its new index.
+         */
+        virtual void RenumberEntry(size_t oldIndex, size_t newIndex) override;
+
+        /**
+         * @fn  virtual void SpatialIndexGrid::ClearEntries() override;
+         *
+         * @brief   Removes all cells.
+         */
+        virtual void ClearEntries() override;
+
+    private:
+
+        using CellKey = long long;
+
+        //Hashes a cell key for the cell map
+        struct CellHash
+        {
+            size_t operator()(CellKey key) const { return static_cast<size_t>(key ^ (key >> 32)); }
+        };
+
+        using CellMap = trUtil::HashMap<CellKey, std::vector<size_t>, CellHash>;
+
+        /**
+         * @fn  int SpatialIndexGrid::GetCellCoordinate(double value) const;
+         *
+         * @brief   Returns the cell coordinate of a position coordinate.
+         */
+        int GetCellCoordinate(double value) const;
+
+        /**
+         * @fn  CellKey SpatialIndexGrid::GetCellKey(const trBase::Vec3& position) const;
+         *
+         * @brief   Returns the key of the cell holding a position.
+         */
+        CellKey GetCellKey(const trBase::Vec3& position) const;
+
+        /**
+         * @fn  static CellKey SpatialIndexGrid::MakeCellKey(int x, int y, int z);
+         *
+         * @brief   Packs cell coordinates into a key, 21 bits per axis.
+         */
+        static CellKey MakeCellKey(int x, int y, int z);
+
+        /**
+         * @fn  void SpatialIndexGrid::RemoveFromCell(CellKey cell, size_t entryIndex);
+         *
+         * @brief   Removes an entry index from a cell, and drops the cell when it is empty.
+         */
+        void RemoveFromCell(CellKey cell, size_t entryIndex);
+
+        /**
+         * @fn  template<typename Test> void SpatialIndexGrid::VisitCells(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Test test, Visitor& visitor) const;
+         *
+         * @brief   Visits the entities that pass a test in the cells overlapping a box. Large boxes go
+         *          through the occupied cells, instead of the mostly empty cell range.
+         */
+        template<typename Test>
+        void VisitCells(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Test test, Visitor& visitor) const;
+
+        double mCellSize;
+        double mInvCellSize;
+
+        CellMap mCells;
+    };
+}
\ No newline at end of file
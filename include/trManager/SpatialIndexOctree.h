@@ -0,0 +1,286 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/SpatialIndex.h>
+#include <trUtil/RefStr.h>
+
+#include <vector>
+
+namespace trManager
+{
+    /**
+     * @class   SpatialIndexOctree
+     *
+     * @brief   A spatial index that stores entities in a loose octree. Leaves split when they hold
+     *          more than the leaf capacity, and merge back when their entities leave. Each node
+     *          accepts entities up to twice its size, so entities that move a little stay in their
+     *          node. The root grows when an entity is placed outside of it. Works best when the
+     *          entities are clustered, or spread over very different densities.
+     */
+    class TR_MANAGER_EXPORT SpatialIndexOctree : public trManager::SpatialIndex
+    {
+    public:
+
+        using BaseClass = trManager::SpatialIndex;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        const static double DEFAULT_HALF_SIZE;              /// Default half of the edge length of the root node
+        const static unsigned int DEFAULT_LEAF_CAPACITY;    /// Default number of entities a leaf holds before splitting
+        const static unsigned int MAX_DEPTH;                /// Leaves at this depth do not split
+        const static double LOOSENESS;                      /// How much larger the bounds of a node are than its cell
+
+        /**
+         * @fn  SpatialIndexOctree::SpatialIndexOctree(const trBase::Vec3& center = trBase::Vec3(0.0, 0.0, 0.0), double halfSize = DEFAULT_HALF_SIZE, unsigned int leafCapacity = DEFAULT_LEAF_CAPACITY);
+         *
+         * @brief   Constructor.
+         *
+         * @param   center          (Optional) The center of the root node.
+         * @param   halfSize        (Optional) Half of the edge length of the root node.
+         * @param   leafCapacity    (Optional) The number of entities a leaf holds before splitting.
+         */
+        SpatialIndexOctree(const trBase::Vec3& center = trBase::Vec3(0.0, 0.0, 0.0), double halfSize = DEFAULT_HALF_SIZE, unsigned int leafCapacity = DEFAULT_LEAF_CAPACITY);
+
+        /**
+         * @fn  virtual const std::string& SpatialIndexOctree::GetType() const override;
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override;
+
+        /**
+         * @fn  void SpatialIndexOctree::SetBounds(const trBase::Vec3& center, double halfSize);
+         *
+         * @brief   Sets the bounds of the root node, and rebuilds the tree.
+         *
+         * @param   center      The center of the root node.
+         * @param   halfSize    Half of the edge length of the root node.
+         */
+        void SetBounds(const trBase::Vec3& center, double halfSize);
+
+        /**
+         * @fn  double SpatialIndexOctree::GetHalfSize() const;
+         *
+         * @brief   Returns half of the edge length of the root node.
+         *
+         * @return  The half size.
+         */
+        double GetHalfSize() const;
+
+        /**
+         * @fn  size_t SpatialIndexOctree::GetNodeCount() const;
+         *
+         * @brief   Returns the number of nodes in use.
+         *
+         * @return  The node count.
+         */
+        size_t GetNodeCount() const;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const override;
+         *
+         * @brief   Visits the entities within a radius of a point.
+         *
+         * @param           center  The center.
+         * @param           radius  The radius.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const override;
+         *
+         * @brief   Visits the entities inside an axis aligned box.
+         *
+         * @param           boxMin  The minimum corner of the box.
+         * @param           boxMax  The maximum corner of the box.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::VisitFrustum(const Frustum& frustum, Visitor& visitor) const override;
+         *
+         * @brief   Visits the entities inside a view frustum.
+         *
+         * @param           frustum The frustum.
+         * @param [in,out]  visitor The visitor.
+         */
+        virtual void VisitFrustum(const Frustum& frustum, Visitor& visitor) const override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance = std::numeric_limits<double>::max()) const override;
+         *
+         * @brief   Finds the entities nearest to a point, visiting the closest children first and
+         *          skipping nodes further away than the furthest neighbor found so far.
+         *
+         * @param           center      The query point.
+         * @param           count       The number of entities to find.
+         * @param [out]     results     The entities, nearest first.
+         * @param           maxDistance (Optional) Entities further away are ignored.
+         */
+        virtual void QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance = std::numeric_limits<double>::max()) const override;
+
+    protected:
+
+        /**
+         * @fn  SpatialIndexOctree::~SpatialIndexOctree();
+         *
+         * @brief   Destructor.
+         */
+        ~SpatialIndexOctree();
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::InsertEntry(size_t entryIndex) override;
+         *
+         * @brief   Puts a new entry in the leaf that holds its position.
+         */
+        virtual void InsertEntry(size_t entryIndex) override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition) override;
+         *
+         * @brief   Moves an entry to a new leaf when it left the loose bounds of its node.
+         */
+        virtual void MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition) override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::RemoveEntry(size_t entryIndex) override;
+         *
+         * @brief   Removes an entry from its node.
+         */
+        virtual void RemoveEntry(size_t entryIndex) override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::RenumberEntry(size_t oldIndex, size_t newIndex) override;
+         *
+         * @brief   Points the node of a moved entry at its new index.
+         */
+        virtual void RenumberEntry(size_t oldIndex, size_t newIndex) override;
+
+        /**
+         * @fn  virtual void SpatialIndexOctree::ClearEntries() override;
+         *
+         * @brief   Removes all nodes but the root.
+         */
+        virtual void ClearEntries() override;
+
+    private:
+
+        static const int NO_CHILDREN = -1;
+
+        struct Node
+        {
+            trBase::Vec3 center;
+            double halfSize;
+            int firstChild;                                 //Index of the first of 8 consecutive children, or NO_CHILDREN
+            int parent;
+            unsigned int depth;
+            std::vector<size_t> entries;                    //Inner nodes only keep the entries that don't fit in a child
+        };
+
+        /**
+         * @fn  void SpatialIndexOctree::Rebuild();
+         *
+         * @brief   Clears the nodes, and inserts every entry again.
+         */
+        void Rebuild();
+
+        /**
+         * @fn  void SpatialIndexOctree::Insert(size_t entryIndex);
+         *
+         * @brief   Inserts an entry from the root down, growing the root when needed.
+         */
+        void Insert(size_t entryIndex);
+
+        /**
+         * @fn  void SpatialIndexOctree::Split(int nodeIndex);
+         *
+         * @brief   Gives a leaf 8 children, and moves its entries into the children whose loose bounds
+         *          hold them.
+         */
+        void Split(int nodeIndex);
+
+        /**
+         * @fn  void SpatialIndexOctree::RemoveFromNode(int nodeIndex, size_t entryIndex);
+         *
+         * @brief   Removes an entry index from a leaf.
+         */
+        void RemoveFromNode(int nodeIndex, size_t entryIndex);
+
+        /**
+         * @fn  void SpatialIndexOctree::TryMerge(int nodeIndex);
+         *
+         * @brief   Turns a node back into a leaf when its children are leaves holding few entries,
+         *          and repeats for its parent.
+         */
+        void TryMerge(int nodeIndex);
+
+        /**
+         * @fn  int SpatialIndexOctree::GetChild(const Node& node, const trBase::Vec3& position) const;
+         *
+         * @brief   Returns the index of the child of a node whose cell holds a position.
+         */
+        int GetChild(const Node& node, const trBase::Vec3& position) const;
+
+        /**
+         * @fn  bool SpatialIndexOctree::IsInside(const Node& node, const trBase::Vec3& position, double scale) const;
+         *
+         * @brief   Checks if a position is inside the cell of a node scaled by a factor.
+         */
+        bool IsInside(const Node& node, const trBase::Vec3& position, double scale) const;
+
+        /**
+         * @fn  static double SpatialIndexOctree::GetDistance2(const Node& node, const trBase::Vec3& point);
+         *
+         * @brief   Returns the squared distance from a point to the loose bounds of a node.
+         */
+        static double GetDistance2(const Node& node, const trBase::Vec3& point);
+
+        /**
+         * @fn  template<typename NodeTest, typename Test> void SpatialIndexOctree::VisitNodes(int nodeIndex, NodeTest nodeTest, Test test, Visitor& visitor) const;
+         *
+         * @brief   Visits the entities that pass a test, in the nodes whose loose bounds pass a test.
+         */
+        template<typename NodeTest, typename Test>
+        void VisitNodes(int nodeIndex, NodeTest nodeTest, Test test, Visitor& visitor) const;
+
+        /**
+         * @fn  void SpatialIndexOctree::FindNearest(int nodeIndex, const trBase::Vec3& center, size_t count, double maxDistance2, std::vector<Neighbor>& heap) const;
+         *
+         * @brief   Recursive part of the nearest neighbor search.
+         */
+        void FindNearest(int nodeIndex, const trBase::Vec3& center, size_t count, double maxDistance2, std::vector<Neighbor>& heap) const;
+
+        trBase::Vec3 mCenter;
+        double mHalfSize;
+        unsigned int mLeafCapacity;
+
+        std::vector<Node> mNodes;                           //The root is always node 0
+        std::vector<int> mFreeBlocks;                       //First indexes of unused blocks of 8 children
+    };
+}
\ No newline at end of file
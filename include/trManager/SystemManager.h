@@ -24,10 +24,19 @@
 #include "Export.h"
 
 #include <trManager/DirectorPriority.h>
+#include <trManager/MessagePriority.h>
 #include <trManager/MessageBase.h>
 #include <trManager/EntityBase.h>
+#include <trManager/InterestManager.h>
+#include <trManager/SpatialIndex.h>
+#include <trManager/TickScheduler.h>
+#include <trManager/TimingStructure.h>
 #include <trUtil/HashMap.h>
+#include <trUtil/Timer.h>
+#include <trUtil/Metrics/Counter.h>
+#include <trUtil/Metrics/Gauge.h>
 #include <trBase/UniqueId.h>
+#include <trBase/ObsrvrPtr.h>
 #include <trBase/SmrtPtr.h>
 #include <trBase/Base.h>
 
@@ -39,9 +48,15 @@
 
 namespace trManager
 {
+    class JournalRecorder;
+    class NetworkDirector;
+
     /**
-    * System Manager class is a singleton that is responsible for all message routing and basic 
-    * operations between actors and directors throughout TR. 
+    * System Manager class is responsible for all message routing and basic operations between 
+    * actors and directors throughout TR. The singleton returned by GetInstance() is the default world. 
+    * Additional independent worlds can be created with new, each with its own System Director, 
+    * message queues and registries. A world is not thread safe by itself, but separate worlds can 
+    * be driven from separate threads. 
     */
     class TR_MANAGER_EXPORT SystemManager : public trBase::Base
     {
@@ -60,6 +75,17 @@ namespace trManager
          */
         static trManager::SystemManager& GetInstance();
 
+        /**
+         * @fn  SystemManager::SystemManager(const std::string name = CLASS_TYPE);
+         *
+         * @brief   Ctor. Creates a new independent world, that shares nothing with the default
+         *          GetInstance() world. Entities registered with it will route their messages through
+         *          it.
+         *
+         * @param   name    (Optional) The name.
+         */
+        SystemManager(const std::string name = CLASS_TYPE);
+
         /**
          * @fn  virtual const std::string& SystemManager::GetType() const override;
          *
@@ -83,7 +109,9 @@ namespace trManager
         /**
          * @fn  virtual bool SystemManager::SendNetworkMessage(const trManager::MessageBase& message);
          *
-         * @brief   Send a Network message to an Actor, Actor Module, or a Director.
+         * @brief   Send a Network message to an Actor, Actor Module, or a Director. If a
+         *          NetworkDirector is attached, the message is sent to the remote worlds, else it
+         *          is handed to the local Directors.
          *
          * @param   message The message.
          *
@@ -104,10 +132,205 @@ namespace trManager
         /**
          * @fn  virtual void SystemManager::ProcessMessages();
          *
-         * @brief   Sends out all the messages from the message queue. This is for system use only.
+         * @brief   Sends out the messages from the message queue, highest priority class first. If a
+         *          message time budget is set, messages below the SYSTEM priority class are only sent
+         *          out while the budget lasts, and the rest are carried over to the next frame. This
+         *          is for system use only.
          */
         virtual void ProcessMessages();
 
+        /**
+         * @fn  virtual void SystemManager::FlushMessages();
+         *
+         * @brief   Sends out all the messages from the message queue, ignoring the message time
+         *          budget. This is for system use only.
+         */
+        virtual void FlushMessages();
+
+        /**
+         * @fn  virtual void SystemManager::ResetMessageTimeBudget();
+         *
+         * @brief   Marks the start of a new frame for the message time budget. Resets the used up
+         *          budget time, and records any messages that were deferred from the last frame. This
+         *          is for system use only, and is called by the System Director at the start of
+         *          every frame.
+         */
+        virtual void ResetMessageTimeBudget();
+
+        /**
+         * @fn  void SystemManager::SetMessageTimeBudget(double seconds);
+         *
+         * @brief   Sets the time budget per frame, that is used to process queued messages. Messages
+         *          that do not fit into the budget are deferred to the next frame, except for the
+         *          SYSTEM priority class messages. A value of 0 disables the budget, and all messages
+         *          are processed in the frame they are sent in. Disabled by default.
+         *
+         * @param   seconds The time budget in seconds.
+         */
+        void SetMessageTimeBudget(double seconds);
+
+        /**
+         * @fn  double SystemManager::GetMessageTimeBudget() const;
+         *
+         * @brief   Returns the time budget per frame, that is used to process queued messages.
+         *
+         * @return  The message time budget in seconds. 0 if the budget is disabled.
+         */
+        double GetMessageTimeBudget() const;
+
+        /**
+         * @fn  unsigned int SystemManager::GetMessageBacklog() const;
+         *
+         * @brief   Returns the number of messages that are currently waiting in the message queue.
+         *
+         * @return  The number of queued messages.
+         */
+        unsigned int GetMessageBacklog() const;
+
+        /**
+         * @fn  unsigned int SystemManager::GetDeferredMessageCount() const;
+         *
+         * @brief   Returns the number of messages that were deferred from the last frame into the
+         *          current one, because the message time budget ran out.
+         *
+         * @return  The deferred message count.
+         */
+        unsigned int GetDeferredMessageCount() const;
+
+        /**
+         * @fn  unsigned int SystemManager::GetPeakDeferredMessageCount() const;
+         *
+         * @brief   Returns the highest number of messages that were deferred from one frame to the
+         *          next.
+         *
+         * @return  The peak deferred message count.
+         */
+        unsigned int GetPeakDeferredMessageCount() const;
+
+        /**
+         * @fn  unsigned long long SystemManager::GetTotalDeferredMessages() const;
+         *
+         * @brief   Returns the sum of all the messages that were carried over from one frame to the
+         *          next. A message that was deferred several times is counted each time.
+         *
+         * @return  The total deferred messages.
+         */
+        unsigned long long GetTotalDeferredMessages() const;
+
+        /**
+         * @fn  unsigned long long SystemManager::GetDeferredFrameCount() const;
+         *
+         * @brief   Returns the number of frames that ran out of the message time budget.
+         *
+         * @return  The deferred frame count.
+         */
+        unsigned long long GetDeferredFrameCount() const;
+
+        /**
+         * @fn  unsigned long long SystemManager::GetProcessedMessageCount() const;
+         *
+         * @brief   Returns the number of messages that were processed since the System Manager was
+         *          created.
+         *
+         * @return  The processed message count.
+         */
+        unsigned long long GetProcessedMessageCount() const;
+
+        /**
+         * @fn  void SystemManager::SetJournalRecorder(trManager::JournalRecorder* recorder);
+         *
+         * @brief   Sets the recorder that gets every processed message. The JournalRecorder sets itself
+         *          when it is registered, so this should not be called directly by the user.
+         *
+         * @param [in,out]  recorder    The recorder, or null to stop recording.
+         */
+        void SetJournalRecorder(trManager::JournalRecorder* recorder);
+
+        /**
+         * @fn  trManager::JournalRecorder* SystemManager::GetJournalRecorder() const;
+         *
+         * @brief   Returns the attached journal recorder.
+         *
+         * @return  Null if no recorder is attached, else the recorder.
+         */
+        trManager::JournalRecorder* GetJournalRecorder() const;
+
+        /**
+         * @fn  void SystemManager::SetNetworkDirector(trManager::NetworkDirector* director);
+         *
+         * @brief   Sets the director that sends the network messages to remote worlds. The
+         *          NetworkDirector sets itself when it is registered, so this should not be called
+         *          directly by the user.
+         *
+         * @param [in,out]  director    The director, or null to keep the network messages local.
+         */
+        void SetNetworkDirector(trManager::NetworkDirector* director);
+
+        /**
+         * @fn  trManager::NetworkDirector* SystemManager::GetNetworkDirector() const;
+         *
+         * @brief   Returns the attached network director.
+         *
+         * @return  Null if no director is attached, else the director.
+         */
+        trManager::NetworkDirector* GetNetworkDirector() const;
+
+        /**
+         * @fn  void SystemManager::SetTimingStructure(const trManager::TimingStructure& timeStruct);
+         *
+         * @brief   Sets the timing of the frame that is being processed. Set at the start of every
+         *          frame by whatever drives the frames, like the System Director or the JournalPlayer.
+         *
+         * @param   timeStruct  The time structure.
+         */
+        void SetTimingStructure(const trManager::TimingStructure& timeStruct);
+
+        /**
+         * @fn  const trManager::TimingStructure& SystemManager::GetTimingStructure() const;
+         *
+         * @brief   Returns the timing of the frame that is being processed.
+         *
+         * @return  The time structure.
+         */
+        const trManager::TimingStructure& GetTimingStructure() const;
+
+        /**
+         * @fn  void SystemManager::SetSuppressSentMessages(bool suppress);
+         *
+         * @brief   Makes SendMessage drop all messages. The JournalPlayer sets it while it plays a
+         *          frame, because the journal already holds what the entities send in reaction to the
+         *          replayed messages.
+         *
+         * @param   suppress    True to drop sent messages.
+         */
+        void SetSuppressSentMessages(bool suppress);
+
+        /**
+         * @fn  bool SystemManager::GetSuppressSentMessages() const;
+         *
+         * @brief   Returns true if sent messages are dropped.
+         *
+         * @return  True if sent messages are dropped.
+         */
+        bool GetSuppressSentMessages() const;
+
+        /**
+         * @fn  unsigned long long SystemManager::GetSuppressedMessageCount() const;
+         *
+         * @brief   Returns the number of sent messages that were dropped, since the System Manager
+         *          was created.
+         *
+         * @return  The suppressed message count.
+         */
+        unsigned long long GetSuppressedMessageCount() const;
+
+        /**
+         * @fn  void SystemManager::ResetDeferredMessageStats();
+         *
+         * @brief   Resets the deferred message counters.
+         */
+        void ResetDeferredMessageStats();
+
         /**
          * @fn  virtual void SystemManager::ProcessNetworkMessages();
          *
@@ -158,6 +381,78 @@ namespace trManager
          */
         virtual void UnregisterFromMessagesAboutEntity(EntityBase& listeningEntity, const trBase::UniqueId& aboutEntityId);
 
+        /**
+         * @fn  virtual void SystemManager::RegisterForMessagesInArea(EntityBase& listeningEntity, double radius, const std::string& invokableName);
+         *
+         * @brief   Registers for messages about all the entities within a radius of the listening
+         *          entity. The position of the listener and the entities come from SetEntityPosition,
+         *          and the members of the area are updated once per frame by UpdateSpatialIndex.
+         *          Registering again changes the radius and invokable.
+         *
+         * @param [in,out]  listeningEntity The Listening entity that will receive the messages.
+         * @param           radius          The radius of the area.
+         * @param           invokableName   Name of the invokable.
+         */
+        virtual void RegisterForMessagesInArea(EntityBase& listeningEntity, double radius, const std::string& invokableName);
+
+        /**
+         * @fn  virtual void SystemManager::UnregisterFromMessagesInArea(EntityBase& listeningEntity);
+         *
+         * @brief   Unregisters from the messages about the entities in an area.
+         *
+         * @param [in,out]  listeningEntity The listening entity.
+         */
+        virtual void UnregisterFromMessagesInArea(EntityBase& listeningEntity);
+
+        /**
+         * @fn  virtual void SystemManager::SetEntityPosition(EntityBase& entity, const trBase::Vec3& position);
+         *
+         * @brief   Publishes the position of an entity to the spatial index. The position is used by
+         *          queries and area of interest registrations after the next UpdateSpatialIndex.
+         *
+         * @param [in,out]  entity      The entity.
+         * @param           position    The position.
+         */
+        virtual void SetEntityPosition(EntityBase& entity, const trBase::Vec3& position);
+
+        /**
+         * @fn  virtual void SystemManager::RemoveEntityPosition(EntityBase& entity);
+         *
+         * @brief   Removes the published position of an entity.
+         *
+         * @param [in,out]  entity  The entity.
+         */
+        virtual void RemoveEntityPosition(EntityBase& entity);
+
+        /**
+         * @fn  void SystemManager::SetSpatialIndex(trManager::SpatialIndex& spatialIndex);
+         *
+         * @brief   Replaces the structure that indexes the entity positions, for example with a
+         *          SpatialIndexOctree when the entities are clustered. The published positions are
+         *          moved into the new index. A SpatialIndexGrid is used by default.
+         *
+         * @param [in,out]  spatialIndex    The spatial index.
+         */
+        void SetSpatialIndex(trManager::SpatialIndex& spatialIndex);
+
+        /**
+         * @fn  const trManager::SpatialIndex& SystemManager::GetSpatialIndex() const;
+         *
+         * @brief   Returns the published entity positions, for proximity queries.
+         *
+         * @return  The spatial index.
+         */
+        const trManager::SpatialIndex& GetSpatialIndex() const;
+
+        /**
+         * @fn  virtual void SystemManager::UpdateSpatialIndex();
+         *
+         * @brief   Applies the positions published during the frame in one batch, and refreshes which
+         *          entities are inside each area of interest. Called once per frame by the system
+         *          director.
+         */
+        virtual void UpdateSpatialIndex();
+
         /**
          * @fn  virtual bool SystemManager::RegisterActor(trManager::EntityBase& actor);
          *
@@ -200,6 +495,30 @@ namespace trManager
          */
         virtual bool UnregisterAllActors();
 
+        /**
+         * @fn  virtual void SystemManager::SetTickRate(trManager::EntityBase& actor, unsigned int framesPerTick);
+         *
+         * @brief   Sets how often an Actor or Actor Module receives the Tick message. Less important
+         *          actors can be ticked every Nth frame, and their Tick will carry the time accumulated
+         *          since their last one. Actors with the same rate are spread evenly across frames. Can
+         *          be changed at runtime.
+         *
+         * @param [in,out]  actor           The actor.
+         * @param           framesPerTick   Number of frames between Ticks. 1 ticks the actor every frame.
+         */
+        virtual void SetTickRate(trManager::EntityBase& actor, unsigned int framesPerTick);
+
+        /**
+         * @fn  virtual unsigned int SystemManager::GetTickRate(trManager::EntityBase& actor) const;
+         *
+         * @brief   Returns the number of frames between the Ticks of the given Actor or Actor Module.
+         *
+         * @param [in,out]  actor   The actor.
+         *
+         * @return  The tick rate.
+         */
+        virtual unsigned int GetTickRate(trManager::EntityBase& actor) const;
+
         /**
          * @fn  virtual trManager::EntityBase* SystemManager::FindActor(const trBase::UniqueId& id);
          *
@@ -330,15 +649,6 @@ namespace trManager
 
     protected:
 
-        /**
-         * @fn  SystemManager::SystemManager(const std::string name = CLASS_TYPE);
-         *
-         * @brief   Ctor.
-         *
-         * @param   name    (Optional) The name.
-         */
-        SystemManager(const std::string name = CLASS_TYPE);
-
         /**
          * @fn  SystemManager::~SystemManager();
          *
@@ -420,11 +730,45 @@ namespace trManager
          */
         virtual void UnregisterEntityFromAboutMessages(trManager::EntityBase& listeningEntity);
 
+        /**
+         * @fn  virtual void SystemManager::ProcessQueuedMessages(bool useBudget);
+         *
+         * @brief   Sends out the queued messages, highest priority class first.
+         *
+         * @param   useBudget   True to stop sending messages below the SYSTEM priority class once
+         *                      the message time budget is used up.
+         */
+        virtual void ProcessQueuedMessages(bool useBudget);
+
     private:
 
         static trBase::SmrtPtr<trManager::SystemManager> mInstance;
-        std::queue<trBase::SmrtPtr<const trManager::MessageBase>> mMessageQueue;
-        std::queue<trBase::SmrtPtr<const trManager::MessageBase>> mNetworkMessageQueue;
+
+        //Message queues, one per message priority class, indexed by the priority ID
+        using MessageQueue = std::queue<trBase::SmrtPtr<const trManager::MessageBase>>;
+        std::vector<MessageQueue> mMessageQueues;
+        MessageQueue mNetworkMessageQueue;
+
+        //Message time budget and deferred message statistics
+        trUtil::Timer mBudgetTimer;
+        double mMessageTimeBudget = 0.0;
+        double mMessageTimeUsed = 0.0;
+        bool mBudgetExhausted = false;
+        unsigned int mDeferredMessageCount = 0;
+        unsigned int mPeakDeferredMessageCount = 0;
+        unsigned long long mTotalDeferredMessages = 0;
+        unsigned long long mDeferredFrameCount = 0;
+        unsigned long long mProcessedMessageCount = 0;
+        bool mSuppressSentMessages = false;
+        unsigned long long mSuppressedMessageCount = 0;
+
+        //Engine metrics, published through the global trUtil::Metrics::MetricsRegistry
+        using MessageCounterMap = trUtil::HashMap<std::string, trUtil::Metrics::Counter*>;
+        MessageCounterMap mMessageCounters;                                             //Processed messages, per message type
+        std::string mMetricsWorldId;                                                    //World ID label, fixed at construction
+        trUtil::Metrics::Counter* mDeferredMessageCounter = nullptr;
+        trUtil::Metrics::Gauge* mMessageBacklogGauge = nullptr;
+        trUtil::Metrics::Gauge* mActorCountGauge = nullptr;
 
         // Storage for all the registered Directors       
         using DirectorList = std::list<trBase::SmrtPtr<trManager::EntityBase>>;           //Needs to be a std::list so the directors can be priority sorted 
@@ -443,6 +787,8 @@ namespace trManager
         MessageRegistrationVectorMap mEntityGlobalMsgRegistrationMap;
         MessageRegistrationMap mDirectorGlobalMsgRegistrationMap;
         UUIDRegistrationVectorMap mListenerRegistrationMap;
+        unsigned int mListenerWalkDepth = 0;                                            //Number of SendMessageToListeners walks in progress
+        bool mHasRemovedAboutListeners = false;                                         //About entity registrations were removed during a walk
         
         //Storage for all registered Actors and Actor Modules
         using ActorList = std::vector<trBase::SmrtPtr<trManager::EntityBase>>;
@@ -450,6 +796,14 @@ namespace trManager
         ActorList mActorList;
         ActorIDMap mActorIDMap; 
 
+        trBase::ObsrvrPtr<trManager::JournalRecorder> mJournalRecorder;                //Records all processed messages, if attached
+        trBase::ObsrvrPtr<trManager::NetworkDirector> mNetworkDirector;                //Sends the network messages to remote worlds, if attached
+        trManager::TimingStructure mTimingStructure;                                   //Timing of the current frame
+
+        TickScheduler mTickScheduler;                                                   //Level of detail scheduling for the Tick message
+        trBase::SmrtPtr<SpatialIndex> mSpatialIndex;                                    //Published entity positions
+        InterestManager mInterestManager;                                               //Area of interest registrations for about messages
+
         std::vector<trBase::SmrtPtr<trManager::EntityBase>> mEntityDeleteList;         //List of entities that will be deleted at the end of the frame
 
         /**
@@ -464,6 +818,40 @@ namespace trManager
          */
         void RegisterMsgWithMsgVectorMap(const std::string& messageType, EntityBase& listeningEntity, const std::string& invokableName, MessageRegistrationVectorMap& messageMap);
 
+        /**
+         * @fn  bool SystemManager::IsRegisteredAboutEntity(const trManager::EntityBase& listeningEntity, const std::string& invokableName, const std::vector<EntityInvokablePair>* listeners, size_t listenerCount);
+         *
+         * @brief   Checks if an entity and invokable are in the listener list of an about entity
+         *          registration, so an area registration does not send the same message to the
+         *          same invokable twice.
+         *
+         * @param   listeningEntity The listening entity.
+         * @param   invokableName   Name of the invokable.
+         * @param   listeners       The about entity listeners the message was sent to, or null.
+         * @param   listenerCount   The number of listeners the message was sent to.
+         *
+         * @return  True if the entity is registered, false if not.
+         */
+        bool IsRegisteredAboutEntity(const trManager::EntityBase& listeningEntity, const std::string& invokableName, const std::vector<EntityInvokablePair>* listeners, size_t listenerCount);
+
+        /**
+         * @fn  void SystemManager::RemoveAboutListener(std::vector<EntityInvokablePair>& listeners, size_t index);
+         *
+         * @brief   Removes an about entity registration. While SendMessageToListeners walks the
+         *          registrations, the entity is only cleared, and the entry is erased after the walk.
+         *
+         * @param [in,out]  listeners   The about entity listeners.
+         * @param           index       The index of the registration.
+         */
+        void RemoveAboutListener(std::vector<EntityInvokablePair>& listeners, size_t index);
+
+        /**
+         * @fn  void SystemManager::EraseRemovedAboutListeners();
+         *
+         * @brief   Erases the about entity registrations that were removed during a walk.
+         */
+        void EraseRemovedAboutListeners();
+
         /**
          * @fn  void SystemManager::UnregisterMsgFromMsgVectorMap(const std::string& messageType, EntityBase& listeningEntity, MessageRegistrationVectorMap& messageMap);
          *
@@ -0,0 +1,144 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include "Export.h"
+
+#include <trManager/MessageTick.h>
+#include <trManager/TimingStructure.h>
+#include <trUtil/HashMap.h>
+#include <trBase/UniqueId.h>
+#include <trBase/SmrtPtr.h>
+
+namespace trManager
+{
+    /**
+     * @class   TickScheduler
+     *
+     * @brief   Level of detail scheduler for the Tick message. Entities can be given a tick rate, which
+     *          makes them receive a Tick only every Nth frame. Entities that share a tick rate are
+     *          spread across round-robin buckets, so the load is even across frames. A scheduled Tick
+     *          carries the delta times accumulated since the entities last Tick. Entities without a
+     *          tick rate get a Tick every frame.
+     */
+    class TR_MANAGER_EXPORT TickScheduler
+    {
+    public:
+
+        /**
+         * @fn  TickScheduler::TickScheduler();
+         *
+         * @brief   Default constructor.
+         */
+        TickScheduler();
+
+        /**
+         * @fn  TickScheduler::~TickScheduler();
+         *
+         * @brief   Destructor.
+         */
+        ~TickScheduler();
+
+        /**
+         * @fn  void TickScheduler::SetTickRate(const trBase::UniqueId& id, unsigned int framesPerTick);
+         *
+         * @brief   Sets how often an entity receives the Tick message. Can be changed at any time; time
+         *          that was accumulated up to the change is kept.
+         *
+         * @param   id              The entities identifier.
+         * @param   framesPerTick   Number of frames between Ticks. 1 or 0 ticks the entity every frame.
+         */
+        void SetTickRate(const trBase::UniqueId& id, unsigned int framesPerTick);
+
+        /**
+         * @fn  unsigned int TickScheduler::GetTickRate(const trBase::UniqueId& id) const;
+         *
+         * @brief   Returns the number of frames between the Ticks of the given entity.
+         *
+         * @param   id  The entities identifier.
+         *
+         * @return  The tick rate. 1 if the entity ticks every frame.
+         */
+        unsigned int GetTickRate(const trBase::UniqueId& id) const;
+
+        /**
+         * @fn  void TickScheduler::RemoveEntity(const trBase::UniqueId& id);
+         *
+         * @brief   Removes the entity from the scheduler, returning it to a Tick every frame.
+         *
+         * @param   id  The entities identifier.
+         */
+        void RemoveEntity(const trBase::UniqueId& id);
+
+        /**
+         * @fn  void TickScheduler::Clear();
+         *
+         * @brief   Removes all the entities from the scheduler.
+         */
+        void Clear();
+
+        /**
+         * @fn  bool TickScheduler::IsEmpty() const;
+         *
+         * @brief   Returns true if no entity has a tick rate set.
+         *
+         * @return  True if empty, false if not.
+         */
+        bool IsEmpty() const;
+
+        /**
+         * @fn  const trManager::MessageTick* TickScheduler::Schedule(const trManager::MessageTick& tick, const trBase::UniqueId& id);
+         *
+         * @brief   Accumulates the frame time of the passed in Tick for the given entity, and returns
+         *          the Tick the entity should receive this frame. This is for system use only, and
+         *          is called for each entity that listens for the Tick. Calling it again with the
+         *          same Tick returns the same result without accumulating the time again, so an
+         *          entity is scheduled once per Tick however many invokables it registered.
+         *
+         * @param   tick    The frames Tick message.
+         * @param   id      The entities identifier.
+         *
+         * @return  Null if the entity skips this frame, the passed in tick if the entity is not
+         *          scheduled, else a Tick holding the accumulated time since the entities last Tick.
+         */
+        const trManager::MessageTick* Schedule(const trManager::MessageTick& tick, const trBase::UniqueId& id);
+
+    private:
+
+        //Holds the scheduling state of a single entity
+        struct TickEntry
+        {
+            unsigned int framesPerTick = 1;
+            unsigned int bucket = 0;
+            bool ticked = false;
+            const trManager::MessageTick* lastTick = nullptr;     //The last scheduled Tick, and its frame
+            int lastFrame = 0;
+            trManager::TimingStructure timeStruct;
+            trBase::SmrtPtr<trManager::MessageTick> tickMessage;
+        };
+
+        using TickEntryMap = trUtil::HashMap<const trBase::UniqueId, TickEntry>;
+        using BucketCounterMap = trUtil::HashMap<unsigned int, unsigned int>;  //<framesPerTick, next bucket>
+        TickEntryMap mTickEntryMap;
+        BucketCounterMap mNextBucketMap;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <trManager/ActorBase.h>
+#include <trUtil/RefStr.h>
+
+#include <string>
+
+namespace trStart
+{
+    /**
+     * @class   LoadActor
+     *
+     * @brief   A synthetic actor used by the batch runner to put load on the system. On every Tick it
+     *          does a configurable amount of busy work, and sends a configurable number of messages.
+     */
+    class LoadActor : public trManager::ActorBase
+    {
+    public:
+        using BaseClass = trManager::ActorBase;             /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        /**
+         * @fn  LoadActor::LoadActor(const std::string& name = CLASS_TYPE);
+         *
+         * @brief   Constructor.
+         *
+         * @param   name    (Optional) The name.
+         */
+        LoadActor(const std::string& name = CLASS_TYPE);
+
+        /**
+         * @fn  virtual const std::string& LoadActor::GetType() const override
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override { return CLASS_TYPE; }
+
+        /**
+         * @fn  virtual void LoadActor::OnTick(const trManager::MessageBase& msg) override;
+         *
+         * @brief   Does the busy work and sends out the load messages.
+         *
+         * @param   msg The message.
+         */
+        virtual void OnTick(const trManager::MessageBase& msg) override;
+
+        /**
+         * @fn  virtual void LoadActor::OnAddedToSysMan() override;
+         *
+         * @brief   Registers for the Tick message.
+         */
+        virtual void OnAddedToSysMan() override;
+
+        /**
+         * @fn  void LoadActor::SetWorkUnits(unsigned int workUnits);
+         *
+         * @brief   Sets the number of busy work iterations done on every Tick.
+         *
+         * @param   workUnits   The work units.
+         */
+        void SetWorkUnits(unsigned int workUnits);
+
+        /**
+         * @fn  void LoadActor::SetMessagesPerTick(unsigned int messagesPerTick);
+         *
+         * @brief   Sets the number of MessageLoad messages sent on every Tick.
+         *
+         * @param   messagesPerTick The messages per tick.
+         */
+        void SetMessagesPerTick(unsigned int messagesPerTick);
+
+    protected:
+
+        /**
+         * @fn  LoadActor::~LoadActor();
+         *
+         * @brief   Destructor.
+         */
+        ~LoadActor();
+
+    private:
+
+        unsigned int mWorkUnits = 0;
+        unsigned int mMessagesPerTick = 0;
+        double mWorkResult = 0.;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <trManager/DirectorBase.h>
+#include <trUtil/RefStr.h>
+
+#include <string>
+
+namespace trStart
+{
+    /**
+     * @class   LoadDirector
+     *
+     * @brief   A synthetic director used by the batch runner. Directors receive every message in the
+     *          system, so this one simply counts what passes through it.
+     */
+    class LoadDirector : public trManager::DirectorBase
+    {
+    public:
+        using BaseClass = trManager::DirectorBase;          /// Adds an easy and swappable access to the base class
+
+        const static trUtil::RefStr CLASS_TYPE;             /// Holds the class type name for efficient comparisons
+
+        /**
+         * @fn  LoadDirector::LoadDirector(const std::string& name = CLASS_TYPE);
+         *
+         * @brief   Constructor.
+         *
+         * @param   name    (Optional) The name.
+         */
+        LoadDirector(const std::string& name = CLASS_TYPE);
+
+        /**
+         * @fn  virtual const std::string& LoadDirector::GetType() const override
+         *
+         * @brief   Gets the class type.
+         *
+         * @return  The type.
+         */
+        virtual const std::string& GetType() const override { return CLASS_TYPE; }
+
+        /**
+         * @fn  virtual void LoadDirector::OnMessage(const trManager::MessageBase& msg) override;
+         *
+         * @brief   Counts the received message.
+         *
+         * @param   msg The message.
+         */
+        virtual void OnMessage(const trManager::MessageBase& msg) override;
+
+        /**
+         * @fn  unsigned long long LoadDirector::GetMessageCount() const;
+         *
+         * @brief   Returns the number of messages this director received.
+         *
+         * @return  The message count.
+         */
+        unsigned long long GetMessageCount() const;
+
+    protected:
+
+        /**
+         * @fn  LoadDirector::~LoadDirector();
+         *
+         * @brief   Destructor.
+         */
+        ~LoadDirector();
+
+    private:
+
+        unsigned long long mMessageCount = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <trCore/SystemDirector.h>
+#include <trManager/SystemManager.h>
+#include <trManager/EntityBase.h>
+#include <trUtil/JSON/Object.h>
+#include <trBase/SmrtPtr.h>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <map>
+
+namespace trStart
+{
+    /**
+     * @class   ScenarioRunner
+     *
+     * @brief   A headless batch runner. Loads a scenario of Actors and Directors from a JSON file into
+     *          its own System Manager world, and drives the System Director with a fixed, synthetic
+     *          time step as fast as possible for a number of frames or sim seconds. Used for batch
+     *          runs and as a repeatable performance harness.
+     */
+    class ScenarioRunner
+    {
+    public:
+
+        const static std::string FRAMES_KEY;                /// Number of frames to run
+        const static std::string SIM_SECONDS_KEY;           /// Number of sim seconds to run
+        const static std::string FIXED_DELTA_TIME_KEY;      /// Synthetic frame time in seconds
+        const static std::string MESSAGE_TIME_BUDGET_KEY;   /// System Manager message time budget in seconds
+        const static std::string DIRECTORS_KEY;             /// Array of Director descriptions
+        const static std::string ACTORS_KEY;                /// Array of Actor descriptions
+        const static std::string TYPE_KEY;                  /// Registered entity type to create
+        const static std::string NAME_KEY;                  /// Entity name
+        const static std::string COUNT_KEY;                 /// Number of entities to create from one description
+        const static std::string PRIORITY_KEY;              /// Director priority name
+        const static std::string TICK_RATE_KEY;             /// Actor tick rate in frames per tick
+
+        const static double DEFAULT_FIXED_DELTA_TIME;       /// Default synthetic frame time (60Hz)
+        const static unsigned int DEFAULT_FRAMES;           /// Default frame count, if no limit is given
+
+        /** @brief   Creates an entity of a registered type from its name and JSON description. */
+        using EntityCreator = std::function<trManager::EntityBase*(const std::string& name, const trUtil::JSON::Object& settings)>;
+
+        /**
+         * @struct  Report
+         *
+         * @brief   The throughput results of a run.
+         */
+        struct Report
+        {
+            unsigned int frames = 0;
+            double realTime = 0.;
+            double simTime = 0.;
+            unsigned long long messages = 0;
+        };
+
+        /**
+         * @fn  ScenarioRunner::ScenarioRunner();
+         *
+         * @brief   Constructor. Creates the runners System Manager world and System Director, and
+         *          registers the built in LoadActor and LoadDirector types.
+         */
+        ScenarioRunner();
+
+        /**
+         * @fn  ScenarioRunner::~ScenarioRunner();
+         *
+         * @brief   Destructor. Shuts down the runners world.
+         */
+        ~ScenarioRunner();
+
+        /**
+         * @fn  void ScenarioRunner::RegisterEntityType(const std::string& type, EntityCreator creator);
+         *
+         * @brief   Registers a creator for an entity type, so the type can be used in scenario files.
+         *
+         * @param   type    The type name used in the scenario file.
+         * @param   creator The creator.
+         */
+        void RegisterEntityType(const std::string& type, EntityCreator creator);
+
+        /**
+         * @fn  bool ScenarioRunner::LoadScenario(const std::string& fileName);
+         *
+         * @brief   Loads a scenario file, and creates and registers all of its entities.
+         *
+         * @param   fileName    The scenario file name and path.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        bool LoadScenario(const std::string& fileName);
+
+        /**
+         * @fn  void ScenarioRunner::SetFrameLimit(unsigned int frames);
+         *
+         * @brief   Sets the number of frames to run. 0 removes the limit.
+         *
+         * @param   frames  The frames.
+         */
+        void SetFrameLimit(unsigned int frames);
+
+        /**
+         * @fn  void ScenarioRunner::SetSimTimeLimit(double seconds);
+         *
+         * @brief   Sets the number of sim seconds to run. 0 removes the limit.
+         *
+         * @param   seconds The seconds.
+         */
+        void SetSimTimeLimit(double seconds);
+
+        /**
+         * @fn  void ScenarioRunner::SetRunLimits(unsigned int frames, double seconds);
+         *
+         * @brief   Replaces both the frame and the sim time limit, so a limit given on its own does
+         *          not run into the other limit of the scenario file. 0 removes a limit.
+         *
+         * @param   frames  The frames.
+         * @param   seconds The sim seconds.
+         */
+        void SetRunLimits(unsigned int frames, double seconds);
+
+        /**
+         * @fn  void ScenarioRunner::SetFixedDeltaTime(double dt);
+         *
+         * @brief   Sets the synthetic frame time.
+         *
+         * @param   dt  The frame time in seconds.
+         */
+        void SetFixedDeltaTime(double dt);
+
+        /**
+         * @fn  Report ScenarioRunner::Run();
+         *
+         * @brief   Runs the loaded scenario until the frame or sim time limit is reached. If no limit
+         *          is set, DEFAULT_FRAMES are run.
+         *
+         * @return  The throughput report.
+         */
+        Report Run();
+
+        /**
+         * @fn  static void ScenarioRunner::PrintReport(const Report& report, std::ostream& stream);
+         *
+         * @brief   Prints out the report with frames/s, sim time to real time ratio and messages/s.
+         *
+         * @param           report  The report.
+         * @param [in,out]  stream  The stream to print to.
+         */
+        static void PrintReport(const Report& report, std::ostream& stream);
+
+    private:
+
+        /**
+         * @fn  bool ScenarioRunner::CreateEntities(const trUtil::JSON::Object& settings, bool isDirector);
+         *
+         * @brief   Creates and registers the entities of a single scenario description.
+         *
+         * @param   settings    The entity description.
+         * @param   isDirector  True if the entities are Directors.
+         *
+         * @return  True if it succeeds, false if it fails.
+         */
+        bool CreateEntities(const trUtil::JSON::Object& settings, bool isDirector);
+
+        trBase::SmrtPtr<trManager::SystemManager> mSysMan;
+        trBase::SmrtPtr<trCore::SystemDirector> mSysDirector;
+        std::map<std::string, EntityCreator> mEntityCreators;
+
+        unsigned int mFrameLimit = 0;
+        double mSimTimeLimit = 0.;
+    };
+}
\ No newline at end of file
@@ -29,8 +29,10 @@
 #pragma once
 #include <trUtil/Export.h>
 
+#include <trUtil/TypeConfig.h>
 #include <trUtil/Logging/LogFile.h>
 #include <trUtil/Logging/LogLevel.h>
+#include <trUtil/Logging/LogRateLimiter.h>
 
 #include <string>
 #include <cstdarg>
@@ -59,22 +61,71 @@ namespace trUtil
  */
 #define TR_LOG_SOURCE __FILE__, __FUNCTION__, __LINE__
 
+/**
+ * @def TR_LOG_COMPILE_LEVEL
+ *
+ * @brief   Log macros below this level are compiled out, together with the evaluation of their
+ *          arguments: 0 - Debug, 1 - Info, 2 - Warning, 3 - Error, 4 - Always. Set with the
+ *          TR_LOG_COMPILE_LEVEL CMake option, or define it before including this header.
+ */
+#ifndef TR_LOG_COMPILE_LEVEL
+#define TR_LOG_COMPILE_LEVEL 0
+#endif
+
 /**
  * @def LOG_FULL(level, name, msg)
  *
- * @brief   Logging macro to make error recording esier.
+ * @brief   Logging macro to make error recording esier. The Log instance is looked up once per
+ *          call site and kept in a function local static, so the name has to be the same every
+ *          time the line runs. Use LOG_FULL_DYNAMIC if it changes. Log instances are never
+ *          deleted, so the cached reference stays valid during static destruction.
  *
  * @param   level   - Level of Logging (ERROR, WARNING, etc)
  * @param   name    - Name of the Log file.
  * @param   msg     - Message to log.
  */
 #define LOG_FULL(level, name, msg) \
+        {\
+        static trUtil::Logging::Log& logger = trUtil::Logging::Log::GetInstance(name); \
+        if (logger.IsLevelEnabled(level)) \
+        logger.LogMessage(TR_LOG_SOURCE, msg, level); \
+        }\
+
+/**
+ * @def LOG_FULL_DYNAMIC(level, name, msg)
+ *
+ * @brief   Same as LOG_FULL, but looks up the Log instance every time, for names that change
+ *          from call to call.
+ *
+ * @param   level   - Level of Logging (ERROR, WARNING, etc)
+ * @param   name    - Name of the Log file.
+ * @param   msg     - Message to log.
+ */
+#define LOG_FULL_DYNAMIC(level, name, msg) \
         {\
         trUtil::Logging::Log& logger = trUtil::Logging::Log::GetInstance(name); \
         if (logger.IsLevelEnabled(level)) \
         logger.LogMessage(TR_LOG_SOURCE, msg, level); \
         }\
 
+/**
+ * @def LOG_STRIPPED(name, msg)
+ *
+ * @brief   What a log macro below TR_LOG_COMPILE_LEVEL turns into. The arguments still have to
+ *          compile, so stripped builds do not break, but they are never evaluated.
+ *
+ * @param   name    - Name of the Log file.
+ * @param   msg     - Message to log.
+ */
+#define LOG_STRIPPED(name, msg) \
+        {\
+        if (false) \
+        { \
+        (void)(name); \
+        (void)(msg); \
+        } \
+        }\
+
 /**
  * @def LOGN_D(name, msg)
  *
@@ -83,7 +134,11 @@ namespace trUtil
  * @param   name    - Log File Name.
  * @param   msg     - Message to log.
  */
+#if TR_LOG_COMPILE_LEVEL <= 0
 #define LOGN_D(name, msg) LOG_FULL(trUtil::Logging::LogLevel::LOG_DEBUG, name, msg)
+#else
+#define LOGN_D(name, msg) LOG_STRIPPED(name, msg)
+#endif
 
 /**
  * @def LOGN_I(name, msg)
@@ -93,7 +148,11 @@ namespace trUtil
  * @param   name    - Log File Name.
  * @param   msg     - Message to log.
  */
+#if TR_LOG_COMPILE_LEVEL <= 1
 #define LOGN_I(name, msg) LOG_FULL(trUtil::Logging::LogLevel::LOG_INFO, name, msg)
+#else
+#define LOGN_I(name, msg) LOG_STRIPPED(name, msg)
+#endif
 
 /**
  * @def LOGN_W(name, msg)
@@ -103,7 +162,11 @@ namespace trUtil
  * @param   name    - Log File Name.
  * @param   msg     - Message to log.
  */
+#if TR_LOG_COMPILE_LEVEL <= 2
 #define LOGN_W(name, msg) LOG_FULL(trUtil::Logging::LogLevel::LOG_WARNING, name, msg)
+#else
+#define LOGN_W(name, msg) LOG_STRIPPED(name, msg)
+#endif
 
 /**
  * @def LOGN_E(name, msg)
@@ -113,7 +176,11 @@ namespace trUtil
  * @param   name    - Log File Name.
  * @param   msg     - Message to log.
  */
+#if TR_LOG_COMPILE_LEVEL <= 3
 #define LOGN_E(name, msg) LOG_FULL(trUtil::Logging::LogLevel::LOG_ERROR, name, msg)
+#else
+#define LOGN_E(name, msg) LOG_STRIPPED(name, msg)
+#endif
 
 /**
  * @def LOGN_A(name, msg)
@@ -170,6 +237,179 @@ namespace trUtil
  */
 #define LOG_A(msg) LOGN_A(trUtil::Logging::Log::LOG_DEFAULT_NAME, msg)
 
+/**
+ * @def LOG_FULL_RATE_LIMITED(level, name, maxPerSecond, msg)
+ *
+ * @brief   Same as LOG_FULL, but lets through at most maxPerSecond messages per second from this
+ *          call site. The next message that gets through notes how many were suppressed, or a
+ *          summary is written once the second is over if none does.
+ *
+ * @param   level           - Level of Logging (ERROR, WARNING, etc)
+ * @param   name            - Name of the Log file.
+ * @param   maxPerSecond    - Maximum number of messages per second.
+ * @param   msg             - Message to log.
+ */
+#define LOG_FULL_RATE_LIMITED(level, name, maxPerSecond, msg) \
+        {\
+        static trUtil::Logging::Log& logger = trUtil::Logging::Log::GetInstance(name); \
+        static trUtil::Logging::LogRateLimiter rateLimiter(maxPerSecond, logger, level, TR_LOG_SOURCE); \
+        unsigned long long suppressedCount = 0; \
+        if (logger.IsLevelEnabled(level) && rateLimiter.Allow(suppressedCount)) \
+        logger.LogMessage(TR_LOG_SOURCE, trUtil::Logging::LogRateLimiter::AddSuppressedNote(msg, suppressedCount), level); \
+        }\
+
+/**
+ * @def LOG_FULL_SAMPLED(level, name, sampleRate, msg)
+ *
+ * @brief   Same as LOG_FULL, but only logs one of every sampleRate messages from this call site.
+ *          The logged message notes how many were skipped.
+ *
+ * @param   level       - Level of Logging (ERROR, WARNING, etc)
+ * @param   name        - Name of the Log file.
+ * @param   sampleRate  - Log one of every sampleRate messages.
+ * @param   msg         - Message to log.
+ */
+#define LOG_FULL_SAMPLED(level, name, sampleRate, msg) \
+        {\
+        static trUtil::Logging::Log& logger = trUtil::Logging::Log::GetInstance(name); \
+        static trUtil::Logging::LogSampler sampler(sampleRate); \
+        unsigned long long suppressedCount = 0; \
+        if (logger.IsLevelEnabled(level) && sampler.Allow(suppressedCount)) \
+        logger.LogMessage(TR_LOG_SOURCE, trUtil::Logging::LogRateLimiter::AddSuppressedNote(msg, suppressedCount), level); \
+        }\
+
+/**
+ * @def LOG_D_RATE(maxPerSecond, msg)
+ *
+ * @brief   Log a DEBUG message, at most maxPerSecond times per second from this call site.
+ *
+ * @param   maxPerSecond    - Maximum number of messages per second.
+ * @param   msg             - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 0
+#define LOG_D_RATE(maxPerSecond, msg) LOG_FULL_RATE_LIMITED(trUtil::Logging::LogLevel::LOG_DEBUG, trUtil::Logging::Log::LOG_DEFAULT_NAME, maxPerSecond, msg)
+#else
+#define LOG_D_RATE(maxPerSecond, msg) LOG_STRIPPED(maxPerSecond, msg)
+#endif
+
+/**
+ * @def LOG_D_EVERY_N(sampleRate, msg)
+ *
+ * @brief   Log a DEBUG message, once for every sampleRate times this call site is reached.
+ *
+ * @param   sampleRate  - Log one of every sampleRate messages.
+ * @param   msg         - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 0
+#define LOG_D_EVERY_N(sampleRate, msg) LOG_FULL_SAMPLED(trUtil::Logging::LogLevel::LOG_DEBUG, trUtil::Logging::Log::LOG_DEFAULT_NAME, sampleRate, msg)
+#else
+#define LOG_D_EVERY_N(sampleRate, msg) LOG_STRIPPED(sampleRate, msg)
+#endif
+
+/**
+ * @def LOG_I_RATE(maxPerSecond, msg)
+ *
+ * @brief   Log an INFO message, at most maxPerSecond times per second from this call site.
+ *
+ * @param   maxPerSecond    - Maximum number of messages per second.
+ * @param   msg             - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 1
+#define LOG_I_RATE(maxPerSecond, msg) LOG_FULL_RATE_LIMITED(trUtil::Logging::LogLevel::LOG_INFO, trUtil::Logging::Log::LOG_DEFAULT_NAME, maxPerSecond, msg)
+#else
+#define LOG_I_RATE(maxPerSecond, msg) LOG_STRIPPED(maxPerSecond, msg)
+#endif
+
+/**
+ * @def LOG_I_EVERY_N(sampleRate, msg)
+ *
+ * @brief   Log an INFO message, once for every sampleRate times this call site is reached.
+ *
+ * @param   sampleRate  - Log one of every sampleRate messages.
+ * @param   msg         - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 1
+#define LOG_I_EVERY_N(sampleRate, msg) LOG_FULL_SAMPLED(trUtil::Logging::LogLevel::LOG_INFO, trUtil::Logging::Log::LOG_DEFAULT_NAME, sampleRate, msg)
+#else
+#define LOG_I_EVERY_N(sampleRate, msg) LOG_STRIPPED(sampleRate, msg)
+#endif
+
+/**
+ * @def LOG_W_RATE(maxPerSecond, msg)
+ *
+ * @brief   Log a WARNING message, at most maxPerSecond times per second from this call site.
+ *
+ * @param   maxPerSecond    - Maximum number of messages per second.
+ * @param   msg             - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 2
+#define LOG_W_RATE(maxPerSecond, msg) LOG_FULL_RATE_LIMITED(trUtil::Logging::LogLevel::LOG_WARNING, trUtil::Logging::Log::LOG_DEFAULT_NAME, maxPerSecond, msg)
+#else
+#define LOG_W_RATE(maxPerSecond, msg) LOG_STRIPPED(maxPerSecond, msg)
+#endif
+
+/**
+ * @def LOG_W_EVERY_N(sampleRate, msg)
+ *
+ * @brief   Log a WARNING message, once for every sampleRate times this call site is reached.
+ *
+ * @param   sampleRate  - Log one of every sampleRate messages.
+ * @param   msg         - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 2
+#define LOG_W_EVERY_N(sampleRate, msg) LOG_FULL_SAMPLED(trUtil::Logging::LogLevel::LOG_WARNING, trUtil::Logging::Log::LOG_DEFAULT_NAME, sampleRate, msg)
+#else
+#define LOG_W_EVERY_N(sampleRate, msg) LOG_STRIPPED(sampleRate, msg)
+#endif
+
+/**
+ * @def LOG_E_RATE(maxPerSecond, msg)
+ *
+ * @brief   Log an ERROR message, at most maxPerSecond times per second from this call site.
+ *
+ * @param   maxPerSecond    - Maximum number of messages per second.
+ * @param   msg             - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 3
+#define LOG_E_RATE(maxPerSecond, msg) LOG_FULL_RATE_LIMITED(trUtil::Logging::LogLevel::LOG_ERROR, trUtil::Logging::Log::LOG_DEFAULT_NAME, maxPerSecond, msg)
+#else
+#define LOG_E_RATE(maxPerSecond, msg) LOG_STRIPPED(maxPerSecond, msg)
+#endif
+
+/**
+ * @def LOG_E_EVERY_N(sampleRate, msg)
+ *
+ * @brief   Log an ERROR message, once for every sampleRate times this call site is reached.
+ *
+ * @param   sampleRate  - Log one of every sampleRate messages.
+ * @param   msg         - Message to log.
+ */
+#if TR_LOG_COMPILE_LEVEL <= 3
+#define LOG_E_EVERY_N(sampleRate, msg) LOG_FULL_SAMPLED(trUtil::Logging::LogLevel::LOG_ERROR, trUtil::Logging::Log::LOG_DEFAULT_NAME, sampleRate, msg)
+#else
+#define LOG_E_EVERY_N(sampleRate, msg) LOG_STRIPPED(sampleRate, msg)
+#endif
+
+/**
+ * @def LOG_A_RATE(maxPerSecond, msg)
+ *
+ * @brief   Log an ALWAYS message, at most maxPerSecond times per second from this call site.
+ *
+ * @param   maxPerSecond    - Maximum number of messages per second.
+ * @param   msg             - Message to log.
+ */
+#define LOG_A_RATE(maxPerSecond, msg) LOG_FULL_RATE_LIMITED(trUtil::Logging::LogLevel::LOG_ALWAYS, trUtil::Logging::Log::LOG_DEFAULT_NAME, maxPerSecond, msg)
+
+/**
+ * @def LOG_A_EVERY_N(sampleRate, msg)
+ *
+ * @brief   Log an ALWAYS message, once for every sampleRate times this call site is reached.
+ *
+ * @param   sampleRate  - Log one of every sampleRate messages.
+ * @param   msg         - Message to log.
+ */
+#define LOG_A_EVERY_N(sampleRate, msg) LOG_FULL_SAMPLED(trUtil::Logging::LogLevel::LOG_ALWAYS, trUtil::Logging::Log::LOG_DEFAULT_NAME, sampleRate, msg)
+
 /**
  * @def LOG_PRINT_TEST
  *
@@ -209,6 +449,20 @@ namespace trUtil
              */
             void LogMessage(const std::string& cppFile, const std::string& method, int line, const std::string& msg, LogLevel logLevel) const;
 
+            /**
+             * @fn  void Log::LogMessage(const char* cppFile, const char* method, int line, const std::string& msg, LogLevel logLevel) const;
+             *
+             * @brief   Logs a time-stamped message. Used by the logging macros. The file and method
+             *          have to be string literals, in asynchronous mode only the pointers are queued.
+             *
+             * @param   cppFile     The source file name which generated this message.
+             * @param   method      The calling method which generated this message.
+             * @param   line        The source code line number.
+             * @param   msg         The message to display.
+             * @param   logLevel    Level of message being displayed. (error,warning,info, etc)
+             */
+            void LogMessage(const char* cppFile, const char* method, int line, const std::string& msg, LogLevel logLevel) const;
+
             /**
              * @fn  void Log::LogMessage(LogLevel logLevel, const std::string& source, int line, const char* msg, ...) const;
              *
@@ -435,6 +689,53 @@ namespace trUtil
                 STANDARD = TO_FILE | TO_CONSOLE | TO_WRITER ///<The default setting
             };
 
+            /**
+             * @enum    AsyncOverflowPolicy
+             *
+             * @brief   What a thread does when its asynchronous log queue is full.
+             */
+            enum AsyncOverflowPolicy
+            {
+                ASYNC_DROP = 0, ///<The message is dropped, the writer reports how many were lost
+                ASYNC_BLOCK     ///<The thread waits until the writer makes room
+            };
+
+            /** @brief   The default number of messages each thread can queue in asynchronous mode. */
+            static const size_t DEFAULT_ASYNC_QUEUE_SIZE = 4096;
+
+            /**
+             * @fn  static void Log::SetAsync(bool async, AsyncOverflowPolicy policy = ASYNC_DROP, size_t queueSize = DEFAULT_ASYNC_QUEUE_SIZE, bool installCrashHandlers = true);
+             *
+             * @brief   Switches all logs between synchronous and asynchronous output. In asynchronous
+             *          mode a logging thread only copies the message into its own lock free queue, and
+             *          a background thread does the formatting and the writing. Switch modes before
+             *          other threads start logging, the same as with creating log instances.
+             *
+             * @param   async                   True to log asynchronously, false to flush and go back
+             *                                  to writing on the calling thread.
+             * @param   policy                  (Optional) What to do when a thread's queue is full.
+             * @param   queueSize               (Optional) Number of messages each thread can queue.
+             * @param   installCrashHandlers    (Optional) True to flush the queue on std::terminate.
+             */
+            static void SetAsync(bool async, AsyncOverflowPolicy policy = ASYNC_DROP, size_t queueSize = DEFAULT_ASYNC_QUEUE_SIZE, bool installCrashHandlers = true);
+
+            /**
+             * @fn  static bool Log::IsAsync();
+             *
+             * @brief   Query if logging is asynchronous.
+             *
+             * @return  True if asynchronous, false if not.
+             */
+            static bool IsAsync();
+
+            /**
+             * @fn  static void Log::Flush();
+             *
+             * @brief   Writes the summaries of the rate limited call sites whose window is over, and
+             *          blocks until all queued messages are written.
+             */
+            static void Flush();
+
             /**
              * @fn  void Log::SetOutputStreamBit(unsigned int option);
              *
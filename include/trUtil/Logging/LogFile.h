@@ -59,6 +59,9 @@ namespace trUtil
             /** @brief   Log file default name. */
             static const std::string LOG_FILE_DEFAULT_NAME;
 
+            /** @brief   Log files with this extension are written in the compact binary format. */
+            static const std::string BINARY_FILE_EXTENSION;
+
             /**
              * @fn  static void LogFile::SetFileName(const std::string& name);
              *
@@ -77,6 +80,17 @@ namespace trUtil
              */
             static const std::string GetFileName();
 
+            /**
+             * @fn  static bool LogFile::IsBinary();
+             *
+             * @brief   Query if the log file is written in the binary format, which is selected by
+             *          giving the file name the BINARY_FILE_EXTENSION. Binary logs are turned into
+             *          HTML, text or JSON with the trLogView utility.
+             *
+             * @return  True if binary, false if HTML.
+             */
+            static bool IsBinary();
+
             /**
              * @fn  static void LogFile::SetTitle(const std::string& title);
              *
@@ -32,6 +32,8 @@
 #include <trUtil/HashMap.h>
 #include <trUtil/Logging/Log.h>
 #include <trUtil/Logging/LogWriter.h>
+#include <trUtil/Logging/LogQueue.h>
+#include <trUtil/Logging/LogWriterBinary.h>
 #include <trUtil/Logging/LogWriterFile.h>
 #include <trUtil/Logging/LogTimeProvider.h>
 
@@ -39,6 +41,7 @@
 #include <osg/ref_ptr>
 #include <osg/observer_ptr>
 
+#include <atomic>
 #include <string>
 
 /**
@@ -150,7 +153,8 @@ namespace trUtil
             /**
              * @fn  void LogManager::LogMessageToFile(const LogWriter::LogData& logData);
              *
-             * @brief   Write out a message to the Log file.
+             * @brief   Write out a message to the Log file, in HTML or in the binary format if the
+             *          file name has the LogFile::BINARY_FILE_EXTENSION.
              *
              * @param   logData Information describing the log.
              */
@@ -165,6 +169,69 @@ namespace trUtil
              */
             void LogMessageToConsole(const LogWriter::LogData& logData);
 
+            /**
+             * @fn  void LogManager::LogMessage(const Log& log, const LogWriter::LogData& logData);
+             *
+             * @brief   Sends a message to the file, console and custom writers, as selected by the
+             *          output stream bits of the log. The caller holds the manager mutex.
+             *
+             * @param   log     The log that sent the message.
+             * @param   logData Information describing the log.
+             */
+            void LogMessage(const Log& log, const LogWriter::LogData& logData);
+
+            /**
+             * @fn  void LogManager::FlushWriters();
+             *
+             * @brief   Flushes the file, console and all custom writers. Safe to call while other threads
+             *          add Log instances.
+             */
+            void FlushWriters();
+
+            /**
+             * @fn  void LogManager::StartLogQueue(unsigned int overflowPolicy, size_t queueSize);
+             *
+             * @brief   Switches to asynchronous logging. Restarts the queue if it is already running.
+             *
+             * @param   overflowPolicy  A Log::AsyncOverflowPolicy value.
+             * @param   queueSize       Number of messages each thread can queue.
+             */
+            void StartLogQueue(unsigned int overflowPolicy, size_t queueSize);
+
+            /**
+             * @fn  void LogManager::StopLogQueue();
+             *
+             * @brief   Writes out all queued messages and switches back to synchronous logging.
+             */
+            void StopLogQueue();
+
+            /**
+             * @fn  LogQueue* LogManager::GetLogQueue() const;
+             *
+             * @brief   Returns the asynchronous log queue. Only tells if logging is asynchronous, use
+             *          AcquireLogQueue to use the queue, as it can be stopped at any time.
+             *
+             * @return  Null if logging is synchronous, else the log queue.
+             */
+            LogQueue* GetLogQueue() const;
+
+            /**
+             * @fn  LogQueue* LogManager::AcquireLogQueue();
+             *
+             * @brief   Returns the asynchronous log queue, and keeps StopLogQueue from deleting it until
+             *          ReleaseLogQueue is called. ReleaseLogQueue has to be called even if this returns null.
+             *
+             * @return  Null if logging is synchronous, else the log queue.
+             */
+            LogQueue* AcquireLogQueue();
+
+            /**
+             * @fn  void LogManager::ReleaseLogQueue();
+             *
+             * @brief   Lets go of the log queue taken by AcquireLogQueue.
+             */
+            void ReleaseLogQueue();
+
             /**
              * @fn  void LogManager::SetLogTimeProvider(LogTimeProvider* ltp);
              *
@@ -207,10 +274,14 @@ namespace trUtil
             trUtil::HashMap<std::string, osg::ref_ptr<Log> > mInstances;
 
             osg::ref_ptr<LogWriterFile> mLogWriterFile; ///writes to file
+            osg::ref_ptr<LogWriterBinary> mLogWriterBinary; ///writes to file if the binary format is selected
             osg::ref_ptr<LogWriter> mLogWriterConsole; ///writes to console
             osg::observer_ptr<osg::Referenced> mLogTimeProviderAsRef;
             LogTimeProvider* mLogTimeProvider;
             OpenThreads::Mutex mMutex;
+            OpenThreads::Mutex mInstancesMutex; ///Guards mInstances, logs are added from any thread while the queue flushes
+            std::atomic<LogQueue*> mLogQueue;
+            std::atomic<unsigned int> mLogQueueUsers; ///Threads between AcquireLogQueue and ReleaseLogQueue
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,271 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+#include <trUtil/Export.h>
+
+#include <trUtil/DateTime.h>
+#include <trUtil/RingBuffer.h>
+#include <trUtil/Timer.h>
+#include <trUtil/Logging/LogLevel.h>
+#include <trUtil/Logging/LogWriter.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        // Fwd declaration
+        class Log;
+        class LogManager;
+
+        /**
+         * @class   LogQueue
+         *
+         * @brief   Backend for the asynchronous logging mode. Every thread that logs gets its own lock
+         *          free ring of fixed size records, so logging a message costs a copy into the ring
+         *          instead of a mutex and the formatting of the message. A background thread drains
+         *          all the rings, orders the records by their time stamp and sends them to the file,
+         *          console and custom LogWriters in batches.
+         *
+         * @sa  trUtil::Logging::Log::SetAsync()
+         */
+        class TR_UTIL_EXPORT LogQueue
+        {
+        public:
+
+            /** @brief   Messages that fit into this many characters are stored in the ring without any allocation. */
+            static const size_t INLINE_MESSAGE_SIZE = 200;
+
+            /** @brief   How long the writer thread sleeps between polls when no one wakes it up. */
+            static const int WRITE_INTERVAL_MS = 10;
+
+            /**
+             * @fn  LogQueue::LogQueue(LogManager& logManager, unsigned int overflowPolicy, size_t ringSize);
+             *
+             * @brief   Constructor. Starts the writer thread.
+             *
+             * @param [in,out]  logManager      The log manager that owns the file and console writers.
+             * @param           overflowPolicy  A Log::AsyncOverflowPolicy value.
+             * @param           ringSize        Number of records each thread can queue.
+             */
+            LogQueue(LogManager& logManager, unsigned int overflowPolicy, size_t ringSize);
+
+            /**
+             * @fn  LogQueue::~LogQueue();
+             *
+             * @brief   Destructor. Writes out all queued messages and stops the writer thread.
+             */
+            ~LogQueue();
+
+            /**
+             * @fn  void LogQueue::Push(const Log& log, const char* file, const char* method, int line, const std::string& msg, LogLevel logLevel);
+             *
+             * @brief   Queues a message from the calling thread. The file and method have to point to
+             *          strings that outlive the queue, like __FILE__ and __FUNCTION__ or interned strings.
+             *
+             * @param   log         The log that sends the message.
+             * @param   file        The source file name which generated this message.
+             * @param   method      The calling method which generated this message.
+             * @param   line        The source code line number.
+             * @param   msg         The message to display.
+             * @param   logLevel    Level of message being displayed.
+             */
+            void Push(const Log& log, const char* file, const char* method, int line, const std::string& msg, LogLevel logLevel);
+
+            /**
+             * @fn  const char* LogQueue::Intern(const std::string& text);
+             *
+             * @brief   Returns a pointer to a copy of the text that lives as long as the queue. Used for
+             *          sources that are not string literals. Takes a lock the first time a thread interns
+             *          a string, so keep the number of different strings small.
+             *
+             * @param   text    The text.
+             *
+             * @return  The interned text.
+             */
+            const char* Intern(const std::string& text);
+
+            /**
+             * @fn  void LogQueue::Stop();
+             *
+             * @brief   Stops the writer thread, and stops threads from waiting on a full ring. Messages
+             *          queued after this are written by the destructor.
+             */
+            void Stop();
+
+            /**
+             * @fn  void LogQueue::Flush();
+             *
+             * @brief   Blocks until all messages that were queued before the call are written out.
+             */
+            void Flush();
+
+            /**
+             * @fn  void LogQueue::FlushFromCrash();
+             *
+             * @brief   Best effort flush used by the terminate handler. Does not wait on the Log Manager
+             *          mutex and gives up on the queues if the writer thread can not be interrupted.
+             */
+            void FlushFromCrash();
+
+            /**
+             * @fn  unsigned long long LogQueue::GetDroppedCount() const;
+             *
+             * @brief   Gets the number of messages that were dropped because a ring was full.
+             *
+             * @return  The dropped count.
+             */
+            unsigned long long GetDroppedCount() const;
+
+            /**
+             * @fn  unsigned long long LogQueue::GetWrittenCount() const;
+             *
+             * @brief   Gets the number of messages the writer has sent out.
+             *
+             * @return  The written count.
+             */
+            unsigned long long GetWrittenCount() const;
+
+            /**
+             * @fn  static void LogQueue::InstallCrashHandlers();
+             *
+             * @brief   Installs a terminate handler that flushes the active queue before the process goes
+             *          down. The previous handler is chained. Safe to call more than once. Fatal signals
+             *          are left alone, formatting and writing the queue is not safe in a signal handler.
+             */
+            static void InstallCrashHandlers();
+
+        private:
+
+            /**
+             * @struct  Record
+             *
+             * @brief   A queued message. Short messages are stored inline, so the ring slots can be
+             *          reused without touching the heap.
+             */
+            struct Record
+            {
+                const Log* log = nullptr;
+                const char* file = nullptr;
+                const char* method = nullptr;
+                int line = 0;
+                LogLevel logLevel = LogLevel::LOG_DEBUG;
+                unsigned frameNumber = 0;
+                bool fromTimeProvider = false;
+                trUtil::DateTime providerTime; ///<Only used if a LogTimeProvider was set
+                TimeTicks ticks = 0;        ///<Fast time stamp, merges the rings and is converted by the writer thread
+                size_t msgLength = 0;
+                char msg[INLINE_MESSAGE_SIZE];
+                std::string longMsg;        ///<Only used if the message does not fit inline
+            };
+
+            /**
+             * @struct  ThreadRing
+             *
+             * @brief   The ring of a single producer thread.
+             */
+            struct ThreadRing
+            {
+                explicit ThreadRing(size_t size) : ring(size) {}
+
+                trUtil::RingBuffer<Record> ring;
+                std::atomic<unsigned long long> dropped{ 0 };
+                std::atomic<bool> closed{ false };
+                unsigned long long reportedDropped = 0; ///<Only touched by the draining thread
+                Record scratch;                         ///<Only touched by the producer thread
+            };
+
+            /**
+             * @fn  ThreadRing& LogQueue::GetThreadRing();
+             *
+             * @brief   Returns the ring of the calling thread, creating it on first use.
+             *
+             * @return  The thread ring.
+             */
+            ThreadRing& GetThreadRing();
+
+            /**
+             * @fn  void LogQueue::Run();
+             *
+             * @brief   The writer thread loop.
+             */
+            void Run();
+
+            /**
+             * @fn  size_t LogQueue::Drain(bool lockManager);
+             *
+             * @brief   Moves everything out of the thread rings and writes it. Caller holds mDrainMutex.
+             *
+             * @param   lockManager True to lock the Log Manager mutex while writing.
+             *
+             * @return  The number of records written.
+             */
+            size_t Drain(bool lockManager);
+
+            /**
+             * @fn  void LogQueue::WriteRecord(const Record& record);
+             *
+             * @brief   Formats a record into the reused LogData and sends it to the writers of its log.
+             *
+             * @param   record  The record.
+             */
+            void WriteRecord(const Record& record);
+
+            LogManager& mLogManager;
+            unsigned int mOverflowPolicy;
+            size_t mRingSize;
+            unsigned int mGeneration;   ///<Tells the thread local ring cache which queue it belongs to
+
+            std::mutex mRingsMutex;
+            std::vector<std::shared_ptr<ThreadRing>> mRings;
+            std::vector<std::shared_ptr<ThreadRing>> mDrainRings;
+            std::vector<Record> mBatch;
+            std::vector<size_t> mBatchOrder;
+            LogWriter::LogData mLogData;
+            std::time_t mLastTime;
+            trUtil::DateTime mLastLocalTime;
+
+            std::mutex mDrainMutex;
+            std::atomic<std::thread::id> mDrainThread;
+
+            std::mutex mWakeMutex;
+            std::condition_variable mWakeCondition;
+            std::atomic<bool> mRunning;
+            std::thread mThread;
+
+            std::mutex mInternMutex;
+            std::set<std::string> mInterned;
+
+            std::atomic<unsigned long long> mDroppedCount;
+            std::atomic<unsigned long long> mWrittenCount;
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+#include <trUtil/Logging/LogLevel.h>
+
+#include <atomic>
+#include <string>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        class Log;
+
+        /**
+         * @class   LogRateLimiter
+         *
+         * @brief   Lets through at most a given number of messages per second from one call site, and
+         *          counts the ones it holds back. Used by the LOG_*_RATE macros, which keep one
+         *          limiter per call site. Only atomic counters are used, so a storm of messages from
+         *          many threads does not wait on a lock.
+         *
+         *          The held back count is noted on the next message that gets through. A limiter
+         *          that knows its log also writes a summary once the window with held back messages
+         *          is over, so the count is not lost when the storm stops. The log queue thread
+         *          writes the summaries, or Log::Flush when logging is synchronous.
+         */
+        class TR_UTIL_EXPORT LogRateLimiter
+        {
+        public:
+
+            /** @brief   Length of the rate limiting window in milliseconds. */
+            static const long long WINDOW_LENGTH_MS = 1000;
+
+            /**
+             * @fn  explicit LogRateLimiter::LogRateLimiter(unsigned int maxPerSecond);
+             *
+             * @brief   Constructor. The limiter does not write summaries.
+             *
+             * @param   maxPerSecond    The maximum number of messages let through each second.
+             */
+            explicit LogRateLimiter(unsigned int maxPerSecond);
+
+            /**
+             * @fn  LogRateLimiter::LogRateLimiter(unsigned int maxPerSecond, Log& log, LogLevel logLevel, const char* cppFile, const char* method, int line);
+             *
+             * @brief   Constructor for a limiter that writes a summary of the held back messages to a
+             *          log, with the source of the call site.
+             *
+             * @param           maxPerSecond    The maximum number of messages let through each second.
+             * @param [in,out]  log             The log of the call site.
+             * @param           logLevel        The log level of the call site.
+             * @param           cppFile         The source file of the call site.
+             * @param           method          The calling method of the call site.
+             * @param           line            The line number of the call site.
+             */
+            LogRateLimiter(unsigned int maxPerSecond, Log& log, LogLevel logLevel, const char* cppFile, const char* method, int line);
+
+            /**
+             * @fn  LogRateLimiter::~LogRateLimiter();
+             *
+             * @brief   Destructor.
+             */
+            ~LogRateLimiter();
+
+            /**
+             * @fn  bool LogRateLimiter::Allow(unsigned long long& suppressedCount);
+             *
+             * @brief   Checks if a message can be logged now.
+             *
+             * @param [out] suppressedCount If the message is allowed, the number of messages held back
+             *                              since the last allowed one. Zero otherwise.
+             *
+             * @return  True if the message should be logged.
+             */
+            bool Allow(unsigned long long& suppressedCount);
+
+            /**
+             * @fn  bool LogRateLimiter::Allow(unsigned long long& suppressedCount, long long now);
+             *
+             * @brief   Same as Allow(suppressedCount), at the given time.
+             *
+             * @param [out] suppressedCount If the message is allowed, the number of messages held back
+             *                              since the last allowed one. Zero otherwise.
+             * @param       now             The time in milliseconds, from GetTimeMilliseconds.
+             *
+             * @return  True if the message should be logged.
+             */
+            bool Allow(unsigned long long& suppressedCount, long long now);
+
+            /**
+             * @fn  unsigned long long LogRateLimiter::TakeSuppressedCount(long long now);
+             *
+             * @brief   Takes the count of the held back messages, once the window they were held back
+             *          in is over.
+             *
+             * @param   now The time in milliseconds, from GetTimeMilliseconds.
+             *
+             * @return  The number of held back messages, zero if there are none or the window is not
+             *          over yet.
+             */
+            unsigned long long TakeSuppressedCount(long long now);
+
+            /**
+             * @fn  static void LogRateLimiter::WriteSummaries(bool endWindows = false);
+             *
+             * @brief   Writes a summary for every limiter with a log, whose window with held back
+             *          messages is over. Returns right away if another thread is writing them.
+             *
+             * @param   endWindows  (Optional) True to also write the windows that are not over yet,
+             *                      like when the process exits.
+             */
+            static void WriteSummaries(bool endWindows = false);
+
+            /**
+             * @fn  static long long LogRateLimiter::GetTimeMilliseconds();
+             *
+             * @brief   Gets the time the limiter windows are measured in.
+             *
+             * @return  The time in milliseconds, from a steady clock.
+             */
+            static long long GetTimeMilliseconds();
+
+            /**
+             * @fn  static std::string LogRateLimiter::AddSuppressedNote(const std::string& msg, unsigned long long suppressedCount);
+             *
+             * @brief   Appends a note about held back messages to a message.
+             *
+             * @param   msg             The message.
+             * @param   suppressedCount Number of suppressed messages.
+             *
+             * @return  The message, with the note if the count is not zero.
+             */
+            static std::string AddSuppressedNote(const std::string& msg, unsigned long long suppressedCount);
+
+        private:
+            unsigned int mMaxPerSecond;
+            std::atomic<long long> mWindowStart;    ///<Milliseconds
+            std::atomic<unsigned int> mWindowCount;
+            std::atomic<unsigned long long> mSuppressedCount;
+
+            //Where the summaries go, no summaries without a log
+            Log* mLog = nullptr;
+            LogLevel mLogLevel = LogLevel::LOG_DEBUG;
+            const char* mFile = "";
+            const char* mMethod = "";
+            int mLine = 0;
+        };
+
+        /**
+         * @class   LogSampler
+         *
+         * @brief   Lets through one of every N messages from one call site. Used by the
+         *          LOG_*_EVERY_N macros.
+         */
+        class TR_UTIL_EXPORT LogSampler
+        {
+        public:
+
+            /**
+             * @fn  explicit LogSampler::LogSampler(unsigned int sampleRate);
+             *
+             * @brief   Constructor.
+             *
+             * @param   sampleRate  Log one of every sampleRate messages. Zero is treated as one.
+             */
+            explicit LogSampler(unsigned int sampleRate);
+
+            /**
+             * @fn  bool LogSampler::Allow(unsigned long long& suppressedCount);
+             *
+             * @brief   Checks if a message should be logged. The first message is always logged.
+             *
+             * @param [out] suppressedCount If the message is allowed, the number of messages skipped
+             *                              since the last allowed one. Zero otherwise.
+             *
+             * @return  True if the message should be logged.
+             */
+            bool Allow(unsigned long long& suppressedCount);
+
+        private:
+            unsigned int mSampleRate;
+            std::atomic<unsigned long long> mCount;
+        };
+    }
+}
\ No newline at end of file
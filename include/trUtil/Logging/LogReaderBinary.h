@@ -0,0 +1,121 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+
+#include <trUtil/Export.h>
+
+#include <trUtil/Logging/LogWriter.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        /**
+         * @class   LogReaderBinary
+         *
+         * @brief   Reads the files written by LogWriterBinary back into LogData.
+         *
+         * @sa  trUtil::Logging::LogWriterBinary
+         */
+        class TR_UTIL_EXPORT LogReaderBinary
+        {
+        public:
+
+            /**
+             * @enum    EntryType
+             *
+             * @brief   Types of entries returned by ReadNext().
+             */
+            enum EntryType
+            {
+                ENTRY_MESSAGE,      ///<A log message was read into the LogData
+                ENTRY_HORIZ_RULE,   ///<A horizontal rule
+                ENTRY_END           ///<End of the file, or the rest of the file could not be read
+            };
+
+            /**
+             * @fn  LogReaderBinary::LogReaderBinary();
+             *
+             * @brief   Default constructor.
+             */
+            LogReaderBinary();
+
+            /**
+             * @fn  bool LogReaderBinary::Open(const std::string& filePath);
+             *
+             * @brief   Opens a binary log file and reads its header.
+             *
+             * @param   filePath    Full pathname of the file.
+             *
+             * @return  False if the file can not be opened or is not a binary log.
+             */
+            bool Open(const std::string& filePath);
+
+            /**
+             * @fn  const std::string& LogReaderBinary::GetTitle() const;
+             *
+             * @brief   Gets the title stored in the file.
+             *
+             * @return  The title.
+             */
+            const std::string& GetTitle() const;
+
+            /**
+             * @fn  EntryType LogReaderBinary::ReadNext(LogWriter::LogData& logData);
+             *
+             * @brief   Reads the next entry.
+             *
+             * @param [out] logData Filled in if a message was read.
+             *
+             * @return  The type of the entry.
+             */
+            EntryType ReadNext(LogWriter::LogData& logData);
+
+            /**
+             * @fn  bool LogReaderBinary::IsCorrupt() const;
+             *
+             * @brief   Query if reading stopped because of bad data, rather than the end of the file. A
+             *          log of a crashed application can end in the middle of a record.
+             *
+             * @return  True if corrupt, false if not.
+             */
+            bool IsCorrupt() const;
+
+        private:
+            bool ReadVarint(uint64_t& value);
+            bool ReadSignedVarint(int64_t& value);
+            bool ReadText(std::string& text);
+            bool GetString(uint64_t id, std::string& text) const;
+
+            std::ifstream mFile;
+            std::string mTitle;
+            std::vector<std::string> mStrings;
+            uint32_t mDate;
+            int64_t mLastMilliseconds;
+            bool mCorrupt;
+        };
+    }
+}
\ No newline at end of file
@@ -95,6 +95,14 @@ namespace trUtil
              */
             virtual void LogMessage(const LogData& logData) = 0;
 
+            /**
+             * @fn  virtual void LogWriter::Flush()
+             *
+             * @brief   Writes out anything the writer buffered. The asynchronous log queue calls this
+             *          after each batch of messages.
+             */
+            virtual void Flush() {}
+
         protected:
 
             /**
@@ -0,0 +1,195 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+
+#include <trUtil/Export.h>
+
+#include <trUtil/HashMap.h>
+#include <trUtil/Logging/LogWriter.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        /**
+         * @class   LogWriterBinary
+         *
+         * @brief   A LogWriter that stores messages in a compact binary file instead of HTML. Every
+         *          record is a small header of variable length integers. Log names, source files,
+         *          methods and repeating messages are interned: their text is written once and
+         *          records refer to it by id. Each message is flushed, unless SetFlushEachMessage
+         *          turns that off, in which case output is buffered and only flushed on Flush(), for
+         *          errors, and when the buffer fills up. Use the trLogView utility to turn the file
+         *          into HTML, plain text or JSON lines.
+         *
+         *          The file starts with FILE_MAGIC, a version byte and the title. After that it is a
+         *          stream of chunks, each starting with one of the ChunkType bytes.
+         *
+         * @sa  trUtil::Logging::LogReaderBinary
+         */
+        class TR_UTIL_EXPORT LogWriterBinary : public Logging::LogWriter
+        {
+        public:
+
+            /** @brief   The first bytes of every binary log file. */
+            static const char FILE_MAGIC[6];
+
+            /** @brief   The version of the binary format. */
+            static const uint8_t FILE_VERSION = 1;
+
+            /** @brief   Maximum number of different messages that get interned. Later new messages are stored inline. */
+            static const size_t MAX_INTERNED_MESSAGES = 4096;
+
+            /** @brief   Size of the output buffer in bytes. */
+            static const size_t BUFFER_SIZE = 64 * 1024;
+
+            /**
+             * @enum    ChunkType
+             *
+             * @brief   Types of chunks in the binary file.
+             */
+            enum ChunkType
+            {
+                CHUNK_STRING = 1,   ///<Defines an interned string: id, length, text
+                CHUNK_DATE = 2,     ///<Sets the date of the following records: yyyymmdd
+                CHUNK_MESSAGE = 3,  ///<A log message
+                CHUNK_HORIZ_RULE = 4 ///<A horizontal rule
+            };
+
+            /**
+             * @fn  LogWriterBinary::LogWriterBinary();
+             *
+             * @brief   Default constructor. Writes to the file set in LogFile.
+             */
+            LogWriterBinary();
+
+            /**
+             * @fn  explicit LogWriterBinary::LogWriterBinary(const std::string& filePath);
+             *
+             * @brief   Constructor for a writer that ignores the LogFile name and writes to the given
+             *          file instead.
+             *
+             * @param   filePath    Full path of the file to write.
+             */
+            explicit LogWriterBinary(const std::string& filePath);
+
+            /**
+             * @fn  void LogWriterBinary::OpenFile();
+             *
+             * @brief   Opens the file. Closes the previous file if one is open.
+             */
+            void OpenFile();
+
+            /**
+             * @fn  virtual void LogWriterBinary::LogMessage(const LogData& logData);
+             *
+             * @brief   Logs a message.
+             *
+             * @param   logData Information describing the log.
+             */
+            virtual void LogMessage(const LogData& logData);
+
+            /**
+             * @fn  virtual void LogWriterBinary::Flush();
+             *
+             * @brief   Writes out the buffer and flushes the file.
+             */
+            virtual void Flush();
+
+            /**
+             * @fn  void LogWriterBinary::SetFlushEachMessage(bool flush);
+             *
+             * @brief   Sets if the buffer is written out after every message, which is the default.
+             *          Turned off by the asynchronous log queue, which flushes once per batch.
+             *
+             * @param   flush   True to flush after every message.
+             */
+            void SetFlushEachMessage(bool flush);
+
+            /**
+             * @fn  void LogWriterBinary::LogHorizRule();
+             *
+             * @brief   Logs horiz rule.
+             */
+            void LogHorizRule();
+
+            /**
+             * @fn  bool LogWriterBinary::IsOpenFailed();
+             *
+             * @brief   Returns true if opening a file failed.
+             *
+             * @return  True if open failed, false if not.
+             */
+            bool IsOpenFailed();
+
+            /**
+             * @fn  void LogWriterBinary::ResetOpenFail();
+             *
+             * @brief   A utility function to reset the OpenFailed flag after a file failure.
+             */
+            void ResetOpenFail();
+
+        protected:
+
+            /**
+             * @fn  virtual LogWriterBinary::~LogWriterBinary();
+             *
+             * @brief   Destructor. Flushes and closes the file.
+             */
+            virtual ~LogWriterBinary();
+
+        private:
+
+            /**
+             * @fn  bool LogWriterBinary::FindOrAddString(const std::string& text, bool limited, uint32_t& id);
+             *
+             * @brief   Looks up the id of an interned string. New strings get a CHUNK_STRING written.
+             *
+             * @param           text    The text.
+             * @param           limited True if the text is a message and counts against MAX_INTERNED_MESSAGES.
+             * @param [out]     id      The id of the string.
+             *
+             * @return  False if the string is not interned and has to be written inline.
+             */
+            bool FindOrAddString(const std::string& text, bool limited, uint32_t& id);
+
+            void WriteVarint(uint64_t value);
+            void WriteSignedVarint(int64_t value);
+            void WriteBytes(const std::string& text);
+            void CloseFile();
+
+            std::ofstream mLogFile;
+            std::string mFilePath;
+            bool mOpenFailed;
+            bool mFlushEachMessage;
+            std::vector<char> mBuffer;
+            trUtil::HashMap<std::string, uint32_t> mStrings;
+            size_t mInternedMessages;
+            uint32_t mDate;
+            int64_t mLastMilliseconds;
+        };
+    }
+}
\ No newline at end of file
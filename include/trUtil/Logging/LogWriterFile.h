@@ -69,6 +69,16 @@ namespace trUtil
              */
             LogWriterFile();
 
+            /**
+             * @fn  explicit LogWriterFile::LogWriterFile(const std::string& filePath);
+             *
+             * @brief   Constructor for a writer that ignores the LogFile name and writes to the given
+             *          file instead. Used to render logs outside of the running application.
+             *
+             * @param   filePath    Full path of the file to write.
+             */
+            explicit LogWriterFile(const std::string& filePath);
+
             /**
              * @fn  void LogWriterFile::OpenFile();
              *
@@ -85,6 +95,23 @@ namespace trUtil
              */
             virtual void LogMessage(const LogData& logData);
 
+            /**
+             * @fn  virtual void LogWriterFile::Flush();
+             *
+             * @brief   Flushes the log file.
+             */
+            virtual void Flush();
+
+            /**
+             * @fn  void LogWriterFile::SetFlushEachMessage(bool flush);
+             *
+             * @brief   Sets if the file is flushed after every message, which is the default. Turned off
+             *          by the asynchronous log queue, which flushes once per batch.
+             *
+             * @param   flush   True to flush after every message.
+             */
+            void SetFlushEachMessage(bool flush);
+
             /**
              * @fn  void LogWriterFile::LogHorizRule();
              *
@@ -108,6 +135,18 @@ namespace trUtil
              */
             void ResetOpenFail();
 
+            /**
+             * @fn  static std::string LogWriterFile::GetLogFilePath(const std::string& fileName);
+             *
+             * @brief   Returns the full path a log file is written to. A name without a path is placed
+             *          in the DEFAULT_LOG_FOLDER of the user log path, which gets created if needed.
+             *
+             * @param   fileName    Name of the log file.
+             *
+             * @return  The log file path.
+             */
+            static std::string GetLogFilePath(const std::string& fileName);
+
         protected:
 
             /**
@@ -119,7 +158,9 @@ namespace trUtil
 
         private:
             std::ofstream mLogFile;
+            std::string mFilePath;
             bool mOpenFailed;
+            bool mFlushEachMessage;
             void TimeTag(std::string prefix);
             void EndFile();
         };
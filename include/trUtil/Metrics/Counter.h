@@ -0,0 +1,95 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+
+#include <trUtil/Metrics/Metric.h>
+
+#include <atomic>
+#include <string>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        /**
+         * @class   Counter
+         *
+         * @brief   A value that only goes up, like the number of processed messages. Rates, such as
+         *          messages per second, are calculated from it by the scraper. Increments are a
+         *          single relaxed atomic add, so it can be used on hot paths from any thread.
+         */
+        class TR_UTIL_EXPORT Counter : public Metric
+        {
+        public:
+
+            const static std::string TYPE_NAME;
+
+            /**
+             * @fn  Counter::Counter();
+             *
+             * @brief   Default constructor.
+             */
+            Counter();
+
+            /**
+             * @fn  void Counter::Increment(unsigned long long amount = 1)
+             *
+             * @brief   Increments the counter.
+             *
+             * @param   amount  (Optional) The amount to add.
+             */
+            void Increment(unsigned long long amount = 1) { mValue.fetch_add(amount, std::memory_order_relaxed); }
+
+            /**
+             * @fn  unsigned long long Counter::GetValue() const
+             *
+             * @brief   Gets the current value.
+             *
+             * @return  The value.
+             */
+            unsigned long long GetValue() const { return mValue.load(std::memory_order_relaxed); }
+
+            /**
+             * @fn  virtual const std::string& Counter::GetTypeName() const override;
+             *
+             * @brief   Gets the Prometheus type name of the metric.
+             *
+             * @return  The type name.
+             */
+            virtual const std::string& GetTypeName() const override;
+
+            /**
+             * @fn  virtual void Counter::Write(std::string& output, const std::string& name, const std::string& labels) const override;
+             *
+             * @brief   Appends the samples of the metric in the Prometheus text format.
+             *
+             * @param [in,out]  output  The text to append to.
+             * @param           name    The metric name.
+             * @param           labels  The rendered labels, without the braces. Can be empty.
+             */
+            virtual void Write(std::string& output, const std::string& name, const std::string& labels) const override;
+
+        private:
+            std::atomic<unsigned long long> mValue;
+        };
+    }
+}
\ No newline at end of file
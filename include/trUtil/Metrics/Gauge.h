@@ -0,0 +1,104 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+
+#include <trUtil/Metrics/Metric.h>
+
+#include <atomic>
+#include <string>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        /**
+         * @class   Gauge
+         *
+         * @brief   A value that can go up and down, like a queue depth or the number of registered
+         *          actors. Setting it is a single atomic store, adding to it is a compare and swap
+         *          loop, so it never takes a lock.
+         */
+        class TR_UTIL_EXPORT Gauge : public Metric
+        {
+        public:
+
+            const static std::string TYPE_NAME;
+
+            /**
+             * @fn  Gauge::Gauge();
+             *
+             * @brief   Default constructor.
+             */
+            Gauge();
+
+            /**
+             * @fn  void Gauge::Set(double value)
+             *
+             * @brief   Sets the value.
+             *
+             * @param   value   The value.
+             */
+            void Set(double value) { mValue.store(value, std::memory_order_relaxed); }
+
+            /**
+             * @fn  void Gauge::Add(double amount);
+             *
+             * @brief   Adds to the value. Use a negative amount to subtract.
+             *
+             * @param   amount  The amount.
+             */
+            void Add(double amount);
+
+            /**
+             * @fn  double Gauge::GetValue() const
+             *
+             * @brief   Gets the current value.
+             *
+             * @return  The value.
+             */
+            double GetValue() const { return mValue.load(std::memory_order_relaxed); }
+
+            /**
+             * @fn  virtual const std::string& Gauge::GetTypeName() const override;
+             *
+             * @brief   Gets the Prometheus type name of the metric.
+             *
+             * @return  The type name.
+             */
+            virtual const std::string& GetTypeName() const override;
+
+            /**
+             * @fn  virtual void Gauge::Write(std::string& output, const std::string& name, const std::string& labels) const override;
+             *
+             * @brief   Appends the samples of the metric in the Prometheus text format.
+             *
+             * @param [in,out]  output  The text to append to.
+             * @param           name    The metric name.
+             * @param           labels  The rendered labels, without the braces. Can be empty.
+             */
+            virtual void Write(std::string& output, const std::string& name, const std::string& labels) const override;
+
+        private:
+            std::atomic<double> mValue;
+        };
+    }
+}
\ No newline at end of file
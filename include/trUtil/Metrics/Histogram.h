@@ -0,0 +1,136 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+
+#include <trUtil/Metrics/Metric.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        /**
+         * @class   Histogram
+         *
+         * @brief   Counts observed values, like frame phase times, into fixed buckets. The bucket
+         *          bounds never change after construction, so an observation is a short search and
+         *          a few relaxed atomic adds.
+         */
+        class TR_UTIL_EXPORT Histogram : public Metric
+        {
+        public:
+
+            const static std::string TYPE_NAME;
+
+            /** @brief   Bucket bounds in seconds, from 100 microseconds to 1 second. Fits frame and message timing. */
+            const static std::vector<double> DEFAULT_TIME_BUCKETS;
+
+            /**
+             * @fn  explicit Histogram::Histogram(const std::vector<double>& bucketBounds);
+             *
+             * @brief   Constructor.
+             *
+             * @param   bucketBounds    The upper bounds of the buckets, in increasing order. A +Inf
+             *                          bucket is always added at the end.
+             */
+            explicit Histogram(const std::vector<double>& bucketBounds);
+
+            /**
+             * @fn  void Histogram::Observe(double value);
+             *
+             * @brief   Adds a value to the histogram.
+             *
+             * @param   value   The value.
+             */
+            void Observe(double value);
+
+            /**
+             * @fn  const std::vector<double>& Histogram::GetBucketBounds() const;
+             *
+             * @brief   Gets the upper bounds of the buckets, without the +Inf bucket.
+             *
+             * @return  The bucket bounds.
+             */
+            const std::vector<double>& GetBucketBounds() const;
+
+            /**
+             * @fn  unsigned long long Histogram::GetBucketCount(size_t index) const;
+             *
+             * @brief   Gets the number of values that fell into a bucket. This is not cumulative.
+             *
+             * @param   index   Zero-based index of the bucket. The index past the last bound is the
+             *                  +Inf bucket.
+             *
+             * @return  The bucket count.
+             */
+            unsigned long long GetBucketCount(size_t index) const;
+
+            /**
+             * @fn  unsigned long long Histogram::GetCount() const;
+             *
+             * @brief   Gets the number of observed values.
+             *
+             * @return  The count.
+             */
+            unsigned long long GetCount() const;
+
+            /**
+             * @fn  double Histogram::GetSum() const;
+             *
+             * @brief   Gets the sum of all the observed values.
+             *
+             * @return  The sum.
+             */
+            double GetSum() const;
+
+            /**
+             * @fn  virtual const std::string& Histogram::GetTypeName() const override;
+             *
+             * @brief   Gets the Prometheus type name of the metric.
+             *
+             * @return  The type name.
+             */
+            virtual const std::string& GetTypeName() const override;
+
+            /**
+             * @fn  virtual void Histogram::Write(std::string& output, const std::string& name, const std::string& labels) const override;
+             *
+             * @brief   Appends the samples of the metric in the Prometheus text format.
+             *
+             * @param [in,out]  output  The text to append to.
+             * @param           name    The metric name.
+             * @param           labels  The rendered labels, without the braces. Can be empty.
+             */
+            virtual void Write(std::string& output, const std::string& name, const std::string& labels) const override;
+
+        private:
+            std::vector<double> mBucketBounds;
+            std::unique_ptr<std::atomic<unsigned long long>[]> mBucketCounts;    ///<One more than the bounds, for +Inf
+            std::atomic<unsigned long long> mCount;
+            std::atomic<double> mSum;
+        };
+    }
+}
\ No newline at end of file
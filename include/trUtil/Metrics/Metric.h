@@ -0,0 +1,93 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+
+#include <string>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        /**
+         * @class   Metric
+         *
+         * @brief   Base of all the values kept in the MetricsRegistry. A metric only holds its value,
+         *          the registry holds its name, help text and labels.
+         */
+        class TR_UTIL_EXPORT Metric
+        {
+        public:
+
+            /**
+             * @fn  virtual Metric::~Metric();
+             *
+             * @brief   Destructor.
+             */
+            virtual ~Metric();
+
+            /**
+             * @fn  virtual const std::string& Metric::GetTypeName() const = 0;
+             *
+             * @brief   Gets the Prometheus type name of the metric.
+             *
+             * @return  The type name, like "counter".
+             */
+            virtual const std::string& GetTypeName() const = 0;
+
+            /**
+             * @fn  virtual void Metric::Write(std::string& output, const std::string& name, const std::string& labels) const = 0;
+             *
+             * @brief   Appends the samples of the metric in the Prometheus text format.
+             *
+             * @param [in,out]  output  The text to append to.
+             * @param           name    The metric name.
+             * @param           labels  The rendered labels, without the braces. Can be empty.
+             */
+            virtual void Write(std::string& output, const std::string& name, const std::string& labels) const = 0;
+
+        protected:
+
+            /**
+             * @fn  static void Metric::WriteSample(std::string& output, const std::string& name, const std::string& labels, double value);
+             *
+             * @brief   Appends one sample line.
+             *
+             * @param [in,out]  output  The text to append to.
+             * @param           name    The sample name.
+             * @param           labels  The rendered labels, without the braces. Can be empty.
+             * @param           value   The value.
+             */
+            static void WriteSample(std::string& output, const std::string& name, const std::string& labels, double value);
+
+            /**
+             * @fn  static std::string Metric::FormatValue(double value);
+             *
+             * @brief   Formats a number the way Prometheus expects it, including +Inf, -Inf and NaN.
+             *
+             * @param   value   The value.
+             *
+             * @return  The formatted value.
+             */
+            static std::string FormatValue(double value);
+        };
+    }
+}
\ No newline at end of file
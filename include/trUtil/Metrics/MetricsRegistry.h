@@ -0,0 +1,213 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+
+#include <trUtil/Metrics/Counter.h>
+#include <trUtil/Metrics/Gauge.h>
+#include <trUtil/Metrics/Histogram.h>
+#include <trUtil/Metrics/Metric.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        /**
+         * @class   MetricsRegistry
+         *
+         * @brief   Holds all the named counters, gauges and histograms of the process, and renders
+         *          them in the Prometheus text format. Metrics are created on the first Get call and
+         *          live until they are removed, or as long as the registry, so callers should look
+         *          them up once and keep the returned reference. Looking up takes a lock, updating a
+         *          metric does not.
+         */
+        class TR_UTIL_EXPORT MetricsRegistry
+        {
+        public:
+
+            /** @brief   Label names and values that tell metrics with the same name apart. */
+            using Labels = std::vector<std::pair<std::string, std::string>>;
+
+            /**
+             * @fn  MetricsRegistry::MetricsRegistry();
+             *
+             * @brief   Default constructor. Most code should use the global registry from
+             *          GetInstance().
+             */
+            MetricsRegistry();
+
+            /**
+             * @fn  MetricsRegistry::~MetricsRegistry();
+             *
+             * @brief   Destructor.
+             */
+            ~MetricsRegistry();
+
+            /**
+             * @fn  static MetricsRegistry& MetricsRegistry::GetInstance();
+             *
+             * @brief   Gets the global registry.
+             *
+             * @return  The instance.
+             */
+            static MetricsRegistry& GetInstance();
+
+            /**
+             * @fn  Counter& MetricsRegistry::GetCounter(const std::string& name, const std::string& help, const Labels& labels = Labels());
+             *
+             * @brief   Gets a counter, creating it if it does not exist yet.
+             *
+             * @exception   trUtil::ExceptionInvalidParameter   Thrown if the name is not a valid metric
+             *                                                  name, or is already used by another
+             *                                                  type of metric.
+             *
+             * @param   name    The metric name, like "tr_messages_total".
+             * @param   help    The help text. Only the first one given for a name is kept.
+             * @param   labels  (Optional) The labels.
+             *
+             * @return  The counter.
+             */
+            Counter& GetCounter(const std::string& name, const std::string& help, const Labels& labels = Labels());
+
+            /**
+             * @fn  Gauge& MetricsRegistry::GetGauge(const std::string& name, const std::string& help, const Labels& labels = Labels());
+             *
+             * @brief   Gets a gauge, creating it if it does not exist yet.
+             *
+             * @exception   trUtil::ExceptionInvalidParameter   Thrown if the name is not a valid metric
+             *                                                  name, or is already used by another
+             *                                                  type of metric.
+             *
+             * @param   name    The metric name.
+             * @param   help    The help text. Only the first one given for a name is kept.
+             * @param   labels  (Optional) The labels.
+             *
+             * @return  The gauge.
+             */
+            Gauge& GetGauge(const std::string& name, const std::string& help, const Labels& labels = Labels());
+
+            /**
+             * @fn  Histogram& MetricsRegistry::GetHistogram(const std::string& name, const std::string& help, const std::vector<double>& bucketBounds = Histogram::DEFAULT_TIME_BUCKETS, const Labels& labels = Labels());
+             *
+             * @brief   Gets a histogram, creating it if it does not exist yet.
+             *
+             * @exception   trUtil::ExceptionInvalidParameter   Thrown if the name is not a valid metric
+             *                                                  name, or is already used by another
+             *                                                  type of metric.
+             *
+             * @param   name            The metric name.
+             * @param   help            The help text. Only the first one given for a name is kept.
+             * @param   bucketBounds    (Optional) The bucket bounds, only used when the histogram
+             *                          is created.
+             * @param   labels          (Optional) The labels.
+             *
+             * @return  The histogram.
+             */
+            Histogram& GetHistogram(const std::string& name, const std::string& help, const std::vector<double>& bucketBounds = Histogram::DEFAULT_TIME_BUCKETS, const Labels& labels = Labels());
+
+            /**
+             * @fn  size_t MetricsRegistry::RemoveMetrics(const std::string& labelName, const std::string& labelValue);
+             *
+             * @brief   Removes every metric that has the given label, like all the metrics of an
+             *          object that is going away. References to the removed metrics must not be
+             *          used after this.
+             *
+             * @param   labelName   The label name.
+             * @param   labelValue  The label value.
+             *
+             * @return  The number of metrics removed.
+             */
+            size_t RemoveMetrics(const std::string& labelName, const std::string& labelValue);
+
+            /**
+             * @fn  std::string MetricsRegistry::GetPrometheusText() const;
+             *
+             * @brief   Renders all the metrics in the Prometheus text exposition format (version 0.0.4).
+             *
+             * @return  The text.
+             */
+            std::string GetPrometheusText() const;
+
+            /**
+             * @fn  static bool MetricsRegistry::IsValidName(const std::string& name);
+             *
+             * @brief   Checks if a string can be used as a metric or label name.
+             *
+             * @param   name    The name.
+             *
+             * @return  True if valid, false if not.
+             */
+            static bool IsValidName(const std::string& name);
+
+        private:
+
+            /**
+             * @struct  Family
+             *
+             * @brief   All the metrics that share a name, one per set of labels.
+             */
+            struct Family
+            {
+                std::string help;
+                const std::string* typeName = nullptr;
+                std::map<std::string, std::unique_ptr<Metric>> metrics;   ///<Keyed by the rendered labels
+            };
+
+            /**
+             * @fn  Metric& MetricsRegistry::GetMetric(const std::string& name, const std::string& help, const Labels& labels, const std::string& typeName, const std::function<Metric*()>& create);
+             *
+             * @brief   Finds or creates a metric.
+             *
+             * @param   name        The metric name.
+             * @param   help        The help text.
+             * @param   labels      The labels.
+             * @param   typeName    The type name of the metric.
+             * @param   create      Creates the metric if it does not exist yet.
+             *
+             * @return  The metric.
+             */
+            Metric& GetMetric(const std::string& name, const std::string& help, const Labels& labels, const std::string& typeName, const std::function<Metric*()>& create);
+
+            /**
+             * @fn  static std::string MetricsRegistry::RenderLabels(const Labels& labels);
+             *
+             * @brief   Renders and escapes labels as name="value" pairs separated by commas, sorted
+             *          by name.
+             *
+             * @param   labels  The labels.
+             *
+             * @return  The rendered labels.
+             */
+            static std::string RenderLabels(const Labels& labels);
+
+            std::map<std::string, Family> mFamilies;
+            mutable std::mutex mMutex;
+        };
+    }
+}
\ No newline at end of file
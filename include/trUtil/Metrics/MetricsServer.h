@@ -0,0 +1,140 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#pragma once
+#include <trUtil/Export.h>
+
+#include <trUtil/Metrics/MetricsRegistry.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        /**
+         * @class   MetricsServer
+         *
+         * @brief   A small embedded HTTP server that answers GET /metrics with the contents of a
+         *          MetricsRegistry in the Prometheus text format. It runs on its own thread and
+         *          serves one request at a time, which is plenty for a scraper or a curl. It only
+         *          listens on the loopback address unless told otherwise.
+         */
+        class TR_UTIL_EXPORT MetricsServer
+        {
+        public:
+
+            const static unsigned short DEFAULT_PORT;
+            const static std::string DEFAULT_ADDRESS;
+            const static std::string METRICS_PATH;
+
+            /**
+             * @fn  explicit MetricsServer::MetricsServer(MetricsRegistry& registry = MetricsRegistry::GetInstance());
+             *
+             * @brief   Constructor.
+             *
+             * @param [in,out]  registry    (Optional) The registry to serve.
+             */
+            explicit MetricsServer(MetricsRegistry& registry = MetricsRegistry::GetInstance());
+
+            /**
+             * @fn  MetricsServer::~MetricsServer();
+             *
+             * @brief   Destructor. Stops the server.
+             */
+            ~MetricsServer();
+
+            /**
+             * @fn  bool MetricsServer::Start(unsigned short port = DEFAULT_PORT, const std::string& address = DEFAULT_ADDRESS);
+             *
+             * @brief   Starts listening and serving requests.
+             *
+             * @param   port    (Optional) The port. 0 lets the system pick a free one, see GetPort().
+             * @param   address (Optional) The IPv4 address to listen on.
+             *
+             * @return  True if it succeeds, false if it fails.
+             */
+            bool Start(unsigned short port = DEFAULT_PORT, const std::string& address = DEFAULT_ADDRESS);
+
+            /**
+             * @fn  void MetricsServer::Stop();
+             *
+             * @brief   Stops the server and waits for its thread.
+             */
+            void Stop();
+
+            /**
+             * @fn  bool MetricsServer::IsRunning() const;
+             *
+             * @brief   Query if the server is running.
+             *
+             * @return  True if running, false if not.
+             */
+            bool IsRunning() const;
+
+            /**
+             * @fn  unsigned short MetricsServer::GetPort() const;
+             *
+             * @brief   Gets the port the server is listening on.
+             *
+             * @return  The port, 0 if not running.
+             */
+            unsigned short GetPort() const;
+
+        private:
+
+            using SocketHandle = std::intptr_t;
+
+            /**
+             * @fn  void MetricsServer::Run();
+             *
+             * @brief   The server thread. Waits for connections until stopped.
+             */
+            void Run();
+
+            /**
+             * @fn  void MetricsServer::HandleConnection(SocketHandle connection);
+             *
+             * @brief   Reads one request from a connection and answers it.
+             *
+             * @param   connection  The connection.
+             */
+            void HandleConnection(SocketHandle connection);
+
+            /**
+             * @fn  static void MetricsServer::CloseSocket(SocketHandle& socket);
+             *
+             * @brief   Closes a socket, and sets the handle to invalid.
+             *
+             * @param [in,out]  socket  The socket.
+             */
+            static void CloseSocket(SocketHandle& socket);
+
+            MetricsRegistry& mRegistry;
+            SocketHandle mListenSocket;
+            unsigned short mPort = 0;
+            std::atomic<bool> mRunning;
+            std::thread mThread;
+        };
+    }
+}
\ No newline at end of file
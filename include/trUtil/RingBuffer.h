@@ -0,0 +1,158 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace trUtil
+{
+    /**
+     * @class   RingBuffer
+     *
+     * @brief   A fixed size, lock-free, single producer and single consumer queue. One thread can push
+     *          while another one pops, without any locking. The capacity is rounded up to a power of
+     *          two. Pushing into a full buffer fails, so the producer decides what to drop.
+     *
+     * @tparam  T   Type of the stored items. Has to be default constructible and movable.
+     */
+    template<typename T>
+    class RingBuffer
+    {
+    public:
+
+        /**
+         * @fn  explicit RingBuffer::RingBuffer(size_t capacity)
+         *
+         * @brief   Constructor.
+         *
+         * @param   capacity    The minimal number of items the buffer can hold.
+         */
+        explicit RingBuffer(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            mSlots.resize(size);
+            mMask = size - 1;
+        }
+
+        /**
+         * @fn  bool RingBuffer::TryPush(T&& item)
+         *
+         * @brief   Moves an item into the buffer. Only call from the producer thread.
+         *
+         * @param [in,out]  item    The item.
+         *
+         * @return  False if the buffer is full.
+         */
+        bool TryPush(T&& item)
+        {
+            size_t head = mHead.load(std::memory_order_relaxed);
+            if (head - mTail.load(std::memory_order_acquire) > mMask)
+            {
+                return false;
+            }
+
+            mSlots[head & mMask] = std::move(item);
+            mHead.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @fn  bool RingBuffer::TryPop(T& item)
+         *
+         * @brief   Moves the oldest item out of the buffer. Only call from the consumer thread.
+         *
+         * @param [out] item    The item.
+         *
+         * @return  False if the buffer is empty.
+         */
+        bool TryPop(T& item)
+        {
+            size_t tail = mTail.load(std::memory_order_relaxed);
+            if (tail == mHead.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            item = std::move(mSlots[tail & mMask]);
+            mTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @fn  size_t RingBuffer::Size() const
+         *
+         * @brief   Returns the number of stored items. Only a snapshot when other threads are active.
+         *
+         * @return  The item count.
+         */
+        size_t Size() const
+        {
+            return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @fn  bool RingBuffer::IsEmpty() const
+         *
+         * @brief   Returns true if there are no stored items.
+         *
+         * @return  True if empty, false if not.
+         */
+        bool IsEmpty() const
+        {
+            return Size() == 0;
+        }
+
+        /**
+         * @fn  size_t RingBuffer::Capacity() const
+         *
+         * @brief   Returns the number of items the buffer can hold.
+         *
+         * @return  The capacity.
+         */
+        size_t Capacity() const
+        {
+            return mSlots.size();
+        }
+
+    private:
+
+        static const size_t CACHE_LINE_SIZE = 64;
+
+        std::vector<T> mSlots;
+        size_t mMask = 0;
+
+        //Keep the producer and consumer counters on separate cache lines. Padding is used instead of
+        //alignas, so the buffer can still be allocated with a plain new before C++17.
+        char mPad1[CACHE_LINE_SIZE];
+        std::atomic<size_t> mHead = { 0 };
+        char mPad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+        std::atomic<size_t> mTail = { 0 };
+        char mPad3[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    };
+}
\ No newline at end of file
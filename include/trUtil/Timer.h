@@ -24,6 +24,16 @@
 
 #include <osg/Timer>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TR_FAST_TICK_TSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TR_FAST_TICK_TSC
+#else
+#include <chrono>
+#endif
+
 /**
  * @namespace   trUtil
  *
@@ -51,6 +61,8 @@ namespace trUtil
      */
     void TR_UTIL_EXPORT AppSleep(unsigned int milliseconds);
 
+    class DateTime;
+
     /**
      * @class   Timer
      *
@@ -225,6 +237,96 @@ namespace trUtil
          */
         double GetSecondsPerTick() const { return (double)(mNewTicks - mOldTicks)*GetSecondsPerCPUTick(); }
 
+        /**
+         * @fn  static TimeTicks Timer::FastTick()
+         *
+         * @brief   Gets a raw time stamp as cheaply as the platform allows. On x86 this reads the CPU
+         *          time stamp counter, everywhere else it falls back to the steady clock in
+         *          nanoseconds. Fast ticks are not related to Tick() and should only be mixed with
+         *          the other Fast* functions. They are meant for hot paths (log records, frame
+         *          stats, pacing loops) that want to take a sample now and convert it later.
+         *
+         * @return  The current fast tick.
+         */
+        static TimeTicks FastTick()
+        {
+#ifdef TR_FAST_TICK_TSC
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        /**
+         * @fn  static double Timer::GetFastTicksPerSecond();
+         *
+         * @brief   Gets the rate of the fast ticks. The first call calibrates the tick rate against
+         *          the steady clock and anchors it to the wall clock, which blocks for a few
+         *          milliseconds. Call it during start up to keep the calibration out of a hot path.
+         *
+         * @return  The fast ticks per second.
+         */
+        static double GetFastTicksPerSecond();
+
+        /**
+         * @fn  static double Timer::FastDeltaSec(TimeTicks t1, TimeTicks t2);
+         *
+         * @brief   Get the time in seconds between fast ticks t1 and t2.
+         *
+         * @param   t1  The first fast tick.
+         * @param   t2  The second fast tick.
+         *
+         * @return  A double, negative if t2 is before t1.
+         */
+        static double FastDeltaSec(TimeTicks t1, TimeTicks t2);
+
+        /**
+         * @fn  static double Timer::FastDeltaMil(TimeTicks t1, TimeTicks t2);
+         *
+         * @brief   Get the time in milliseconds between fast ticks t1 and t2.
+         *
+         * @param   t1  The first fast tick.
+         * @param   t2  The second fast tick.
+         *
+         * @return  A double, negative if t2 is before t1.
+         */
+        static double FastDeltaMil(TimeTicks t1, TimeTicks t2) { return FastDeltaSec(t1, t2) * 1e3; }
+
+        /**
+         * @fn  static double Timer::FastDeltaMicro(TimeTicks t1, TimeTicks t2);
+         *
+         * @brief   Get the time in microseconds between fast ticks t1 and t2.
+         *
+         * @param   t1  The first fast tick.
+         * @param   t2  The second fast tick.
+         *
+         * @return  A double, negative if t2 is before t1.
+         */
+        static double FastDeltaMicro(TimeTicks t1, TimeTicks t2) { return FastDeltaSec(t1, t2) * 1e6; }
+
+        /**
+         * @fn  static double Timer::FastTickToEpochSeconds(TimeTicks ticks);
+         *
+         * @brief   Converts a fast tick to wall clock time, in seconds since the Unix epoch.
+         *
+         * @param   ticks   The fast tick.
+         *
+         * @return  The seconds since the epoch, including the fraction of a second.
+         */
+        static double FastTickToEpochSeconds(TimeTicks ticks);
+
+        /**
+         * @fn  static DateTime Timer::FastTickToDateTime(TimeTicks ticks);
+         *
+         * @brief   Converts a fast tick to local DateTime. This is the expensive part, so it should
+         *          be done when the time is displayed or written, not when it is sampled.
+         *
+         * @param   ticks   The fast tick.
+         *
+         * @return  The local DateTime.
+         */
+        static DateTime FastTickToDateTime(TimeTicks ticks);
+
     private:
         osg::Timer mTimer;
         TimeTicks mOldTicks = 0;
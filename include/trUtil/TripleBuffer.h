@@ -0,0 +1,163 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace trUtil
+{
+    /**
+     * @class   TripleBuffer
+     *
+     * @brief   A lock-free, single producer and single consumer "latest value" exchange. The producer
+     *          always has a slot to write into and never waits on the consumer, while the consumer
+     *          always picks up the newest published value. Values the consumer did not get to in time
+     *          are overwritten, unlike the RingBuffer which keeps all of them in order.
+     *
+     * @tparam  T   Type of the stored items. Has to be default constructible and copyable.
+     */
+    template<typename T>
+    class TripleBuffer
+    {
+    public:
+
+        /**
+         * @fn  TripleBuffer::TripleBuffer()
+         *
+         * @brief   Default constructor.
+         */
+        TripleBuffer()
+        {
+        }
+
+        /**
+         * @fn  void TripleBuffer::Fill(const T& value)
+         *
+         * @brief   Sets all slots to the given value, for example to preallocate them. Not thread safe,
+         *          only call before the producer and consumer threads start using the buffer.
+         *
+         * @param   value   The value.
+         */
+        void Fill(const T& value)
+        {
+            for (size_t i = 0; i < SLOT_COUNT; ++i)
+            {
+                mSlots[i] = value;
+            }
+        }
+
+        /**
+         * @fn  T& TripleBuffer::GetWriteBuffer()
+         *
+         * @brief   Returns the slot the producer writes the next value into. Only call from the
+         *          producer thread.
+         *
+         * @return  The write slot.
+         */
+        T& GetWriteBuffer()
+        {
+            return mSlots[mWriteIndex];
+        }
+
+        /**
+         * @fn  bool TripleBuffer::Publish()
+         *
+         * @brief   Makes the value in the write slot the newest one, and hands the producer a new write
+         *          slot. Only call from the producer thread.
+         *
+         * @return  False if the previously published value was never acquired and got overwritten.
+         */
+        bool Publish()
+        {
+            size_t previous = mShared.exchange(mWriteIndex | NEW_VALUE_FLAG, std::memory_order_acq_rel);
+            mWriteIndex = previous & INDEX_MASK;
+            return (previous & NEW_VALUE_FLAG) == 0;
+        }
+
+        /**
+         * @fn  bool TripleBuffer::Acquire()
+         *
+         * @brief   Moves the newest published value into the read slot. Only call from the consumer
+         *          thread.
+         *
+         * @return  False if nothing new was published since the last call, the read slot then still
+         *          holds the old value.
+         */
+        bool Acquire()
+        {
+            if (!HasNewValue())
+            {
+                return false;
+            }
+
+            size_t previous = mShared.exchange(mReadIndex, std::memory_order_acq_rel);
+            mReadIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        /**
+         * @fn  const T& TripleBuffer::GetReadBuffer() const
+         *
+         * @brief   Returns the slot with the last acquired value. Only call from the consumer thread.
+         *
+         * @return  The read slot.
+         */
+        const T& GetReadBuffer() const
+        {
+            return mSlots[mReadIndex];
+        }
+
+        /**
+         * @fn  bool TripleBuffer::HasNewValue() const
+         *
+         * @brief   Returns true if a value was published that has not been acquired yet.
+         *
+         * @return  True if there is a new value, false if not.
+         */
+        bool HasNewValue() const
+        {
+            return (mShared.load(std::memory_order_acquire) & NEW_VALUE_FLAG) != 0;
+        }
+
+    private:
+
+        static const size_t SLOT_COUNT = 3;
+        static const size_t INDEX_MASK = 3;
+        static const size_t NEW_VALUE_FLAG = 4;
+        static const size_t CACHE_LINE_SIZE = 64;
+
+        T mSlots[SLOT_COUNT];
+
+        //Keep the producer index, the shared index and the consumer index on separate cache lines,
+        //the same way the RingBuffer does.
+        char mPad1[CACHE_LINE_SIZE];
+        size_t mWriteIndex = 0;
+        char mPad2[CACHE_LINE_SIZE - sizeof(size_t)];
+
+        //The slot that is neither being written nor read, tagged with NEW_VALUE_FLAG until the consumer takes it
+        std::atomic<size_t> mShared = { 2 };
+        char mPad3[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+        size_t mReadIndex = 1;
+        char mPad4[CACHE_LINE_SIZE - sizeof(size_t)];
+    };
+}
\ No newline at end of file
@@ -28,10 +28,17 @@ namespace trApp
     const trUtil::RefStr AppBase::CLASS_TYPE = trUtil::RefStr("trApp::AppBase");
 
     //////////////////////////////////////////////////////////////////////////
-    AppBase::AppBase(const std::string& name) : BaseClass(name)
+    AppBase::AppBase(const std::string& name, trManager::SystemManager* sysMan) : BaseClass(name)
     {
-        //Create an instance of the System Manager
-        mSysMan = &trManager::SystemManager::GetInstance();
+        //Use the passed in world, or the default instance of the System Manager
+        if (sysMan != nullptr)
+        {
+            mSysMan = sysMan;
+        }
+        else
+        {
+            mSysMan = &trManager::SystemManager::GetInstance();
+        }
 
         //Create and register the System Director
         mSysDirector = new trCore::SystemDirector();
@@ -29,6 +29,7 @@
 #include <boost/uuid/nil_generator.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace trBase
@@ -80,6 +81,18 @@ namespace trBase
         mGUID = boost::uuids::string_generator()(idString);
     }
 
+    ////////////////////////////////////////////////
+    void UniqueId::ToBytes(unsigned char* bytes) const
+    {
+        std::copy(mGUID.begin(), mGUID.end(), bytes);
+    }
+
+    ////////////////////////////////////////////////
+    void UniqueId::FromBytes(const unsigned char* bytes)
+    {
+        std::copy(bytes, bytes + BYTE_SIZE, mGUID.begin());
+    }
+
     ////////////////////////////////////////////////
     bool UniqueId::IsNull() const
     {
@@ -41,4 +41,10 @@ namespace trCore
     {
         return MESSAGE_TYPE;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessageCameraSynch::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::SYSTEM;
+    }
 }
@@ -41,4 +41,10 @@ namespace trCore
     {
         return MESSAGE_TYPE;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessagePostEventTraversal::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::SYSTEM;
+    }
 }
@@ -41,4 +41,10 @@ namespace trCore
     {
         return MESSAGE_TYPE;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessagePostFrame::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::SYSTEM;
+    }
 }
\ No newline at end of file
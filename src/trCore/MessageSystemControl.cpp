@@ -44,6 +44,12 @@ namespace trCore
         return MESSAGE_TYPE;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessageSystemControl::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::SYSTEM;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     const trCore::SystemControls& MessageSystemControl::GetSysControlType() const 
     {
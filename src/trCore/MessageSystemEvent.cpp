@@ -45,6 +45,12 @@ namespace trCore
         return MESSAGE_TYPE;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessageSystemEvent::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::SYSTEM;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     const trCore::SystemEvents& MessageSystemEvent::GetSysEventType() const
     {
@@ -35,6 +35,7 @@
 #include <trManager/MessageTick.h>
 #include <trBase/SmrtPtr.h>
 #include <trUtil/Logging/Log.h>
+#include <trUtil/Metrics/MetricsRegistry.h>
 
 namespace trCore
 {
@@ -43,9 +44,16 @@ namespace trCore
     const double SystemDirector::MAX_TIME_SCALE = 1048576;              /// Hold the maximum time scale the system can use for positive and negative time (2^20). 
     const double SystemDirector::MIN_TIME_SCALE = 0.03125;              /// Hold the minimum time scale the system can use for positive and negative time (1/32).
 
+    //The frame phases, in the order they run, and their names in the frame phase metrics
+    using FramePhase = void (SystemDirector::*)(const trManager::TimingStructure&);
+    static const size_t FRAME_PHASE_COUNT = 7;
+    static const char* const FRAME_PHASE_NAMES[FRAME_PHASE_COUNT] = { "event_traversal", "post_event_traversal", "pre_frame", "camera_synch", "frame_synch", "frame", "post_frame" };
+
     //////////////////////////////////////////////////////////////////////////
     SystemDirector::SystemDirector(const std::string name) : BaseClass(name)
     {
+        //Calibrate the phase timer now, instead of during the first frame
+        trUtil::Timer::GetFastTicksPerSecond();
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -93,6 +101,26 @@ namespace trCore
         }    
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void SystemDirector::OnAddedToSysMan()
+    {
+        BaseClass::OnAddedToSysMan();
+
+        //The frame metrics carry the same world labels as the System Manager ones, and are
+        //removed with them when the world is destroyed. Frames only run while registered.
+        trUtil::Metrics::MetricsRegistry& registry = trUtil::Metrics::MetricsRegistry::GetInstance();
+        trUtil::Metrics::MetricsRegistry::Labels labels = { { "world", mSysMan->GetName() }, { "world_id", mSysMan->GetUUID().ToString() } };
+        mPhaseHistograms.clear();
+        for (size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+        {
+            trUtil::Metrics::MetricsRegistry::Labels phaseLabels = labels;
+            phaseLabels.push_back({ "phase", FRAME_PHASE_NAMES[i] });
+            mPhaseHistograms.push_back(&registry.GetHistogram("tr_frame_phase_seconds", "Time spent in each phase of the frame loop.",
+                trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, phaseLabels));
+        }
+        mFrameHistogram = &registry.GetHistogram("tr_frame_seconds", "Real time between frames.", trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, labels);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void SystemDirector::Run()
     {
@@ -108,21 +136,20 @@ namespace trCore
             {
                 LOG_D("\n***************** Starting Frame #" + trUtil::StringUtils::ToString<int>(mTimeStruct.frameNumber))
 
-                EventTraversal(mTimeStruct);
-                PostEventTraversal(mTimeStruct);
-                PreFrame(mTimeStruct);
-                CameraSynch(mTimeStruct);
-                FrameSynch(mTimeStruct);
-                Frame(mTimeStruct);
-                PostFrame(mTimeStruct);
+                //Start a new frame for the message time budget, and publish its timing
+                mSysMan->ResetMessageTimeBudget();
+                mSysMan->SetTimingStructure(mTimeStruct);
+
+                RunFramePhases();
 
                 LOG_D("\n***************** Ending Frame #" + trUtil::StringUtils::ToString<int>(mTimeStruct.frameNumber))
 
                 //Get the time between frames in seconds
                 mSystemTimer.Tick();
+                mFrameHistogram->Observe(mSystemTimer.GetSecondsPerTick());
 
                 //Update System Timing
-                UpdateTiming(mTimeStruct, mSystemTimer.GetSecondsPerTick());
+                UpdateTiming(mTimeStruct, mFixedDeltaTime > 0. ? mFixedDeltaTime : mSystemTimer.GetSecondsPerTick());
             }
         }
     }
@@ -145,25 +172,41 @@ namespace trCore
             {
                 LOG_D("\n***************** Starting Frame #" + trUtil::StringUtils::ToString<int>(mTimeStruct.frameNumber))
 
-                EventTraversal(mTimeStruct);
-                PostEventTraversal(mTimeStruct);
-                PreFrame(mTimeStruct);
-                CameraSynch(mTimeStruct);
-                FrameSynch(mTimeStruct);
-                Frame(mTimeStruct);
-                PostFrame(mTimeStruct);
+                //Start a new frame for the message time budget, and publish its timing
+                mSysMan->ResetMessageTimeBudget();
+                mSysMan->SetTimingStructure(mTimeStruct);
+
+                RunFramePhases();
 
                 LOG_D("\n***************** Ending Frame #" + trUtil::StringUtils::ToString<int>(mTimeStruct.frameNumber))
 
                     //Get the time between frames in seconds
                     mSystemTimer.Tick();
+                mFrameHistogram->Observe(mSystemTimer.GetSecondsPerTick());
 
                 //Update System Timing
-                UpdateTiming(mTimeStruct, mSystemTimer.GetSecondsPerTick());
+                UpdateTiming(mTimeStruct, mFixedDeltaTime > 0. ? mFixedDeltaTime : mSystemTimer.GetSecondsPerTick());
             }
         }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void SystemDirector::RunFramePhases()
+    {
+        static const FramePhase FRAME_PHASES[FRAME_PHASE_COUNT] = { &SystemDirector::EventTraversal, &SystemDirector::PostEventTraversal, &SystemDirector::PreFrame,
+            &SystemDirector::CameraSynch, &SystemDirector::FrameSynch, &SystemDirector::Frame, &SystemDirector::PostFrame };
+
+        trUtil::TimeTicks phaseStart = trUtil::Timer::FastTick();
+        for (size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+        {
+            (this->*FRAME_PHASES[i])(mTimeStruct);
+
+            trUtil::TimeTicks phaseEnd = trUtil::Timer::FastTick();
+            mPhaseHistograms[i]->Observe(trUtil::Timer::FastDeltaSec(phaseStart, phaseEnd));
+            phaseStart = phaseEnd;
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     bool SystemDirector::IsRunning()
     {
@@ -187,6 +230,18 @@ namespace trCore
         return mTimeStruct;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void SystemDirector::SetFixedDeltaTime(double dt)
+    {
+        mFixedDeltaTime = dt > 0. ? dt : 0.;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double SystemDirector::GetFixedDeltaTime() const
+    {
+        return mFixedDeltaTime;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void SystemDirector::UpdateTiming(trManager::TimingStructure& timeStruct, double dt)
     {
@@ -324,6 +379,9 @@ namespace trCore
         //Make the System Manager send out all its queued messages after the Post Frame and System Event messages got processed.
         mSysMan->ProcessMessages();
 
+        //Apply the positions published this frame, and move the entities in and out of the areas of interest.
+        mSysMan->UpdateSpatialIndex();
+
         //Removes all entities that were unregistered during this frame. 
         mSysMan->RemoveMarkedEntities();
 
@@ -0,0 +1,260 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trLogView/Utils.h>
+
+#include <trUtil/Logging/Log.h>
+#include <trUtil/Logging/LogFile.h>
+#include <trUtil/Logging/LogReaderBinary.h>
+#include <trUtil/Logging/LogWriterFile.h>
+
+#include <osg/ref_ptr>
+#include <osgDB/FileNameUtils>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+//Forward declaration
+int RenderHtml(trUtil::Logging::LogReaderBinary& reader, const std::string& outputFile);
+int RenderStream(trUtil::Logging::LogReaderBinary& reader, const std::string& outputFile, bool json);
+void WriteText(std::ostream& out, const trUtil::Logging::LogWriter::LogData& logData);
+void WriteJson(std::ostream& out, const trUtil::Logging::LogWriter::LogData& logData);
+void WriteJsonString(std::ostream& out, const std::string& text);
+
+/**
+ * Software's main function.
+ */
+int main(int argc, char** argv)
+{
+    std::string inputFile;
+    std::string outputFile;
+    std::string format = FORMAT_TEXT;
+
+    //Parse command line arguments
+    ParseCmdLineArgs(argc, argv, inputFile, outputFile, format);
+
+    trUtil::Logging::LogReaderBinary reader;
+    if (!reader.Open(inputFile))
+    {
+        std::cerr << EXE_NAME << ": \"" << inputFile << "\" is not a binary log file." << std::endl;
+        return -1;
+    }
+
+    int result = 0;
+    if (format == FORMAT_HTML)
+    {
+        if (outputFile.empty())
+        {
+            outputFile = osgDB::getNameLessExtension(inputFile) + ".html";
+        }
+        result = RenderHtml(reader, outputFile);
+    }
+    else if (format == FORMAT_TEXT || format == FORMAT_JSON)
+    {
+        result = RenderStream(reader, outputFile, format == FORMAT_JSON);
+    }
+    else
+    {
+        std::cerr << EXE_NAME << ": Unknown format \"" << format << "\"." << std::endl;
+        return -1;
+    }
+
+    if (reader.IsCorrupt())
+    {
+        std::cerr << EXE_NAME << ": The log ends in a damaged record, the rest of the file was skipped." << std::endl;
+    }
+    return result;
+}
+
+/**
+ * Writes the log out in the same HTML the file logger produces.
+ */
+int RenderHtml(trUtil::Logging::LogReaderBinary& reader, const std::string& outputFile)
+{
+    trUtil::Logging::LogFile::SetTitle(reader.GetTitle());
+
+    osg::ref_ptr<trUtil::Logging::LogWriterFile> writer = new trUtil::Logging::LogWriterFile(outputFile);
+    writer->SetFlushEachMessage(false);
+    writer->OpenFile();
+    if (writer->IsOpenFailed())
+    {
+        return -1;
+    }
+
+    trUtil::Logging::LogWriter::LogData logData;
+    trUtil::Logging::LogReaderBinary::EntryType entry;
+    while ((entry = reader.ReadNext(logData)) != trUtil::Logging::LogReaderBinary::ENTRY_END)
+    {
+        if (entry == trUtil::Logging::LogReaderBinary::ENTRY_MESSAGE)
+        {
+            writer->LogMessage(logData);
+        }
+        else
+        {
+            writer->LogHorizRule();
+        }
+    }
+    return 0;
+}
+
+/**
+ * Writes the log out as plain text or JSON lines, to a file or the console.
+ */
+int RenderStream(trUtil::Logging::LogReaderBinary& reader, const std::string& outputFile, bool json)
+{
+    std::ofstream file;
+    if (!outputFile.empty())
+    {
+        file.open(outputFile.c_str());
+        if (!file.is_open())
+        {
+            std::cerr << EXE_NAME << ": Could not open \"" << outputFile << "\"." << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& out = outputFile.empty() ? std::cout : file;
+
+    trUtil::Logging::LogWriter::LogData logData;
+    trUtil::Logging::LogReaderBinary::EntryType entry;
+    while ((entry = reader.ReadNext(logData)) != trUtil::Logging::LogReaderBinary::ENTRY_END)
+    {
+        if (entry == trUtil::Logging::LogReaderBinary::ENTRY_HORIZ_RULE)
+        {
+            if (!json)
+            {
+                out << "--------------------------------------------------------------------------------\n";
+            }
+        }
+        else if (json)
+        {
+            WriteJson(out, logData);
+        }
+        else
+        {
+            WriteText(out, logData);
+        }
+    }
+    out.flush();
+    return 0;
+}
+
+/**
+ * Writes a message in the same layout as the console logger.
+ */
+void WriteText(std::ostream& out, const trUtil::Logging::LogWriter::LogData& logData)
+{
+    out << "[" << logData.time.ToString(trUtil::DateTime::TimeFormat::CLOCK_TIME_24_HOUR_FORMAT);
+
+    if (logData.frameNumber > 0)
+    {
+        out << " Frm# " << logData.frameNumber;
+    }
+
+    out << " " << trUtil::Logging::Log::GetLogLevelString(logData.logLevel) << "] ";
+
+    out << logData.msg << " [";
+
+    if (!logData.logName.empty())
+    {
+        out << "'" << logData.logName << "' ";
+    }
+
+    if (!logData.method.empty())
+    {
+        out << logData.method << "()";
+    }
+
+    if (!logData.file.empty())
+    {
+        out << " " << logData.file;
+
+        if (logData.line > 0)
+        {
+            out << "(" << logData.line << ")";
+        }
+    }
+
+    out << "]\n";
+}
+
+/**
+ * Writes a message as one JSON object per line.
+ */
+void WriteJson(std::ostream& out, const trUtil::Logging::LogWriter::LogData& logData)
+{
+    char date[16];
+    snprintf(date, sizeof(date), "%04u-%02u-%02u", logData.time.GetYear(), logData.time.GetMonth(), logData.time.GetDay());
+
+    out << "{\"date\":\"" << date << "\",\"time\":\"" << logData.time.ToString(trUtil::DateTime::TimeFormat::CLOCK_TIME_24_HOUR_FORMAT)
+        << "\",\"frame\":" << logData.frameNumber
+        << ",\"level\":\"" << trUtil::Logging::Log::GetLogLevelString(logData.logLevel)
+        << "\",\"log\":";
+    WriteJsonString(out, logData.logName);
+    out << ",\"method\":";
+    WriteJsonString(out, logData.method);
+    out << ",\"file\":";
+    WriteJsonString(out, logData.file);
+    out << ",\"line\":" << logData.line << ",\"msg\":";
+    WriteJsonString(out, logData.msg);
+    out << "}\n";
+}
+
+/**
+ * Writes a quoted and escaped JSON string.
+ */
+void WriteJsonString(std::ostream& out, const std::string& text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\r':
+            out << "\\r";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                out << escaped;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
\ No newline at end of file
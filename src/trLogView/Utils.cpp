@@ -0,0 +1,66 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trLogView/Utils.h>
+
+#include <iostream>
+#include <cstdlib>
+
+#include <osg/ArgumentParser>
+
+/*
+ * Parses the command line variables that are passed in to the executable
+ */
+void ParseCmdLineArgs(int& argc, char** argv, std::string& inputFile, std::string& outputFile, std::string& format)
+{
+    osg::ArgumentParser arguments(&argc, argv);
+
+    arguments.getApplicationUsage()->setApplicationName(PROGRAM_NAME);
+    arguments.getApplicationUsage()->setCommandLineUsage(EXE_NAME + " <binary log file> [options]");
+
+    arguments.getApplicationUsage()->addCommandLineOption("\n--format <format>          ", "Output format: " + FORMAT_HTML + ", " + FORMAT_TEXT + " or " + FORMAT_JSON + " (JSON lines). Defaults to " + FORMAT_TEXT);
+    arguments.getApplicationUsage()->addCommandLineOption("\n--output <filename>        ", "The file to write to. Defaults to the console for text and JSON, and to the log file name with a .html extension for HTML");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--help, /help, -h, /h, /?  ", "Show this help screen.");
+
+    if (arguments.argc() < 2 ||
+        arguments.read("--help") == true ||
+        arguments.read("/help") == true ||
+        arguments.read("-h") == true ||
+        arguments.read("/h") == true ||
+        arguments.read("/?") == true)
+    {
+        arguments.getApplicationUsage()->write(std::cout);
+        exit(0);
+    }
+
+    arguments.read("--format", format);
+    arguments.read("--output", outputFile);
+
+    // Whatever is left that is not an option is the input file.
+    for (int i = 1; i < arguments.argc(); ++i)
+    {
+        if (!arguments.isOption(i))
+        {
+            inputFile = arguments[i];
+            break;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEG/AdaptiveRateController.h>
+
+#include <algorithm>
+
+namespace trMPEG
+{
+    const double AdaptiveRateController::SCALE_STEP = 0.25;
+
+    //////////////////////////////////////////////////////////////////////////
+    AdaptiveRateController::AdaptiveRateController()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void AdaptiveRateController::Reset(const Settings& settings, int bitRate, int frameRate)
+    {
+        mSettings = settings;
+        if (mSettings.maxBitRate <= 0)
+        {
+            mSettings.maxBitRate = bitRate;
+        }
+        if (mSettings.minBitRate <= 0)
+        {
+            mSettings.minBitRate = mSettings.maxBitRate / 4;
+        }
+        if (mSettings.maxFrameRate <= 0)
+        {
+            mSettings.maxFrameRate = frameRate;
+        }
+        if (mSettings.minFrameRate <= 0)
+        {
+            mSettings.minFrameRate = std::max(1, mSettings.maxFrameRate / 4);
+        }
+        mSettings.minBitRate = std::min(mSettings.minBitRate, mSettings.maxBitRate);
+        mSettings.minFrameRate = std::min(mSettings.minFrameRate, mSettings.maxFrameRate);
+        mSettings.minScale = std::min(std::max(mSettings.minScale, 0.1), 1.0);
+
+        mBitRate = mSettings.maxBitRate;
+        mFrameRate = mSettings.maxFrameRate;
+        mScale = 1.0;
+
+        mWorkTimeSum = 0.0;
+        mWorkFrameCount = 0;
+        mLastEvaluation = -1.0;
+        mHoldUntil = 0.0;
+        mLastCongestionEvents = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void AdaptiveRateController::AddFrame(double workTime)
+    {
+        mWorkTimeSum += workTime;
+        ++mWorkFrameCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool AdaptiveRateController::Update(double time, double queueFill, unsigned long long congestionEvents)
+    {
+        // The first call only starts the clock
+        if (mLastEvaluation < 0.0)
+        {
+            mLastEvaluation = time;
+            mHoldUntil = time + mSettings.recoveryTime;
+            mLastCongestionEvents = congestionEvents;
+            return false;
+        }
+
+        if (time - mLastEvaluation < mSettings.evaluationInterval)
+        {
+            return false;
+        }
+
+        // Share of each frame period the encoder is busy
+        double load = mWorkFrameCount > 0 ? mWorkTimeSum / mWorkFrameCount * mFrameRate : 0.0;
+        bool isCongested = congestionEvents > mLastCongestionEvents || queueFill > 0.5;
+        bool isOverloaded = load > 0.9;
+
+        mLastEvaluation = time;
+        mLastCongestionEvents = congestionEvents;
+        mWorkTimeSum = 0.0;
+        mWorkFrameCount = 0;
+
+        int oldBitRate = mBitRate;
+        int oldFrameRate = mFrameRate;
+        double oldScale = mScale;
+
+        if (isCongested)
+        {
+            // The network can't take what we send, send less of it
+            if (mBitRate > mSettings.minBitRate)
+            {
+                mBitRate = std::max(mSettings.minBitRate, mBitRate * 3 / 4);
+            }
+            else
+            {
+                mFrameRate = std::max(mSettings.minFrameRate, mFrameRate * 3 / 4);
+            }
+            mHoldUntil = time + mSettings.recoveryTime;
+        }
+        else if (isOverloaded)
+        {
+            // The encoder can't keep up, give it fewer pixels to work on
+            if (mSettings.scaleResolution && mScale > mSettings.minScale)
+            {
+                mScale = std::max(mSettings.minScale, mScale - SCALE_STEP);
+            }
+            else
+            {
+                mFrameRate = std::max(mSettings.minFrameRate, mFrameRate * 3 / 4);
+            }
+            mHoldUntil = time + mSettings.recoveryTime;
+        }
+        else if (time >= mHoldUntil && queueFill < 0.1 && load < 0.6)
+        {
+            // Healthy for a while, raise one setting a step. The encoding cost grows with the pixel count,
+            // so only go up in resolution if the encoder still has room for it.
+            double nextScale = std::min(1.0, mScale + SCALE_STEP);
+            if (mFrameRate < mSettings.maxFrameRate)
+            {
+                mFrameRate = std::min(mSettings.maxFrameRate, mFrameRate + std::max(1, mSettings.maxFrameRate / 10));
+            }
+            else if (mScale < 1.0 && load * (nextScale * nextScale) / (mScale * mScale) < 0.75)
+            {
+                mScale = nextScale;
+            }
+            else if (mBitRate < mSettings.maxBitRate)
+            {
+                mBitRate = std::min(mSettings.maxBitRate, mBitRate + std::max(1, mSettings.maxBitRate / 10));
+            }
+            mHoldUntil = time + mSettings.recoveryTime;
+        }
+
+        return mBitRate != oldBitRate || mFrameRate != oldFrameRate || mScale != oldScale;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const AdaptiveRateController::Settings& AdaptiveRateController::GetSettings() const
+    {
+        return mSettings;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int AdaptiveRateController::GetBitRate() const
+    {
+        return mBitRate;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int AdaptiveRateController::GetFrameRate() const
+    {
+        return mFrameRate;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double AdaptiveRateController::GetScale() const
+    {
+        return mScale;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void AdaptiveRateController::SetCurrent(int bitRate, int frameRate, double scale)
+    {
+        mBitRate = bitRate;
+        mFrameRate = frameRate;
+        mScale = scale;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEG/CaptureTimestamp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    // Identifies our user data SEI messages. No zero bytes, so the message never needs emulation prevention.
+    const uint8_t MESSAGE_UUID[16] = { 'T', 'R', 'M', 'P', 'E', 'G', '-', 'C', 'A', 'P', 'T', 'U', 'R', 'E', '-', '1' };
+
+    // The time is split into 7 bit groups with the high bit set, again so it never contains zero bytes
+    const int TIME_GROUP_COUNT = 10;
+
+    const uint8_t SEI_USER_DATA_UNREGISTERED = 5;
+    const uint8_t H264_NAL_SEI = 6;
+    const uint8_t HEVC_NAL_PREFIX_SEI = 39;
+    const uint8_t RBSP_TRAILING_BITS = 0x80;
+}
+
+namespace trMPEG
+{
+    //////////////////////////////////////////////////////////////////////////
+    bool CaptureTimestamp::IsCodecSupported(AVCodecID codecId)
+    {
+        return codecId == AV_CODEC_ID_H264 || codecId == AV_CODEC_ID_HEVC;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int64_t CaptureTimestamp::GetWallClockTime()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool CaptureTimestamp::Insert(AVPacket* packet, AVCodecID codecId, int64_t captureTime)
+    {
+        uint8_t message[MAX_MESSAGE_SIZE];
+        int messageSize = BuildMessage(codecId, captureTime, message);
+        if (messageSize == 0)
+        {
+            return false;
+        }
+
+        int position = FindFirstSlice(packet->data, packet->size, codecId);
+        if (position < 0)
+        {
+            return false;
+        }
+
+        // Make room for the message in front of the slice
+        int oldSize = packet->size;
+        if (av_grow_packet(packet, messageSize) < 0)
+        {
+            return false;
+        }
+        memmove(packet->data + position + messageSize, packet->data + position, oldSize - position);
+        memcpy(packet->data + position, message, messageSize);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool CaptureTimestamp::Find(const uint8_t* data, int size, int64_t& captureTime)
+    {
+        if (data == nullptr || size <= 0)
+        {
+            return false;
+        }
+
+        const uint8_t* end = data + size;
+        const uint8_t* found = std::search(data, end, MESSAGE_UUID, MESSAGE_UUID + sizeof(MESSAGE_UUID));
+        if (end - found < static_cast<int>(sizeof(MESSAGE_UUID)) + TIME_GROUP_COUNT)
+        {
+            return false;
+        }
+
+        uint64_t time = 0;
+        const uint8_t* groups = found + sizeof(MESSAGE_UUID);
+        for (int i = 0; i < TIME_GROUP_COUNT; ++i)
+        {
+            time = (time << 7) | (groups[i] & 0x7F);
+        }
+        captureTime = static_cast<int64_t>(time);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int CaptureTimestamp::BuildMessage(AVCodecID codecId, int64_t captureTime, uint8_t* message)
+    {
+        if (!IsCodecSupported(codecId))
+        {
+            return 0;
+        }
+
+        int size = 0;
+
+        // Start code and NAL header
+        message[size++] = 0;
+        message[size++] = 0;
+        message[size++] = 0;
+        message[size++] = 1;
+        if (codecId == AV_CODEC_ID_H264)
+        {
+            message[size++] = H264_NAL_SEI;
+        }
+        else
+        {
+            message[size++] = HEVC_NAL_PREFIX_SEI << 1;
+            message[size++] = 1;    // Layer 0, temporal id 0
+        }
+
+        // SEI message header, then the payload
+        message[size++] = SEI_USER_DATA_UNREGISTERED;
+        message[size++] = sizeof(MESSAGE_UUID) + TIME_GROUP_COUNT;
+        memcpy(message + size, MESSAGE_UUID, sizeof(MESSAGE_UUID));
+        size += sizeof(MESSAGE_UUID);
+
+        uint64_t time = static_cast<uint64_t>(captureTime);
+        for (int i = TIME_GROUP_COUNT - 1; i >= 0; --i)
+        {
+            message[size + i] = 0x80 | (time & 0x7F);
+            time >>= 7;
+        }
+        size += TIME_GROUP_COUNT;
+
+        message[size++] = RBSP_TRAILING_BITS;
+        return size;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int CaptureTimestamp::FindFirstSlice(const uint8_t* data, int size, AVCodecID codecId)
+    {
+        for (int i = 0; i + 3 < size; ++i)
+        {
+            // Look for a 00 00 01 start code
+            if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1)
+            {
+                continue;
+            }
+
+            uint8_t header = data[i + 3];
+            bool isSlice = false;
+            if (codecId == AV_CODEC_ID_H264)
+            {
+                int type = header & 0x1F;
+                isSlice = type >= 1 && type <= 5;
+            }
+            else
+            {
+                int type = (header >> 1) & 0x3F;
+                isSlice = type <= 31;
+            }
+
+            if (isSlice)
+            {
+                // Include the leading zero of a four byte start code
+                return (i > 0 && data[i - 1] == 0) ? i - 1 : i;
+            }
+            i += 2;
+        }
+        return -1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,386 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEG/ColorConverter.h>
+
+#include <cstddef>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#   define TR_COLOR_CONVERTER_X86
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#       include <immintrin.h>
+#       define TR_TARGET_SSE41
+#       define TR_TARGET_AVX2
+#   else
+#       include <immintrin.h>
+#       define TR_TARGET_SSE41 __attribute__((target("sse4.1")))
+#       define TR_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#endif
+
+namespace
+{
+    //BT.601 limited range. Luma uses 7 bit coefficients, so they fit the signed bytes of the SIMD
+    //multiply-add, chroma uses 8 bit ones. Chroma is taken from the rounded average of each 2x2 block,
+    //vertical pair first, the same order the SIMD kernels use, so all the kernels give the same output.
+    const int Y_R = 33, Y_G = 64, Y_B = 13;
+    const int U_R = -38, U_G = -74, U_B = 112;
+    const int V_R = 112, V_G = -94, V_B = -18;
+
+    typedef void (*RowPairFunc)(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int width);
+
+    //////////////////////////////////////////////////////////////////////////
+    inline int Average(int a, int b)
+    {
+        return (a + b + 1) >> 1;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    inline uint8_t ToY(int r, int g, int b)
+    {
+        return static_cast<uint8_t>(((Y_R * r + Y_G * g + Y_B * b + 64) >> 7) + 16);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    inline uint8_t ToU(int r, int g, int b)
+    {
+        return static_cast<uint8_t>(((U_R * r + U_G * g + U_B * b + 128) >> 8) + 128);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    inline uint8_t ToV(int r, int g, int b)
+    {
+        return static_cast<uint8_t>(((V_R * r + V_G * g + V_B * b + 128) >> 8) + 128);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void RowPairScalarFrom(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int start, int width)
+    {
+        for (int x = start; x < width; x += 2)
+        {
+            //An odd width reuses the last column for the missing neighbour
+            int next = (x + 1 < width) ? x + 1 : x;
+            const uint8_t* a0 = row0 + x * 4;
+            const uint8_t* a1 = row0 + next * 4;
+            const uint8_t* b0 = row1 + x * 4;
+            const uint8_t* b1 = row1 + next * 4;
+
+            y0[x] = ToY(a0[0], a0[1], a0[2]);
+            y1[x] = ToY(b0[0], b0[1], b0[2]);
+            if (next != x)
+            {
+                y0[next] = ToY(a1[0], a1[1], a1[2]);
+                y1[next] = ToY(b1[0], b1[1], b1[2]);
+            }
+
+            int r = Average(Average(a0[0], b0[0]), Average(a1[0], b1[0]));
+            int g = Average(Average(a0[1], b0[1]), Average(a1[1], b1[1]));
+            int b = Average(Average(a0[2], b0[2]), Average(a1[2], b1[2]));
+            u[x / 2] = ToU(r, g, b);
+            v[x / 2] = ToV(r, g, b);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void RowPairScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int width)
+    {
+        RowPairScalarFrom(row0, row1, y0, y1, u, v, 0, width);
+    }
+
+#ifdef TR_COLOR_CONVERTER_X86
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_SSE41 inline __m128i LumaSSE41(__m128i p0, __m128i p1, __m128i p2, __m128i p3)
+    {
+        const __m128i coef = _mm_setr_epi8(Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0);
+        const __m128i round = _mm_set1_epi16(64);
+
+        //Multiply-add gives R+G and B+A pairs, the horizontal add finishes one sum per pixel
+        __m128i sum0 = _mm_hadd_epi16(_mm_maddubs_epi16(p0, coef), _mm_maddubs_epi16(p1, coef));
+        __m128i sum1 = _mm_hadd_epi16(_mm_maddubs_epi16(p2, coef), _mm_maddubs_epi16(p3, coef));
+        sum0 = _mm_srli_epi16(_mm_add_epi16(sum0, round), 7);
+        sum1 = _mm_srli_epi16(_mm_add_epi16(sum1, round), 7);
+        return _mm_adds_epu8(_mm_packus_epi16(sum0, sum1), _mm_set1_epi8(16));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_SSE41 inline __m128i AverageColumnsSSE41(__m128i p0, __m128i p1)
+    {
+        __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(p0), _mm_castsi128_ps(p1), 0x88);
+        __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(p0), _mm_castsi128_ps(p1), 0xdd);
+        return _mm_avg_epu8(_mm_castps_si128(even), _mm_castps_si128(odd));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_SSE41 inline __m128i ChromaSSE41(__m128i h0, __m128i h1, __m128i coef)
+    {
+        __m128i sum = _mm_hadd_epi16(_mm_maddubs_epi16(h0, coef), _mm_maddubs_epi16(h1, coef));
+        sum = _mm_srai_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+        return _mm_add_epi16(sum, _mm_set1_epi16(128));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_SSE41 void RowPairSSE41(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int width)
+    {
+        const __m128i uCoef = _mm_setr_epi8(U_R, U_G, U_B, 0, U_R, U_G, U_B, 0, U_R, U_G, U_B, 0, U_R, U_G, U_B, 0);
+        const __m128i vCoef = _mm_setr_epi8(V_R, V_G, V_B, 0, V_R, V_G, V_B, 0, V_R, V_G, V_B, 0, V_R, V_G, V_B, 0);
+
+        //16 pixels of both rows per loop
+        int x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            const __m128i* src0 = reinterpret_cast<const __m128i*>(row0 + x * 4);
+            const __m128i* src1 = reinterpret_cast<const __m128i*>(row1 + x * 4);
+            __m128i a0 = _mm_loadu_si128(src0);
+            __m128i a1 = _mm_loadu_si128(src0 + 1);
+            __m128i a2 = _mm_loadu_si128(src0 + 2);
+            __m128i a3 = _mm_loadu_si128(src0 + 3);
+            __m128i b0 = _mm_loadu_si128(src1);
+            __m128i b1 = _mm_loadu_si128(src1 + 1);
+            __m128i b2 = _mm_loadu_si128(src1 + 2);
+            __m128i b3 = _mm_loadu_si128(src1 + 3);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(y0 + x), LumaSSE41(a0, a1, a2, a3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + x), LumaSSE41(b0, b1, b2, b3));
+
+            __m128i h0 = AverageColumnsSSE41(_mm_avg_epu8(a0, b0), _mm_avg_epu8(a1, b1));
+            __m128i h1 = AverageColumnsSSE41(_mm_avg_epu8(a2, b2), _mm_avg_epu8(a3, b3));
+            __m128i uv = _mm_packus_epi16(ChromaSSE41(h0, h1, uCoef), ChromaSSE41(h0, h1, vCoef));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), uv);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), _mm_srli_si128(uv, 8));
+        }
+
+        RowPairScalarFrom(row0, row1, y0, y1, u, v, x, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_AVX2 inline __m256i LumaAVX2(__m256i p0, __m256i p1, __m256i p2, __m256i p3)
+    {
+        const __m256i coef = _mm256_setr_epi8(Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0,
+                                              Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0, Y_R, Y_G, Y_B, 0);
+        const __m256i round = _mm256_set1_epi16(64);
+
+        __m256i sum0 = _mm256_hadd_epi16(_mm256_maddubs_epi16(p0, coef), _mm256_maddubs_epi16(p1, coef));
+        __m256i sum1 = _mm256_hadd_epi16(_mm256_maddubs_epi16(p2, coef), _mm256_maddubs_epi16(p3, coef));
+        sum0 = _mm256_srli_epi16(_mm256_add_epi16(sum0, round), 7);
+        sum1 = _mm256_srli_epi16(_mm256_add_epi16(sum1, round), 7);
+
+        //The adds and packs work per 128 bit lane, put the groups of 4 pixels back in order
+        __m256i packed = _mm256_packus_epi16(sum0, sum1);
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        return _mm256_adds_epu8(packed, _mm256_set1_epi8(16));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_AVX2 inline __m256i AverageColumnsAVX2(__m256i p0, __m256i p1)
+    {
+        __m256 even = _mm256_shuffle_ps(_mm256_castsi256_ps(p0), _mm256_castsi256_ps(p1), 0x88);
+        __m256 odd = _mm256_shuffle_ps(_mm256_castsi256_ps(p0), _mm256_castsi256_ps(p1), 0xdd);
+        __m256i averaged = _mm256_avg_epu8(_mm256_castps_si256(even), _mm256_castps_si256(odd));
+        return _mm256_permutevar8x32_epi32(averaged, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_AVX2 inline __m256i ChromaAVX2(__m256i h0, __m256i h1, __m256i coef)
+    {
+        __m256i sum = _mm256_hadd_epi16(_mm256_maddubs_epi16(h0, coef), _mm256_maddubs_epi16(h1, coef));
+        sum = _mm256_srai_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(128)), 8);
+        return _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TR_TARGET_AVX2 void RowPairAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, int width)
+    {
+        const __m256i uCoef = _mm256_setr_epi8(U_R, U_G, U_B, 0, U_R, U_G, U_B, 0, U_R, U_G, U_B, 0, U_R, U_G, U_B, 0,
+                                               U_R, U_G, U_B, 0, U_R, U_G, U_B, 0, U_R, U_G, U_B, 0, U_R, U_G, U_B, 0);
+        const __m256i vCoef = _mm256_setr_epi8(V_R, V_G, V_B, 0, V_R, V_G, V_B, 0, V_R, V_G, V_B, 0, V_R, V_G, V_B, 0,
+                                               V_R, V_G, V_B, 0, V_R, V_G, V_B, 0, V_R, V_G, V_B, 0, V_R, V_G, V_B, 0);
+
+        //32 pixels of both rows per loop
+        int x = 0;
+        for (; x + 32 <= width; x += 32)
+        {
+            const __m256i* src0 = reinterpret_cast<const __m256i*>(row0 + x * 4);
+            const __m256i* src1 = reinterpret_cast<const __m256i*>(row1 + x * 4);
+            __m256i a0 = _mm256_loadu_si256(src0);
+            __m256i a1 = _mm256_loadu_si256(src0 + 1);
+            __m256i a2 = _mm256_loadu_si256(src0 + 2);
+            __m256i a3 = _mm256_loadu_si256(src0 + 3);
+            __m256i b0 = _mm256_loadu_si256(src1);
+            __m256i b1 = _mm256_loadu_si256(src1 + 1);
+            __m256i b2 = _mm256_loadu_si256(src1 + 2);
+            __m256i b3 = _mm256_loadu_si256(src1 + 3);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y0 + x), LumaAVX2(a0, a1, a2, a3));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y1 + x), LumaAVX2(b0, b1, b2, b3));
+
+            __m256i h0 = AverageColumnsAVX2(_mm256_avg_epu8(a0, b0), _mm256_avg_epu8(a1, b1));
+            __m256i h1 = AverageColumnsAVX2(_mm256_avg_epu8(a2, b2), _mm256_avg_epu8(a3, b3));
+            __m256i uv = _mm256_packus_epi16(ChromaAVX2(h0, h1, uCoef), ChromaAVX2(h0, h1, vCoef));
+            uv = _mm256_permutevar8x32_epi32(uv, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x / 2), _mm256_castsi256_si128(uv));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(v + x / 2), _mm256_extracti128_si256(uv, 1));
+        }
+
+        RowPairScalarFrom(row0, row1, y0, y1, u, v, x, width);
+    }
+
+    /**
+     * @struct  CpuFeatures
+     *
+     * @brief   The instruction sets the SIMD kernels need, checked once.
+     */
+    struct CpuFeatures
+    {
+        bool sse41 = false;
+        bool avx2 = false;
+
+        CpuFeatures()
+        {
+#   if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+
+            __cpuid(info, 1);
+            sse41 = (info[2] & (1 << 19)) != 0;
+            bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+
+            if (maxLeaf >= 7 && osSavesAvx)
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#   else
+            __builtin_cpu_init();
+            sse41 = __builtin_cpu_supports("sse4.1") != 0;
+            avx2 = __builtin_cpu_supports("avx2") != 0;
+#   endif
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    const CpuFeatures& GetCpuFeatures()
+    {
+        static const CpuFeatures features;
+        return features;
+    }
+
+#endif
+}
+
+namespace trMPEG
+{
+    //////////////////////////////////////////////////////////////////////////
+    bool ColorConverter::IsKernelSupported(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::AUTO:
+        case Kernel::SCALAR:
+            return true;
+#ifdef TR_COLOR_CONVERTER_X86
+        case Kernel::SSE41:
+            return GetCpuFeatures().sse41;
+        case Kernel::AVX2:
+            return GetCpuFeatures().avx2;
+#endif
+        default:
+            return false;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ColorConverter::Kernel ColorConverter::GetBestKernel()
+    {
+        if (IsKernelSupported(Kernel::AVX2))
+        {
+            return Kernel::AVX2;
+        }
+        else if (IsKernelSupported(Kernel::SSE41))
+        {
+            return Kernel::SSE41;
+        }
+        return Kernel::SCALAR;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const char* ColorConverter::GetKernelName(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::SWSCALE:
+            return "swscale";
+        case Kernel::AUTO:
+            return "auto";
+        case Kernel::SCALAR:
+            return "scalar";
+        case Kernel::SSE41:
+            return "sse4.1";
+        case Kernel::AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ColorConverter::RGBAToI420(Kernel kernel, const uint8_t* rgba, int rgbaStride, uint8_t* const yuv[3], const int yuvStride[3], int width, int height)
+    {
+        if (kernel == Kernel::AUTO)
+        {
+            kernel = GetBestKernel();
+        }
+
+        if (!IsKernelSupported(kernel))
+        {
+            return false;
+        }
+
+        RowPairFunc rowPair = RowPairScalar;
+#ifdef TR_COLOR_CONVERTER_X86
+        if (kernel == Kernel::SSE41)
+        {
+            rowPair = RowPairSSE41;
+        }
+        else if (kernel == Kernel::AVX2)
+        {
+            rowPair = RowPairAVX2;
+        }
+#endif
+
+        for (int row = 0; row < height; row += 2)
+        {
+            //An odd height converts the last row against itself
+            bool hasSecondRow = row + 1 < height;
+            const uint8_t* row0 = rgba + static_cast<std::ptrdiff_t>(row) * rgbaStride;
+            const uint8_t* row1 = hasSecondRow ? row0 + rgbaStride : row0;
+            uint8_t* y0 = yuv[0] + static_cast<std::ptrdiff_t>(row) * yuvStride[0];
+            uint8_t* y1 = hasSecondRow ? y0 + yuvStride[0] : y0;
+            uint8_t* u = yuv[1] + static_cast<std::ptrdiff_t>(row / 2) * yuvStride[1];
+            uint8_t* v = yuv[2] + static_cast<std::ptrdiff_t>(row / 2) * yuvStride[2];
+
+            rowPair(row0, row1, y0, y1, u, v, width);
+        }
+        return true;
+    }
+}
\ No newline at end of file
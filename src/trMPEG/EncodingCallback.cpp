@@ -22,6 +22,7 @@
 #include <trMPEG/EncodingCallback.h>
 
 #include <trUtil/Logging/Log.h>
+#include <trUtil/Timer.h>
 
 namespace trMPEG
 {
@@ -215,11 +216,83 @@ namespace trMPEG
         return mStream.GetFrameRate();
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetEncoderThreadCount(int count)
+    {
+        mStream.SetEncoderThreadCount(count);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int EncodingCallback::GetEncoderThreadCount()
+    {
+        return mStream.GetEncoderThreadCount();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetEncoderThreadType(StreamServer::EncoderThreadType type)
+    {
+        mStream.SetEncoderThreadType(type);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    StreamServer::EncoderThreadType EncodingCallback::GetEncoderThreadType()
+    {
+        return mStream.GetEncoderThreadType();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetEncoderCpuAffinity(const std::vector<int>& cpus)
+    {
+        mStream.SetEncoderCpuAffinity(cpus);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetEmbedCaptureTime(bool embed)
+    {
+        mStream.SetEmbedCaptureTime(embed);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetAdaptiveRateControl(bool enable)
+    {
+        mStream.SetAdaptiveRateControl(enable);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetKeepAliveInterval(unsigned int intervalMs)
+    {
+        mStream.SetKeepAliveInterval(intervalMs);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EncodingCallback::SetAdaptiveRateSettings(const AdaptiveRateController::Settings& settings)
+    {
+        mStream.SetAdaptiveRateSettings(settings);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trUtil::Metrics::Histogram* EncodingCallback::GetLatencyHistogram(StreamServer::LatencyStage stage) const
+    {
+        return mStream.GetLatencyHistogram(stage);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    StreamServer& EncodingCallback::AddSimulcastOutput()
+    {
+        mSimulcastOutputs.push_back(std::unique_ptr<StreamServer>(new StreamServer()));
+        mStream.AddSimulcastOutput(*mSimulcastOutputs.back());
+        mSimulcastOutputs.back()->SetSilent(mSilent);
+        return *mSimulcastOutputs.back();
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void EncodingCallback::operator () (osg::RenderInfo& renderInfo) const
     {
         if (mEnabled)
         {
+            //The capture stage of the frame's latency starts here, before the read back
+            trUtil::TimeTicks captureTime = trUtil::Timer::FastTick();
+
             if (mTexturePtr)
             {
                 renderInfo.getState()->applyTextureAttribute(0, mTexturePtr);
@@ -229,7 +302,7 @@ namespace trMPEG
             if (mStream.IsInit())
             {
                 //Encode a frame
-                mStream.Encode(mFrameData);
+                mStream.Encode(mFrameData, captureTime);
             }
             else
             {
@@ -20,10 +20,13 @@
 */
 
 #include <trMPEG/StreamServer.h>
+#include <trMPEG/CaptureTimestamp.h>
 
 #include <trUtil/Logging/Log.h>
+#include <trUtil/PlatformMacros.h>
 #include <trUtil/StringUtils.h>
 #include <trUtil/Timer.h>
+#include <trUtil/Metrics/MetricsRegistry.h>
 
 #include <osg/Timer>
 #include <osgDB/WriteFile>
@@ -34,6 +37,93 @@
 #include <iostream>
 #include <chrono>
 
+#ifdef TR_WIN
+    #include <windows.h>
+#elif defined(TR_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace
+{
+#ifdef TR_WIN
+    typedef DWORD_PTR AffinityMask;
+#elif defined(TR_LINUX)
+    typedef cpu_set_t AffinityMask;
+#else
+    typedef int AffinityMask;
+#endif
+
+    /**
+     * Pins the calling thread to the given CPU cores, and optionally saves the mask it had before so
+     * it can be restored. Threads started by the calling thread inherit the new mask. Returns false on
+     * failure, and on platforms without thread affinity.
+     */
+    bool SetCurrentThreadAffinity(const std::vector<int>& cpus, AffinityMask* previousMask = nullptr)
+    {
+#ifdef TR_WIN
+        AffinityMask mask = 0;
+        for (int cpu : cpus)
+        {
+            if (cpu >= 0 && cpu < static_cast<int>(sizeof(AffinityMask) * 8))
+            {
+                mask |= AffinityMask(1) << cpu;
+            }
+        }
+
+        AffinityMask oldMask = SetThreadAffinityMask(GetCurrentThread(), mask);
+        if (previousMask != nullptr)
+        {
+            *previousMask = oldMask;
+        }
+        return oldMask != 0;
+#elif defined(TR_LINUX)
+        if (previousMask != nullptr && pthread_getaffinity_np(pthread_self(), sizeof(AffinityMask), previousMask) != 0)
+        {
+            return false;
+        }
+
+        AffinityMask mask;
+        CPU_ZERO(&mask);
+        for (int cpu : cpus)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &mask);
+            }
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(AffinityMask), &mask) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Restores a mask saved by SetCurrentThreadAffinity.
+     */
+    void RestoreCurrentThreadAffinity(const AffinityMask& mask)
+    {
+#ifdef TR_WIN
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+#elif defined(TR_LINUX)
+        pthread_setaffinity_np(pthread_self(), sizeof(AffinityMask), &mask);
+#endif
+    }
+
+    /**
+     * Simulcast outputs that share a resolution. The source frame is scaled once for all of them.
+     */
+    struct SimulcastGroup
+    {
+        int width = 0;
+        int height = 0;
+        SwsContext* scaleContext = nullptr;     /// Null if the resolution matches the source
+        AVFrame* scaledFrame = nullptr;
+        std::vector<uint8_t> packedFrame;
+        std::vector<trMPEG::StreamServer*> outputs;
+    };
+}
+
 namespace trMPEG
 {   
     const trUtil::RefStr StreamServer::DEFAULT_TITLE = trUtil::RefStr("trMPEG Broadcast");
@@ -45,6 +135,8 @@ namespace trMPEG
     const int StreamServer::DEFAULT_FRAME_WIDTH = 800;
     const int StreamServer::DEFAULT_FRAME_HEIGHT = 600;
     const int StreamServer::DEFAULT_FRAME_RATE = 60;
+    const int StreamServer::DEFAULT_PACKET_QUEUE_SIZE = 64;
+    const int StreamServer::DEFAULT_GOP_SIZE = 3;
 
 	//////////////////////////////////////////////////////////////////////////
 	StreamServer::StreamServer()
@@ -81,6 +173,12 @@ namespace trMPEG
             }
             LOG_D("Main Rendering thread terminated")
         }        
+
+        if (mMuxThreadPtr)
+        {
+            delete mMuxThreadPtr;
+            mMuxThreadPtr = nullptr;
+        }
 	}
 
     //////////////////////////////////////////////////////////////////////////
@@ -100,6 +198,23 @@ namespace trMPEG
             exit(1);
         }
 
+        // A file can't change its settings half way through, and simulcast outputs are fed at our input resolution
+        if (mAdaptiveRateControl && !mIsBroadcast)
+        {
+            LOG_W("Adaptive rate control is only used for broadcasts, it will be turned off")
+            mAdaptiveRateControl = false;
+        }
+        if (mAdaptiveRateControl && mAdaptiveRateSettings.scaleResolution && !mSimulcastOutputs.empty())
+        {
+            LOG_W("Adaptive rate control can't scale the resolution of a stream with simulcast outputs, only the bit rate and frame rate will adapt")
+            mAdaptiveRateSettings.scaleResolution = false;
+        }
+        mRateController.Reset(mAdaptiveRateSettings, mBitRate, mFrameRate);
+        mCurrentBitRate = mBitRate;
+        mCurrentFrameRate = mFrameRate;
+        mCurrentWidth = mFrameWidth;
+        mCurrentHeight = mFrameHeight;
+
         /* Allocate the output Format context */
         if (mIsBroadcast)
         {
@@ -178,7 +293,59 @@ namespace trMPEG
             av_dump_format(mFormatContextPtr, 0, mFileName.c_str(), 1);
         }
 
-        mIsInit = true;
+        //Preallocate the frame slots shared by Encode and the encoder thread
+        InputFrame emptyFrame;
+        emptyFrame.data.resize(GetInputFrameSize());
+        mFrameBuffer.Fill(emptyFrame);
+
+        if (mEmbedCaptureTime && !CaptureTimestamp::IsCodecSupported(mCodecContextPtr->codec_id))
+        {
+            LOG_W("Only H.264 and H.265 streams can carry the capture time, it will not be embedded")
+            mEmbedCaptureTime = false;
+        }
+
+        //Set up the metrics before the encoder thread starts using them
+        trUtil::Metrics::MetricsRegistry& registry = trUtil::Metrics::MetricsRegistry::GetInstance();
+        trUtil::Metrics::MetricsRegistry::Labels labels = { { "stream", mFileName } };
+        mEncodedFramesCounter = &registry.GetCounter("tr_stream_encoded_frames_total", "Frames encoded by the stream server.", labels);
+        mDroppedFramesCounter = &registry.GetCounter("tr_stream_dropped_frames_total", "Frames replaced by a newer one before the encoder picked them up.", labels);
+        mDuplicatedFramesCounter = &registry.GetCounter("tr_stream_duplicated_frames_total", "Frames encoded again because no new frame arrived within the keep alive interval.", labels);
+        mEncodedBytesCounter = &registry.GetCounter("tr_stream_encoded_bytes_total", "Bytes of encoded video sent to the muxer.", labels);
+        mEncodeFpsGauge = &registry.GetGauge("tr_stream_encode_fps", "Frames per second the encoder is producing.", labels);
+        mBitRateGauge = &registry.GetGauge("tr_stream_bitrate_bits_per_second", "Encoded bit rate, measured over the last second.", labels);
+        mPacketQueueDepthGauge = &registry.GetGauge("tr_stream_packet_queue_depth", "Encoded packets waiting for the muxing thread.", labels);
+        mPacketQueueFullCounter = &registry.GetCounter("tr_stream_packet_queue_full_total", "Times the encoder found the packet queue full.", labels);
+        mDroppedPacketsCounter = &registry.GetCounter("tr_stream_dropped_packets_total", "Encoded packets dropped from a full broadcast queue.", labels);
+        mMuxWriteHistogram = &registry.GetHistogram("tr_stream_mux_write_seconds", "Time to write one packet to the output.", trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, labels);
+
+        mEncoderRestartsCounter = &registry.GetCounter("tr_stream_encoder_restarts_total", "Times the adaptive rate control restarted the encoder with new settings.", labels);
+
+        const char* stageNames[] = { "capture", "handoff", "conversion", "encode", "mux", "total" };
+        for (int i = 0; i <= static_cast<int>(LatencyStage::TOTAL); ++i)
+        {
+            trUtil::Metrics::MetricsRegistry::Labels stageLabels = { { "stream", mFileName }, { "stage", stageNames[i] } };
+            mLatencyHistograms[i] = &registry.GetHistogram("tr_stream_latency_seconds", "Time a frame spends in each stage of the stream server.", trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, stageLabels);
+        }
+
+        //Start writing packets to the output in the background, so a slow disk or network does not stall the encoder
+        mMuxThreadPtr = new std::thread(&StreamServer::MuxPackets, this);
+        LOG_D("Setting up muxing thread")
+
+        //The simulcast outputs have to be ready before our encoder thread starts feeding them
+        for (StreamServer* output : mSimulcastOutputs)
+        {
+            if (!output->IsInit())
+            {
+                output->Init();
+            }
+        }
+
+        //Wake up the encoder thread, it is waiting for us to finish
+        {
+            std::lock_guard<std::mutex> signalLock(mFrameSignalLock);
+            mIsInit = true;
+        }
+        mFrameSignal.notify_all();
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -190,8 +357,12 @@ namespace trMPEG
     //////////////////////////////////////////////////////////////////////////
     void StreamServer::ShutDown()
     {
-        //Signal the worker thread to shut down
-        mMainThreadActive = false; 
+        //Signal the worker thread to shut down, and wake it if it is waiting on a frame
+        {
+            std::lock_guard<std::mutex> signalLock(mFrameSignalLock);
+            mMainThreadActive = false;
+        }
+        mFrameSignal.notify_all();
         
         if (!mSilent)
         {
@@ -205,6 +376,12 @@ namespace trMPEG
             std::cerr << "Encoding Thread " << mEncodeThreadPtr->get_id() << " Joined Main thread " << std::this_thread::get_id() << std::endl;
         }
 
+        //The encoder flushed its last packets before finishing, wait for them to be written
+        if (mMuxThreadPtr)
+        {
+            mMuxThreadPtr->join();
+        }
+
         //Write the file trailer if needed
         av_write_trailer(mFormatContextPtr);
 
@@ -226,6 +403,15 @@ namespace trMPEG
         /* free the stream */
         avformat_free_context(mFormatContextPtr);   
 
+        //Nothing feeds the simulcast outputs anymore, so they can finish too
+        for (StreamServer* output : mSimulcastOutputs)
+        {
+            if (output->IsInit())
+            {
+                output->ShutDown();
+            }
+        }
+
         LOG_D("Shutting down the MPEG Stream")
     }
 
@@ -270,16 +456,6 @@ namespace trMPEG
         }
 
         mCodecContextPtr->codec_id = codecId;
-        mCodecContextPtr->bit_rate = mBitRate;
-
-        /* Resolution must be a multiple of two. */
-        mCodecContextPtr->width = mFrameWidth;
-        mCodecContextPtr->height = mFrameHeight;
-        
-        /* Threading options */
-        mCodecContextPtr->thread_count = 1;
-        mCodecContextPtr->thread_type = FF_THREAD_SLICE;
-        mCodecContextPtr->slices = 16;
 
         /* 
         * This is the fundamental unit of time (in seconds) in terms
@@ -292,10 +468,7 @@ namespace trMPEG
         strCont->stream->time_base = mFrameRateRat;
         strCont->stream->codec->time_base = strCont->stream->time_base;
 
-        mCodecContextPtr->time_base = strCont->stream->time_base;
-        mCodecContextPtr->gop_size = 3;               // Emit one intra frame every three frames at most
-        mCodecContextPtr->keyint_min = 1;
-        mCodecContextPtr->pix_fmt = AV_PIX_FMT_YUV420P;
+        ConfigureCodecContext(mCodecContextPtr, mBitRate, mFrameWidth, mFrameHeight);
 
         //Set Buffering options
         AVCPBProperties *props;
@@ -306,59 +479,208 @@ namespace trMPEG
         props->avg_bitrate = 0;
         props->vbv_delay = 120000;// UINT64_MAX;
 
-        if (mCodecContextPtr->codec_id == AV_CODEC_ID_H264 || mCodecContextPtr->codec_id == AV_CODEC_ID_HEVC)
+        // Set stream metadata
+        av_dict_set(&strCont->stream->metadata, "publisher", DEFAULT_PUBLISHER, 0);
+        av_dict_set(&formatContext->metadata, "publisher", DEFAULT_PUBLISHER, 0);
+        av_dict_set(&strCont->stream->metadata, "copyright", DEFAULT_COPYRIGHT, 0);
+        av_dict_set(&formatContext->metadata, "copyright", DEFAULT_COPYRIGHT, 0);
+        av_dict_set(&strCont->stream->metadata, "service_name", DEFAULT_PUBLISHER, 0);
+        av_dict_set(&formatContext->metadata, "service_name", DEFAULT_PUBLISHER, 0);
+        av_dict_set(&strCont->stream->metadata, "service_provider", DEFAULT_COPYRIGHT, 0);
+        av_dict_set(&formatContext->metadata, "service_provider", DEFAULT_COPYRIGHT, 0);
+        av_dict_set(&strCont->stream->metadata, "title", DEFAULT_TITLE, 0);
+        av_dict_set(&formatContext->metadata, "title", DEFAULT_TITLE, 0);  
+        
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::ConfigureCodecContext(AVCodecContext *codecContext, int bitRate, int width, int height) const
+    {
+        codecContext->bit_rate = bitRate;
+
+        /* Resolution must be a multiple of two. */
+        codecContext->width = width;
+        codecContext->height = height;
+        
+        /* Threading options */
+        codecContext->thread_count = mEncoderThreadCount;
+        if (mEncoderThreadType == EncoderThreadType::FRAME)
+        {
+            codecContext->thread_type = FF_THREAD_FRAME;
+        }
+        else if (mEncoderThreadType == EncoderThreadType::SLICE)
+        {
+            codecContext->thread_type = FF_THREAD_SLICE;
+            codecContext->slices = 16;
+        }
+        else
+        {
+            codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+            codecContext->slices = 16;
+        }
+
+        codecContext->time_base = mFrameRateRat;
+        codecContext->gop_size = mGopSize;        // Emit one intra frame every mGopSize frames at most
+        codecContext->keyint_min = 1;
+        codecContext->pix_fmt = AV_PIX_FMT_YUV420P;
+
+        if (codecContext->codec_id == AV_CODEC_ID_H264 || codecContext->codec_id == AV_CODEC_ID_HEVC)
         {
-            av_opt_set(mCodecContextPtr->priv_data, "crf", "18", AV_OPT_SEARCH_CHILDREN);
-            av_opt_set(mCodecContextPtr->priv_data, "preset", "fast", AV_OPT_SEARCH_CHILDREN);
-            av_opt_set(mCodecContextPtr->priv_data, "tune", "zerolatency", AV_OPT_SEARCH_CHILDREN);
-            av_opt_set(mCodecContextPtr->priv_data, "gpu", "any", AV_OPT_SEARCH_CHILDREN);
-            av_opt_set(mCodecContextPtr->priv_data, "vsync", "vfr", AV_OPT_SEARCH_CHILDREN);
+            //A constant quality ignores the bit rate, the adaptive rate control needs a bit rate it can steer
+            if (mAdaptiveRateControl)
+            {
+                codecContext->rc_max_rate = bitRate;
+                codecContext->rc_buffer_size = bitRate;
+            }
+            else
+            {
+                av_opt_set(codecContext->priv_data, "crf", "18", AV_OPT_SEARCH_CHILDREN);
+            }
+            av_opt_set(codecContext->priv_data, "preset", "fast", AV_OPT_SEARCH_CHILDREN);
+            av_opt_set(codecContext->priv_data, "tune", "zerolatency", AV_OPT_SEARCH_CHILDREN);
+            av_opt_set(codecContext->priv_data, "gpu", "any", AV_OPT_SEARCH_CHILDREN);
+            av_opt_set(codecContext->priv_data, "vsync", "vfr", AV_OPT_SEARCH_CHILDREN);
         }
-        else if (mCodecContextPtr->codec_id == AV_CODEC_ID_MPEG2VIDEO)
+        else if (codecContext->codec_id == AV_CODEC_ID_MPEG2VIDEO)
         {
             /* just for testing, we also add B-frames */
-            mCodecContextPtr->max_b_frames = 2;
+            codecContext->max_b_frames = 2;
         }        
-        else if (mCodecContextPtr->codec_id == AV_CODEC_ID_MPEG1VIDEO)
+        else if (codecContext->codec_id == AV_CODEC_ID_MPEG1VIDEO)
         {
             /* Needed to avoid using macroblocks in which some coeffs overflow.
             * This does not happen with normal video, it just happens here as
             * the motion of the chroma plane does not match the luma plane. */
-            mCodecContextPtr->mb_decision = FF_MB_DECISION_RD;
+            codecContext->mb_decision = FF_MB_DECISION_RD;
         }
 
         /* Some formats want stream headers to be separate. */
-        if (formatContext->oformat->flags & AVFMT_GLOBALHEADER)
+        if (mFormatContextPtr->oformat->flags & AVFMT_GLOBALHEADER)
         {
-            mCodecContextPtr->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
         }  
-
-        // Set stream metadata
-        av_dict_set(&strCont->stream->metadata, "publisher", DEFAULT_PUBLISHER, 0);
-        av_dict_set(&formatContext->metadata, "publisher", DEFAULT_PUBLISHER, 0);
-        av_dict_set(&strCont->stream->metadata, "copyright", DEFAULT_COPYRIGHT, 0);
-        av_dict_set(&formatContext->metadata, "copyright", DEFAULT_COPYRIGHT, 0);
-        av_dict_set(&strCont->stream->metadata, "service_name", DEFAULT_PUBLISHER, 0);
-        av_dict_set(&formatContext->metadata, "service_name", DEFAULT_PUBLISHER, 0);
-        av_dict_set(&strCont->stream->metadata, "service_provider", DEFAULT_COPYRIGHT, 0);
-        av_dict_set(&formatContext->metadata, "service_provider", DEFAULT_COPYRIGHT, 0);
-        av_dict_set(&strCont->stream->metadata, "title", DEFAULT_TITLE, 0);
-        av_dict_set(&formatContext->metadata, "title", DEFAULT_TITLE, 0);  
-        
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void StreamServer::OpenVideoCodec(AVCodecContext *codecContext, AVCodec *codec, StreamContainer *strCont, AVDictionary *optArg)
+    int StreamServer::OpenCodecContext(AVCodecContext *codecContext, const AVCodec *codec, AVDictionary *optArg) const
     {
-        int ret;
         AVDictionary *opt = nullptr;
 
         av_dict_copy(&opt, optArg, 0);
 
-        /* Open the codec */
-        ret = avcodec_open2(codecContext, codec, &opt);
+        /* 
+        * Open the codec. The codec starts its worker threads here, so pin this thread while it does,
+        * and the workers inherit the encoder CPU affinity. 
+        */
+        AffinityMask previousMask;
+        bool isPinned = !mEncoderCpuAffinity.empty() && SetCurrentThreadAffinity(mEncoderCpuAffinity, &previousMask);
+
+        int ret = avcodec_open2(codecContext, codec, &opt);
         av_dict_free(&opt);
 
+        if (isPinned)
+        {
+            RestoreCurrentThreadAffinity(previousMask);
+        }
+        return ret;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool StreamServer::RestartEncoder(int bitRate, int width, int height) const
+    {
+        //Open the new encoder first, the stream keeps going on the old one if it fails
+        const AVCodec* codec = mCodecContextPtr->codec;
+        AVCodecContext* codecContext = avcodec_alloc_context3(codec);
+        if (!codecContext)
+        {
+            LOG_E("Could not allocate an encoding context, keeping the current encoder.")
+            return false;
+        }
+
+        ConfigureCodecContext(codecContext, bitRate, width, height);
+        if (OpenCodecContext(codecContext, codec, nullptr) < 0)
+        {
+            LOG_E("Could not reopen the video codec, keeping the current encoder.")
+            avcodec_free_context(&codecContext);
+            return false;
+        }
+
+        //Let the old encoder finish its frames, their packets still go out in order
+        SendFrameToEncoder(mCodecContextPtr, &mVidStream, nullptr, 0);
+        mFramesInEncoder.clear();
+
+        avcodec_free_context(&mCodecContextPtr);
+        mCodecContextPtr = codecContext;
+
+        if (mVidStream.finalFrame->width != width || mVidStream.finalFrame->height != height)
+        {
+            av_frame_free(&mVidStream.finalFrame);
+            mVidStream.finalFrame = AllocateFrame(AV_PIX_FMT_YUV420P, width, height);
+        }
+
+        mCurrentBitRate = bitRate;
+        mCurrentWidth = width;
+        mCurrentHeight = height;
+        mEncoderRestartsCounter->Increment();
+        LOG_D("Restarted the encoder at " + trUtil::StringUtils::ToString<int>(bitRate) + " bits per second and " + 
+            trUtil::StringUtils::ToString<int>(width) + "x" + trUtil::StringUtils::ToString<int>(height))
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SwsContext* StreamServer::CreateConversionContext(int width, int height) const
+    {
+        AVPixelFormat inputFormat = AV_PIX_FMT_NONE;
+        if (mPixFmt == PixelFormat::RGB)
+        {
+            inputFormat = AV_PIX_FMT_RGB24;
+        }
+        else if (mPixFmt == PixelFormat::RGBA)
+        {
+            inputFormat = AV_PIX_FMT_RGBA;
+        }
+        else if (mPixFmt == PixelFormat::YUV420P)
+        {
+            inputFormat = AV_PIX_FMT_YUV420P;
+        }
+        else
+        {
+            LOG_E("Invalid pixel format detected")
+            return nullptr;
+        }
+
+        return sws_getContext(mFrameWidth, mFrameHeight, inputFormat, 
+            width, height, AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::GetScaledResolution(double scale, int& width, int& height) const
+    {
+        if (scale >= 1.0)
+        {
+            width = mFrameWidth;
+            height = mFrameHeight;
+            return;
+        }
+
+        //Encoders want even sizes
+        width = static_cast<int>(mFrameWidth * scale) / 2 * 2;
+        height = static_cast<int>(mFrameHeight * scale) / 2 * 2;
+        if (width < 16)
+        {
+            width = 16;
+        }
+        if (height < 16)
+        {
+            height = 16;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::OpenVideoCodec(AVCodecContext *codecContext, AVCodec *codec, StreamContainer *strCont, AVDictionary *optArg)
+    {
+        /* Open the codec */
+        int ret = OpenCodecContext(codecContext, codec, optArg);
         if (ret < 0) 
         {
             LOG_E("Could not open video codec.")
@@ -462,45 +784,176 @@ namespace trMPEG
     }
     
     //////////////////////////////////////////////////////////////////////////
-    void StreamServer::EncodeVideoFrame(AVCodecContext *codecContext, AVFormatContext *frmtCont, StreamContainer *strCont) const
+    void StreamServer::EncodeVideoFrame(AVCodecContext *codecContext, StreamContainer *strCont, trUtil::TimeTicks captureTime) const
     {
-        int gotPacket = 0;
-
         AVFrame* framePtr = GenerateVideoFrame(codecContext, strCont);
 
         if (framePtr)
         {
-            av_init_packet(&mVidPkt);
+            SendFrameToEncoder(codecContext, strCont, framePtr, captureTime);
+        }        
+    }
 
-            /* Encode the image */
-            int ret = avcodec_encode_video2(codecContext, &mVidPkt, framePtr, &gotPacket);
-            if (ret < 0)
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SendFrameToEncoder(AVCodecContext *codecContext, StreamContainer *strCont, const AVFrame* frame, trUtil::TimeTicks captureTime) const
+    {
+        //Remember when the frame went in, so its packet can be timed when it comes out
+        if (frame != nullptr)
+        {
+            EncoderFrame encoderFrame;
+            encoderFrame.pts = frame->pts;
+            encoderFrame.captureTime = captureTime;
+            encoderFrame.sendTime = trUtil::Timer::FastTick();
+            mFramesInEncoder.push_back(encoderFrame);
+        }
+
+        /* Encode the image */
+        int ret = avcodec_send_frame(codecContext, frame);
+        if (ret < 0 && ret != AVERROR_EOF)
+        {
+            LOG_E("Error encoding video frame.")
+            exit(1);
+        }
+
+        //The encoder can hold on to frames, so it can have zero or more packets ready
+        while (true)
+        {
+            AVPacket* packet = av_packet_alloc();
+            ret = avcodec_receive_packet(codecContext, packet);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            {
+                av_packet_free(&packet);
+                break;
+            }
+            else if (ret < 0)
             {
                 LOG_E("Error encoding video frame.")
                 exit(1);
             }
 
-            if (gotPacket)
+            //Find the frame this packet was made from. Codecs with B-frames reorder them, so it is not always the oldest.
+            trUtil::TimeTicks packetCaptureTime = 0;
+            std::deque<EncoderFrame>::iterator encoderFrame = mFramesInEncoder.begin();
+            while (encoderFrame != mFramesInEncoder.end() && encoderFrame->pts != packet->pts)
+            {
+                ++encoderFrame;
+            }
+            if (encoderFrame != mFramesInEncoder.end())
             {
-                /* Rescale output packet timestamp values from codec to stream timebase */
-                av_packet_rescale_ts(&mVidPkt, codecContext->time_base, strCont->stream->time_base);
-                mVidPkt.stream_index = strCont->stream->index;
+                trUtil::TimeTicks now = trUtil::Timer::FastTick();
+                mLatencyHistograms[static_cast<int>(LatencyStage::ENCODE)]->Observe(trUtil::Timer::FastDeltaSec(encoderFrame->sendTime, now));
+                packetCaptureTime = encoderFrame->captureTime;
+                mFramesInEncoder.erase(encoderFrame);
 
-                /* Write the compressed frame to the media file. */
-                ret = av_interleaved_write_frame(frmtCont, &mVidPkt);
+                //Carry the capture time to the slave as wall clock time, the local ticks mean nothing there
+                if (mEmbedCaptureTime)
+                {
+                    int64_t captureWallTime = CaptureTimestamp::GetWallClockTime() - static_cast<int64_t>(trUtil::Timer::FastDeltaSec(packetCaptureTime, now) * 1000000.0);
+                    CaptureTimestamp::Insert(packet, codecContext->codec_id, captureWallTime);
+                }
+            }
 
-                av_packet_unref(&mVidPkt);
+            //Frames that never got a packet, e.g. ones the codec skipped, should not pile up
+            while (mFramesInEncoder.size() > static_cast<size_t>(mPacketQueueSize))
+            {
+                mFramesInEncoder.pop_front();
             }
-            else
+
+            /* Rescale output packet timestamp values from codec to stream timebase */
+            av_packet_rescale_ts(packet, codecContext->time_base, strCont->stream->time_base);
+            packet->stream_index = strCont->stream->index;
+            mEncodedBytesCounter->Increment(packet->size);
+
+            QueuePacket(packet, packetCaptureTime);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::QueuePacket(AVPacket* packet, trUtil::TimeTicks captureTime) const
+    {
+        {
+            std::unique_lock<std::mutex> lock(mPacketQueueLock);
+            if (mPacketQueue.size() >= static_cast<size_t>(mPacketQueueSize))
+            {
+                mPacketQueueFullCounter->Increment();
+                if (mIsBroadcast)
+                {
+                    //A live stream is better off losing its oldest data than falling further behind.
+                    //The viewers recover on the next key frame.
+                    AVPacket* oldestPacket = mPacketQueue.front().packet;
+                    mPacketQueue.pop_front();
+                    av_packet_free(&oldestPacket);
+                    mDroppedPacketsCounter->Increment();
+                }
+                else
+                {
+                    //A file can't lose data, so wait for the muxer to catch up
+                    mPacketQueueSignal.wait(lock, [this] { return mPacketQueue.size() < static_cast<size_t>(mPacketQueueSize); });
+                }
+            }
+
+            QueuedPacket queuedPacket;
+            queuedPacket.packet = packet;
+            queuedPacket.captureTime = captureTime;
+            queuedPacket.queueTime = trUtil::Timer::FastTick();
+            mPacketQueue.push_back(queuedPacket);
+            mPacketQueueDepthGauge->Set(static_cast<double>(mPacketQueue.size()));
+        }
+        mPacketQueueSignal.notify_all();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::MuxPackets() const
+    {
+        if (!mEncoderCpuAffinity.empty() && !SetCurrentThreadAffinity(mEncoderCpuAffinity))
+        {
+            LOG_W("Could not set the CPU affinity of the muxing thread")
+        }
+
+        while (true)
+        {
+            QueuedPacket queuedPacket;
+            {
+                std::unique_lock<std::mutex> lock(mPacketQueueLock);
+                mPacketQueueSignal.wait(lock, [this] { return !mPacketQueue.empty() || mEncoderFinished; });
+
+                //The encoder only finishes after its last packets are queued, so an empty queue means we are done
+                if (mPacketQueue.empty())
+                {
+                    break;
+                }
+
+                queuedPacket = mPacketQueue.front();
+                mPacketQueue.pop_front();
+                mPacketQueueDepthGauge->Set(static_cast<double>(mPacketQueue.size()));
+            }
+
+            //Let the encoder know there is room in the queue again
+            mPacketQueueSignal.notify_all();
+
+            /* Write the compressed frame to the media file. */
+            trUtil::TimeTicks writeStart = trUtil::Timer::FastTick();
+            int ret = av_interleaved_write_frame(mFormatContextPtr, queuedPacket.packet);
+            trUtil::TimeTicks writeEnd = trUtil::Timer::FastTick();
+            mMuxWriteHistogram->Observe(trUtil::Timer::FastDeltaSec(writeStart, writeEnd));
+            mLatencyHistograms[static_cast<int>(LatencyStage::MUX)]->Observe(trUtil::Timer::FastDeltaSec(queuedPacket.queueTime, writeEnd));
+            if (queuedPacket.captureTime != 0)
             {
-                ret = 0;
+                mLatencyHistograms[static_cast<int>(LatencyStage::TOTAL)]->Observe(trUtil::Timer::FastDeltaSec(queuedPacket.captureTime, writeEnd));
             }
+
+            av_packet_free(&queuedPacket.packet);
             if (ret < 0)
             {
                 LOG_E("Error while writing video frame.")
                 exit(1);
             }
-        }        
+        }
+
+        if (!mSilent)
+        {
+            std::cerr << "Muxing Thread " << std::this_thread::get_id() << " done!!!" << std::endl;
+        }
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -512,127 +965,372 @@ namespace trMPEG
         }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetColorConversionKernel(ColorConverter::Kernel kernel)
+    {
+        if (!mIsInit)
+        {
+            mConversionKernel = kernel;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ColorConverter::Kernel StreamServer::GetColorConversionKernel() const
+    {
+        return mConversionKernel;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetPacketQueueSize(int size)
+    {
+        if (!mIsInit && size > 0)
+        {
+            mPacketQueueSize = size;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamServer::GetPacketQueueSize() const
+    {
+        return mPacketQueueSize;
+    }
+
     //////////////////////////////////////////////////////////////////////////   
     void StreamServer::operator()() const
     {
-        while (!mIsInit)
+        // Wait until the StreamServer is initialized 
+        {
+            std::unique_lock<std::mutex> signalLock(mFrameSignalLock);
+            mFrameSignal.wait(signalLock, [this] { return mIsInit || !mMainThreadActive; });
+            if (!mIsInit)
+            {
+                return;
+            }
+        }
+
+        if (!mEncoderCpuAffinity.empty() && !SetCurrentThreadAffinity(mEncoderCpuAffinity))
         {
-            // Wait until the StreamServer is initialized 
-            std::this_thread::yield();
+            LOG_W("Could not set the CPU affinity of the encoding thread")
         }
 
         //Get a lock to allocate resources
         mEncodeThreadLock.lock();
 
-        const unsigned char* rgbDataPtr = nullptr;
         SwsContext* rgbToYuvCtx = nullptr;
-        AVFrame *rgbFrame;
-        trUtil::Timer frameTimer;
-        trUtil::TimeTicks oldTicks = 0;
-        trUtil::TimeTicks newTicks = 0;
-
-        // Set the input frame pixel format and conversion context
-        if (mPixFmt == PixelFormat::RGB)
+        ColorConverter::Kernel conversionKernel = mConversionKernel;
+        std::chrono::steady_clock::duration framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / mFrameRate));
+        std::chrono::steady_clock::time_point lastFrameTime;
+        std::chrono::steady_clock::time_point nextFrameDeadline = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration keepAliveInterval = std::chrono::milliseconds(mKeepAliveIntervalMs);
+        bool framePacing = mFramePacing;
+        trUtil::TimeTicks bitRateWindowStart = trUtil::Timer::FastTick();
+        unsigned long long bitRateWindowBytes = mEncodedBytesCounter->GetValue();
+
+        // The in-tree converter only reads RGBA, everything else goes through swscale
+        if (mPixFmt == PixelFormat::YUV420P)
         {
-            rgbToYuvCtx = sws_getContext(mFrameWidth, mFrameHeight, AV_PIX_FMT_RGB24, 
-                mFrameWidth, mFrameHeight, AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-
-            rgbFrame = AllocateFrame(AV_PIX_FMT_RGB24, mFrameWidth, mFrameHeight);
+            conversionKernel = ColorConverter::Kernel::SWSCALE;
         }
-        else if (mPixFmt == PixelFormat::RGBA)
+        else if (conversionKernel != ColorConverter::Kernel::SWSCALE && (mPixFmt != PixelFormat::RGBA || !ColorConverter::IsKernelSupported(conversionKernel)))
         {
-            rgbToYuvCtx = sws_getContext(mFrameWidth, mFrameHeight, AV_PIX_FMT_RGBA, 
-                mFrameWidth, mFrameHeight, AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+            LOG_W("The " + std::string(ColorConverter::GetKernelName(conversionKernel)) + " color conversion kernel can't be used for this stream, falling back to swscale")
+            conversionKernel = ColorConverter::Kernel::SWSCALE;
+        }
 
-            rgbFrame = AllocateFrame(AV_PIX_FMT_RGBA, mFrameWidth, mFrameHeight);
+        // Set the input frame pixel format and conversion context
+        if (mPixFmt == PixelFormat::YUV420P)
+        {
+            LOG_D("Encoding frames that are already in YUV420P")
+        }
+        else if (conversionKernel != ColorConverter::Kernel::SWSCALE)
+        {
+            LOG_D("Converting frames with the " + std::string(ColorConverter::GetKernelName(conversionKernel == ColorConverter::Kernel::AUTO ? ColorConverter::GetBestKernel() : conversionKernel)) + " color conversion kernel")
         }
         else
         {
-            LOG_E("Invalid pixel format detected")
+            rgbToYuvCtx = CreateConversionContext(mFrameWidth, mFrameHeight);
+        }
+
+        // The size the encoder runs at, the adaptive rate control can scale it below the input size
+        int encodeWidth = mFrameWidth;
+        int encodeHeight = mFrameHeight;
+        double encodeScale = 1.0;
+        int framesInGop = 0;
+        bool isRestartPending = false;
+
+        // Group the simulcast outputs by resolution, so each resolution is only scaled once per frame
+        std::vector<SimulcastGroup> simulcastGroups;
+        for (StreamServer* output : mSimulcastOutputs)
+        {
+            std::vector<SimulcastGroup>::iterator group = simulcastGroups.begin();
+            while (group != simulcastGroups.end() && (group->width != output->GetWidth() || group->height != output->GetHeight()))
+            {
+                ++group;
+            }
+
+            if (group == simulcastGroups.end())
+            {
+                SimulcastGroup newGroup;
+                newGroup.width = output->GetWidth();
+                newGroup.height = output->GetHeight();
+                if (newGroup.width != mFrameWidth || newGroup.height != mFrameHeight)
+                {
+                    newGroup.scaleContext = sws_getContext(mFrameWidth, mFrameHeight, AV_PIX_FMT_YUV420P,
+                        newGroup.width, newGroup.height, AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+                    newGroup.scaledFrame = AllocateFrame(AV_PIX_FMT_YUV420P, newGroup.width, newGroup.height);
+                }
+                newGroup.packedFrame.resize(output->GetInputFrameSize());
+                simulcastGroups.push_back(newGroup);
+                group = simulcastGroups.end() - 1;
+            }
+            group->outputs.push_back(output);
         }
 
         mEncodeThreadLock.unlock();
 
+        bool hasFrame = false;
         while (mMainThreadActive)
         {
-            if (mNewFrameReady && mTextureData.size() > 0)
             {
-                //Lock the encoding thread mutex for this scope
-                std::lock_guard<std::mutex> lock(mEncodeThreadLock);
+                std::unique_lock<std::mutex> signalLock(mFrameSignalLock);
+
+                //Sleep until Encode hands us the first frame
+                if (!hasFrame)
+                {
+                    mFrameSignal.wait(signalLock, [this] { return mFrameBuffer.HasNewValue() || !mMainThreadActive; });
+                }
+
+                //Don't encode faster than our frame rate, sleep out the rest of this frame's time slot
+                if (framePacing)
+                {
+                    mFrameSignal.wait_until(signalLock, nextFrameDeadline, [this] { return !mMainThreadActive; });
+                }
 
-                //Update the time it took to encode one frame
-                if (oldTicks == 0)
+                //An idle stream waits for the next frame. With a keep alive interval the last frame is
+                //repeated once the interval has passed, but never sooner than one frame time late.
+                if (keepAliveInterval == std::chrono::steady_clock::duration::zero())
                 {
-                    oldTicks = frameTimer.Tick();
-                    newTicks = frameTimer.Tick();
+                    mFrameSignal.wait(signalLock, [this] { return mFrameBuffer.HasNewValue() || !mMainThreadActive; });
                 }
                 else
                 {
-                    oldTicks = newTicks;
-                }                
+                    std::chrono::steady_clock::time_point repeatDeadline = lastFrameTime + keepAliveInterval;
+                    if (repeatDeadline < nextFrameDeadline + framePeriod)
+                    {
+                        repeatDeadline = nextFrameDeadline + framePeriod;
+                    }
+                    mFrameSignal.wait_until(signalLock, repeatDeadline, [this] { return mFrameBuffer.HasNewValue() || !mMainThreadActive; });
+                }
+            }
+
+            if (!mMainThreadActive)
+            {
+                break;
+            }
 
-                //Check if our frame time is shorter than our frame rate, and even it out
-                while (frameTimer.DeltaMil(oldTicks, newTicks) < (1000.0 / mFrameRate))
+            //Always take the newest frame, the ones in between were already counted as dropped by Encode
+            if (mFrameBuffer.Acquire())
+            {
+                hasFrame = true;
+                mLatencyHistograms[static_cast<int>(LatencyStage::HANDOFF)]->Observe(trUtil::Timer::FastDeltaSec(mFrameBuffer.GetReadBuffer().handoffTime, trUtil::Timer::FastTick()));
+            }
+            else
+            {
+                mDuplicatedFramesCounter->Increment();
+            }
+
+            const std::vector<uint8_t>& frameData = mFrameBuffer.GetReadBuffer().data;
+            trUtil::TimeTicks captureTime = mFrameBuffer.GetReadBuffer().captureTime;
+            if (frameData.size() < static_cast<size_t>(GetInputFrameSize()))
+            {
+                continue;
+            }
+
+            {
+                //Lock the encoding thread mutex for this scope
+                std::lock_guard<std::mutex> lock(mEncodeThreadLock);
+
+                //Schedule the next frame one period after this one's slot. If we fell more than a
+                //frame behind, start over from now instead of bursting frames to catch up.
+                std::chrono::steady_clock::time_point frameTime = std::chrono::steady_clock::now();
+                nextFrameDeadline += framePeriod;
+                if (nextFrameDeadline < frameTime)
                 {
-                    newTicks = frameTimer.Tick();
+                    nextFrameDeadline = frameTime + framePeriod;
                 }
 
-                //Saves off the time it takes to encode a frame for FPS calculations later
-                mFrameTimeLength = frameTimer.DeltaMil(oldTicks, newTicks);
+                //Saves off the time between encoded frames for FPS calculations later
+                if (lastFrameTime == std::chrono::steady_clock::time_point())
+                {
+                    mFrameTimeLength = 1000.0 / mFrameRate;
+                }
+                else
+                {
+                    mFrameTimeLength = std::chrono::duration<double, std::milli>(frameTime - lastFrameTime).count();
+                }
+                lastFrameTime = frameTime;
 
                 fflush(stdout);
 
-                /* Copy the image from rgb data into an RGB(A) Frame */
-                for (int y = 0; y < mFrameHeight; ++y)
+                //Apply new settings from the adaptive rate control where the next GOP starts anyway
+                if (isRestartPending && (mGopSize <= 1 || framesInGop % mGopSize == 0))
                 {
-                    for (int x = 0; x < rgbFrame->linesize[0]; ++x)
+                    int width = 0;
+                    int height = 0;
+                    GetScaledResolution(mRateController.GetScale(), width, height);
+                    if (RestartEncoder(mRateController.GetBitRate(), width, height))
+                    {
+                        encodeScale = mRateController.GetScale();
+                    }
+                    else
                     {
+                        //Stay on the old encoder, and let the controller decide again from its settings
+                        mRateController.SetCurrent(mCurrentBitRate, mCurrentFrameRate, encodeScale);
+                        width = encodeWidth;
+                        height = encodeHeight;
+                    }
+
+                    if (width != encodeWidth || height != encodeHeight)
+                    {
+                        encodeWidth = width;
+                        encodeHeight = height;
 
-                        //Get the RGBA/RGB Data
-                        rgbDataPtr = &mTextureData[y * rgbFrame->linesize[0] + x];
-                        
-
-                        //Set the R component
-                        rgbFrame->data[0][y * rgbFrame->linesize[0] + x] = rgbDataPtr[0];
-                        
-                        //Set the G component
-                        ++x;
-                        rgbFrame->data[0][y * rgbFrame->linesize[0] + x] = rgbDataPtr[1];
-                        
-                        //Set the B component
-                        ++x;
-                        rgbFrame->data[0][y * rgbFrame->linesize[0] + x] = rgbDataPtr[2];
-                        
-                        if (mPixFmt == PixelFormat::RGBA)
+                        //Scaling always goes through swscale, which converts and scales in one pass
+                        sws_freeContext(rgbToYuvCtx);
+                        rgbToYuvCtx = nullptr;
+                        if (encodeWidth != mFrameWidth || encodeHeight != mFrameHeight || (conversionKernel == ColorConverter::Kernel::SWSCALE && mPixFmt != PixelFormat::YUV420P))
                         {
-                            //Set the A component
-                            ++x;
-                            rgbFrame->data[0][y * rgbFrame->linesize[0] + x] = 255;
-                        }                        
+                            rgbToYuvCtx = CreateConversionContext(encodeWidth, encodeHeight);
+                        }
+                    }
+                    framesInGop = 0;
+                    isRestartPending = false;
+                }
+                bool isScaled = encodeWidth != mFrameWidth || encodeHeight != mFrameHeight;
+
+                //A frame threaded encoder can still be reading the last frame, give it a copy if so
+                av_frame_make_writable(mVidStream.finalFrame);
+
+                trUtil::TimeTicks conversionStart = trUtil::Timer::FastTick();
+
+                if (mPixFmt == PixelFormat::YUV420P)
+                {
+                    //Simulcast input is already converted, it only has to be copied (or scaled) into the encoder frame
+                    uint8_t* srcPlanes[4];
+                    int srcStrides[4];
+                    av_image_fill_arrays(srcPlanes, srcStrides, frameData.data(), AV_PIX_FMT_YUV420P, mFrameWidth, mFrameHeight, 1);
+                    if (isScaled)
+                    {
+                        sws_scale(rgbToYuvCtx, srcPlanes, srcStrides, 0, mFrameHeight, mVidStream.finalFrame->data, mVidStream.finalFrame->linesize);
+                    }
+                    else
+                    {
+                        av_image_copy(mVidStream.finalFrame->data, mVidStream.finalFrame->linesize, const_cast<const uint8_t**>(srcPlanes), srcStrides, AV_PIX_FMT_YUV420P, mFrameWidth, mFrameHeight);
+                    }
+                }
+                else
+                {
+                    //Convert straight from the captured frame. A flipped image is read from its last row
+                    //upwards with a negative stride, so the output needs no separate flip pass.
+                    const uint8_t* srcData = frameData.data();
+                    int srcStride = mFrameWidth * mPixFmtSize;
+                    if (mFlipImageVertically)
+                    {
+                        srcData += (mFrameHeight - 1) * srcStride;
+                        srcStride = -srcStride;
                     }
-                }                             
 
-                //Change the image from RGBA/RGB to YUV
-                sws_scale(rgbToYuvCtx, rgbFrame->data, rgbFrame->linesize, 0, rgbFrame->height, mVidStream.finalFrame->data, mVidStream.finalFrame->linesize);
+                    //Change the image from RGBA/RGB to YUV
+                    if (conversionKernel == ColorConverter::Kernel::SWSCALE || isScaled)
+                    {
+                        sws_scale(rgbToYuvCtx, &srcData, &srcStride, 0, mFrameHeight, mVidStream.finalFrame->data, mVidStream.finalFrame->linesize);
+                    }
+                    else
+                    {
+                        ColorConverter::RGBAToI420(conversionKernel, srcData, srcStride, mVidStream.finalFrame->data, mVidStream.finalFrame->linesize, mFrameWidth, mFrameHeight);
+                    }
+                }
+
+                mLatencyHistograms[static_cast<int>(LatencyStage::CONVERSION)]->Observe(trUtil::Timer::FastDeltaSec(conversionStart, trUtil::Timer::FastTick()));
 
-                //Flip the image vertically 
-                if (mFlipImageVertically)
+                //Hand the converted frame to the simulcast outputs, scaled once per resolution
+                for (SimulcastGroup& group : simulcastGroups)
                 {
-                    FlipYUV420Frame(mVidStream.finalFrame);
-                }                 
+                    const AVFrame* source = mVidStream.finalFrame;
+                    if (group.scaleContext != nullptr)
+                    {
+                        sws_scale(group.scaleContext, mVidStream.finalFrame->data, mVidStream.finalFrame->linesize, 0, mFrameHeight, group.scaledFrame->data, group.scaledFrame->linesize);
+                        source = group.scaledFrame;
+                    }
+
+                    av_image_copy_to_buffer(group.packedFrame.data(), static_cast<int>(group.packedFrame.size()), source->data, source->linesize, AV_PIX_FMT_YUV420P, group.width, group.height, 1);
+                    for (StreamServer* output : group.outputs)
+                    {
+                        output->Encode(group.packedFrame.data(), captureTime);
+                    }
+                }
 
-                EncodeVideoFrame(mCodecContextPtr, mFormatContextPtr, &mVidStream);   
+                EncodeVideoFrame(mCodecContextPtr, &mVidStream, captureTime);   
+                ++framesInGop;
 
-                //Mark that we just consumed a frame and can use a new one on the next loop
-                mNewFrameReady = false;
+                //Let the adaptive rate control see how the encoder and the network are keeping up
+                if (mAdaptiveRateControl)
+                {
+                    mRateController.AddFrame(trUtil::Timer::FastDeltaSec(conversionStart, trUtil::Timer::FastTick()));
+
+                    double queueFill = mPacketQueueDepthGauge->GetValue() / static_cast<double>(mPacketQueueSize);
+                    unsigned long long congestionEvents = mPacketQueueFullCounter->GetValue() + mDroppedPacketsCounter->GetValue();
+                    double now = std::chrono::duration<double>(frameTime.time_since_epoch()).count();
+                    if (mRateController.Update(now, queueFill, congestionEvents))
+                    {
+                        //The frame rate only changes the pacing, the time stamps already follow the real frame times
+                        if (mRateController.GetFrameRate() != mCurrentFrameRate)
+                        {
+                            mCurrentFrameRate = mRateController.GetFrameRate();
+                            framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / mCurrentFrameRate));
+                        }
+
+                        int width = 0;
+                        int height = 0;
+                        GetScaledResolution(mRateController.GetScale(), width, height);
+                        isRestartPending = mRateController.GetBitRate() != mCurrentBitRate || width != encodeWidth || height != encodeHeight;
+                    }
+                }
+
+                //Publish the encoder metrics, the bit rate once a second
+                mEncodedFramesCounter->Increment();
+                if (mFrameTimeLength > 0.0)
+                {
+                    mEncodeFpsGauge->Set(1000.0 / mFrameTimeLength);
+                }
+
+                trUtil::TimeTicks bitRateWindowEnd = trUtil::Timer::FastTick();
+                double bitRateWindowSeconds = trUtil::Timer::FastDeltaSec(bitRateWindowStart, bitRateWindowEnd);
+                if (bitRateWindowSeconds >= 1.0)
+                {
+                    unsigned long long encodedBytes = mEncodedBytesCounter->GetValue();
+                    mBitRateGauge->Set((encodedBytes - bitRateWindowBytes) * 8.0 / bitRateWindowSeconds);
+                    bitRateWindowBytes = encodedBytes;
+                    bitRateWindowStart = bitRateWindowEnd;
+                }
             } 
-            else
-            {
-                //Make sure this thread is not hugging the CPU core.
-                std::this_thread::yield();
-            }
         }        
 
+        sws_freeContext(rgbToYuvCtx);
+        for (SimulcastGroup& group : simulcastGroups)
+        {
+            sws_freeContext(group.scaleContext);
+            av_frame_free(&group.scaledFrame);
+        }
+
+        //Drain the frames the encoder is still holding on to, and let the muxing thread finish
+        SendFrameToEncoder(mCodecContextPtr, &mVidStream, nullptr, 0);
+        {
+            std::lock_guard<std::mutex> lock(mPacketQueueLock);
+            mEncoderFinished = true;
+        }
+        mPacketQueueSignal.notify_all();
+
         if (!mSilent)
         {
             std::cerr << "Encoding Thread " << std::this_thread::get_id() << " done!!!" << std::endl;
@@ -641,17 +1339,50 @@ namespace trMPEG
     }    
 
     //////////////////////////////////////////////////////////////////////////
-    void StreamServer::Encode(const GLubyte* frameData) const
+    void StreamServer::Encode(const GLubyte* frameData, trUtil::TimeTicks captureTime) const
+    {
+        //If we have no data, skip this loop
+        if (frameData)
+        {
+            trUtil::TimeTicks handoffTime = trUtil::Timer::FastTick();
+            if (captureTime == 0)
+            {
+                captureTime = handoffTime;
+            }
+            else if (mLatencyHistograms[static_cast<int>(LatencyStage::CAPTURE)] != nullptr)
+            {
+                mLatencyHistograms[static_cast<int>(LatencyStage::CAPTURE)]->Observe(trUtil::Timer::FastDeltaSec(captureTime, handoffTime));
+            }
+
+            // Copy Frame Data into our slot of the frame buffer, the slot is already sized so this does not allocate
+            InputFrame& inputFrame = mFrameBuffer.GetWriteBuffer();
+            inputFrame.data.assign(frameData, frameData + GetInputFrameSize());
+            inputFrame.captureTime = captureTime;
+            inputFrame.handoffTime = handoffTime;
+
+            // Publish it as the newest frame. If the encoder never picked up the previous one, that one is lost.
+            if (!mFrameBuffer.Publish() && mDroppedFramesCounter != nullptr)
+            {
+                mDroppedFramesCounter->Increment();
+            }
+
+            // Send signal to the Encoder thread that New Frame Data is ready. The lock is only taken so the
+            // signal can't slip in between the encoder checking for a frame and going to sleep.
+            {
+                std::lock_guard<std::mutex> signalLock(mFrameSignalLock);
+            }
+            mFrameSignal.notify_one();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamServer::GetInputFrameSize() const
     {
-        //If the encoding frame is not done or we have no data, skip this loop
-        if (!mNewFrameReady && frameData)
+        if (mPixFmt == PixelFormat::YUV420P)
         {
-            // Copy Frame Data into a variable that will be used by the encoding thread. 
-            mTextureData.assign(frameData, frameData + mFrameWidth * mFrameHeight * mPixFmtSize);
-                                 
-            // Send signal to the Encoder thread that New Frame Data is ready
-            mNewFrameReady = true;
+            return mFrameWidth * mFrameHeight + 2 * ((mFrameWidth + 1) / 2) * ((mFrameHeight + 1) / 2);
         }
+        return mFrameWidth * mFrameHeight * mPixFmtSize;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -806,6 +1537,205 @@ namespace trMPEG
         return mBitRate;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetGopSize(int gopSize)
+    {
+        if (!mIsInit)
+        {
+            mGopSize = gopSize;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamServer::GetGopSize() const
+    {
+        return mGopSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetEncoderThreadCount(int count)
+    {
+        if (!mIsInit)
+        {
+            mEncoderThreadCount = count;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamServer::GetEncoderThreadCount() const
+    {
+        return mEncoderThreadCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetEncoderThreadType(EncoderThreadType type)
+    {
+        if (!mIsInit)
+        {
+            mEncoderThreadType = type;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    StreamServer::EncoderThreadType StreamServer::GetEncoderThreadType() const
+    {
+        return mEncoderThreadType;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetEncoderCpuAffinity(const std::vector<int>& cpus)
+    {
+        if (!mIsInit)
+        {
+            mEncoderCpuAffinity = cpus;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::vector<int>& StreamServer::GetEncoderCpuAffinity() const
+    {
+        return mEncoderCpuAffinity;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetAdaptiveRateControl(bool enable)
+    {
+        if (!mIsInit)
+        {
+            mAdaptiveRateControl = enable;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool StreamServer::GetAdaptiveRateControl() const
+    {
+        return mAdaptiveRateControl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetAdaptiveRateSettings(const AdaptiveRateController::Settings& settings)
+    {
+        if (!mIsInit)
+        {
+            mAdaptiveRateSettings = settings;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const AdaptiveRateController::Settings& StreamServer::GetAdaptiveRateSettings() const
+    {
+        return mAdaptiveRateSettings;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetKeepAliveInterval(unsigned int intervalMs)
+    {
+        if (!mIsInit)
+        {
+            mKeepAliveIntervalMs = intervalMs;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int StreamServer::GetKeepAliveInterval() const
+    {
+        return mKeepAliveIntervalMs;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetFramePacing(bool pace)
+    {
+        if (!mIsInit)
+        {
+            mFramePacing = pace;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool StreamServer::GetFramePacing() const
+    {
+        return mFramePacing;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamServer::GetCurrentBitRate() const
+    {
+        return mCurrentBitRate;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamServer::GetCurrentFrameRate() const
+    {
+        return mCurrentFrameRate;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::GetCurrentResolution(int& width, int& height) const
+    {
+        width = mCurrentWidth;
+        height = mCurrentHeight;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::SetEmbedCaptureTime(bool embed)
+    {
+        if (!mIsInit)
+        {
+            mEmbedCaptureTime = embed;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool StreamServer::GetEmbedCaptureTime() const
+    {
+        return mEmbedCaptureTime;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trUtil::Metrics::Histogram* StreamServer::GetLatencyHistogram(LatencyStage stage) const
+    {
+        return mLatencyHistograms[static_cast<int>(stage)];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamServer::GetEncodedFrameCount() const
+    {
+        return mEncodedFramesCounter != nullptr ? mEncodedFramesCounter->GetValue() : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamServer::GetDroppedFrameCount() const
+    {
+        return mDroppedFramesCounter != nullptr ? mDroppedFramesCounter->GetValue() : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamServer::GetDuplicatedFrameCount() const
+    {
+        return mDuplicatedFramesCounter != nullptr ? mDuplicatedFramesCounter->GetValue() : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamServer::GetEncodedByteCount() const
+    {
+        return mEncodedBytesCounter != nullptr ? mEncodedBytesCounter->GetValue() : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamServer::AddSimulcastOutput(StreamServer& output)
+    {
+        if (mIsInit)
+        {
+            LOG_W("Simulcast outputs have to be added before the stream is initialized")
+            return;
+        }
+
+        //The output gets frames that were already converted, and flipped if needed, by this stream
+        output.SetInputPixelFormat(PixelFormat::YUV420P);
+        output.SetFlipImageVertically(false);
+        mSimulcastOutputs.push_back(&output);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void StreamServer::SetInputPixelFormat(PixelFormat format)
     {
@@ -821,6 +1751,11 @@ namespace trMPEG
             {
                 mPixFmtSize = 4;
             }
+            else if (mPixFmt == PixelFormat::YUV420P)
+            {
+                //Planar, the chroma planes add half a byte per pixel on top of this. See GetInputFrameSize
+                mPixFmtSize = 1;
+            }
             else
             {
                 LOG_E("Unsupported pixel format was detected")
@@ -20,9 +20,12 @@
 */
 
 #include <trMPEG/StreamSlave.h>
+#include <trMPEG/CaptureTimestamp.h>
 
 #include <trUtil/Logging/Log.h>
 #include <trUtil/StringUtils.h>
+#include <trUtil/Timer.h>
+#include <trUtil/Metrics/MetricsRegistry.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,6 +43,8 @@ extern "C"
 
 namespace trMPEG
 {
+    const int StreamSlave::DEFAULT_JITTER_BUFFER_SIZE = 2;
+
     //////////////////////////////////////////////////////////////////////////
     StreamSlave::StreamSlave()
     {
@@ -48,8 +53,32 @@ namespace trMPEG
     //////////////////////////////////////////////////////////////////////////
     StreamSlave::~StreamSlave()
     {
+        //Stop the decoding thread, the interrupt callback breaks it out of a blocking read
+        mDecodeThreadActive = false;
+        if (mDecodeThreadPtr != nullptr)
+        {
+            mDecodeThreadPtr->join();
+            delete mDecodeThreadPtr;
+        }
+
+        for (BufferedFrame& buffered : mJitterBuffer)
+        {
+            av_frame_free(&buffered.frame);
+        }
+        mJitterBuffer.clear();
+
+        // The target image can outlive us, give it its own copy of the last frame
+        if (mImageTarget.Valid() && mImageTarget->data() != nullptr &&
+            (mImageTarget->data() == mImageBuffers[0].data() || mImageTarget->data() == mImageBuffers[1].data()))
+        {
+            std::vector<unsigned char>& lastBuffer = mImageTarget->data() == mImageBuffers[0].data() ? mImageBuffers[0] : mImageBuffers[1];
+            mImageTarget->allocateImage(mImageTarget->s(), mImageTarget->t(), 1, GL_RGB, GL_UNSIGNED_BYTE, 1);
+            memcpy(mImageTarget->data(), lastBuffer.data(), lastBuffer.size());
+        }
+
+        sws_freeContext(mFrameConvertCtx);
+        avcodec_free_context(&mCodecContext);
         av_frame_free(&mFrameYUV);
-        av_frame_free(&mFrameRGB);
         av_read_pause(mFrmtContext);
         avformat_close_input(&mFrmtContext);
     }
@@ -69,6 +98,10 @@ namespace trMPEG
         // Open the initial context variables that are needed        
         mFrmtContext = avformat_alloc_context();        
 
+        // Lets the decoding thread be stopped while it is waiting on the network
+        mFrmtContext->interrupt_callback.callback = &StreamSlave::InterruptCallback;
+        mFrmtContext->interrupt_callback.opaque = this;
+
         // Register everything
         av_register_all();
         avformat_network_init();
@@ -108,8 +141,6 @@ namespace trMPEG
             exit(1);
         }   
 
-        av_init_packet(&mPacket);
-
         // Start playing the stream
         //av_read_play(mFrmtContext);    
 
@@ -135,51 +166,340 @@ namespace trMPEG
             exit(1);
         }
 
-        // Create a color conversion context
-        mFrameConvertCtx = sws_getContext(mCodecContext->width, mCodecContext->height, mCodecContext->pix_fmt, 
-                                            mCodecContext->width, mCodecContext->height, AV_PIX_FMT_RGB24, SWS_BICUBIC, nullptr, nullptr, nullptr);
+        // The jitter buffer delay is counted in frames of the incoming stream
+        AVRational frameRate = av_guess_frame_rate(mFrmtContext, mInputStream, nullptr);
+        if (frameRate.num <= 0 || frameRate.den <= 0)
+        {
+            frameRate = { 30, 1 };
+        }
+        mFramePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(av_q2d(av_inv_q(frameRate))));
+
+        // Register the decoder metrics, labeled with the address so several slaves can be told apart
+        trUtil::Metrics::MetricsRegistry& registry = trUtil::Metrics::MetricsRegistry::GetInstance();
+        trUtil::Metrics::MetricsRegistry::Labels labels = { { "stream", mUDPAddrs } };
+        mDecodedFramesCounter = &registry.GetCounter("tr_slave_decoded_frames_total", "Frames decoded by the stream slave.", labels);
+        mLateFramesCounter = &registry.GetCounter("tr_slave_late_frames_total", "Frames decoded after the time they should have been shown.", labels);
+        mDroppedFramesCounter = &registry.GetCounter("tr_slave_dropped_frames_total", "Decoded frames that were never shown.", labels);
+        mJitterBufferDepthGauge = &registry.GetGauge("tr_slave_jitter_buffer_depth", "Decoded frames waiting in the jitter buffer.", labels);
+
+        const char* stageNames[] = { "receive", "decode", "present", "end_to_end" };
+        for (int i = 0; i <= static_cast<int>(LatencyStage::END_TO_END); ++i)
+        {
+            trUtil::Metrics::MetricsRegistry::Labels stageLabels = { { "stream", mUDPAddrs }, { "stage", stageNames[i] } };
+            mLatencyHistograms[i] = &registry.GetHistogram("tr_slave_latency_seconds", "Time a frame spends in each stage of the stream slave.", trUtil::Metrics::Histogram::DEFAULT_TIME_BUCKETS, stageLabels);
+        }
+
+        // Read and decode in the background from here on
+        mDecodeThreadPtr = new std::thread(&StreamSlave::DecodeFrames, this);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool StreamSlave::Update()
+    {
+        // Nothing is being decoded before Connect
+        if (mDecodeThreadPtr == nullptr)
+        {
+            return false;
+        }
+
+        BufferedFrame newFrame = { nullptr };
+        {
+            std::lock_guard<std::mutex> lock(mJitterBufferLock);
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            // Skip frames that a newer due frame has already replaced, we are updating too slowly for them
+            while (mJitterBuffer.size() > 1 && mJitterBuffer[1].presentTime <= now)
+            {
+                av_frame_free(&mJitterBuffer.front().frame);
+                mJitterBuffer.pop_front();
+                mDroppedFramesCounter->Increment();
+            }
+
+            if (!mJitterBuffer.empty() && mJitterBuffer.front().presentTime <= now)
+            {
+                newFrame = mJitterBuffer.front();
+                mJitterBuffer.pop_front();
+            }
+            mJitterBufferDepthGauge->Set(static_cast<double>(mJitterBuffer.size()));
+        }
+
+        if (newFrame.frame == nullptr)
+        {
+            return false;
+        }
+
+        // Keep the shown frame around until the next one replaces it
+        av_frame_free(&mFrameYUV);
+        mFrameYUV = newFrame.frame;
+
+        //Flip the image vertically 
+        if (mFlipImageVertically)
+        {
+            FlipYUV420Frame(mFrameYUV);
+        }
+
+        if (mConvertToRGB && mImageTarget.Valid())
+        {
+            // Convert YUV to RGB straight into the buffer the image is not pointing at. The previous
+            // frame can still be uploading from the other one.
+            mImageBufferIndex = 1 - mImageBufferIndex;
+            std::vector<unsigned char>& imageBuffer = mImageBuffers[mImageBufferIndex];
+            imageBuffer.resize(newFrame.width * newFrame.height * 3);
+
+            // The server can change the stream's resolution mid stream, so the conversion follows each frame's own size
+            int scalerFlags = SWS_BICUBIC;
+            if (mScalerQuality == ScalerQuality::FAST_BILINEAR)
+            {
+                scalerFlags = SWS_FAST_BILINEAR;
+            }
+            else if (mScalerQuality == ScalerQuality::BILINEAR)
+            {
+                scalerFlags = SWS_BILINEAR;
+            }
+            mFrameConvertCtx = sws_getCachedContext(mFrameConvertCtx, newFrame.width, newFrame.height, newFrame.format,
+                                                    newFrame.width, newFrame.height, AV_PIX_FMT_RGB24, scalerFlags, nullptr, nullptr, nullptr);
+
+            uint8_t* rgbData[1] = { imageBuffer.data() };
+            int rgbLineSize[1] = { newFrame.width * 3 };
+            sws_scale(mFrameConvertCtx, mFrameYUV->data, mFrameYUV->linesize, 0, newFrame.height, rgbData, rgbLineSize);
+
+            // Point the image at the new frame, setImage dirties it so it refreshes
+            mImageTarget->setImage(newFrame.width, newFrame.height, 1, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE,
+                                    imageBuffer.data(), osg::Image::NO_DELETE, 1);
+        }
+
+        mLatencyHistograms[static_cast<int>(LatencyStage::PRESENT)]->Observe(trUtil::Timer::FastDeltaSec(newFrame.decodedTime, trUtil::Timer::FastTick()));
+        if (newFrame.captureTime != 0)
+        {
+            mLatencyHistograms[static_cast<int>(LatencyStage::END_TO_END)]->Observe((CaptureTimestamp::GetWallClockTime() - newFrame.captureTime) / 1000000.0);
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const AVFrame* StreamSlave::GetYUVFrame() const
+    {
+        return mFrameYUV;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamSlave::SetScalerQuality(ScalerQuality quality)
+    {
+        if (mDecodeThreadPtr == nullptr)
+        {
+            mScalerQuality = quality;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    StreamSlave::ScalerQuality StreamSlave::GetScalerQuality() const
+    {
+        return mScalerQuality;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamSlave::SetConvertToRGB(bool convert)
+    {
+        if (mDecodeThreadPtr == nullptr)
+        {
+            mConvertToRGB = convert;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool StreamSlave::GetConvertToRGB() const
+    {
+        return mConvertToRGB;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamSlave::SetJitterBufferSize(int frames)
+    {
+        if (mDecodeThreadPtr == nullptr)
+        {
+            mJitterBufferSize = frames > 0 ? frames : 1;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamSlave::GetJitterBufferSize() const
+    {
+        return mJitterBufferSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamSlave::GetDecodedFrameCount() const
+    {
+        return mDecodedFramesCounter != nullptr ? mDecodedFramesCounter->GetValue() : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamSlave::GetLateFrameCount() const
+    {
+        return mLateFramesCounter != nullptr ? mLateFramesCounter->GetValue() : 0;
+    }
 
-        mFrameYUV = AllocateFrame(AV_PIX_FMT_YUV420P, mCodecContext->width, mCodecContext->height);
-        mFrameRGB = AllocateFrame(AV_PIX_FMT_RGB24, mCodecContext->width, mCodecContext->height);
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long StreamSlave::GetDroppedFrameCount() const
+    {
+        return mDroppedFramesCounter != nullptr ? mDroppedFramesCounter->GetValue() : 0;
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void StreamSlave::Update()
+    double StreamSlave::GetAverageDecodeLatency() const
     {
-        // Read one frame from the Formant Context Stream
-        //av_init_packet(&mPacket);
-        av_read_frame(mFrmtContext, &mPacket);
-            
-        // Send a packet for decoding to the codec context
-        avcodec_send_packet(mCodecContext, &mPacket);
-            
-        //Read one frame from the Context, if one is read, save it into a YUV Frame
-        if (avcodec_receive_frame(mCodecContext, mFrameYUV) >= 0)
-        {                
-            //Flip the image vertically 
-            if (mFlipImageVertically)
+        const trUtil::Metrics::Histogram* decodeHistogram = mLatencyHistograms[static_cast<int>(LatencyStage::DECODE)];
+        if (decodeHistogram == nullptr || decodeHistogram->GetCount() == 0)
+        {
+            return 0.0;
+        }
+        return decodeHistogram->GetSum() / decodeHistogram->GetCount();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trUtil::Metrics::Histogram* StreamSlave::GetLatencyHistogram(LatencyStage stage) const
+    {
+        return mLatencyHistograms[static_cast<int>(stage)];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamSlave::DecodeFrames()
+    {
+        AVPacket* packet = av_packet_alloc();
+        AVFrame* frame = av_frame_alloc();
+
+        while (mDecodeThreadActive)
+        {
+            // Read one packet from the Format Context Stream, this blocks until the network delivers
+            trUtil::TimeTicks readStart = trUtil::Timer::FastTick();
+            int ret = av_read_frame(mFrmtContext, packet);
+            if (ret == AVERROR_EOF || ret == AVERROR_EXIT)
             {
-                FlipYUV420Frame(mFrameYUV);
+                break;
             }
+            else if (ret < 0)
+            {
+                continue;
+            }
+
+            if (packet->stream_index != mInputStream->index)
+            {
+                av_packet_unref(packet);
+                continue;
+            }
+
+            DecoderPacket decoderPacket;
+            decoderPacket.pts = packet->pts;
+            decoderPacket.readTime = trUtil::Timer::FastTick();
+            decoderPacket.captureTime = 0;
+            mLatencyHistograms[static_cast<int>(LatencyStage::RECEIVE)]->Observe(trUtil::Timer::FastDeltaSec(readStart, decoderPacket.readTime));
 
-            // Convert YUV to RGB
-            sws_scale(mFrameConvertCtx, mFrameYUV->data, mFrameYUV->linesize, 0, mCodecContext->height, mFrameRGB->data, mFrameRGB->linesize);
+            // Pick up the capture time if the server embedded one
+            CaptureTimestamp::Find(packet->data, packet->size, decoderPacket.captureTime);
+            mPacketsInDecoder.push_back(decoderPacket);
 
-            if (mImageTarget.Valid())
-            { // Copy the frame data into the Image, and dirty the image to make sure it refreshes
-                memcpy(mImageTarget->data(), mFrameRGB->data[0], mFrameRGB->linesize[0] * mCodecContext->height);
-                mImageTarget->dirty();
+            // Send a packet for decoding to the codec context, and queue every frame it gives back
+            if (avcodec_send_packet(mCodecContext, packet) < 0)
+            {
+                LOG_D("No (Bad) Frame Data...")
             }
-        } 
-        else
+            av_packet_unref(packet);
+
+            while (avcodec_receive_frame(mCodecContext, frame) >= 0)
+            {
+                // Find the packet the frame came from, frames come out in display order and packets do not
+                std::deque<DecoderPacket>::iterator framePacket = mPacketsInDecoder.begin();
+                while (framePacket != mPacketsInDecoder.end() && framePacket->pts != frame->pts)
+                {
+                    ++framePacket;
+                }
+
+                int64_t captureTime = 0;
+                if (framePacket != mPacketsInDecoder.end())
+                {
+                    mLatencyHistograms[static_cast<int>(LatencyStage::DECODE)]->Observe(trUtil::Timer::FastDeltaSec(framePacket->readTime, trUtil::Timer::FastTick()));
+                    captureTime = framePacket->captureTime;
+                    mPacketsInDecoder.erase(framePacket);
+                }
+                mDecodedFramesCounter->Increment();
+
+                BufferFrame(frame, captureTime);
+                frame = av_frame_alloc();
+            }
+
+            // Packets that never produced a frame, e.g. corrupt ones, should not pile up
+            while (mPacketsInDecoder.size() > 64)
+            {
+                mPacketsInDecoder.pop_front();
+            }
+        }
+
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void StreamSlave::BufferFrame(AVFrame* frame, int64_t captureTime)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration delay = mFramePeriod * mJitterBufferSize;
+        int64_t pts = frame->best_effort_timestamp;
+
+        // Place the frame on the local clock using its time stamp, delayed by the jitter buffer size.
+        // Start over on the first frame, on frames without a time stamp, and when the stream jumps.
+        std::chrono::steady_clock::time_point presentTime = now + delay;
+        bool restartClock = pts == AV_NOPTS_VALUE || mPlayoutStartPts == AV_NOPTS_VALUE;
+        if (!restartClock)
+        {
+            std::chrono::duration<double> offset(av_q2d(mInputStream->time_base) * (pts - mPlayoutStartPts));
+            presentTime = mPlayoutStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+
+            if (presentTime > now + delay + std::chrono::seconds(1) || presentTime < now - std::chrono::seconds(1))
+            {
+                presentTime = now + delay;
+                restartClock = true;
+            }
+            else if (presentTime < now)
+            {
+                // The network fell further behind than the buffer covers. Show this frame right away,
+                // and rebuild the full delay for the frames after it.
+                mLateFramesCounter->Increment();
+                restartClock = true;
+            }
+        }
+
+        if (restartClock)
+        {
+            mPlayoutStart = now + delay;
+            mPlayoutStartPts = pts;
+        }
+
+        std::lock_guard<std::mutex> lock(mJitterBufferLock);
+
+        // Nobody is picking the frames up fast enough, let go of the oldest
+        while (static_cast<int>(mJitterBuffer.size()) >= mJitterBufferSize * 2)
         {
-            LOG_D("No (Bad) Frame Data...")
+            av_frame_free(&mJitterBuffer.front().frame);
+            mJitterBuffer.pop_front();
+            mDroppedFramesCounter->Increment();
         }
-        
-        //std::cerr << mCodecContext->frame_number << std::endl;
 
-        // Clear Packet Data
-        av_packet_unref(&mPacket);    
+        BufferedFrame buffered;
+        buffered.frame = frame;
+        buffered.width = frame->width;
+        buffered.height = frame->height;
+        buffered.format = static_cast<AVPixelFormat>(frame->format);
+        buffered.presentTime = presentTime;
+        buffered.decodedTime = trUtil::Timer::FastTick();
+        buffered.captureTime = captureTime;
+        mJitterBuffer.push_back(buffered);
+        mJitterBufferDepthGauge->Set(static_cast<double>(mJitterBuffer.size()));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int StreamSlave::InterruptCallback(void* slave)
+    {
+        return static_cast<StreamSlave*>(slave)->mDecodeThreadActive ? 0 : 1;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,176 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEGBench/Utils.h>
+
+#include <trMPEG/ColorConverter.h>
+#include <trUtil/JSON/Array.h>
+#include <trUtil/JSON/Object.h>
+#include <trUtil/Timer.h>
+
+extern "C"
+{
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    /**
+     * @struct  YuvImage
+     *
+     * @brief   A YUV420P image with tightly packed planes.
+     */
+    struct YuvImage
+    {
+        std::vector<uint8_t> planes[3];
+        uint8_t* data[3];
+        int stride[3];
+
+        YuvImage(int width, int height)
+        {
+            int chromaWidth = (width + 1) / 2;
+            int chromaHeight = (height + 1) / 2;
+            planes[0].resize(width * height);
+            planes[1].resize(chromaWidth * chromaHeight);
+            planes[2].resize(chromaWidth * chromaHeight);
+            for (int i = 0; i < 3; ++i)
+            {
+                data[i] = planes[i].data();
+                stride[i] = i == 0 ? width : chromaWidth;
+            }
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    int GetMaxDifference(const YuvImage& first, const YuvImage& second)
+    {
+        int maxDifference = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            for (size_t j = 0; j < first.planes[i].size(); ++j)
+            {
+                maxDifference = std::max(maxDifference, std::abs(first.planes[i][j] - second.planes[i][j]));
+            }
+        }
+        return maxDifference;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void AddResult(trUtil::JSON::Array& results, const std::string& kernel, bool supported, double secondsPerFrame, double baseSecondsPerFrame, int maxDifference)
+    {
+        trUtil::JSON::Object result;
+        result.SetString("kernel", kernel);
+        result.SetBool("supported", supported);
+        if (supported)
+        {
+            result.SetDouble("msPerFrame", secondsPerFrame * 1000.0);
+            result.SetDouble("fps", 1.0 / secondsPerFrame);
+            result.SetDouble("speedup", baseSecondsPerFrame / secondsPerFrame);
+            result.SetInt("maxDifference", maxDifference);
+        }
+        results.AddObject(result);
+    }
+}
+
+/**
+ * Fills an RGBA frame with a test pattern that moves with the frame number.
+ */
+void FillTestPattern(std::vector<uint8_t>& rgba, int width, int height, int frameNumber)
+{
+    rgba.resize(width * height * 4);
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t* row = &rgba[y * width * 4];
+        for (int x = 0; x < width; ++x)
+        {
+            row[x * 4 + 0] = static_cast<uint8_t>(x + frameNumber * 4);
+            row[x * 4 + 1] = static_cast<uint8_t>(y + frameNumber * 2);
+            row[x * 4 + 2] = static_cast<uint8_t>((x ^ y) + frameNumber);
+            row[x * 4 + 3] = 255;
+        }
+    }
+}
+
+/**
+ * Times RGBA to YUV420P conversion through swscale, the way the StreamServer sets it up, against
+ * each in-tree ColorConverter kernel, and reports how far each kernel's output is from swscale's.
+ */
+int RunConversionBenchmark(const BenchSettings& settings, trUtil::JSON::Object& report)
+{
+    using trMPEG::ColorConverter;
+
+    std::vector<uint8_t> rgba;
+    FillTestPattern(rgba, settings.width, settings.height, 0);
+    const uint8_t* srcData = rgba.data();
+    int srcStride = settings.width * 4;
+
+    SwsContext* swsContext = sws_getContext(settings.width, settings.height, AV_PIX_FMT_RGBA,
+        settings.width, settings.height, AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    if (swsContext == nullptr)
+    {
+        std::cerr << EXE_NAME << ": Could not create the swscale context." << std::endl;
+        return -1;
+    }
+
+    YuvImage swsImage(settings.width, settings.height);
+    trUtil::TimeTicks startTicks = trUtil::Timer::FastTick();
+    for (int i = 0; i < settings.iterations; ++i)
+    {
+        sws_scale(swsContext, &srcData, &srcStride, 0, settings.height, swsImage.data, swsImage.stride);
+    }
+    double swsSecondsPerFrame = trUtil::Timer::FastDeltaSec(startTicks, trUtil::Timer::FastTick()) / settings.iterations;
+    sws_freeContext(swsContext);
+
+    trUtil::JSON::Array results;
+    AddResult(results, ColorConverter::GetKernelName(ColorConverter::Kernel::SWSCALE), true, swsSecondsPerFrame, swsSecondsPerFrame, 0);
+
+    for (ColorConverter::Kernel kernel : { ColorConverter::Kernel::SCALAR, ColorConverter::Kernel::SSE41, ColorConverter::Kernel::AVX2 })
+    {
+        if (!ColorConverter::IsKernelSupported(kernel))
+        {
+            AddResult(results, ColorConverter::GetKernelName(kernel), false, 0.0, 0.0, 0);
+            continue;
+        }
+
+        YuvImage image(settings.width, settings.height);
+        startTicks = trUtil::Timer::FastTick();
+        for (int i = 0; i < settings.iterations; ++i)
+        {
+            ColorConverter::RGBAToI420(kernel, srcData, srcStride, image.data, image.stride, settings.width, settings.height);
+        }
+        double secondsPerFrame = trUtil::Timer::FastDeltaSec(startTicks, trUtil::Timer::FastTick()) / settings.iterations;
+
+        AddResult(results, ColorConverter::GetKernelName(kernel), true, secondsPerFrame, swsSecondsPerFrame, GetMaxDifference(image, swsImage));
+    }
+
+    report.SetString("benchmark", BENCHMARK_CONVERSION);
+    report.SetInt("width", settings.width);
+    report.SetInt("height", settings.height);
+    report.SetInt("iterations", settings.iterations);
+    report.SetString("bestKernel", ColorConverter::GetKernelName(ColorConverter::GetBestKernel()));
+    report.SetArray("results", results);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,357 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEGBench/Utils.h>
+
+#include <trBase/SmrtPtr.h>
+#include <trMPEG/CodecH264.h>
+#include <trMPEG/CodecH265.h>
+#include <trMPEG/CodecMpeg2.h>
+#include <trMPEG/CodecMpeg4.h>
+#include <trMPEG/StreamServer.h>
+#include <trUtil/JSON/Array.h>
+#include <trUtil/JSON/Object.h>
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/Timer.h>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef TR_WIN
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+//Forward declaration
+void FillTestPattern(std::vector<uint8_t>& rgba, int width, int height, int frameNumber);
+
+namespace
+{
+    /** @brief   Frames of the moving test pattern generated up front, and fed in a loop, so drawing them does not load the CPU during the measurement. */
+    const int PATTERN_FRAME_COUNT = 8;
+
+    const std::string CODEC_H264 = "h264";
+    const std::string CODEC_H265 = "h265";
+    const std::string CODEC_MPEG2 = "mpeg2";
+    const std::string CODEC_MPEG4 = "mpeg4";
+
+    const std::string PIXEL_FORMAT_RGB = "rgb";
+    const std::string PIXEL_FORMAT_RGBA = "rgba";
+
+    /**
+     * @struct  Resolution
+     *
+     * @brief   A named frame size to benchmark.
+     */
+    struct Resolution
+    {
+        std::string name;
+        int width;
+        int height;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    trMPEG::CodecBase* CreateCodec(const std::string& name)
+    {
+        if (name == CODEC_H264)
+        {
+            return new trMPEG::CodecH264();
+        }
+        else if (name == CODEC_H265)
+        {
+            return new trMPEG::CodecH265();
+        }
+        else if (name == CODEC_MPEG2)
+        {
+            return new trMPEG::CodecMpeg2();
+        }
+        else if (name == CODEC_MPEG4)
+        {
+            return new trMPEG::CodecMpeg4();
+        }
+        return nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double GetProcessCpuSeconds()
+    {
+#ifdef TR_WIN
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        {
+            return 0.0;
+        }
+
+        ULARGE_INTEGER kernel, user;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+        return (kernel.QuadPart + user.QuadPart) / 1.0e7;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0.0;
+        }
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e6;
+#endif
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GeneratePatternFrames(std::vector<std::vector<uint8_t>>& frames, int width, int height, const std::string& pixelFormat)
+    {
+        frames.resize(PATTERN_FRAME_COUNT);
+        for (int i = 0; i < PATTERN_FRAME_COUNT; ++i)
+        {
+            FillTestPattern(frames[i], width, height, i);
+            if (pixelFormat == PIXEL_FORMAT_RGB)
+            {
+                //Drop the alpha channel in place
+                std::vector<uint8_t>& frame = frames[i];
+                for (int pixel = 0; pixel < width * height; ++pixel)
+                {
+                    frame[pixel * 3 + 0] = frame[pixel * 4 + 0];
+                    frame[pixel * 3 + 1] = frame[pixel * 4 + 1];
+                    frame[pixel * 3 + 2] = frame[pixel * 4 + 2];
+                }
+                frame.resize(width * height * 3);
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double GetAverageMs(const trUtil::Metrics::Histogram* histogram)
+    {
+        if (histogram == nullptr || histogram->GetCount() == 0)
+        {
+            return 0.0;
+        }
+        return histogram->GetSum() / histogram->GetCount() * 1000.0;
+    }
+
+    /**
+     * Waits until the condition holds, giving up once the StreamServer made no progress for a second,
+     * so a stalled encoder can not hang the benchmark. Returns false on a stall.
+     */
+    template <typename Condition, typename Progress>
+    bool WaitForEncoder(Condition condition, Progress progress)
+    {
+        const std::chrono::steady_clock::duration stallTimeout = std::chrono::seconds(1);
+        unsigned long long lastProgress = progress();
+        std::chrono::steady_clock::time_point lastProgressTime = std::chrono::steady_clock::now();
+        while (!condition())
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            if (progress() != lastProgress)
+            {
+                lastProgress = progress();
+                lastProgressTime = std::chrono::steady_clock::now();
+            }
+            else if (std::chrono::steady_clock::now() - lastProgressTime > stallTimeout)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Streams the pattern frames to a file at the benchmark frame rate, the way a render loop would
+     * hand them over, and measures how much of that rate the StreamServer sustains. Unthrottled, the
+     * server does not keep to the frame rate and each frame is fed as soon as the encoder picked up
+     * the one before it, which measures the maximum throughput instead.
+     */
+    void RunEncode(const BenchSettings& settings, const std::string& codecName, const Resolution& resolution, const std::string& pixelFormat,
+        const std::vector<std::vector<uint8_t>>& frames, trUtil::JSON::Object& result)
+    {
+        result.SetString("codec", codecName);
+        result.SetString("resolution", resolution.name);
+        result.SetInt("width", resolution.width);
+        result.SetInt("height", resolution.height);
+        result.SetString("pixelFormat", pixelFormat);
+
+        //The encoder libraries ffmpeg was built with decide which codecs can run, the StreamServer exits on a missing one
+        trBase::SmrtPtr<trMPEG::CodecBase> codec = CreateCodec(codecName);
+        if (avcodec_find_encoder(codec->GetEncoderType()) == nullptr)
+        {
+            result.SetBool("supported", false);
+            return;
+        }
+        result.SetBool("supported", true);
+
+        trMPEG::StreamServer server;
+        server.SetSilent(true);
+        server.SetFileName(EXE_NAME + "_" + codecName + "_" + resolution.name + "_" + pixelFormat);
+        server.SetMpegType(codec.Get());
+        server.SetResolution(resolution.width, resolution.height);
+        server.SetFrameRate(settings.frameRate);
+        server.SetInputPixelFormat(pixelFormat == PIXEL_FORMAT_RGB ? trMPEG::StreamServer::PixelFormat::RGB : trMPEG::StreamServer::PixelFormat::RGBA);
+        server.SetFramePacing(!settings.unthrottled);
+        server.Init();
+
+        const trUtil::Metrics::Histogram* handoff = server.GetLatencyHistogram(trMPEG::StreamServer::LatencyStage::HANDOFF);
+        const unsigned long long handoffStart = handoff->GetCount();
+        auto getHandedOff = [&]() { return handoff->GetCount() - handoffStart; };
+        auto getEncoded = [&]() { return server.GetEncodedFrameCount() - server.GetDuplicatedFrameCount(); };
+        const unsigned long long iterations = settings.iterations;
+
+        const std::chrono::steady_clock::duration framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / settings.frameRate));
+        bool stalled = false;
+        double cpuStart = GetProcessCpuSeconds();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point nextFrameTime = startTime;
+        for (unsigned long long i = 0; i < iterations && !stalled; ++i)
+        {
+            if (settings.unthrottled)
+            {
+                //Keep one frame waiting while the encoder works on the one before it, without replacing it
+                stalled = !WaitForEncoder([&]() { return getHandedOff() >= i; }, getHandedOff);
+            }
+            else
+            {
+                std::this_thread::sleep_until(nextFrameTime);
+                nextFrameTime += framePeriod;
+            }
+            server.Encode(frames[i % frames.size()].data(), trUtil::Timer::FastTick());
+        }
+
+        if (settings.unthrottled)
+        {
+            //Run until the last frame is encoded
+            stalled = stalled || !WaitForEncoder([&]() { return getEncoded() >= iterations; }, getEncoded);
+        }
+        else
+        {
+            //Give the encoder the last frame's time slot to pick it up
+            std::this_thread::sleep_until(nextFrameTime);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        double cpuSeconds = GetProcessCpuSeconds() - cpuStart;
+        unsigned long long encodedFrames = server.GetEncodedFrameCount();
+        unsigned long long duplicatedFrames = server.GetDuplicatedFrameCount();
+        unsigned long long droppedFrames = server.GetDroppedFrameCount();
+
+        //Shutting down flushes the encoder, so all the frames' bytes are in the count afterwards
+        server.ShutDown();
+        unsigned long long encodedBytes = server.GetEncodedByteCount();
+        std::remove(server.GetFileName().c_str());
+
+        unsigned int cpuCount = std::thread::hardware_concurrency();
+        result.SetBool("unthrottled", settings.unthrottled);
+        result.SetBool("stalled", stalled);
+        result.SetDouble("fps", (encodedFrames - duplicatedFrames) / seconds);
+        result.SetUInt64("encodedFrames", encodedFrames);
+        result.SetUInt64("droppedFrames", droppedFrames);
+        result.SetUInt64("duplicatedFrames", duplicatedFrames);
+        result.SetDouble("cpuCores", cpuSeconds / seconds);
+        result.SetDouble("cpuUtilization", cpuCount > 0 ? cpuSeconds / seconds / cpuCount : 0.0);
+        result.SetDouble("bitRate", encodedBytes * 8.0 / seconds);
+
+        trUtil::JSON::Object stages;
+        stages.SetDouble("handoff", GetAverageMs(server.GetLatencyHistogram(trMPEG::StreamServer::LatencyStage::HANDOFF)));
+        stages.SetDouble("conversion", GetAverageMs(server.GetLatencyHistogram(trMPEG::StreamServer::LatencyStage::CONVERSION)));
+        stages.SetDouble("encode", GetAverageMs(server.GetLatencyHistogram(trMPEG::StreamServer::LatencyStage::ENCODE)));
+        stages.SetDouble("mux", GetAverageMs(server.GetLatencyHistogram(trMPEG::StreamServer::LatencyStage::MUX)));
+        stages.SetDouble("total", GetAverageMs(server.GetLatencyHistogram(trMPEG::StreamServer::LatencyStage::TOTAL)));
+        result.SetObject("msPerStage", stages);
+    }
+}
+
+/**
+ * Feeds moving test patterns through the StreamServer for every codec, input pixel format and
+ * resolution, and reports the frame rate it sustains, the average time per stage, the CPU use of
+ * the whole process and the bit rate of the encoded stream.
+ */
+int RunEncodeBenchmark(const BenchSettings& settings, trUtil::JSON::Object& report)
+{
+    std::vector<Resolution> resolutions;
+    if (settings.hasResolution)
+    {
+        resolutions.push_back({ std::to_string(settings.width) + "x" + std::to_string(settings.height), settings.width, settings.height });
+    }
+    else
+    {
+        resolutions.push_back({ "720p", 1280, 720 });
+        resolutions.push_back({ "1080p", 1920, 1080 });
+        resolutions.push_back({ "4K", 3840, 2160 });
+    }
+
+    std::vector<std::string> codecs = { CODEC_H264, CODEC_H265, CODEC_MPEG2, CODEC_MPEG4 };
+    if (!settings.codec.empty())
+    {
+        trBase::SmrtPtr<trMPEG::CodecBase> codec = CreateCodec(settings.codec);
+        if (!codec.Valid())
+        {
+            std::cerr << EXE_NAME << ": Unknown codec \"" << settings.codec << "\"." << std::endl;
+            return -1;
+        }
+        codecs = { settings.codec };
+    }
+
+    std::vector<std::string> pixelFormats = { PIXEL_FORMAT_RGB, PIXEL_FORMAT_RGBA };
+    if (!settings.pixelFormat.empty())
+    {
+        if (settings.pixelFormat != PIXEL_FORMAT_RGB && settings.pixelFormat != PIXEL_FORMAT_RGBA)
+        {
+            std::cerr << EXE_NAME << ": Unknown pixel format \"" << settings.pixelFormat << "\"." << std::endl;
+            return -1;
+        }
+        pixelFormats = { settings.pixelFormat };
+    }
+
+    avcodec_register_all();
+
+    trUtil::JSON::Array results;
+    for (const Resolution& resolution : resolutions)
+    {
+        for (const std::string& pixelFormat : pixelFormats)
+        {
+            std::vector<std::vector<uint8_t>> frames;
+            GeneratePatternFrames(frames, resolution.width, resolution.height, pixelFormat);
+
+            for (const std::string& codecName : codecs)
+            {
+                trUtil::JSON::Object result;
+                RunEncode(settings, codecName, resolution, pixelFormat, frames, result);
+                results.AddObject(result);
+            }
+        }
+    }
+
+    report.SetString("benchmark", BENCHMARK_ENCODE);
+    report.SetInt("frameRate", settings.frameRate);
+    report.SetBool("unthrottled", settings.unthrottled);
+    report.SetInt("iterations", settings.iterations);
+    report.SetUInt("cpuCount", std::thread::hardware_concurrency());
+    report.SetArray("results", results);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEGBench/Utils.h>
+
+#include <trUtil/JSON/Object.h>
+
+#include <fstream>
+#include <iostream>
+
+//Forward declaration
+int RunConversionBenchmark(const BenchSettings& settings, trUtil::JSON::Object& report);
+int RunEncodeBenchmark(const BenchSettings& settings, trUtil::JSON::Object& report);
+
+/**
+ * Software's main function.
+ */
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+
+    //Parse command line arguments
+    ParseCmdLineArgs(argc, argv, settings);
+
+    if (settings.width <= 0 || settings.height <= 0 || settings.iterations <= 0 || settings.frameRate <= 0)
+    {
+        std::cerr << EXE_NAME << ": The width, height, iteration count and frame rate have to be positive." << std::endl;
+        return -1;
+    }
+
+    trUtil::JSON::Object report;
+    int result = 0;
+    if (settings.benchmark == BENCHMARK_CONVERSION)
+    {
+        result = RunConversionBenchmark(settings, report);
+    }
+    else if (settings.benchmark == BENCHMARK_ENCODE)
+    {
+        result = RunEncodeBenchmark(settings, report);
+    }
+    else
+    {
+        std::cerr << EXE_NAME << ": Unknown benchmark \"" << settings.benchmark << "\"." << std::endl;
+        return -1;
+    }
+
+    if (result != 0)
+    {
+        return result;
+    }
+
+    if (settings.outputFile.empty())
+    {
+        std::cout << report.GetJSONRoot() << std::endl;
+    }
+    else
+    {
+        std::ofstream output(settings.outputFile.c_str());
+        if (!output)
+        {
+            std::cerr << EXE_NAME << ": Can't open \"" << settings.outputFile << "\" for writing." << std::endl;
+            return -1;
+        }
+        output << report.GetJSONRoot() << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trMPEGBench/Utils.h>
+
+#include <iostream>
+#include <cstdlib>
+
+#include <osg/ArgumentParser>
+
+/*
+ * Parses the command line variables that are passed in to the executable
+ */
+void ParseCmdLineArgs(int& argc, char** argv, BenchSettings& settings)
+{
+    osg::ArgumentParser arguments(&argc, argv);
+
+    arguments.getApplicationUsage()->setApplicationName(PROGRAM_NAME);
+    arguments.getApplicationUsage()->setCommandLineUsage(EXE_NAME + " [options]");
+
+    arguments.getApplicationUsage()->addCommandLineOption("\n--benchmark <name>         ", "The benchmark to run: " + BENCHMARK_CONVERSION + " (RGBA to YUV420P with swscale and the in-tree kernels) or " + BENCHMARK_ENCODE + " (synthetic frames through the StreamServer). Defaults to " + BENCHMARK_CONVERSION);
+    arguments.getApplicationUsage()->addCommandLineOption("\n--width <pixels>           ", "Frame width. Defaults to 1920, the " + BENCHMARK_ENCODE + " benchmark runs 720p, 1080p and 4K unless a size is given");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--height <pixels>          ", "Frame height. Defaults to 1080");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--iterations <count>       ", "Frames to run through each measured path. Defaults to 100");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--fps <count>              ", "Frame rate the " + BENCHMARK_ENCODE + " benchmark feeds and streams at. Defaults to 60");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--unthrottled              ", "Feed the " + BENCHMARK_ENCODE + " benchmark frames as fast as the encoder takes them, without keeping to the frame rate, to measure the maximum throughput");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--codec <name>             ", "Only run the " + BENCHMARK_ENCODE + " benchmark with this codec: h264, h265, mpeg2 or mpeg4. Defaults to all of them");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--pixel-format <name>      ", "Only feed the " + BENCHMARK_ENCODE + " benchmark this input format: rgb or rgba. Defaults to both");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--output <filename>        ", "The file to write the JSON report to. Defaults to the console");
+    arguments.getApplicationUsage()->addCommandLineOption("\n--help, /help, -h, /h, /?  ", "Show this help screen.");
+
+    if (arguments.read("--help") == true ||
+        arguments.read("/help") == true ||
+        arguments.read("-h") == true ||
+        arguments.read("/h") == true ||
+        arguments.read("/?") == true)
+    {
+        arguments.getApplicationUsage()->write(std::cout);
+        exit(0);
+    }
+
+    arguments.read("--benchmark", settings.benchmark);
+    if (arguments.read("--width", settings.width))
+    {
+        settings.hasResolution = true;
+    }
+    if (arguments.read("--height", settings.height))
+    {
+        settings.hasResolution = true;
+    }
+    arguments.read("--iterations", settings.iterations);
+    arguments.read("--fps", settings.frameRate);
+    if (arguments.read("--unthrottled"))
+    {
+        settings.unthrottled = true;
+    }
+    arguments.read("--codec", settings.codec);
+    arguments.read("--pixel-format", settings.pixelFormat);
+    arguments.read("--output", settings.outputFile);
+}
\ No newline at end of file
@@ -24,6 +24,7 @@
 #include <trManager/SystemManager.h>
 #include <trManager/Invokable.h>
 #include <trManager/EntityType.h>
+#include <trManager/MessageTick.h>
 #include <trUtil/Functor.h>
 #include <trUtil/Logging/Log.h>
 
@@ -121,6 +122,57 @@ namespace trManager
         }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void ActorBase::RegisterForMessagesInArea(double radius, const std::string& invokableName)
+    {
+        if (mSysMan.valid())
+        {
+            mSysMan->RegisterForMessagesInArea(*this, radius, invokableName);
+        }
+        else
+        {
+            LOG_E("The entity " + GetName() + " is missing the internal System Manager reference. ")
+            if (!IsRegistered())
+            {
+                LOG_W("The entity " + GetName() + " is not registered with System Manager. ")
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ActorBase::UnregisterFromMessagesInArea()
+    {
+        if (mSysMan.valid())
+        {
+            mSysMan->UnregisterFromMessagesInArea(*this);
+        }
+        else
+        {
+            LOG_E("The entity " + GetName() + " is missing the internal System Manager reference. ")
+            if (!IsRegistered())
+            {
+                LOG_W("The entity " + GetName() + " is not registered with System Manager. ")
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ActorBase::SetPosition(const trBase::Vec3& position)
+    {
+        if (mSysMan.valid())
+        {
+            mSysMan->SetEntityPosition(*this, position);
+        }
+        else
+        {
+            LOG_E("The entity " + GetName() + " is missing the internal System Manager reference. ")
+            if (!IsRegistered())
+            {
+                LOG_W("The entity " + GetName() + " is not registered with System Manager. ")
+            }
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void ActorBase::BuildInvokables()
     {
@@ -130,7 +182,19 @@ namespace trManager
 
     //////////////////////////////////////////////////////////////////////////
     void ActorBase::OnTickRemote(const trManager::MessageBase& msg)
-    {}
+    {
+        trManager::ReplicatedFields* fields = GetReplicatedFields();
+        if (fields != nullptr && msg.GetMessageType() == trManager::MessageTick::MESSAGE_TYPE)
+        {
+            fields->Interpolate(static_cast<const trManager::MessageTick&>(msg).GetDeltaSimTime());
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    trManager::ReplicatedFields* ActorBase::GetReplicatedFields()
+    {
+        return nullptr;
+    }
 
     //////////////////////////////////////////////////////////////////////////
     bool ActorBase::SendMessage(const trManager::MessageBase& message)
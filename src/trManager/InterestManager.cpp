@@ -0,0 +1,238 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/InterestManager.h>
+
+#include <algorithm>
+
+namespace trManager
+{
+    //////////////////////////////////////////////////////////////////////////
+    InterestManager::InterestManager()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    InterestManager::~InterestManager()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::AddSubscription(trManager::EntityBase& listener, double radius, const std::string& invokableName)
+    {
+        Subscription& subscription = mSubscriptionMap[listener.GetUUID()];
+        subscription.listener = &listener;
+        subscription.radius = radius;
+        subscription.invokableName = invokableName;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool InterestManager::RemoveSubscription(const trBase::UniqueId& listenerId)
+    {
+        SubscriptionMap::iterator it = mSubscriptionMap.find(listenerId);
+        if (it == mSubscriptionMap.end() || !it->second.listener.Valid())
+        {
+            return false;
+        }
+
+        if (mWalkDepth > 0)
+        {
+            //Keep the subscription until the walk ends. Subscribing again before then brings it back.
+            it->second.listener = nullptr;
+            mRemovedListeners.push_back(listenerId);
+        }
+        else
+        {
+            EraseSubscription(listenerId);
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::RemoveEntity(const trBase::UniqueId& id)
+    {
+        RemoveSubscription(id);
+
+        if (mWalkDepth > 0)
+        {
+            mRemovedEntities.push_back(id);
+        }
+        else
+        {
+            RemoveFromAreas(id);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::BeginWalk()
+    {
+        ++mWalkDepth;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::EndWalk()
+    {
+        if (--mWalkDepth > 0)
+        {
+            return;
+        }
+
+        for (const trBase::UniqueId& listenerId : mRemovedListeners)
+        {
+            SubscriptionMap::iterator it = mSubscriptionMap.find(listenerId);
+            if (it != mSubscriptionMap.end() && !it->second.listener.Valid())
+            {
+                EraseSubscription(listenerId);
+            }
+        }
+        mRemovedListeners.clear();
+
+        for (const trBase::UniqueId& id : mRemovedEntities)
+        {
+            RemoveFromAreas(id);
+        }
+        mRemovedEntities.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::EraseSubscription(const trBase::UniqueId& listenerId)
+    {
+        SubscriptionMap::iterator it = mSubscriptionMap.find(listenerId);
+        for (const trBase::UniqueId& member : it->second.members)
+        {
+            RemoveMember(member, it->second);
+        }
+        mSubscriptionMap.erase(it);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::RemoveFromAreas(const trBase::UniqueId& id)
+    {
+        MemberMap::iterator it = mMemberMap.find(id);
+        if (it != mMemberMap.end())
+        {
+            for (Subscription* subscription : it->second)
+            {
+                std::vector<trBase::UniqueId>& members = subscription->members;
+                std::vector<trBase::UniqueId>::iterator member = std::lower_bound(members.begin(), members.end(), id);
+                if (member != members.end() && *member == id)
+                {
+                    members.erase(member);
+                }
+            }
+            mMemberMap.erase(it);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::Clear()
+    {
+        mSubscriptionMap.clear();
+        mMemberMap.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool InterestManager::IsEmpty() const
+    {
+        return mSubscriptionMap.empty();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::Update(const trManager::SpatialIndex& index)
+    {
+        trBase::Vec3 center;
+        for (SubscriptionMap::value_type& entry : mSubscriptionMap)
+        {
+            Subscription& subscription = entry.second;
+
+            mQueryResults.clear();
+            if (index.GetPosition(entry.first, center))
+            {
+                index.QueryRadius(center, subscription.radius, mQueryResults);
+
+                //Listeners do not get the messages about themselves
+                mQueryResults.erase(std::remove(mQueryResults.begin(), mQueryResults.end(), entry.first), mQueryResults.end());
+                std::sort(mQueryResults.begin(), mQueryResults.end());
+            }
+
+            //Walk both sorted lists, and only touch the entities that entered or left
+            std::vector<trBase::UniqueId>::const_iterator oldIt = subscription.members.begin();
+            std::vector<trBase::UniqueId>::const_iterator newIt = mQueryResults.begin();
+            while (oldIt != subscription.members.end() || newIt != mQueryResults.end())
+            {
+                if (newIt == mQueryResults.end() || (oldIt != subscription.members.end() && *oldIt < *newIt))
+                {
+                    RemoveMember(*oldIt, subscription);
+                    ++oldIt;
+                }
+                else if (oldIt == subscription.members.end() || *newIt < *oldIt)
+                {
+                    AddMember(*newIt, subscription);
+                    ++newIt;
+                }
+                else
+                {
+                    ++oldIt;
+                    ++newIt;
+                }
+            }
+
+            subscription.members.swap(mQueryResults);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::vector<InterestManager::Subscription*>* InterestManager::GetSubscriptions(const trBase::UniqueId& aboutId) const
+    {
+        MemberMap::const_iterator it = mMemberMap.find(aboutId);
+        return it != mMemberMap.end() ? &it->second : nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const InterestManager::Subscription* InterestManager::FindSubscription(const trBase::UniqueId& listenerId) const
+    {
+        SubscriptionMap::const_iterator it = mSubscriptionMap.find(listenerId);
+        return it != mSubscriptionMap.end() && it->second.listener.Valid() ? &it->second : nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::AddMember(const trBase::UniqueId& id, Subscription& subscription)
+    {
+        mMemberMap[id].push_back(&subscription);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void InterestManager::RemoveMember(const trBase::UniqueId& id, Subscription& subscription)
+    {
+        MemberMap::iterator it = mMemberMap.find(id);
+        if (it == mMemberMap.end())
+        {
+            return;
+        }
+
+        std::vector<Subscription*>& subscriptions = it->second;
+        subscriptions.erase(std::remove(subscriptions.begin(), subscriptions.end(), &subscription), subscriptions.end());
+        if (subscriptions.empty())
+        {
+            mMemberMap.erase(it);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/JournalData.h>
+
+#include <cstring>
+
+namespace trManager
+{
+    //////////////////////////////////////////////////////////////////////////
+    JournalData::JournalData()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    JournalData::JournalData(const char* data, size_t size)
+        : mReadData(data)
+        , mReadSize(size)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    JournalData::~JournalData()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalData::Write(const void* data, size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+
+        //The buffer might have moved, so keep the read view pointing at it
+        mReadData = mBuffer.data();
+        mReadSize = mBuffer.size();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalData::WriteString(const std::string& value)
+    {
+        unsigned int size = static_cast<unsigned int>(value.size());
+        Write(size);
+        Write(value.data(), value.size());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalData::Read(void* data, size_t size)
+    {
+        if (GetRemaining() < size)
+        {
+            return false;
+        }
+
+        std::memcpy(data, mReadData + mReadPos, size);
+        mReadPos += size;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalData::ReadString(std::string& value)
+    {
+        unsigned int size = 0;
+        if (!Read(size) || GetRemaining() < size)
+        {
+            return false;
+        }
+
+        value.assign(mReadData + mReadPos, size);
+        mReadPos += size;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalData::SetReadPosition(size_t position)
+    {
+        mReadPos = position < mReadSize ? position : mReadSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t JournalData::GetReadPosition() const
+    {
+        return mReadPos;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const char* JournalData::GetData() const
+    {
+        return mReadData;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t JournalData::GetSize() const
+    {
+        return mReadSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t JournalData::GetRemaining() const
+    {
+        return mReadSize - mReadPos;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalData::Clear()
+    {
+        mBuffer.clear();
+        mReadData = mBuffer.data();
+        mReadSize = 0;
+        mReadPos = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,452 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/JournalPlayer.h>
+
+#include <trManager/JournalRecorder.h>
+#include <trManager/MessageTick.h>
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/Logging/Log.h>
+
+#ifdef TR_WIN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace trManager
+{
+    //Size of a message record after its type byte: type, from, about, filter, isDirect, payload size
+    static const size_t MESSAGE_HEADER_SIZE = 4 * sizeof(unsigned int) + sizeof(unsigned char) + sizeof(unsigned int);
+
+    //////////////////////////////////////////////////////////////////////////
+    JournalPlayer::JournalPlayer(trManager::SystemManager& sysMan)
+        : mSysMan(&sysMan)
+    {
+        //Ticks are recreated against the players timing
+        RegisterMessageType(trManager::MessageTick::MESSAGE_TYPE, [](const MessageInfo& info)
+        {
+            return trBase::SmrtPtr<trManager::MessageBase>(new trManager::MessageTick(info.fromActorID, *info.timeStruct));
+        });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    JournalPlayer::~JournalPlayer()
+    {
+        Close();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalPlayer::RegisterMessageType(const std::string& type, MessageCreator creator)
+    {
+        mCreatorMap[type] = creator;
+        ResolveCreators();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalPlayer::Open(const std::string& fileName)
+    {
+        Close();
+
+        if (!MapFile(fileName))
+        {
+            LOG_E("Unable to open the message journal: " + fileName)
+            return false;
+        }
+
+        if (!BuildIndex())
+        {
+            LOG_E("Invalid message journal: " + fileName)
+            Close();
+            return false;
+        }
+
+        ResolveCreators();
+        mCurrentFrame = 0;
+        mPlayedMessageCount = 0;
+        mSkippedMessageCount = 0;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalPlayer::Close()
+    {
+        UnmapFile();
+        mStrings.clear();
+        mStringCreators.clear();
+        mIds.clear();
+        mFrames.clear();
+        mCurrentFrame = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalPlayer::IsOpen() const
+    {
+        return mMapData != nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int JournalPlayer::GetFrameCount() const
+    {
+        return static_cast<unsigned int>(mFrames.size());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int JournalPlayer::GetCurrentFrame() const
+    {
+        return mCurrentFrame;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalPlayer::Seek(unsigned int frameIndex)
+    {
+        if (frameIndex >= mFrames.size())
+        {
+            return false;
+        }
+
+        mCurrentFrame = frameIndex;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalPlayer::PlayFrame()
+    {
+        if (mCurrentFrame >= mFrames.size())
+        {
+            return false;
+        }
+
+        const FrameEntry& frame = mFrames[mCurrentFrame];
+        mTimeStruct = frame.timeStruct;
+        mSysMan->SetTimingStructure(mTimeStruct);
+
+        //The tables were filled in by BuildIndex, so only the message records need to be read
+        JournalData journal(mMapData, frame.end);
+        journal.SetReadPosition(frame.offset);
+
+        //The journal holds the messages the entities sent in reaction, so sending them again would deliver them twice
+        bool wasSuppressed = mSysMan->GetSuppressSentMessages();
+        mSysMan->SetSuppressSentMessages(true);
+
+        char recordType = 0;
+        unsigned int size = 0;
+        MessageInfo info;
+        info.timeStruct = &mTimeStruct;
+
+        while (journal.Read(recordType))
+        {
+            if (recordType != JournalRecorder::MESSAGE_RECORD)
+            {
+                //String and ID records
+                journal.Read(size);
+                journal.SetReadPosition(journal.GetReadPosition() + size);
+                continue;
+            }
+
+            unsigned int typeIndex = 0;
+            unsigned int fromIndex = 0;
+            unsigned int aboutIndex = 0;
+            unsigned int filterIndex = 0;
+            unsigned char isDirect = 0;
+            journal.Read(typeIndex);
+            journal.Read(fromIndex);
+            journal.Read(aboutIndex);
+            journal.Read(filterIndex);
+            journal.Read(isDirect);
+            journal.Read(size);
+
+            JournalData payload(journal.GetData() + journal.GetReadPosition(), size);
+            journal.SetReadPosition(journal.GetReadPosition() + size);
+
+            //The indices were validated by BuildIndex
+            const MessageCreator* creator = mStringCreators[typeIndex];
+            if (creator == nullptr)
+            {
+                ++mSkippedMessageCount;
+                continue;
+            }
+
+            info.fromActorID = fromIndex != JournalRecorder::NULL_INDEX ? mIds[fromIndex].Get() : nullptr;
+            info.aboutActorID = aboutIndex != JournalRecorder::NULL_INDEX ? mIds[aboutIndex].Get() : nullptr;
+            info.isDirect = isDirect != 0;
+            info.messageFilter = &mStrings[filterIndex];
+            info.data = &payload;
+
+            trBase::SmrtPtr<trManager::MessageBase> message = (*creator)(info);
+            if (!message.Valid())
+            {
+                ++mSkippedMessageCount;
+                continue;
+            }
+
+            mSysMan->ProcessMessage(*message);
+            ++mPlayedMessageCount;
+        }
+
+        //Send out anything queued before the frame, and clean up like the System Director would
+        mSysMan->FlushMessages();
+        mSysMan->RemoveMarkedEntities();
+        mSysMan->SetSuppressSentMessages(wasSuppressed);
+
+        ++mCurrentFrame;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int JournalPlayer::PlayAll()
+    {
+        unsigned int frameCount = 0;
+        while (PlayFrame())
+        {
+            ++frameCount;
+        }
+        return frameCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::TimingStructure& JournalPlayer::GetTimeStructure() const
+    {
+        return mTimeStruct;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long JournalPlayer::GetPlayedMessageCount() const
+    {
+        return mPlayedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long JournalPlayer::GetSkippedMessageCount() const
+    {
+        return mSkippedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalPlayer::MapFile(const std::string& fileName)
+    {
+#ifdef TR_WIN
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        mFileHandle = file;
+        mMapHandle = mapping;
+        mMapData = static_cast<const char*>(data);
+        mMapSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int file = open(fileName.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(file);
+            return false;
+        }
+
+        void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        //The mapping stays valid after the file is closed
+        close(file);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+        mMapData = static_cast<const char*>(data);
+        mMapSize = static_cast<size_t>(fileStat.st_size);
+#endif
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalPlayer::UnmapFile()
+    {
+        if (mMapData == nullptr)
+        {
+            return;
+        }
+
+#ifdef TR_WIN
+        UnmapViewOfFile(mMapData);
+        CloseHandle(static_cast<HANDLE>(mMapHandle));
+        CloseHandle(static_cast<HANDLE>(mFileHandle));
+        mMapHandle = nullptr;
+        mFileHandle = nullptr;
+#else
+        munmap(const_cast<char*>(mMapData), mMapSize);
+#endif
+        mMapData = nullptr;
+        mMapSize = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalPlayer::BuildIndex()
+    {
+        JournalData journal(mMapData, mMapSize);
+
+        //Check the file header
+        std::string fileId(JournalRecorder::FILE_ID.size(), '\0');
+        unsigned int version = 0;
+        if (!journal.Read(&fileId[0], fileId.size()) || fileId != JournalRecorder::FILE_ID ||
+            !journal.Read(version) || version != JournalRecorder::FILE_VERSION)
+        {
+            return false;
+        }
+
+        char recordType = 0;
+        size_t recordStart = journal.GetReadPosition();
+        bool isComplete = true;
+
+        while (isComplete && journal.Read(recordType))
+        {
+            switch (recordType)
+            {
+            case JournalRecorder::STRING_RECORD:
+            {
+                std::string value;
+                isComplete = journal.ReadString(value);
+                if (isComplete)
+                {
+                    mStrings.push_back(value);
+                }
+                break;
+            }
+            case JournalRecorder::ID_RECORD:
+            {
+                std::string value;
+                isComplete = journal.ReadString(value);
+                if (isComplete)
+                {
+                    mIds.push_back(new trBase::UniqueId(value));
+                }
+                break;
+            }
+            case JournalRecorder::FRAME_RECORD:
+            {
+                FrameEntry frame;
+                isComplete = journal.Read(frame.timeStruct.frameNumber) &&
+                             journal.Read(frame.timeStruct.deltaSimTime) &&
+                             journal.Read(frame.timeStruct.deltaRealTime) &&
+                             journal.Read(frame.timeStruct.simTime) &&
+                             journal.Read(frame.timeStruct.realTime) &&
+                             journal.Read(frame.timeStruct.timeScale);
+                if (isComplete)
+                {
+                    if (!mFrames.empty())
+                    {
+                        mFrames.back().end = recordStart;
+                    }
+                    frame.offset = journal.GetReadPosition();
+                    mFrames.push_back(frame);
+                }
+                break;
+            }
+            case JournalRecorder::MESSAGE_RECORD:
+            {
+                unsigned int indices[4];
+                unsigned char isDirect = 0;
+                unsigned int size = 0;
+                //A crash can cut the header short, check it all at once before reading it
+                isComplete = !mFrames.empty() && journal.GetRemaining() >= MESSAGE_HEADER_SIZE && journal.Read(indices) && journal.Read(isDirect) && journal.Read(size) && journal.GetRemaining() >= size;
+
+                //Everything a message refers to has to be recorded before it
+                isComplete = isComplete &&
+                             indices[0] < mStrings.size() &&
+                             (indices[1] == JournalRecorder::NULL_INDEX || indices[1] < mIds.size()) &&
+                             (indices[2] == JournalRecorder::NULL_INDEX || indices[2] < mIds.size()) &&
+                             indices[3] < mStrings.size();
+                if (isComplete)
+                {
+                    journal.SetReadPosition(journal.GetReadPosition() + size);
+                }
+                break;
+            }
+            default:
+                isComplete = false;
+                break;
+            }
+
+            if (isComplete)
+            {
+                recordStart = journal.GetReadPosition();
+            }
+        }
+
+        if (!isComplete)
+        {
+            LOG_W("The message journal is cut short or damaged, playing it up to the last complete record.")
+        }
+
+        //The last frame ends with the last complete record
+        if (!mFrames.empty())
+        {
+            mFrames.back().end = recordStart;
+        }
+
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalPlayer::ResolveCreators()
+    {
+        mStringCreators.assign(mStrings.size(), nullptr);
+        for (size_t i = 0; i < mStrings.size(); ++i)
+        {
+            trUtil::HashMap<std::string, MessageCreator>::const_iterator it = mCreatorMap.find(mStrings[i]);
+            if (it != mCreatorMap.end())
+            {
+                mStringCreators[i] = &it->second;
+            }
+        }
+    }
+}
\ No newline at end of file
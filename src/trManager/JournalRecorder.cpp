@@ -0,0 +1,248 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/JournalRecorder.h>
+
+#include <trManager/SystemManager.h>
+#include <trUtil/Logging/Log.h>
+
+namespace trManager
+{
+    const trUtil::RefStr JournalRecorder::CLASS_TYPE("trManager::JournalRecorder");
+
+    const std::string JournalRecorder::FILE_ID("TRJOURNAL");
+    const unsigned int JournalRecorder::FILE_VERSION = 1;
+    const unsigned int JournalRecorder::NULL_INDEX = 0xFFFFFFFF;
+
+    //Size of the record buffer that triggers a write to the file
+    static const size_t FLUSH_SIZE = 64 * 1024;
+
+    //////////////////////////////////////////////////////////////////////////
+    JournalRecorder::JournalRecorder(const std::string& name) : BaseClass(name)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    JournalRecorder::~JournalRecorder()
+    {
+        Close();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalRecorder::OnAddedToSysMan()
+    {
+        BaseClass::OnAddedToSysMan();
+
+        mRecordingSysMan = mSysMan.get();
+        mRecordingSysMan->SetJournalRecorder(this);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalRecorder::OnRemovedFromSysMan()
+    {
+        BaseClass::OnRemovedFromSysMan();
+
+        if (mRecordingSysMan.valid() && mRecordingSysMan->GetJournalRecorder() == this)
+        {
+            mRecordingSysMan->SetJournalRecorder(nullptr);
+        }
+        mRecordingSysMan = nullptr;
+
+        Flush();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalRecorder::Open(const std::string& fileName)
+    {
+        Close();
+
+        mFile.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!mFile.is_open())
+        {
+            LOG_E("Unable to create the message journal: " + fileName)
+            return false;
+        }
+
+        //Reset the interning tables, so the journal is self contained
+        mTypeIndexMap.clear();
+        mStringIndexMap.clear();
+        mIdIndexMap.clear();
+        mNextStringIndex = 0;
+        mNextIdIndex = 0;
+        mFrameStarted = false;
+        mRecordedMessageCount = 0;
+        mRecordedFrameCount = 0;
+
+        mBuffer.Clear();
+        mBuffer.Write(FILE_ID.data(), FILE_ID.size());
+        mBuffer.Write(FILE_VERSION);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalRecorder::Close()
+    {
+        if (mFile.is_open())
+        {
+            Flush();
+            mFile.close();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool JournalRecorder::IsRecording() const
+    {
+        return mFile.is_open();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalRecorder::Flush()
+    {
+        if (mFile.is_open())
+        {
+            mFile.write(mBuffer.GetData(), mBuffer.GetSize());
+            mFile.flush();
+        }
+        mBuffer.Clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalRecorder::RecordMessage(const trManager::MessageBase& message)
+    {
+        if (!mFile.is_open())
+        {
+            return;
+        }
+
+        //Start a new frame record whenever the frame changes
+        const trManager::TimingStructure& timeStruct = mRecordingSysMan.valid() ? mRecordingSysMan->GetTimingStructure() : trManager::TimingStructure();
+        if (!mFrameStarted || timeStruct.frameNumber != mLastFrameNumber)
+        {
+            if (mBuffer.GetSize() >= FLUSH_SIZE)
+            {
+                mFile.write(mBuffer.GetData(), mBuffer.GetSize());
+                mBuffer.Clear();
+            }
+
+            WriteFrame(timeStruct);
+            mFrameStarted = true;
+            mLastFrameNumber = timeStruct.frameNumber;
+        }
+
+        //The interned records have to precede the message that uses them
+        unsigned int typeIndex = InternType(message.GetMessageType());
+        unsigned int fromIndex = InternId(message.GetFromActorID());
+        unsigned int aboutIndex = InternId(message.GetAboutActorID());
+        unsigned int filterIndex = InternString(message.GetMessageFilter());
+
+        mPayload.Clear();
+        message.WriteJournalData(mPayload);
+
+        mBuffer.Write(static_cast<char>(MESSAGE_RECORD));
+        mBuffer.Write(typeIndex);
+        mBuffer.Write(fromIndex);
+        mBuffer.Write(aboutIndex);
+        mBuffer.Write(filterIndex);
+        mBuffer.Write(static_cast<unsigned char>(message.GetIsDirect() ? 1 : 0));
+        mBuffer.Write(static_cast<unsigned int>(mPayload.GetSize()));
+        mBuffer.Write(mPayload.GetData(), mPayload.GetSize());
+
+        ++mRecordedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long JournalRecorder::GetRecordedMessageCount() const
+    {
+        return mRecordedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long JournalRecorder::GetRecordedFrameCount() const
+    {
+        return mRecordedFrameCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int JournalRecorder::InternType(const std::string& type)
+    {
+        //Message types are RefStr, so their address is a cheap key
+        trUtil::HashMap<const std::string*, unsigned int>::const_iterator it = mTypeIndexMap.find(&type);
+        if (it != mTypeIndexMap.end())
+        {
+            return it->second;
+        }
+
+        unsigned int index = InternString(type);
+        mTypeIndexMap[&type] = index;
+        return index;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int JournalRecorder::InternString(const std::string& value)
+    {
+        trUtil::HashMap<std::string, unsigned int>::const_iterator it = mStringIndexMap.find(value);
+        if (it != mStringIndexMap.end())
+        {
+            return it->second;
+        }
+
+        mBuffer.Write(static_cast<char>(STRING_RECORD));
+        mBuffer.WriteString(value);
+
+        mStringIndexMap[value] = mNextStringIndex;
+        return mNextStringIndex++;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int JournalRecorder::InternId(const trBase::UniqueId* id)
+    {
+        if (id == nullptr)
+        {
+            return NULL_INDEX;
+        }
+
+        std::map<trBase::UniqueId, unsigned int>::const_iterator it = mIdIndexMap.find(*id);
+        if (it != mIdIndexMap.end())
+        {
+            return it->second;
+        }
+
+        mBuffer.Write(static_cast<char>(ID_RECORD));
+        mBuffer.WriteString(id->ToString());
+
+        mIdIndexMap[*id] = mNextIdIndex;
+        return mNextIdIndex++;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void JournalRecorder::WriteFrame(const trManager::TimingStructure& timeStruct)
+    {
+        mBuffer.Write(static_cast<char>(FRAME_RECORD));
+        mBuffer.Write(timeStruct.frameNumber);
+        mBuffer.Write(timeStruct.deltaSimTime);
+        mBuffer.Write(timeStruct.deltaRealTime);
+        mBuffer.Write(timeStruct.simTime);
+        mBuffer.Write(timeStruct.realTime);
+        mBuffer.Write(timeStruct.timeScale);
+
+        ++mRecordedFrameCount;
+    }
+}
\ No newline at end of file
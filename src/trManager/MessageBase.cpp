@@ -88,8 +88,19 @@ namespace trManager
     }
 
     //////////////////////////////////////////////////////////////////////////
-    const std::string& MessageBase::GetMessageFilter()
+    const std::string& MessageBase::GetMessageFilter() const
     {
         return *mMessageFilter;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessageBase::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::NORMAL;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void MessageBase::WriteJournalData(trManager::JournalData& data) const
+    {
+    }
 }
@@ -47,4 +47,10 @@ namespace trManager
     {
         return MESSAGE_TYPE;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessagePriority& MessageTick::GetMessagePriority() const
+    {
+        return trManager::MessagePriority::SYSTEM;
+    }
 }
@@ -0,0 +1,164 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/NetTransport.h>
+
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/Logging/Log.h>
+
+#include <cstring>
+
+#ifdef TR_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using NativeSocket = SOCKET;
+#else
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netdb.h>
+    #include <unistd.h>
+    using NativeSocket = int;
+#endif
+
+namespace trManager
+{
+    const trUtil::RefStr NetTransport::CLASS_TYPE("trManager::NetTransport");
+
+    const NetTransport::SocketHandle NetTransport::INVALID_SOCKET_HANDLE = -1;
+
+    //////////////////////////////////////////////////////////////////////////
+    NetTransport::NetTransport()
+    {
+#ifdef TR_WIN
+        //WSAStartup is reference counted, so every transport can call it
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        {
+            LOG_E("Unable to initialize Windows Sockets.")
+        }
+#endif
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    NetTransport::~NetTransport()
+    {
+#ifdef TR_WIN
+        WSACleanup();
+#endif
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::string& NetTransport::GetType() const
+    {
+        return CLASS_TYPE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransport::CloseSocket(SocketHandle& socket)
+    {
+        if (socket == INVALID_SOCKET_HANDLE)
+        {
+            return;
+        }
+
+#ifdef TR_WIN
+        closesocket(static_cast<NativeSocket>(socket));
+#else
+        close(static_cast<NativeSocket>(socket));
+#endif
+        socket = INVALID_SOCKET_HANDLE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransport::WaitForRead(const std::vector<SocketHandle>& sockets, unsigned int timeoutMs, std::vector<SocketHandle>& readySockets)
+    {
+        readySockets.clear();
+
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        SocketHandle maxSocket = 0;
+        for (SocketHandle socket : sockets)
+        {
+            FD_SET(static_cast<NativeSocket>(socket), &readSet);
+            maxSocket = socket > maxSocket ? socket : maxSocket;
+        }
+
+        timeval timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+        if (select(static_cast<int>(maxSocket + 1), &readSet, nullptr, nullptr, &timeout) <= 0)
+        {
+            return false;
+        }
+
+        for (SocketHandle socket : sockets)
+        {
+            if (FD_ISSET(static_cast<NativeSocket>(socket), &readSet))
+            {
+                readySockets.push_back(socket);
+            }
+        }
+        return !readySockets.empty();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransport::ResolveAddress(const std::string& host, unsigned short port, std::vector<char>& address)
+    {
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr)
+        {
+            LOG_E("Unable to resolve the network address: " + host)
+            return false;
+        }
+
+        sockaddr_in socketAddress;
+        std::memcpy(&socketAddress, result->ai_addr, sizeof(socketAddress));
+        socketAddress.sin_port = htons(port);
+        freeaddrinfo(result);
+
+        const char* bytes = reinterpret_cast<const char*>(&socketAddress);
+        address.assign(bytes, bytes + sizeof(socketAddress));
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned short NetTransport::GetSocketPort(SocketHandle socket)
+    {
+        if (socket == INVALID_SOCKET_HANDLE)
+        {
+            return 0;
+        }
+
+        sockaddr_in socketAddress;
+        socklen_t addressSize = sizeof(socketAddress);
+        if (getsockname(static_cast<NativeSocket>(socket), reinterpret_cast<sockaddr*>(&socketAddress), &addressSize) != 0)
+        {
+            return 0;
+        }
+        return ntohs(socketAddress.sin_port);
+    }
+}
\ No newline at end of file
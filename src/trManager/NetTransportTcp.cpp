@@ -0,0 +1,432 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/NetTransportTcp.h>
+
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/StringUtils.h>
+#include <trUtil/Logging/Log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
+
+#ifdef TR_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using NativeSocket = SOCKET;
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <fcntl.h>
+    #include <cerrno>
+    using NativeSocket = int;
+#endif
+
+namespace trManager
+{
+    const trUtil::RefStr NetTransportTcp::CLASS_TYPE("trManager::NetTransportTcp");
+
+    const size_t NetTransportTcp::DEFAULT_MAX_PACKET_SIZE = 65536;
+
+    //Size of the length prefix in front of every packet
+    static const size_t FRAME_HEADER_SIZE = sizeof(unsigned int);
+
+    //Largest chunk read from a connection at once
+    static const size_t READ_BUFFER_SIZE = 65536;
+
+    //Unsent data a connection may build up before it is dropped as too slow
+    static const size_t MAX_SEND_BUFFER_SIZE = 16 * 1024 * 1024;
+
+    //A peer that hangs up early should not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+    static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    static const int SEND_FLAGS = 0;
+#endif
+
+    //////////////////////////////////////////////////////////////////////////
+    static bool IsWouldBlock()
+    {
+#ifdef TR_WIN
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    NetTransportTcp::NetTransportTcp()
+        : mReadBuffer(READ_BUFFER_SIZE)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    NetTransportTcp::~NetTransportTcp()
+    {
+        Close();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::string& NetTransportTcp::GetType() const
+    {
+        return CLASS_TYPE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::Listen(unsigned short port)
+    {
+        CloseSocket(mListenSocket);
+
+        mListenSocket = static_cast<SocketHandle>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        if (mListenSocket == INVALID_SOCKET_HANDLE)
+        {
+            LOG_E("Unable to create a TCP socket.")
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(static_cast<NativeSocket>(mListenSocket), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (bind(static_cast<NativeSocket>(mListenSocket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(static_cast<NativeSocket>(mListenSocket), SOMAXCONN) != 0)
+        {
+            LOG_E("Unable to listen on TCP port: " + trUtil::StringUtils::ToString<unsigned short>(port))
+            CloseSocket(mListenSocket);
+            return false;
+        }
+
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::Connect(const std::string& host, unsigned short port)
+    {
+        std::vector<char> address;
+        if (!ResolveAddress(host, port, address))
+        {
+            return false;
+        }
+
+        SocketHandle connection = static_cast<SocketHandle>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        if (connection == INVALID_SOCKET_HANDLE)
+        {
+            LOG_E("Unable to create a TCP socket.")
+            return false;
+        }
+
+        if (connect(static_cast<NativeSocket>(connection), reinterpret_cast<const sockaddr*>(address.data()), static_cast<int>(address.size())) != 0)
+        {
+            LOG_E("Unable to connect to: " + host + ":" + trUtil::StringUtils::ToString<unsigned short>(port))
+            CloseSocket(connection);
+            return false;
+        }
+
+        AddConnection(connection);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::Send(const char* data, size_t size)
+    {
+        //Frame the packet with its length in network byte order
+        std::vector<char> frame(FRAME_HEADER_SIZE + size);
+        unsigned int frameSize = htonl(static_cast<unsigned int>(size));
+        std::memcpy(frame.data(), &frameSize, FRAME_HEADER_SIZE);
+        std::memcpy(frame.data() + FRAME_HEADER_SIZE, data, size);
+
+        std::lock_guard<std::mutex> lock(mConnectionLock);
+        bool hasConnection = false;
+        for (Connection& connection : mConnections)
+        {
+            if (!connection.isFailed)
+            {
+                connection.sendBuffer.insert(connection.sendBuffer.end(), frame.begin(), frame.end());
+                hasConnection = true;
+            }
+        }
+        return FlushConnections() && hasConnection;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::Receive(std::vector<char>& packet, unsigned int timeoutMs)
+    {
+        if (mReceivedPackets.empty())
+        {
+            //Wait on the listening socket and all the connections
+            std::vector<SocketHandle> sockets;
+            {
+                std::lock_guard<std::mutex> lock(mConnectionLock);
+                FlushConnections();
+                CloseFailedConnections();
+                for (const Connection& connection : mConnections)
+                {
+                    sockets.push_back(connection.socket);
+                }
+            }
+            if (mListenSocket != INVALID_SOCKET_HANDLE)
+            {
+                sockets.push_back(mListenSocket);
+            }
+            if (sockets.empty())
+            {
+                //Nothing to wait on yet, so do not spin the caller
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+                return false;
+            }
+
+            std::vector<SocketHandle> readySockets;
+            if (!WaitForRead(sockets, timeoutMs, readySockets))
+            {
+                return false;
+            }
+
+            for (SocketHandle readySocket : readySockets)
+            {
+                if (readySocket == mListenSocket)
+                {
+                    SocketHandle connection = static_cast<SocketHandle>(accept(static_cast<NativeSocket>(mListenSocket), nullptr, nullptr));
+                    if (connection != INVALID_SOCKET_HANDLE)
+                    {
+                        AddConnection(connection);
+                    }
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(mConnectionLock);
+                for (Connection& connection : mConnections)
+                {
+                    if (connection.socket == readySocket)
+                    {
+                        if (!connection.isFailed && !ReadConnection(connection))
+                        {
+                            connection.isFailed = true;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mConnectionLock);
+            CloseFailedConnections();
+        }
+
+        if (mReceivedPackets.empty())
+        {
+            return false;
+        }
+
+        packet.swap(mReceivedPackets.front());
+        mReceivedPackets.pop_front();
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransportTcp::Close()
+    {
+        CloseSocket(mListenSocket);
+
+        std::lock_guard<std::mutex> lock(mConnectionLock);
+        for (Connection& connection : mConnections)
+        {
+            CloseSocket(connection.socket);
+        }
+        mConnections.clear();
+        mReceivedPackets.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t NetTransportTcp::GetMaxPacketSize() const
+    {
+        return DEFAULT_MAX_PACKET_SIZE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned short NetTransportTcp::GetLocalPort() const
+    {
+        return GetSocketPort(mListenSocket);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t NetTransportTcp::GetConnectionCount() const
+    {
+        std::lock_guard<std::mutex> lock(mConnectionLock);
+        size_t count = 0;
+        for (const Connection& connection : mConnections)
+        {
+            if (!connection.isFailed)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransportTcp::AddConnection(SocketHandle socket)
+    {
+        //A slow peer should not stall the sending thread
+        if (!SetNonBlocking(socket))
+        {
+            LOG_E("Unable to make a TCP connection non blocking.")
+            CloseSocket(socket);
+            return;
+        }
+
+        //Small batches should leave right away
+        int noDelay = 1;
+        setsockopt(static_cast<NativeSocket>(socket), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        Connection connection;
+        connection.socket = socket;
+
+        std::lock_guard<std::mutex> lock(mConnectionLock);
+        mConnections.push_back(connection);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::SetNonBlocking(SocketHandle socket)
+    {
+#ifdef TR_WIN
+        u_long nonBlocking = 1;
+        return ioctlsocket(static_cast<NativeSocket>(socket), FIONBIO, &nonBlocking) == 0;
+#else
+        int flags = fcntl(static_cast<NativeSocket>(socket), F_GETFL, 0);
+        return flags != -1 && fcntl(static_cast<NativeSocket>(socket), F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::ReadConnection(Connection& connection)
+    {
+        int size = recv(static_cast<NativeSocket>(connection.socket), mReadBuffer.data(), static_cast<int>(mReadBuffer.size()), 0);
+        if (size < 0 && IsWouldBlock())
+        {
+            return true;
+        }
+        if (size <= 0)
+        {
+            return false;
+        }
+        connection.buffer.insert(connection.buffer.end(), mReadBuffer.begin(), mReadBuffer.begin() + size);
+
+        //Split off all the complete packets
+        size_t position = 0;
+        while (connection.buffer.size() - position >= FRAME_HEADER_SIZE)
+        {
+            unsigned int frameSize = 0;
+            std::memcpy(&frameSize, connection.buffer.data() + position, FRAME_HEADER_SIZE);
+            frameSize = ntohl(frameSize);
+            if (frameSize > DEFAULT_MAX_PACKET_SIZE)
+            {
+                LOG_W("Received an oversized TCP packet, closing the connection.")
+                return false;
+            }
+
+            if (connection.buffer.size() - position - FRAME_HEADER_SIZE < frameSize)
+            {
+                break;
+            }
+
+            std::vector<char>::const_iterator start = connection.buffer.begin() + position + FRAME_HEADER_SIZE;
+            mReceivedPackets.push_back(std::vector<char>(start, start + frameSize));
+            position += FRAME_HEADER_SIZE + frameSize;
+        }
+        connection.buffer.erase(connection.buffer.begin(), connection.buffer.begin() + position);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::FlushConnection(Connection& connection)
+    {
+        size_t sent = 0;
+        while (sent < connection.sendBuffer.size())
+        {
+            int result = static_cast<int>(send(static_cast<NativeSocket>(connection.socket), connection.sendBuffer.data() + sent, static_cast<int>(connection.sendBuffer.size() - sent), SEND_FLAGS));
+            if (result < 0 && IsWouldBlock())
+            {
+                break;
+            }
+            if (result <= 0)
+            {
+                return false;
+            }
+            sent += result;
+        }
+        connection.sendBuffer.erase(connection.sendBuffer.begin(), connection.sendBuffer.begin() + sent);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportTcp::FlushConnections()
+    {
+        bool isSent = true;
+        for (Connection& connection : mConnections)
+        {
+            if (connection.isFailed)
+            {
+                continue;
+            }
+
+            if (!FlushConnection(connection))
+            {
+                LOG_W("A TCP connection failed while sending, and will be closed.")
+                connection.isFailed = true;
+            }
+            else if (connection.sendBuffer.size() > MAX_SEND_BUFFER_SIZE)
+            {
+                LOG_W("A TCP connection fell too far behind, and will be closed.")
+                connection.isFailed = true;
+            }
+
+            if (connection.isFailed)
+            {
+                connection.sendBuffer.clear();
+                isSent = false;
+            }
+        }
+        return isSent;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransportTcp::CloseFailedConnections()
+    {
+        for (std::vector<Connection>::iterator it = mConnections.begin(); it != mConnections.end();)
+        {
+            if (it->isFailed)
+            {
+                CloseSocket(it->socket);
+                it = mConnections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+}
\ No newline at end of file
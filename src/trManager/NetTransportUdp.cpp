@@ -0,0 +1,214 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/NetTransportUdp.h>
+
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/StringUtils.h>
+#include <trUtil/Logging/Log.h>
+
+#include <cstring>
+#include <chrono>
+#include <thread>
+
+#ifdef TR_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using NativeSocket = SOCKET;
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    using NativeSocket = int;
+#endif
+
+namespace trManager
+{
+    const trUtil::RefStr NetTransportUdp::CLASS_TYPE("trManager::NetTransportUdp");
+
+    const size_t NetTransportUdp::DEFAULT_MAX_PACKET_SIZE = 1200;
+
+    //Largest possible UDP payload
+    static const size_t RECEIVE_BUFFER_SIZE = 65536;
+
+    //////////////////////////////////////////////////////////////////////////
+    NetTransportUdp::NetTransportUdp()
+        : mReceiveBuffer(RECEIVE_BUFFER_SIZE)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    NetTransportUdp::~NetTransportUdp()
+    {
+        Close();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::string& NetTransportUdp::GetType() const
+    {
+        return CLASS_TYPE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportUdp::Listen(unsigned short port)
+    {
+        Close();
+
+        mSocket = static_cast<SocketHandle>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        if (mSocket == INVALID_SOCKET_HANDLE)
+        {
+            LOG_E("Unable to create a UDP socket.")
+            return false;
+        }
+
+        //A large receive buffer rides out bursts while the IO thread is busy
+        int bufferSize = 4 * 1024 * 1024;
+        setsockopt(static_cast<NativeSocket>(mSocket), SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (bind(static_cast<NativeSocket>(mSocket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            LOG_E("Unable to bind the UDP socket to port: " + trUtil::StringUtils::ToString<unsigned short>(port))
+            CloseSocket(mSocket);
+            return false;
+        }
+
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportUdp::Connect(const std::string& host, unsigned short port)
+    {
+        if (mSocket == INVALID_SOCKET_HANDLE && !Listen(0))
+        {
+            return false;
+        }
+
+        std::vector<char> address;
+        if (!ResolveAddress(host, port, address))
+        {
+            return false;
+        }
+
+        AddPeer(address);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportUdp::Send(const char* data, size_t size)
+    {
+        if (mSocket == INVALID_SOCKET_HANDLE)
+        {
+            return false;
+        }
+
+        bool isSent = true;
+        std::lock_guard<std::mutex> lock(mPeerLock);
+        for (const std::vector<char>& peer : mPeers)
+        {
+            if (sendto(static_cast<NativeSocket>(mSocket), data, static_cast<int>(size), 0, reinterpret_cast<const sockaddr*>(peer.data()), static_cast<int>(peer.size())) < 0)
+            {
+                isSent = false;
+            }
+        }
+        return isSent;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetTransportUdp::Receive(std::vector<char>& packet, unsigned int timeoutMs)
+    {
+        if (mSocket == INVALID_SOCKET_HANDLE)
+        {
+            //Nothing to wait on yet, so do not spin the caller
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return false;
+        }
+
+        std::vector<SocketHandle> readySockets;
+        if (!WaitForRead(std::vector<SocketHandle>(1, mSocket), timeoutMs, readySockets))
+        {
+            return false;
+        }
+
+        sockaddr_in sender;
+        socklen_t senderSize = sizeof(sender);
+        int size = recvfrom(static_cast<NativeSocket>(mSocket), mReceiveBuffer.data(), static_cast<int>(mReceiveBuffer.size()), 0, reinterpret_cast<sockaddr*>(&sender), &senderSize);
+        if (size <= 0)
+        {
+            return false;
+        }
+
+        //Learn the senders address, so replies reach it
+        const char* senderBytes = reinterpret_cast<const char*>(&sender);
+        AddPeer(std::vector<char>(senderBytes, senderBytes + sizeof(sender)));
+
+        packet.assign(mReceiveBuffer.begin(), mReceiveBuffer.begin() + size);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransportUdp::Close()
+    {
+        CloseSocket(mSocket);
+
+        std::lock_guard<std::mutex> lock(mPeerLock);
+        mPeers.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t NetTransportUdp::GetMaxPacketSize() const
+    {
+        return mMaxPacketSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransportUdp::SetMaxPacketSize(size_t size)
+    {
+        //Leave room for the datagram headers. Not std::min, winsock2.h brings in the min macro.
+        mMaxPacketSize = size < RECEIVE_BUFFER_SIZE - 64 ? size : RECEIVE_BUFFER_SIZE - 64;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned short NetTransportUdp::GetLocalPort() const
+    {
+        return GetSocketPort(mSocket);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t NetTransportUdp::GetPeerCount() const
+    {
+        std::lock_guard<std::mutex> lock(mPeerLock);
+        return mPeers.size();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetTransportUdp::AddPeer(const std::vector<char>& address)
+    {
+        std::lock_guard<std::mutex> lock(mPeerLock);
+        if (std::find(mPeers.begin(), mPeers.end(), address) == mPeers.end())
+        {
+            mPeers.push_back(address);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,468 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/NetworkDirector.h>
+
+#include <trManager/MessageTick.h>
+#include <trManager/SystemManager.h>
+#include <trUtil/StringUtils.h>
+#include <trUtil/Logging/Log.h>
+
+#include <cstring>
+#include <limits>
+
+namespace trManager
+{
+    const trUtil::RefStr NetworkDirector::CLASS_TYPE("trManager::NetworkDirector");
+
+    const unsigned int NetworkDirector::PROTOCOL_ID = 0x544E5254;
+    const unsigned int NetworkDirector::DEFAULT_INBOUND_QUEUE_SIZE = 4096;
+
+    //Message flags
+    static const unsigned char FLAG_HAS_FROM = 1;
+    static const unsigned char FLAG_HAS_ABOUT = 2;
+    static const unsigned char FLAG_IS_DIRECT = 4;
+
+    //Packet header: protocol ID and message count
+    static const size_t PACKET_HEADER_SIZE = sizeof(unsigned int) + sizeof(unsigned short);
+
+    //How long the IO thread waits on a transport before checking the other one
+    static const unsigned int IO_WAIT_MS = 5;
+
+    //////////////////////////////////////////////////////////////////////////
+    NetworkDirector::NetworkDirector(const std::string& name) : BaseClass(name)
+        , mInboundQueue(new trUtil::RingBuffer<std::vector<char>>(DEFAULT_INBOUND_QUEUE_SIZE))
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    NetworkDirector::~NetworkDirector()
+    {
+        Stop();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::OnAddedToSysMan()
+    {
+        BaseClass::OnAddedToSysMan();
+
+        RegisterForMessage(trManager::MessageTick::MESSAGE_TYPE, ON_TICK_INVOKABLE);
+
+        mNetworkSysMan = mSysMan.get();
+        mNetworkSysMan->SetNetworkDirector(this);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::OnRemovedFromSysMan()
+    {
+        BaseClass::OnRemovedFromSysMan();
+
+        if (mNetworkSysMan.valid() && mNetworkSysMan->GetNetworkDirector() == this)
+        {
+            mNetworkSysMan->SetNetworkDirector(nullptr);
+        }
+        mNetworkSysMan = nullptr;
+
+        Stop();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::OnTick(const trManager::MessageBase& msg)
+    {
+        ProcessIncoming();
+        Flush();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::SetUnreliableTransport(trManager::NetTransport* transport)
+    {
+        if (IsRunning())
+        {
+            LOG_W("The transports can not be changed while the network director is running.")
+            return;
+        }
+        mUnreliableBatch.transport = transport;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::SetReliableTransport(trManager::NetTransport* transport)
+    {
+        if (IsRunning())
+        {
+            LOG_W("The transports can not be changed while the network director is running.")
+            return;
+        }
+        mReliableBatch.transport = transport;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::RegisterMessageType(const std::string& type, MessageCreator creator, bool isReliable)
+    {
+        MessageTypeEntry& entry = mTypeMap[type];
+        entry.typeHash = HashMessageType(type);
+        entry.isReliable = isReliable;
+        entry.creator = creator;
+
+        trUtil::HashMap<unsigned int, const MessageTypeEntry*>::const_iterator it = mTypeHashMap.find(entry.typeHash);
+        if (it != mTypeHashMap.end() && it->second != &entry)
+        {
+            LOG_E("The message type " + type + " has the same network ID as another registered type.")
+            return;
+        }
+        mTypeHashMap[entry.typeHash] = &entry;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetworkDirector::Start()
+    {
+        if (IsRunning())
+        {
+            return true;
+        }
+
+        if (!mUnreliableBatch.transport.Valid() && !mReliableBatch.transport.Valid())
+        {
+            LOG_E("The network director needs a transport to start.")
+            return false;
+        }
+
+        mIsRunning = true;
+        mIOThread = std::thread(&NetworkDirector::IOThreadLoop, this);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::Stop()
+    {
+        if (!IsRunning())
+        {
+            return;
+        }
+
+        Flush();
+
+        mIsRunning = false;
+        if (mIOThread.joinable())
+        {
+            mIOThread.join();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetworkDirector::IsRunning() const
+    {
+        return mIsRunning;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool NetworkDirector::SendNetworkMessage(const trManager::MessageBase& message)
+    {
+        trUtil::HashMap<std::string, MessageTypeEntry>::const_iterator it = mTypeMap.find(message.GetMessageType());
+        if (it == mTypeMap.end())
+        {
+            return false;
+        }
+        const MessageTypeEntry& entry = it->second;
+
+        //Reliable types fall back to the unreliable transport, and the other way around
+        Batch* batch = entry.isReliable ? &mReliableBatch : &mUnreliableBatch;
+        if (!batch->transport.Valid())
+        {
+            batch = entry.isReliable ? &mUnreliableBatch : &mReliableBatch;
+            if (!batch->transport.Valid())
+            {
+                return false;
+            }
+        }
+
+        mPayload.Clear();
+        message.WriteJournalData(mPayload);
+        if (mPayload.GetSize() > std::numeric_limits<unsigned short>::max())
+        {
+            LOG_W("The network message " + message.GetMessageType() + " has a payload that is too large to be sent.")
+            return false;
+        }
+
+        const trBase::UniqueId* fromId = message.GetFromActorID();
+        const trBase::UniqueId* aboutId = message.GetAboutActorID();
+        unsigned char flags = 0;
+        flags |= fromId != nullptr ? FLAG_HAS_FROM : 0;
+        flags |= aboutId != nullptr ? FLAG_HAS_ABOUT : 0;
+        flags |= message.GetIsDirect() ? FLAG_IS_DIRECT : 0;
+
+        unsigned char idBytes[trBase::UniqueId::BYTE_SIZE];
+        mEncodeBuffer.Clear();
+        mEncodeBuffer.Write(entry.typeHash);
+        mEncodeBuffer.Write(flags);
+        if (fromId != nullptr)
+        {
+            fromId->ToBytes(idBytes);
+            mEncodeBuffer.Write(idBytes, sizeof(idBytes));
+        }
+        if (aboutId != nullptr)
+        {
+            aboutId->ToBytes(idBytes);
+            mEncodeBuffer.Write(idBytes, sizeof(idBytes));
+        }
+        mEncodeBuffer.Write(static_cast<unsigned short>(mPayload.GetSize()));
+        mEncodeBuffer.Write(mPayload.GetData(), mPayload.GetSize());
+
+        size_t maxPacketSize = batch->transport->GetMaxPacketSize();
+        if (PACKET_HEADER_SIZE + mEncodeBuffer.GetSize() > maxPacketSize)
+        {
+            LOG_W("The network message " + message.GetMessageType() + " does not fit into a single packet.")
+            return false;
+        }
+
+        //Send out the current batch if the message does not fit into it
+        if (batch->data.size() + mEncodeBuffer.GetSize() > maxPacketSize ||
+            batch->messageCount == std::numeric_limits<unsigned short>::max())
+        {
+            FlushBatch(*batch);
+        }
+
+        if (batch->data.empty())
+        {
+            batch->data.resize(PACKET_HEADER_SIZE);
+            std::memcpy(batch->data.data(), &PROTOCOL_ID, sizeof(PROTOCOL_ID));
+        }
+        batch->data.insert(batch->data.end(), mEncodeBuffer.GetData(), mEncodeBuffer.GetData() + mEncodeBuffer.GetSize());
+        ++batch->messageCount;
+        ++mSentMessageCount;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::Flush()
+    {
+        FlushBatch(mUnreliableBatch);
+        FlushBatch(mReliableBatch);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::ProcessIncoming()
+    {
+        std::vector<char> packet;
+        while (mInboundQueue->TryPop(packet))
+        {
+            DecodePacket(packet);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::SetInboundQueueSize(size_t size)
+    {
+        if (IsRunning())
+        {
+            LOG_W("The inbound queue size can not be changed while the network director is running.")
+            return;
+        }
+        mInboundQueue.reset(new trUtil::RingBuffer<std::vector<char>>(size));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long NetworkDirector::GetSentMessageCount() const
+    {
+        return mSentMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long NetworkDirector::GetSentPacketCount() const
+    {
+        return mSentPacketCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long NetworkDirector::GetReceivedMessageCount() const
+    {
+        return mReceivedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long NetworkDirector::GetReceivedPacketCount() const
+    {
+        return mReceivedPacketCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long NetworkDirector::GetDroppedPacketCount() const
+    {
+        return mDroppedPacketCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long NetworkDirector::GetUnknownMessageCount() const
+    {
+        return mUnknownMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int NetworkDirector::HashMessageType(const std::string& type)
+    {
+        //32 bit FNV-1a, so the IDs match across compilers and platforms
+        unsigned int hash = 2166136261u;
+        for (unsigned char c : type)
+        {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::FlushBatch(Batch& batch)
+    {
+        if (batch.messageCount == 0)
+        {
+            return;
+        }
+
+        std::memcpy(batch.data.data() + sizeof(PROTOCOL_ID), &batch.messageCount, sizeof(batch.messageCount));
+        if (batch.transport.Valid() && batch.transport->Send(batch.data.data(), batch.data.size()))
+        {
+            ++mSentPacketCount;
+        }
+
+        batch.data.clear();
+        batch.messageCount = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::DecodePacket(const std::vector<char>& packet)
+    {
+        trManager::JournalData data(packet.data(), packet.size());
+
+        unsigned int protocolId = 0;
+        unsigned short messageCount = 0;
+        if (!data.Read(protocolId) || protocolId != PROTOCOL_ID || !data.Read(messageCount))
+        {
+            ++mDroppedPacketCount;
+            return;
+        }
+
+        //Messages without a sender are sent from the director, so the other directors can handle them
+        const trBase::UniqueId* localId = &GetUUID();
+
+        MessageInfo info;
+        info.timeStruct = &mSysMan->GetTimingStructure();
+        info.messageFilter = &trUtil::StringUtils::STR_BLANK;
+
+        unsigned char idBytes[trBase::UniqueId::BYTE_SIZE];
+        for (unsigned short i = 0; i < messageCount; ++i)
+        {
+            unsigned int typeHash = 0;
+            unsigned char flags = 0;
+            unsigned short size = 0;
+            if (!data.Read(typeHash) || !data.Read(flags))
+            {
+                ++mDroppedPacketCount;
+                return;
+            }
+
+            info.fromActorID = localId;
+            if ((flags & FLAG_HAS_FROM) != 0)
+            {
+                if (!data.Read(idBytes, sizeof(idBytes)))
+                {
+                    ++mDroppedPacketCount;
+                    return;
+                }
+                info.fromActorID = GetRemoteId(idBytes);
+            }
+
+            info.aboutActorID = nullptr;
+            if ((flags & FLAG_HAS_ABOUT) != 0)
+            {
+                if (!data.Read(idBytes, sizeof(idBytes)))
+                {
+                    ++mDroppedPacketCount;
+                    return;
+                }
+                info.aboutActorID = GetRemoteId(idBytes);
+            }
+
+            if (!data.Read(size) || data.GetRemaining() < size)
+            {
+                ++mDroppedPacketCount;
+                return;
+            }
+
+            trManager::JournalData payload(data.GetData() + data.GetReadPosition(), size);
+            data.SetReadPosition(data.GetReadPosition() + size);
+
+            trUtil::HashMap<unsigned int, const MessageTypeEntry*>::const_iterator it = mTypeHashMap.find(typeHash);
+            if (it == mTypeHashMap.end())
+            {
+                ++mUnknownMessageCount;
+                continue;
+            }
+
+            info.isDirect = (flags & FLAG_IS_DIRECT) != 0;
+            info.data = &payload;
+
+            trBase::SmrtPtr<trManager::MessageBase> message = it->second->creator(info);
+            if (!message.Valid())
+            {
+                ++mUnknownMessageCount;
+                continue;
+            }
+
+            mSysMan->SendMessage(*message);
+            ++mReceivedMessageCount;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trBase::UniqueId* NetworkDirector::GetRemoteId(const unsigned char* bytes)
+    {
+        trBase::UniqueId id(false);
+        id.FromBytes(bytes);
+
+        trBase::SmrtPtr<trBase::UniqueId>& storedId = mRemoteIds[id];
+        if (!storedId.Valid())
+        {
+            storedId = new trBase::UniqueId(id);
+        }
+        return storedId.Get();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void NetworkDirector::IOThreadLoop()
+    {
+        std::vector<char> packet;
+        while (mIsRunning)
+        {
+            for (trManager::NetTransport* transport : { mUnreliableBatch.transport.Get(), mReliableBatch.transport.Get() })
+            {
+                //Drain everything that is waiting before moving to the next transport
+                while (transport != nullptr && mIsRunning && transport->Receive(packet, IO_WAIT_MS))
+                {
+                    ++mReceivedPacketCount;
+                    if (!mInboundQueue->TryPush(std::move(packet)))
+                    {
+                        ++mDroppedPacketCount;
+                    }
+                    packet.clear();
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,609 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/ReplicatedFields.h>
+
+#include <trUtil/Logging/Log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace trManager
+{
+    const double ReplicatedFields::DEFAULT_INTERPOLATION_DELAY = 0.1;
+    const unsigned int ReplicatedFields::MAX_BUFFERED_SNAPSHOTS = 32;
+
+    //Range of the three smallest components of a normalized quaternion
+    static const double QUAT_COMPONENT_RANGE = 0.70710678118654752440;
+
+    //Max number of bits per component of a quantized quaternion, so it fits into 64 bits
+    static const unsigned char MAX_QUAT_BITS = 20;
+
+    //////////////////////////////////////////////////////////////////////////
+    static size_t GetQuantizedSize(unsigned char bits)
+    {
+        return (bits + 7) / 8;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void WriteUnsigned(char* data, std::uint64_t value, size_t size)
+    {
+        //Written byte by byte, so quantized values do not depend on the byte order
+        for (size_t i = 0; i < size; ++i)
+        {
+            data[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static std::uint64_t ReadUnsigned(const char* data, size_t size)
+    {
+        std::uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (i * 8);
+        }
+        return value;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static std::uint64_t Quantize(double value, double minValue, double maxValue, unsigned char bits)
+    {
+        const double maxStep = static_cast<double>((std::uint64_t(1) << bits) - 1);
+        double normalized = (value - minValue) / (maxValue - minValue);
+        normalized = std::min(std::max(normalized, 0.0), 1.0);
+        return static_cast<std::uint64_t>(std::floor(normalized * maxStep + 0.5));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static double Dequantize(std::uint64_t value, double minValue, double maxValue, unsigned char bits)
+    {
+        const double maxStep = static_cast<double>((std::uint64_t(1) << bits) - 1);
+        return minValue + (maxValue - minValue) * (static_cast<double>(value) / maxStep);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ReplicatedFields::ReplicatedFields()
+        : mInterpolationDelay(DEFAULT_INTERPOLATION_DELAY)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ReplicatedFields::~ReplicatedFields()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, bool& value)
+    {
+        AddField(name, BOOL_FIELD, &value, Quantization(), 1);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, int& value)
+    {
+        AddField(name, INT_FIELD, &value, Quantization(), sizeof(std::int32_t));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, float& value, const Quantization& quantization)
+    {
+        size_t size = quantization.bits > 0 ? GetQuantizedSize(quantization.bits) : sizeof(float);
+        AddField(name, FLOAT_FIELD, &value, quantization, size);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, double& value, const Quantization& quantization)
+    {
+        size_t size = quantization.bits > 0 ? GetQuantizedSize(quantization.bits) : sizeof(double);
+        AddField(name, DOUBLE_FIELD, &value, quantization, size);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, trBase::Vec3& value, const Quantization& quantization)
+    {
+        size_t size = 3 * (quantization.bits > 0 ? GetQuantizedSize(quantization.bits) : sizeof(trBase::Vec3::value_type));
+        AddField(name, VEC3_FIELD, &value, quantization, size);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, trBase::Quat& value, unsigned char bits)
+    {
+        if (bits == 1 || bits > MAX_QUAT_BITS)
+        {
+            LOG_W("Invalid quantization for the rotation field " + name + ", using the full precision.")
+            bits = 0;
+        }
+
+        //The index of the dropped component takes two bits
+        Quantization quantization(-QUAT_COMPONENT_RANGE, QUAT_COMPONENT_RANGE, bits);
+        size_t size = bits > 0 ? GetQuantizedSize(2 + 3 * bits) : 4 * sizeof(trBase::Quat::value_type);
+        AddField(name, QUAT_FIELD, &value, quantization, size);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t ReplicatedFields::GetFieldCount() const
+    {
+        return mFields.size();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t ReplicatedFields::GetSnapshotSize() const
+    {
+        return mSnapshotSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::WriteSnapshot(std::vector<char>& snapshot) const
+    {
+        snapshot.resize(mSnapshotSize);
+        for (const Field& field : mFields)
+        {
+            EncodeField(field, snapshot.data() + field.offset);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ReplicatedFields::ReadSnapshot(const std::vector<char>& snapshot)
+    {
+        if (snapshot.size() != mSnapshotSize)
+        {
+            return false;
+        }
+
+        double values[4];
+        for (const Field& field : mFields)
+        {
+            DecodeField(field, snapshot.data() + field.offset, values);
+            SetField(field, values);
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ReplicatedFields::WriteDelta(const std::vector<char>& baseline, const std::vector<char>& snapshot, trManager::JournalData& data) const
+    {
+        bool hasBaseline = baseline.size() == mSnapshotSize;
+
+        //One bit per field marks the fields that follow
+        std::vector<unsigned char> changeMask((mFields.size() + 7) / 8, 0);
+        bool hasChanges = false;
+        for (size_t i = 0; i < mFields.size(); ++i)
+        {
+            const Field& field = mFields[i];
+            if (!hasBaseline || std::memcmp(baseline.data() + field.offset, snapshot.data() + field.offset, field.size) != 0)
+            {
+                changeMask[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+                hasChanges = true;
+            }
+        }
+
+        if (!hasChanges)
+        {
+            return false;
+        }
+
+        data.Write(changeMask.data(), changeMask.size());
+        for (size_t i = 0; i < mFields.size(); ++i)
+        {
+            if ((changeMask[i / 8] & (1 << (i % 8))) != 0)
+            {
+                data.Write(snapshot.data() + mFields[i].offset, mFields[i].size);
+            }
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ReplicatedFields::ReadDelta(const std::vector<char>& baseline, trManager::JournalData& data, std::vector<char>& snapshot) const
+    {
+        bool hasBaseline = baseline.size() == mSnapshotSize;
+        if (hasBaseline)
+        {
+            snapshot = baseline;
+        }
+        else
+        {
+            snapshot.assign(mSnapshotSize, 0);
+        }
+
+        std::vector<unsigned char> changeMask((mFields.size() + 7) / 8, 0);
+        if (!data.Read(changeMask.data(), changeMask.size()))
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < mFields.size(); ++i)
+        {
+            if ((changeMask[i / 8] & (1 << (i % 8))) != 0)
+            {
+                if (!data.Read(snapshot.data() + mFields[i].offset, mFields[i].size))
+                {
+                    return false;
+                }
+            }
+            else if (!hasBaseline)
+            {
+                //Without a baseline every field has to be in the delta
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddRemoteSnapshot(double time, const std::vector<char>& snapshot)
+    {
+        if (snapshot.size() != mSnapshotSize || (!mRemoteSnapshots.empty() && time <= mRemoteSnapshots.back().time))
+        {
+            return;
+        }
+
+        mRemoteSnapshots.push_back(RemoteSnapshot{ time, snapshot });
+        while (mRemoteSnapshots.size() > MAX_BUFFERED_SNAPSHOTS)
+        {
+            mRemoteSnapshots.pop_front();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::Interpolate(double deltaTime)
+    {
+        if (mRemoteSnapshots.empty())
+        {
+            return;
+        }
+
+        //Play back a fixed delay behind the newest snapshot. Small differences between the local
+        //and server clocks are corrected slowly to keep the motion smooth, large ones right away.
+        double targetTime = mRemoteSnapshots.back().time - mInterpolationDelay;
+        if (!mIsPlaybackStarted)
+        {
+            mPlaybackTime = targetTime;
+            mIsPlaybackStarted = true;
+        }
+        else
+        {
+            mPlaybackTime += deltaTime;
+            double error = targetTime - mPlaybackTime;
+            if (std::abs(error) > mInterpolationDelay)
+            {
+                mPlaybackTime = targetTime;
+            }
+            else
+            {
+                mPlaybackTime += error * 0.05;
+            }
+        }
+
+        //Find the snapshots around the playback time, and hold the oldest or newest one outside of them
+        size_t next = 0;
+        while (next < mRemoteSnapshots.size() && mRemoteSnapshots[next].time < mPlaybackTime)
+        {
+            ++next;
+        }
+        const RemoteSnapshot& from = mRemoteSnapshots[next > 0 ? next - 1 : 0];
+        const RemoteSnapshot& to = mRemoteSnapshots[std::min(next, mRemoteSnapshots.size() - 1)];
+
+        double t = 0.0;
+        if (to.time > from.time)
+        {
+            t = std::min(std::max((mPlaybackTime - from.time) / (to.time - from.time), 0.0), 1.0);
+        }
+
+        double fromValues[4];
+        double toValues[4];
+        for (const Field& field : mFields)
+        {
+            DecodeField(field, from.data.data() + field.offset, fromValues);
+            DecodeField(field, to.data.data() + field.offset, toValues);
+
+            switch (field.type)
+            {
+            case FLOAT_FIELD:
+            case DOUBLE_FIELD:
+            case VEC3_FIELD:
+                for (int i = 0; i < (field.type == VEC3_FIELD ? 3 : 1); ++i)
+                {
+                    fromValues[i] += (toValues[i] - fromValues[i]) * t;
+                }
+                break;
+            case QUAT_FIELD:
+            {
+                trBase::Quat rotation;
+                rotation.Slerp(t, trBase::Quat(fromValues[0], fromValues[1], fromValues[2], fromValues[3]),
+                                  trBase::Quat(toValues[0], toValues[1], toValues[2], toValues[3]));
+                fromValues[0] = rotation.X();
+                fromValues[1] = rotation.Y();
+                fromValues[2] = rotation.Z();
+                fromValues[3] = rotation.W();
+                break;
+            }
+            default:
+                //Discrete values change when the playback reaches the next snapshot
+                if (t >= 1.0)
+                {
+                    std::copy(toValues, toValues + 4, fromValues);
+                }
+                break;
+            }
+
+            SetField(field, fromValues);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::SetInterpolationDelay(double delay)
+    {
+        mInterpolationDelay = delay;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double ReplicatedFields::GetInterpolationDelay() const
+    {
+        return mInterpolationDelay;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double ReplicatedFields::GetPlaybackTime() const
+    {
+        return mPlaybackTime;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::AddField(const std::string& name, FieldType type, void* value, const Quantization& quantization, size_t size)
+    {
+        Quantization fieldQuantization = quantization;
+        if (fieldQuantization.bits > 32 || (fieldQuantization.bits > 0 && fieldQuantization.maxValue <= fieldQuantization.minValue))
+        {
+            LOG_W("Invalid quantization for the field " + name + ", using the full precision.")
+            fieldQuantization = Quantization();
+            switch (type)
+            {
+            case FLOAT_FIELD:   size = sizeof(float); break;
+            case DOUBLE_FIELD:  size = sizeof(double); break;
+            case VEC3_FIELD:    size = 3 * sizeof(trBase::Vec3::value_type); break;
+            default:            break;
+            }
+        }
+
+        mFields.push_back(Field{ name, type, value, fieldQuantization, mSnapshotSize, size });
+        mSnapshotSize += size;
+
+        //Buffered snapshots no longer match the layout
+        mRemoteSnapshots.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::EncodeField(const Field& field, char* data) const
+    {
+        const Quantization& q = field.quantization;
+        switch (field.type)
+        {
+        case BOOL_FIELD:
+            data[0] = *static_cast<const bool*>(field.value) ? 1 : 0;
+            break;
+        case INT_FIELD:
+        {
+            std::int32_t value = *static_cast<const int*>(field.value);
+            std::memcpy(data, &value, sizeof(value));
+            break;
+        }
+        case FLOAT_FIELD:
+        {
+            const float& value = *static_cast<const float*>(field.value);
+            if (q.bits > 0)
+            {
+                WriteUnsigned(data, Quantize(value, q.minValue, q.maxValue, q.bits), field.size);
+            }
+            else
+            {
+                std::memcpy(data, &value, sizeof(value));
+            }
+            break;
+        }
+        case DOUBLE_FIELD:
+        {
+            const double& value = *static_cast<const double*>(field.value);
+            if (q.bits > 0)
+            {
+                WriteUnsigned(data, Quantize(value, q.minValue, q.maxValue, q.bits), field.size);
+            }
+            else
+            {
+                std::memcpy(data, &value, sizeof(value));
+            }
+            break;
+        }
+        case VEC3_FIELD:
+        {
+            const trBase::Vec3& value = *static_cast<const trBase::Vec3*>(field.value);
+            size_t componentSize = field.size / 3;
+            for (int i = 0; i < 3; ++i)
+            {
+                trBase::Vec3::value_type component = value[i];
+                if (q.bits > 0)
+                {
+                    WriteUnsigned(data + i * componentSize, Quantize(component, q.minValue, q.maxValue, q.bits), componentSize);
+                }
+                else
+                {
+                    std::memcpy(data + i * componentSize, &component, componentSize);
+                }
+            }
+            break;
+        }
+        case QUAT_FIELD:
+        {
+            const trBase::Quat& value = *static_cast<const trBase::Quat*>(field.value);
+            double components[4] = { value.X(), value.Y(), value.Z(), value.W() };
+            if (q.bits == 0)
+            {
+                std::memcpy(data, components, sizeof(components));
+                break;
+            }
+
+            //Drop the largest component, it is rebuilt from the other three
+            double length = std::sqrt(components[0] * components[0] + components[1] * components[1] +
+                                      components[2] * components[2] + components[3] * components[3]);
+            int largest = 0;
+            for (int i = 1; i < 4; ++i)
+            {
+                if (std::abs(components[i]) > std::abs(components[largest]))
+                {
+                    largest = i;
+                }
+            }
+            double sign = components[largest] < 0.0 ? -1.0 : 1.0;
+            double scale = length > 0.0 ? sign / length : 0.0;
+
+            std::uint64_t packed = static_cast<std::uint64_t>(largest);
+            unsigned int shift = 2;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (i != largest)
+                {
+                    packed |= Quantize(components[i] * scale, q.minValue, q.maxValue, q.bits) << shift;
+                    shift += q.bits;
+                }
+            }
+            WriteUnsigned(data, packed, field.size);
+            break;
+        }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::DecodeField(const Field& field, const char* data, double* values) const
+    {
+        const Quantization& q = field.quantization;
+        switch (field.type)
+        {
+        case BOOL_FIELD:
+            values[0] = data[0] != 0 ? 1.0 : 0.0;
+            break;
+        case INT_FIELD:
+        {
+            std::int32_t value = 0;
+            std::memcpy(&value, data, sizeof(value));
+            values[0] = value;
+            break;
+        }
+        case FLOAT_FIELD:
+        {
+            float value = 0.0f;
+            if (q.bits > 0)
+            {
+                values[0] = Dequantize(ReadUnsigned(data, field.size), q.minValue, q.maxValue, q.bits);
+            }
+            else
+            {
+                std::memcpy(&value, data, sizeof(value));
+                values[0] = value;
+            }
+            break;
+        }
+        case DOUBLE_FIELD:
+            if (q.bits > 0)
+            {
+                values[0] = Dequantize(ReadUnsigned(data, field.size), q.minValue, q.maxValue, q.bits);
+            }
+            else
+            {
+                std::memcpy(&values[0], data, sizeof(double));
+            }
+            break;
+        case VEC3_FIELD:
+        {
+            size_t componentSize = field.size / 3;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (q.bits > 0)
+                {
+                    values[i] = Dequantize(ReadUnsigned(data + i * componentSize, componentSize), q.minValue, q.maxValue, q.bits);
+                }
+                else
+                {
+                    trBase::Vec3::value_type component = 0;
+                    std::memcpy(&component, data + i * componentSize, componentSize);
+                    values[i] = component;
+                }
+            }
+            break;
+        }
+        case QUAT_FIELD:
+        {
+            if (q.bits == 0)
+            {
+                std::memcpy(values, data, 4 * sizeof(double));
+                break;
+            }
+
+            std::uint64_t packed = ReadUnsigned(data, field.size);
+            const std::uint64_t mask = (std::uint64_t(1) << q.bits) - 1;
+            int largest = static_cast<int>(packed & 3);
+            unsigned int shift = 2;
+            double sum = 0.0;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (i != largest)
+                {
+                    values[i] = Dequantize((packed >> shift) & mask, q.minValue, q.maxValue, q.bits);
+                    sum += values[i] * values[i];
+                    shift += q.bits;
+                }
+            }
+            values[largest] = std::sqrt(std::max(0.0, 1.0 - sum));
+            break;
+        }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicatedFields::SetField(const Field& field, const double* values)
+    {
+        switch (field.type)
+        {
+        case BOOL_FIELD:
+            *static_cast<bool*>(field.value) = values[0] != 0.0;
+            break;
+        case INT_FIELD:
+            *static_cast<int*>(field.value) = static_cast<int>(values[0]);
+            break;
+        case FLOAT_FIELD:
+            *static_cast<float*>(field.value) = static_cast<float>(values[0]);
+            break;
+        case DOUBLE_FIELD:
+            *static_cast<double*>(field.value) = values[0];
+            break;
+        case VEC3_FIELD:
+            static_cast<trBase::Vec3*>(field.value)->Set(static_cast<trBase::Vec3::value_type>(values[0]),
+                                                         static_cast<trBase::Vec3::value_type>(values[1]),
+                                                         static_cast<trBase::Vec3::value_type>(values[2]));
+            break;
+        case QUAT_FIELD:
+            static_cast<trBase::Quat*>(field.value)->Set(values[0], values[1], values[2], values[3]);
+            break;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,500 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/ReplicationDirector.h>
+
+#include <trManager/MessageTick.h>
+#include <trManager/SystemManager.h>
+#include <trUtil/Logging/Log.h>
+
+#include <cmath>
+#include <limits>
+
+namespace trManager
+{
+    const trUtil::RefStr ReplicationDirector::CLASS_TYPE("trManager::ReplicationDirector");
+
+    const unsigned int ReplicationDirector::PROTOCOL_ID = 0x50525254;
+    const unsigned int ReplicationDirector::SNAPSHOT_HISTORY_SIZE = 32;
+
+    //Packet types
+    static const unsigned char SNAPSHOT_PACKET = 1;
+    static const unsigned char ACK_PACKET = 2;
+
+    //Entity record flags
+    static const unsigned char RECORD_REMOVED = 1;
+
+    //Acknowledgement states
+    static const unsigned char ACK_APPLIED = 0;
+    static const unsigned char ACK_NEEDS_FULL_SNAPSHOT = 1;
+    static const unsigned char ACK_NOT_A_BASELINE = 2;             //Applied, but the client keeps its last acknowledged baseline
+
+    //Packet header: protocol ID, packet type, sequence, baseline sequence, sim time, record count
+    static const size_t SNAPSHOT_HEADER_SIZE = 3 * sizeof(unsigned int) + sizeof(unsigned char) + sizeof(double) + sizeof(unsigned short);
+
+    //Entity record header: ID, flags, delta size
+    static const size_t RECORD_HEADER_SIZE = trBase::UniqueId::BYTE_SIZE + sizeof(unsigned char) + sizeof(unsigned short);
+
+    //////////////////////////////////////////////////////////////////////////
+    ReplicationDirector::ReplicationDirector(const std::string& name) : BaseClass(name)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ReplicationDirector::~ReplicationDirector()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::OnAddedToSysMan()
+    {
+        BaseClass::OnAddedToSysMan();
+
+        RegisterForMessage(trManager::MessageTick::MESSAGE_TYPE, ON_TICK_INVOKABLE);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::OnTick(const trManager::MessageBase& msg)
+    {
+        const trManager::MessageTick& tick = static_cast<const trManager::MessageTick&>(msg);
+
+        if (mServerTransport.Valid())
+        {
+            ReceiveSnapshots();
+        }
+
+        if (!mClients.empty())
+        {
+            mTimeSinceSnapshot += tick.GetDeltaSimTime();
+            if (mSnapshotRate <= 0.0 || mTimeSinceSnapshot >= 1.0 / mSnapshotRate)
+            {
+                mTimeSinceSnapshot = mSnapshotRate > 0.0 ? std::fmod(mTimeSinceSnapshot, 1.0 / mSnapshotRate) : 0.0;
+                SendSnapshots(tick.GetSimTime());
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ReplicationDirector::AddReplicatedActor(trManager::ActorBase& actor)
+    {
+        if (actor.GetReplicatedFields() == nullptr)
+        {
+            LOG_W("The actor " + actor.GetName() + " has no replicated fields.")
+            return false;
+        }
+
+        mReplicatedActors[actor.GetUUID()] = &actor;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::RemoveReplicatedActor(const trBase::UniqueId& id)
+    {
+        mReplicatedActors.erase(id);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int ReplicationDirector::AddClient(trManager::NetTransport& transport)
+    {
+        unsigned int clientIndex = mNextClientIndex++;
+        mClients[clientIndex].transport = &transport;
+        return clientIndex;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::RemoveClient(unsigned int clientIndex)
+    {
+        mClients.erase(clientIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::SetServerTransport(trManager::NetTransport* transport)
+    {
+        mServerTransport = transport;
+        mReceivedSnapshots.clear();
+        mLatestSequence = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::SetSnapshotRate(double rate)
+    {
+        mSnapshotRate = rate;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double ReplicationDirector::GetSnapshotRate() const
+    {
+        return mSnapshotRate;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long ReplicationDirector::GetSentSnapshotCount() const
+    {
+        return mSentSnapshotCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long ReplicationDirector::GetSentBytes() const
+    {
+        return mSentBytes;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long ReplicationDirector::GetFullSnapshotBytes() const
+    {
+        return mFullSnapshotBytes;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long ReplicationDirector::GetReceivedSnapshotCount() const
+    {
+        return mReceivedSnapshotCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long ReplicationDirector::GetDroppedSnapshotCount() const
+    {
+        return mDroppedSnapshotCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::SendSnapshots(double simTime)
+    {
+        //Encode every actor once, and share the result between the clients
+        std::shared_ptr<EntitySnapshots> current = std::make_shared<EntitySnapshots>();
+        size_t fullSize = SNAPSHOT_HEADER_SIZE;
+        for (auto it = mReplicatedActors.begin(); it != mReplicatedActors.end();)
+        {
+            if (!it->second.valid())
+            {
+                it = mReplicatedActors.erase(it);
+                continue;
+            }
+
+            trManager::ReplicatedFields* fields = it->second->GetReplicatedFields();
+            fields->WriteSnapshot((*current)[it->first]);
+            fullSize += RECORD_HEADER_SIZE + fields->GetSnapshotSize();
+            ++it;
+        }
+
+        ++mSequence;
+        for (auto& client : mClients)
+        {
+            ReceiveAcks(client.second);
+            SendSnapshot(client.second, current, simTime);
+            mFullSnapshotBytes += fullSize;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::SendSnapshot(Client& client, const std::shared_ptr<const EntitySnapshots>& current, double simTime)
+    {
+        //Use the last snapshot the client acknowledged as the baseline, or send everything
+        static const EntitySnapshots EMPTY_SNAPSHOTS;
+        static const std::vector<char> EMPTY_DATA;
+        const EntitySnapshots* baseline = &EMPTY_SNAPSHOTS;
+        unsigned int baselineSequence = 0;
+        for (const SentSnapshotEntry& entry : client.history)
+        {
+            if (entry.sequence == client.ackedSequence)
+            {
+                baseline = entry.entities.get();
+                baselineSequence = entry.sequence;
+                break;
+            }
+        }
+
+        mRecords.Clear();
+
+        size_t maxPacketSize = client.transport->GetMaxPacketSize();
+        unsigned short recordCount = 0;
+        unsigned char idBytes[trBase::UniqueId::BYTE_SIZE];
+        trManager::JournalData delta;
+
+        //Entities from the first one that does not fit on stay at their baseline
+        EntitySnapshots::const_iterator sentEnd = current->begin();
+        for (; sentEnd != current->end(); ++sentEnd)
+        {
+            const auto& entity = *sentEnd;
+            EntitySnapshots::const_iterator baseIt = baseline->find(entity.first);
+            const std::vector<char>& baseData = baseIt != baseline->end() ? baseIt->second : EMPTY_DATA;
+
+            delta.Clear();
+            trManager::ReplicatedFields* fields = mReplicatedActors[entity.first]->GetReplicatedFields();
+            if (!fields->WriteDelta(baseData, entity.second, delta))
+            {
+                continue;
+            }
+
+            if (SNAPSHOT_HEADER_SIZE + mRecords.GetSize() + RECORD_HEADER_SIZE + delta.GetSize() > maxPacketSize ||
+                recordCount == std::numeric_limits<unsigned short>::max())
+            {
+                break;
+            }
+
+            entity.first.ToBytes(idBytes);
+            mRecords.Write(idBytes, sizeof(idBytes));
+            mRecords.Write(static_cast<unsigned char>(0));
+            mRecords.Write(static_cast<unsigned short>(delta.GetSize()));
+            mRecords.Write(delta.GetData(), delta.GetSize());
+            ++recordCount;
+        }
+
+        //Remove the entities the client has, but that are no longer replicated. From the first removal
+        //that does not fit on, the client keeps the entities.
+        EntitySnapshots::const_iterator removedEnd = baseline->begin();
+        for (; removedEnd != baseline->end(); ++removedEnd)
+        {
+            const auto& entity = *removedEnd;
+            if (current->find(entity.first) == current->end())
+            {
+                if (SNAPSHOT_HEADER_SIZE + mRecords.GetSize() + RECORD_HEADER_SIZE > maxPacketSize ||
+                    recordCount == std::numeric_limits<unsigned short>::max())
+                {
+                    break;
+                }
+
+                entity.first.ToBytes(idBytes);
+                mRecords.Write(idBytes, sizeof(idBytes));
+                mRecords.Write(RECORD_REMOVED);
+                mRecords.Write(static_cast<unsigned short>(0));
+                ++recordCount;
+            }
+        }
+
+        mPacket.Clear();
+        mPacket.Write(PROTOCOL_ID);
+        mPacket.Write(SNAPSHOT_PACKET);
+        mPacket.Write(mSequence);
+        mPacket.Write(baselineSequence);
+        mPacket.Write(simTime);
+        mPacket.Write(recordCount);
+        mPacket.Write(mRecords.GetData(), mRecords.GetSize());
+
+        if (client.transport->Send(mPacket.GetData(), mPacket.GetSize()))
+        {
+            mSentBytes += mPacket.GetSize();
+            ++mSentSnapshotCount;
+        }
+
+        //A client that got every record has the current snapshot, unchanged entities already match it.
+        //Only a packet that ran out of room needs a snapshot of its own.
+        if (sentEnd == current->end() && removedEnd == baseline->end())
+        {
+            client.history.push_back(SentSnapshotEntry{ mSequence, current });
+        }
+        else
+        {
+            std::shared_ptr<EntitySnapshots> clientSnapshots = std::make_shared<EntitySnapshots>(current->begin(), sentEnd);
+            bool isPastRemovedEnd = false;
+            for (EntitySnapshots::const_iterator it = baseline->begin(); it != baseline->end(); ++it)
+            {
+                isPastRemovedEnd = isPastRemovedEnd || it == removedEnd;
+                bool isReplicated = current->find(it->first) != current->end();
+                if ((isReplicated && sentEnd != current->end() && !(it->first < sentEnd->first)) || (!isReplicated && isPastRemovedEnd))
+                {
+                    clientSnapshots->insert(*it);
+                }
+            }
+            client.history.push_back(SentSnapshotEntry{ mSequence, clientSnapshots });
+        }
+        while (client.history.size() > SNAPSHOT_HISTORY_SIZE)
+        {
+            client.history.pop_front();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::ReceiveAcks(Client& client)
+    {
+        while (client.transport->Receive(mReceiveBuffer, 0))
+        {
+            trManager::JournalData data(mReceiveBuffer.data(), mReceiveBuffer.size());
+            unsigned int protocolId = 0;
+            unsigned char packetType = 0;
+            unsigned int sequence = 0;
+            unsigned char ackState = ACK_APPLIED;
+            if (!data.Read(protocolId) || protocolId != PROTOCOL_ID || !data.Read(packetType) || packetType != ACK_PACKET ||
+                !data.Read(sequence) || !data.Read(ackState))
+            {
+                continue;
+            }
+
+            //ACK_NOT_A_BASELINE leaves the acknowledged baseline as it is, so the next snapshots resync from it
+            if (ackState == ACK_NEEDS_FULL_SNAPSHOT)
+            {
+                //The client lost track of its baselines, start over
+                client.ackedSequence = 0;
+                client.history.clear();
+            }
+            else if (ackState == ACK_APPLIED && sequence > client.ackedSequence)
+            {
+                //Older snapshots will not be used as baselines anymore
+                while (!client.history.empty() && client.history.front().sequence < sequence)
+                {
+                    client.history.pop_front();
+                }
+                if (!client.history.empty() && client.history.front().sequence == sequence)
+                {
+                    client.ackedSequence = sequence;
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ReplicationDirector::ReceiveSnapshots()
+    {
+        while (mServerTransport.Valid() && mServerTransport->Receive(mReceiveBuffer, 0))
+        {
+            if (!ApplySnapshot(mReceiveBuffer))
+            {
+                ++mDroppedSnapshotCount;
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ReplicationDirector::ApplySnapshot(const std::vector<char>& packet)
+    {
+        trManager::JournalData data(packet.data(), packet.size());
+        unsigned int protocolId = 0;
+        unsigned char packetType = 0;
+        unsigned int sequence = 0;
+        unsigned int baselineSequence = 0;
+        double simTime = 0.0;
+        unsigned short recordCount = 0;
+        if (!data.Read(protocolId) || protocolId != PROTOCOL_ID || !data.Read(packetType) || packetType != SNAPSHOT_PACKET ||
+            !data.Read(sequence) || !data.Read(baselineSequence) || !data.Read(simTime) || !data.Read(recordCount))
+        {
+            return false;
+        }
+
+        //Late snapshots are covered by the newer ones
+        if (sequence <= mLatestSequence)
+        {
+            return false;
+        }
+
+        bool needsFullSnapshot = false;
+        bool isBaseline = true;
+        SnapshotEntry entry{ sequence, EntitySnapshots() };
+        if (baselineSequence != 0)
+        {
+            std::deque<SnapshotEntry>::const_iterator it = mReceivedSnapshots.begin();
+            while (it != mReceivedSnapshots.end() && it->sequence != baselineSequence)
+            {
+                ++it;
+            }
+
+            if (it == mReceivedSnapshots.end())
+            {
+                needsFullSnapshot = true;
+            }
+            else
+            {
+                entry.entities = it->entities;
+            }
+        }
+
+        unsigned char idBytes[trBase::UniqueId::BYTE_SIZE];
+        trBase::UniqueId id(false);
+        for (unsigned short i = 0; i < recordCount && !needsFullSnapshot; ++i)
+        {
+            unsigned char flags = 0;
+            unsigned short size = 0;
+            if (!data.Read(idBytes, sizeof(idBytes)) || !data.Read(flags) || !data.Read(size) || data.GetRemaining() < size)
+            {
+                return false;
+            }
+            id.FromBytes(idBytes);
+
+            trManager::JournalData delta(data.GetData() + data.GetReadPosition(), size);
+            data.SetReadPosition(data.GetReadPosition() + size);
+
+            if ((flags & RECORD_REMOVED) != 0)
+            {
+                entry.entities.erase(id);
+                continue;
+            }
+
+            //Without a proxy the delta can't be read. The rest of the snapshot is still applied, but it
+            //can't be a baseline, so the server keeps sending against the last acknowledged one.
+            trManager::ReplicatedFields* fields = FindFields(id);
+            if (fields == nullptr)
+            {
+                isBaseline = false;
+                continue;
+            }
+
+            std::vector<char>& snapshot = entry.entities[id];
+            std::vector<char> baseData;
+            baseData.swap(snapshot);
+            if (!fields->ReadDelta(baseData, delta, snapshot))
+            {
+                needsFullSnapshot = true;
+            }
+        }
+
+        //Acknowledge the snapshot, so the server can use it as the next baseline
+        mPacket.Clear();
+        mPacket.Write(PROTOCOL_ID);
+        mPacket.Write(ACK_PACKET);
+        mPacket.Write(sequence);
+        mPacket.Write(needsFullSnapshot ? ACK_NEEDS_FULL_SNAPSHOT : (isBaseline ? ACK_APPLIED : ACK_NOT_A_BASELINE));
+        mServerTransport->Send(mPacket.GetData(), mPacket.GetSize());
+
+        if (needsFullSnapshot)
+        {
+            mReceivedSnapshots.clear();
+            return false;
+        }
+
+        for (const auto& entity : entry.entities)
+        {
+            trManager::ReplicatedFields* fields = FindFields(entity.first);
+            if (fields != nullptr)
+            {
+                fields->AddRemoteSnapshot(simTime, entity.second);
+            }
+        }
+
+        mLatestSequence = sequence;
+        if (isBaseline)
+        {
+            mReceivedSnapshots.push_back(std::move(entry));
+            while (mReceivedSnapshots.size() > SNAPSHOT_HISTORY_SIZE)
+            {
+                mReceivedSnapshots.pop_front();
+            }
+        }
+
+        ++mReceivedSnapshotCount;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    trManager::ReplicatedFields* ReplicationDirector::FindFields(const trBase::UniqueId& id)
+    {
+        trManager::ActorBase* actor = dynamic_cast<trManager::ActorBase*>(mSysMan->FindActor(id));
+        return actor != nullptr ? actor->GetReplicatedFields() : nullptr;
+    }
+}
\ No newline at end of file
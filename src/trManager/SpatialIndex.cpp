@@ -0,0 +1,282 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/SpatialIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace trManager
+{
+    const trUtil::RefStr SpatialIndex::CLASS_TYPE("trManager::SpatialIndex");
+
+    /**
+     * @class   IdCollector
+     *
+     * @brief   Collects the IDs found by a query into a vector.
+     */
+    class IdCollector : public SpatialIndex::Visitor
+    {
+    public:
+        IdCollector(std::vector<trBase::UniqueId>& results)
+            : mResults(results)
+        {
+        }
+
+        virtual void Visit(const trBase::UniqueId& id, const trBase::Vec3& position) override
+        {
+            mResults.push_back(id);
+        }
+
+    private:
+        std::vector<trBase::UniqueId>& mResults;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::Frustum::Set(const trBase::Matrix& viewProjection)
+    {
+        //Points are transformed as row vectors, so each clip plane is a sum of matrix columns
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                planes[axis * 2][row] = viewProjection(row, 3) + viewProjection(row, axis);
+                planes[axis * 2 + 1][row] = viewProjection(row, 3) - viewProjection(row, axis);
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool SpatialIndex::Frustum::Contains(const trBase::Vec3& point) const
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            if (planes[i][0] * point[0] + planes[i][1] * point[1] + planes[i][2] * point[2] + planes[i][3] < 0.0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool SpatialIndex::Frustum::Intersects(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax) const
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            //Test the corner of the box that is furthest along the plane normal
+            double x = planes[i][0] >= 0.0 ? boxMax[0] : boxMin[0];
+            double y = planes[i][1] >= 0.0 ? boxMax[1] : boxMin[1];
+            double z = planes[i][2] >= 0.0 ? boxMax[2] : boxMin[2];
+            if (planes[i][0] * x + planes[i][1] * y + planes[i][2] * z + planes[i][3] < 0.0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndex::SpatialIndex()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndex::~SpatialIndex()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::string& SpatialIndex::GetType() const
+    {
+        return CLASS_TYPE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::Update(const trBase::UniqueId& id, const trBase::Vec3& position)
+    {
+        mPendingUpdates.push_back(PendingUpdate{ id, position });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::ApplyUpdates()
+    {
+        for (const PendingUpdate& update : mPendingUpdates)
+        {
+            EntryMap::iterator it = mEntryMap.find(update.id);
+            if (it == mEntryMap.end())
+            {
+                size_t entryIndex = mEntries.size();
+                mEntries.push_back(Entry{ update.id, update.position, 0 });
+                mEntryMap[update.id] = entryIndex;
+                InsertEntry(entryIndex);
+            }
+            else
+            {
+                Entry& entry = mEntries[it->second];
+                trBase::Vec3 oldPosition = entry.position;
+                entry.position = update.position;
+                MoveEntry(it->second, oldPosition);
+            }
+        }
+        mPendingUpdates.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::CopyFrom(const SpatialIndex& source)
+    {
+        mPendingUpdates.reserve(mPendingUpdates.size() + source.mEntries.size());
+        for (const Entry& entry : source.mEntries)
+        {
+            mPendingUpdates.push_back(PendingUpdate{ entry.id, entry.position });
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t SpatialIndex::GetPendingUpdateCount() const
+    {
+        return mPendingUpdates.size();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool SpatialIndex::Remove(const trBase::UniqueId& id)
+    {
+        //Drop the queued updates, so the entity does not come back on the next ApplyUpdates
+        bool hadUpdates = false;
+        if (!mPendingUpdates.empty())
+        {
+            std::vector<PendingUpdate>::iterator end = std::remove_if(mPendingUpdates.begin(), mPendingUpdates.end(), [&id](const PendingUpdate& update) { return update.id == id; });
+            hadUpdates = end != mPendingUpdates.end();
+            mPendingUpdates.erase(end, mPendingUpdates.end());
+        }
+
+        EntryMap::iterator it = mEntryMap.find(id);
+        if (it == mEntryMap.end())
+        {
+            return hadUpdates;
+        }
+
+        size_t entryIndex = it->second;
+        RemoveEntry(entryIndex);
+        mEntryMap.erase(it);
+
+        //Move the last entry into the gap
+        size_t lastIndex = mEntries.size() - 1;
+        if (entryIndex != lastIndex)
+        {
+            mEntries[entryIndex] = mEntries[lastIndex];
+            mEntryMap[mEntries[entryIndex].id] = entryIndex;
+            RenumberEntry(lastIndex, entryIndex);
+        }
+        mEntries.pop_back();
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::Clear()
+    {
+        ClearEntries();
+        mEntries.clear();
+        mEntryMap.clear();
+        mPendingUpdates.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t SpatialIndex::GetSize() const
+    {
+        return mEntries.size();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool SpatialIndex::GetPosition(const trBase::UniqueId& id, trBase::Vec3& position) const
+    {
+        EntryMap::const_iterator it = mEntryMap.find(id);
+        if (it == mEntryMap.end())
+        {
+            return false;
+        }
+        position = mEntries[it->second].position;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::VisitAll(Visitor& visitor) const
+    {
+        for (const Entry& entry : mEntries)
+        {
+            visitor.Visit(entry.id, entry.position);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::QueryRadius(const trBase::Vec3& center, double radius, std::vector<trBase::UniqueId>& results) const
+    {
+        results.clear();
+        IdCollector collector(results);
+        VisitRadius(center, radius, collector);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::QueryBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, std::vector<trBase::UniqueId>& results) const
+    {
+        results.clear();
+        IdCollector collector(results);
+        VisitBox(boxMin, boxMax, collector);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::QueryFrustum(const Frustum& frustum, std::vector<trBase::UniqueId>& results) const
+    {
+        results.clear();
+        IdCollector collector(results);
+        VisitFrustum(frustum, collector);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndex::AddNeighbor(const Entry& entry, const trBase::Vec3& center, size_t count, double maxDistance2, std::vector<Neighbor>& heap)
+    {
+        double distance2 = (entry.position - center).Length2();
+        if (distance2 > maxDistance2)
+        {
+            return;
+        }
+
+        if (heap.size() < count)
+        {
+            heap.push_back(Neighbor{ entry.id, distance2 });
+            std::push_heap(heap.begin(), heap.end());
+        }
+        else if (distance2 < heap.front().distance2)
+        {
+            //Replace the furthest neighbor
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back().id = entry.id;
+            heap.back().distance2 = distance2;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double SpatialIndex::GetMaxDistance2(double maxDistance)
+    {
+        return maxDistance < std::sqrt(std::numeric_limits<double>::max()) ? maxDistance * maxDistance : std::numeric_limits<double>::max();
+    }
+}
\ No newline at end of file
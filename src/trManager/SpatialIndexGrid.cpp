@@ -0,0 +1,353 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/SpatialIndexGrid.h>
+
+#include <trUtil/Logging/Log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace trManager
+{
+    const trUtil::RefStr SpatialIndexGrid::CLASS_TYPE("trManager::SpatialIndexGrid");
+
+    const double SpatialIndexGrid::DEFAULT_CELL_SIZE = 100.0;
+
+    //Cell coordinates are packed into 21 bits per axis
+    static const int CELL_COORDINATE_BITS = 21;
+    static const int CELL_COORDINATE_LIMIT = (1 << (CELL_COORDINATE_BITS - 1)) - 1;
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndexGrid::SpatialIndexGrid(double cellSize)
+        : mCellSize(cellSize)
+        , mInvCellSize(1.0 / cellSize)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndexGrid::~SpatialIndexGrid()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::string& SpatialIndexGrid::GetType() const
+    {
+        return CLASS_TYPE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::SetCellSize(double cellSize)
+    {
+        if (cellSize <= 0.0)
+        {
+            LOG_W("The spatial index cell size has to be positive.")
+            return;
+        }
+
+        mCellSize = cellSize;
+        mInvCellSize = 1.0 / cellSize;
+
+        //Put every entity into its new cell
+        mCells.clear();
+        for (size_t i = 0; i < mEntries.size(); ++i)
+        {
+            InsertEntry(i);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double SpatialIndexGrid::GetCellSize() const
+    {
+        return mCellSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const
+    {
+        const double radius2 = radius * radius;
+        trBase::Vec3 extent(radius, radius, radius);
+        VisitCells(center - extent, center + extent, [&center, radius2](const trBase::Vec3& position)
+        {
+            return (position - center).Length2() <= radius2;
+        }, visitor);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const
+    {
+        VisitCells(boxMin, boxMax, [&boxMin, &boxMax](const trBase::Vec3& position)
+        {
+            return position[0] >= boxMin[0] && position[0] <= boxMax[0] &&
+                   position[1] >= boxMin[1] && position[1] <= boxMax[1] &&
+                   position[2] >= boxMin[2] && position[2] <= boxMax[2];
+        }, visitor);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::VisitFrustum(const Frustum& frustum, Visitor& visitor) const
+    {
+        const CellKey mask = (CellKey(1) << CELL_COORDINATE_BITS) - 1;
+        const CellKey signBit = CellKey(1) << (CELL_COORDINATE_BITS - 1);
+
+        for (const CellMap::value_type& cell : mCells)
+        {
+            //Unpack the cell coordinates, and cull the whole cell first
+            trBase::Vec3 cellMin;
+            for (int i = 0; i < 3; ++i)
+            {
+                CellKey coordinate = (cell.first >> (i * CELL_COORDINATE_BITS)) & mask;
+                if (coordinate & signBit)
+                {
+                    coordinate -= mask + 1;
+                }
+                cellMin[i] = static_cast<double>(coordinate) * mCellSize;
+            }
+
+            if (!frustum.Intersects(cellMin, cellMin + trBase::Vec3(mCellSize, mCellSize, mCellSize)))
+            {
+                continue;
+            }
+
+            for (size_t entryIndex : cell.second)
+            {
+                const Entry& entry = mEntries[entryIndex];
+                if (frustum.Contains(entry.position))
+                {
+                    visitor.Visit(entry.id, entry.position);
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance) const
+    {
+        results.clear();
+        if (count == 0 || mEntries.empty())
+        {
+            return;
+        }
+
+        const double maxDistance2 = GetMaxDistance2(maxDistance);
+
+        int centerCell[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            centerCell[i] = GetCellCoordinate(center[i]);
+        }
+
+        //Search growing shells of cells, until nothing outside the searched cube can be closer
+        size_t searchedCells = 0;
+        for (int ring = 0; ; ++ring)
+        {
+            for (int x = centerCell[0] - ring; x <= centerCell[0] + ring; ++x)
+            {
+                bool xEdge = x == centerCell[0] - ring || x == centerCell[0] + ring;
+                for (int y = centerCell[1] - ring; y <= centerCell[1] + ring; ++y)
+                {
+                    bool yEdge = y == centerCell[1] - ring || y == centerCell[1] + ring;
+
+                    //Inside the shell only the two end cells along z are new
+                    int zStep = (xEdge || yEdge || ring == 0) ? 1 : 2 * ring;
+                    for (int z = centerCell[2] - ring; z <= centerCell[2] + ring; z += zStep)
+                    {
+                        ++searchedCells;
+                        CellMap::const_iterator cellIt = mCells.find(MakeCellKey(x, y, z));
+                        if (cellIt != mCells.end())
+                        {
+                            for (size_t entryIndex : cellIt->second)
+                            {
+                                AddNeighbor(mEntries[entryIndex], center, count, maxDistance2, results);
+                            }
+                        }
+                    }
+                }
+            }
+
+            //Distance from the center to the nearest cell that has not been searched
+            double bound = std::numeric_limits<double>::max();
+            for (int i = 0; i < 3; ++i)
+            {
+                bound = std::min(bound, center[i] - static_cast<double>(centerCell[i] - ring) * mCellSize);
+                bound = std::min(bound, static_cast<double>(centerCell[i] + ring + 1) * mCellSize - center[i]);
+            }
+
+            if ((results.size() == count && results.front().distance2 <= bound * bound) || bound * bound > maxDistance2)
+            {
+                break;
+            }
+
+            //Sparse grids are faster to search entry by entry
+            if (searchedCells > mCells.size())
+            {
+                results.clear();
+                for (const Entry& entry : mEntries)
+                {
+                    AddNeighbor(entry, center, count, maxDistance2, results);
+                }
+                break;
+            }
+        }
+
+        std::sort_heap(results.begin(), results.end());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::InsertEntry(size_t entryIndex)
+    {
+        Entry& entry = mEntries[entryIndex];
+        entry.location = GetCellKey(entry.position);
+        mCells[entry.location].push_back(entryIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition)
+    {
+        //Updates often repeat the old position, which can't change the cell
+        Entry& entry = mEntries[entryIndex];
+        if (entry.position == oldPosition)
+        {
+            return;
+        }
+
+        CellKey cell = GetCellKey(entry.position);
+        if (cell != entry.location)
+        {
+            RemoveFromCell(entry.location, entryIndex);
+            mCells[cell].push_back(entryIndex);
+            entry.location = cell;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::RemoveEntry(size_t entryIndex)
+    {
+        RemoveFromCell(mEntries[entryIndex].location, entryIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::RenumberEntry(size_t oldIndex, size_t newIndex)
+    {
+        std::vector<size_t>& cell = mCells[mEntries[newIndex].location];
+        std::replace(cell.begin(), cell.end(), oldIndex, newIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::ClearEntries()
+    {
+        mCells.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int SpatialIndexGrid::GetCellCoordinate(double value) const
+    {
+        double cell = std::floor(value * mInvCellSize);
+        return static_cast<int>(std::min(std::max(cell, static_cast<double>(-CELL_COORDINATE_LIMIT)), static_cast<double>(CELL_COORDINATE_LIMIT)));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndexGrid::CellKey SpatialIndexGrid::GetCellKey(const trBase::Vec3& position) const
+    {
+        return MakeCellKey(GetCellCoordinate(position[0]), GetCellCoordinate(position[1]), GetCellCoordinate(position[2]));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndexGrid::CellKey SpatialIndexGrid::MakeCellKey(int x, int y, int z)
+    {
+        const CellKey mask = (CellKey(1) << CELL_COORDINATE_BITS) - 1;
+        return (CellKey(x) & mask) | ((CellKey(y) & mask) << CELL_COORDINATE_BITS) | ((CellKey(z) & mask) << (2 * CELL_COORDINATE_BITS));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexGrid::RemoveFromCell(CellKey cell, size_t entryIndex)
+    {
+        CellMap::iterator cellIt = mCells.find(cell);
+        if (cellIt == mCells.end())
+        {
+            return;
+        }
+
+        std::vector<size_t>& entries = cellIt->second;
+        std::vector<size_t>::iterator it = std::find(entries.begin(), entries.end(), entryIndex);
+        if (it != entries.end())
+        {
+            *it = entries.back();
+            entries.pop_back();
+        }
+        if (entries.empty())
+        {
+            mCells.erase(cellIt);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<typename Test>
+    void SpatialIndexGrid::VisitCells(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Test test, Visitor& visitor) const
+    {
+        int minCell[3];
+        int maxCell[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            minCell[i] = GetCellCoordinate(boxMin[i]);
+            maxCell[i] = GetCellCoordinate(boxMax[i]);
+        }
+
+        //Large queries go through the entities, instead of mostly empty cells
+        double cellCount = double(maxCell[0] - minCell[0] + 1) * double(maxCell[1] - minCell[1] + 1) * double(maxCell[2] - minCell[2] + 1);
+        if (cellCount > static_cast<double>(mCells.size()))
+        {
+            for (const Entry& entry : mEntries)
+            {
+                if (test(entry.position))
+                {
+                    visitor.Visit(entry.id, entry.position);
+                }
+            }
+            return;
+        }
+
+        for (int x = minCell[0]; x <= maxCell[0]; ++x)
+        {
+            for (int y = minCell[1]; y <= maxCell[1]; ++y)
+            {
+                for (int z = minCell[2]; z <= maxCell[2]; ++z)
+                {
+                    CellMap::const_iterator cellIt = mCells.find(MakeCellKey(x, y, z));
+                    if (cellIt == mCells.end())
+                    {
+                        continue;
+                    }
+
+                    for (size_t entryIndex : cellIt->second)
+                    {
+                        const Entry& entry = mEntries[entryIndex];
+                        if (test(entry.position))
+                        {
+                            visitor.Visit(entry.id, entry.position);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,445 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/SpatialIndexOctree.h>
+
+#include <trUtil/Logging/Log.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace trManager
+{
+    const trUtil::RefStr SpatialIndexOctree::CLASS_TYPE("trManager::SpatialIndexOctree");
+
+    const double SpatialIndexOctree::DEFAULT_HALF_SIZE = 1000.0;
+    const unsigned int SpatialIndexOctree::DEFAULT_LEAF_CAPACITY = 16;
+    const unsigned int SpatialIndexOctree::MAX_DEPTH = 20;
+    const double SpatialIndexOctree::LOOSENESS = 2.0;
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndexOctree::SpatialIndexOctree(const trBase::Vec3& center, double halfSize, unsigned int leafCapacity)
+        : mCenter(center)
+        , mHalfSize(halfSize > 0.0 ? halfSize : DEFAULT_HALF_SIZE)
+        , mLeafCapacity(leafCapacity > 0 ? leafCapacity : DEFAULT_LEAF_CAPACITY)
+    {
+        ClearEntries();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    SpatialIndexOctree::~SpatialIndexOctree()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const std::string& SpatialIndexOctree::GetType() const
+    {
+        return CLASS_TYPE;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::SetBounds(const trBase::Vec3& center, double halfSize)
+    {
+        if (halfSize <= 0.0)
+        {
+            LOG_W("The spatial index octree size has to be positive.")
+            return;
+        }
+
+        mCenter = center;
+        mHalfSize = halfSize;
+        Rebuild();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double SpatialIndexOctree::GetHalfSize() const
+    {
+        return mHalfSize;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t SpatialIndexOctree::GetNodeCount() const
+    {
+        return mNodes.size() - mFreeBlocks.size() * 8;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::VisitRadius(const trBase::Vec3& center, double radius, Visitor& visitor) const
+    {
+        const double radius2 = radius * radius;
+        VisitNodes(0, [&center, radius2](const Node& node)
+        {
+            return GetDistance2(node, center) <= radius2;
+        },
+        [&center, radius2](const trBase::Vec3& position)
+        {
+            return (position - center).Length2() <= radius2;
+        }, visitor);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::VisitBox(const trBase::Vec3& boxMin, const trBase::Vec3& boxMax, Visitor& visitor) const
+    {
+        VisitNodes(0, [&boxMin, &boxMax](const Node& node)
+        {
+            double extent = node.halfSize * LOOSENESS;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (node.center[i] + extent < boxMin[i] || node.center[i] - extent > boxMax[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        },
+        [&boxMin, &boxMax](const trBase::Vec3& position)
+        {
+            return position[0] >= boxMin[0] && position[0] <= boxMax[0] &&
+                   position[1] >= boxMin[1] && position[1] <= boxMax[1] &&
+                   position[2] >= boxMin[2] && position[2] <= boxMax[2];
+        }, visitor);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::VisitFrustum(const Frustum& frustum, Visitor& visitor) const
+    {
+        VisitNodes(0, [&frustum](const Node& node)
+        {
+            double extent = node.halfSize * LOOSENESS;
+            trBase::Vec3 looseExtent(extent, extent, extent);
+            return frustum.Intersects(node.center - looseExtent, node.center + looseExtent);
+        },
+        [&frustum](const trBase::Vec3& position)
+        {
+            return frustum.Contains(position);
+        }, visitor);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::QueryNearest(const trBase::Vec3& center, size_t count, std::vector<Neighbor>& results, double maxDistance) const
+    {
+        results.clear();
+        if (count == 0 || mEntries.empty())
+        {
+            return;
+        }
+
+        FindNearest(0, center, count, GetMaxDistance2(maxDistance), results);
+        std::sort_heap(results.begin(), results.end());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::InsertEntry(size_t entryIndex)
+    {
+        Insert(entryIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::MoveEntry(size_t entryIndex, const trBase::Vec3& oldPosition)
+    {
+        int nodeIndex = static_cast<int>(mEntries[entryIndex].location);
+        if (IsInside(mNodes[nodeIndex], mEntries[entryIndex].position, LOOSENESS))
+        {
+            return;
+        }
+
+        RemoveFromNode(nodeIndex, entryIndex);
+        TryMerge(mNodes[nodeIndex].parent);
+        Insert(entryIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::RemoveEntry(size_t entryIndex)
+    {
+        int nodeIndex = static_cast<int>(mEntries[entryIndex].location);
+        RemoveFromNode(nodeIndex, entryIndex);
+        TryMerge(mNodes[nodeIndex].parent);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::RenumberEntry(size_t oldIndex, size_t newIndex)
+    {
+        std::vector<size_t>& entries = mNodes[static_cast<int>(mEntries[newIndex].location)].entries;
+        std::replace(entries.begin(), entries.end(), oldIndex, newIndex);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::ClearEntries()
+    {
+        mNodes.clear();
+        mFreeBlocks.clear();
+
+        Node root;
+        root.center = mCenter;
+        root.halfSize = mHalfSize;
+        root.firstChild = NO_CHILDREN;
+        root.parent = -1;
+        root.depth = 0;
+        mNodes.push_back(root);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::Rebuild()
+    {
+        ClearEntries();
+        for (size_t i = 0; i < mEntries.size(); ++i)
+        {
+            Insert(i);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::Insert(size_t entryIndex)
+    {
+        const trBase::Vec3& position = mEntries[entryIndex].position;
+
+        //Grow the root until it holds the new position, and put every entry in the larger tree
+        if (!IsInside(mNodes[0], position, 1.0))
+        {
+            if (std::isfinite(position[0]) && std::isfinite(position[1]) && std::isfinite(position[2]))
+            {
+                while (!IsInside(mNodes[0], position, mHalfSize / mNodes[0].halfSize))
+                {
+                    mHalfSize *= 2.0;
+                }
+                Rebuild();
+                return;
+            }
+            LOG_W("An entity with an invalid position was added to the spatial index.")
+        }
+
+        int nodeIndex = 0;
+        while (mNodes[nodeIndex].firstChild != NO_CHILDREN)
+        {
+            nodeIndex = GetChild(mNodes[nodeIndex], position);
+        }
+
+        Node& node = mNodes[nodeIndex];
+        node.entries.push_back(entryIndex);
+        mEntries[entryIndex].location = nodeIndex;
+
+        if (node.entries.size() > mLeafCapacity && node.depth < MAX_DEPTH)
+        {
+            Split(nodeIndex);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::Split(int nodeIndex)
+    {
+        int firstChild;
+        if (!mFreeBlocks.empty())
+        {
+            firstChild = mFreeBlocks.back();
+            mFreeBlocks.pop_back();
+        }
+        else
+        {
+            firstChild = static_cast<int>(mNodes.size());
+            mNodes.resize(mNodes.size() + 8);
+        }
+
+        Node& node = mNodes[nodeIndex];
+        double childHalfSize = node.halfSize * 0.5;
+        for (int i = 0; i < 8; ++i)
+        {
+            Node& child = mNodes[firstChild + i];
+            child.center = node.center + trBase::Vec3((i & 1) ? childHalfSize : -childHalfSize,
+                                                      (i & 2) ? childHalfSize : -childHalfSize,
+                                                      (i & 4) ? childHalfSize : -childHalfSize);
+            child.halfSize = childHalfSize;
+            child.firstChild = NO_CHILDREN;
+            child.parent = nodeIndex;
+            child.depth = node.depth + 1;
+            child.entries.clear();
+        }
+        node.firstChild = firstChild;
+
+        //Entries that moved up to twice the half size from the center can be outside the loose bounds
+        //of their octant's child, those stay in this node
+        size_t keptCount = 0;
+        for (size_t i = 0; i < node.entries.size(); ++i)
+        {
+            size_t entryIndex = node.entries[i];
+            int childIndex = GetChild(node, mEntries[entryIndex].position);
+            if (IsInside(mNodes[childIndex], mEntries[entryIndex].position, LOOSENESS))
+            {
+                mNodes[childIndex].entries.push_back(entryIndex);
+                mEntries[entryIndex].location = childIndex;
+            }
+            else
+            {
+                node.entries[keptCount++] = entryIndex;
+            }
+        }
+        node.entries.resize(keptCount);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::RemoveFromNode(int nodeIndex, size_t entryIndex)
+    {
+        std::vector<size_t>& entries = mNodes[nodeIndex].entries;
+        std::vector<size_t>::iterator it = std::find(entries.begin(), entries.end(), entryIndex);
+        if (it != entries.end())
+        {
+            *it = entries.back();
+            entries.pop_back();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::TryMerge(int nodeIndex)
+    {
+        while (nodeIndex >= 0)
+        {
+            Node& node = mNodes[nodeIndex];
+
+            //Only merge children that are all leaves, and hold at most half a leaf, so a node does not split and merge every frame
+            size_t total = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                const Node& child = mNodes[node.firstChild + i];
+                if (child.firstChild != NO_CHILDREN)
+                {
+                    return;
+                }
+                total += child.entries.size();
+            }
+            if (total > mLeafCapacity / 2)
+            {
+                return;
+            }
+
+            for (int i = 0; i < 8; ++i)
+            {
+                Node& child = mNodes[node.firstChild + i];
+                for (size_t entryIndex : child.entries)
+                {
+                    node.entries.push_back(entryIndex);
+                    mEntries[entryIndex].location = nodeIndex;
+                }
+                child.entries.clear();
+            }
+            mFreeBlocks.push_back(node.firstChild);
+            node.firstChild = NO_CHILDREN;
+
+            nodeIndex = node.parent;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int SpatialIndexOctree::GetChild(const Node& node, const trBase::Vec3& position) const
+    {
+        int octant = (position[0] >= node.center[0] ? 1 : 0) | (position[1] >= node.center[1] ? 2 : 0) | (position[2] >= node.center[2] ? 4 : 0);
+        return node.firstChild + octant;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool SpatialIndexOctree::IsInside(const Node& node, const trBase::Vec3& position, double scale) const
+    {
+        double extent = node.halfSize * scale;
+        return std::abs(position[0] - node.center[0]) <= extent &&
+               std::abs(position[1] - node.center[1]) <= extent &&
+               std::abs(position[2] - node.center[2]) <= extent;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double SpatialIndexOctree::GetDistance2(const Node& node, const trBase::Vec3& point)
+    {
+        double extent = node.halfSize * LOOSENESS;
+        double distance2 = 0.0;
+        for (int i = 0; i < 3; ++i)
+        {
+            double distance = std::abs(point[i] - node.center[i]) - extent;
+            if (distance > 0.0)
+            {
+                distance2 += distance * distance;
+            }
+        }
+        return distance2;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<typename NodeTest, typename Test>
+    void SpatialIndexOctree::VisitNodes(int nodeIndex, NodeTest nodeTest, Test test, Visitor& visitor) const
+    {
+        const Node& node = mNodes[nodeIndex];
+        if (!nodeTest(node))
+        {
+            return;
+        }
+
+        for (size_t entryIndex : node.entries)
+        {
+            const Entry& entry = mEntries[entryIndex];
+            if (test(entry.position))
+            {
+                visitor.Visit(entry.id, entry.position);
+            }
+        }
+
+        if (node.firstChild == NO_CHILDREN)
+        {
+            return;
+        }
+
+        for (int i = 0; i < 8; ++i)
+        {
+            VisitNodes(node.firstChild + i, nodeTest, test, visitor);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SpatialIndexOctree::FindNearest(int nodeIndex, const trBase::Vec3& center, size_t count, double maxDistance2, std::vector<Neighbor>& heap) const
+    {
+        const Node& node = mNodes[nodeIndex];
+        double limit = heap.size() == count ? heap.front().distance2 : maxDistance2;
+        if (GetDistance2(node, center) > limit)
+        {
+            return;
+        }
+
+        for (size_t entryIndex : node.entries)
+        {
+            AddNeighbor(mEntries[entryIndex], center, count, maxDistance2, heap);
+        }
+
+        if (node.firstChild == NO_CHILDREN)
+        {
+            return;
+        }
+
+        //Search the closest children first, so the rest are more likely to be skipped
+        double distances[8];
+        int order[8];
+        for (int i = 0; i < 8; ++i)
+        {
+            distances[i] = GetDistance2(mNodes[node.firstChild + i], center);
+            order[i] = i;
+        }
+        std::sort(order, order + 8, [&distances](int a, int b) { return distances[a] < distances[b]; });
+
+        for (int i = 0; i < 8; ++i)
+        {
+            FindNearest(node.firstChild + order[i], center, count, maxDistance2, heap);
+        }
+    }
+}
\ No newline at end of file
@@ -23,14 +23,19 @@
 
 #include <trManager/MessageEntityUnregistered.h>
 #include <trManager/MessageEntityRegistered.h>
+#include <trManager/JournalRecorder.h>
+#include <trManager/NetworkDirector.h>
+#include <trManager/MessageTick.h>
 #include <trManager/DirectorBase.h>
 #include <trManager/EntityType.h>
 #include <trManager/Invokable.h>
+#include <trManager/SpatialIndexGrid.h>
 #include <trUtil/ExceptionInvalidParameter.cpp.h>
 #include <trUtil/Logging/Log.h>
+#include <trUtil/Metrics/MetricsRegistry.h>
 #include <trBase/SmrtPtr.h>
 
-
+#include <algorithm>
 #include <string>
 
 namespace trManager
@@ -43,12 +48,27 @@ namespace trManager
 
     //////////////////////////////////////////////////////////////////////////
     SystemManager::SystemManager(const std::string name) : BaseClass(name)
+        , mSpatialIndex(new trManager::SpatialIndexGrid())
     {
+        //Create one message queue for each message priority class
+        mMessageQueues.resize(std::max<size_t>(MessagePriority::EnumerateType().size(), 1));
+
+        //Each world publishes its own metrics. Names don't have to be unique, so the world ID tells
+        //worlds with the same name apart.
+        mMetricsWorldId = GetUUID().ToString();
+        trUtil::Metrics::MetricsRegistry& registry = trUtil::Metrics::MetricsRegistry::GetInstance();
+        trUtil::Metrics::MetricsRegistry::Labels labels = { { "world", GetName() }, { "world_id", mMetricsWorldId } };
+        mDeferredMessageCounter = &registry.GetCounter("tr_messages_deferred_total", "Messages deferred to the next frame by the message time budget.", labels);
+        mMessageBacklogGauge = &registry.GetGauge("tr_message_queue_depth", "Messages waiting in the System Manager queues.", labels);
+        mActorCountGauge = &registry.GetGauge("tr_registered_actors", "Actors registered with the System Manager.", labels);
     }
 
     //////////////////////////////////////////////////////////////////////////
     SystemManager::~SystemManager()
     {
+        //Remove the metrics of this world, including the ones its directors added, so the
+        //registry does not keep a series for every world ever created
+        trUtil::Metrics::MetricsRegistry::GetInstance().RemoveMetrics("world_id", mMetricsWorldId);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -70,13 +90,30 @@ namespace trManager
     //////////////////////////////////////////////////////////////////////////
     bool SystemManager::SendMessage(const trManager::MessageBase& message)
     {
-        mMessageQueue.push(trBase::SmrtPtr<const trManager::MessageBase>(&message));
+        if (mSuppressSentMessages)
+        {
+            //Take and release a reference, so the fresh message is freed
+            trBase::SmrtPtr<const trManager::MessageBase> holder(&message);
+            ++mSuppressedMessageCount;
+            return false;
+        }
+
+        //Find the queue for the messages priority class. Unknown classes go into the lowest one.
+        unsigned int queueIndex = std::min<unsigned int>(message.GetMessagePriority().GetID(), static_cast<unsigned int>(mMessageQueues.size() - 1));
+        mMessageQueues[queueIndex].push(trBase::SmrtPtr<const trManager::MessageBase>(&message));
         return true;
     }
 
     //////////////////////////////////////////////////////////////////////////
     bool SystemManager::SendNetworkMessage(const trManager::MessageBase& message)
     {
+        if (mNetworkDirector.valid())
+        {
+            //Callers hand over a fresh message, so hold it until the director is done with it
+            trBase::SmrtPtr<const trManager::MessageBase> holder(&message);
+            return mNetworkDirector->SendNetworkMessage(*holder);
+        }
+
         mNetworkMessageQueue.push(trBase::SmrtPtr<const trManager::MessageBase>(&message));
         return true;
     }
@@ -84,6 +121,23 @@ namespace trManager
     //////////////////////////////////////////////////////////////////////////
     void SystemManager::ProcessMessage(const trManager::MessageBase& message)
     {
+        ++mProcessedMessageCount;
+
+        //Count the message by type, the scraper turns the counts into messages per second
+        trUtil::Metrics::Counter*& messageCounter = mMessageCounters[message.GetMessageType()];
+        if (messageCounter == nullptr)
+        {
+            messageCounter = &trUtil::Metrics::MetricsRegistry::GetInstance().GetCounter("tr_messages_processed_total", "Messages processed by the System Manager.",
+                { { "world", GetName() }, { "world_id", mMetricsWorldId }, { "type", message.GetMessageType() } });
+        }
+        messageCounter->Increment();
+
+        //Record the message before any entity reacts to it
+        if (mJournalRecorder.valid())
+        {
+            mJournalRecorder->RecordMessage(message);
+        }
+
         //Send messages to Directors
         SendMessageToDirectors(message);
 
@@ -97,14 +151,188 @@ namespace trManager
     //////////////////////////////////////////////////////////////////////////
     void SystemManager::ProcessMessages()
     {
-        //Go through all stored messages and send them out...
-        while (!mMessageQueue.empty())
+        ProcessQueuedMessages(mMessageTimeBudget > 0.0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::FlushMessages()
+    {
+        ProcessQueuedMessages(false);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::ProcessQueuedMessages(bool useBudget)
+    {
+        trUtil::TimeTicks lastTick = mBudgetTimer.Tick();
+        unsigned int queueIndex = 0;
+
+        //Go through all stored messages and send them out, starting with the highest priority class...
+        while (queueIndex < mMessageQueues.size())
         {
-            ProcessMessage(*mMessageQueue.front().Get());            
+            MessageQueue& queue = mMessageQueues[queueIndex];
+            if (queue.empty())
+            {
+                ++queueIndex;
+                continue;
+            }
+
+            //Everything below the System priority class waits for the next frame once the budget is gone
+            if (useBudget && queueIndex != MessagePriority::SYSTEM.GetID() && mMessageTimeUsed >= mMessageTimeBudget)
+            {
+                mBudgetExhausted = true;
+                break;
+            }
+
+            ProcessMessage(*queue.front().Get());
 
             //Removed the handled message
-            mMessageQueue.pop();
+            queue.pop();
+
+            //Account for the time used, and start over from the top, in case a higher priority message was sent
+            trUtil::TimeTicks currentTick = mBudgetTimer.Tick();
+            mMessageTimeUsed += mBudgetTimer.DeltaSec(lastTick, currentTick);
+            lastTick = currentTick;
+            queueIndex = 0;
         }
+
+        mMessageBacklogGauge->Set(GetMessageBacklog());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::ResetMessageTimeBudget()
+    {
+        mDeferredMessageCount = 0;
+
+        //If the last frame ran out of budget, whatever is left in the queues got deferred
+        if (mBudgetExhausted)
+        {
+            mDeferredMessageCount = GetMessageBacklog();
+            mPeakDeferredMessageCount = std::max(mPeakDeferredMessageCount, mDeferredMessageCount);
+            mTotalDeferredMessages += mDeferredMessageCount;
+            ++mDeferredFrameCount;
+            mDeferredMessageCounter->Increment(mDeferredMessageCount);
+
+            LOG_D("Message time budget ran out, deferring " + trUtil::StringUtils::ToString<unsigned int>(mDeferredMessageCount) + " messages to the next frame.")
+        }
+
+        mBudgetExhausted = false;
+        mMessageTimeUsed = 0.0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetMessageTimeBudget(double seconds)
+    {
+        mMessageTimeBudget = std::max(seconds, 0.0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double SystemManager::GetMessageTimeBudget() const
+    {
+        return mMessageTimeBudget;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int SystemManager::GetMessageBacklog() const
+    {
+        size_t backlog = 0;
+        for (const MessageQueue& queue : mMessageQueues)
+        {
+            backlog += queue.size();
+        }
+        return static_cast<unsigned int>(backlog);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int SystemManager::GetDeferredMessageCount() const
+    {
+        return mDeferredMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int SystemManager::GetPeakDeferredMessageCount() const
+    {
+        return mPeakDeferredMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long SystemManager::GetTotalDeferredMessages() const
+    {
+        return mTotalDeferredMessages;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long SystemManager::GetDeferredFrameCount() const
+    {
+        return mDeferredFrameCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long SystemManager::GetProcessedMessageCount() const
+    {
+        return mProcessedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetJournalRecorder(trManager::JournalRecorder* recorder)
+    {
+        mJournalRecorder = recorder;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    trManager::JournalRecorder* SystemManager::GetJournalRecorder() const
+    {
+        return mJournalRecorder.get();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetNetworkDirector(trManager::NetworkDirector* director)
+    {
+        mNetworkDirector = director;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    trManager::NetworkDirector* SystemManager::GetNetworkDirector() const
+    {
+        return mNetworkDirector.get();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetTimingStructure(const trManager::TimingStructure& timeStruct)
+    {
+        mTimingStructure = timeStruct;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetSuppressSentMessages(bool suppress)
+    {
+        mSuppressSentMessages = suppress;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool SystemManager::GetSuppressSentMessages() const
+    {
+        return mSuppressSentMessages;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long SystemManager::GetSuppressedMessageCount() const
+    {
+        return mSuppressedMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::TimingStructure& SystemManager::GetTimingStructure() const
+    {
+        return mTimingStructure;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::ResetDeferredMessageStats()
+    {
+        mDeferredMessageCount = 0;
+        mPeakDeferredMessageCount = 0;
+        mTotalDeferredMessages = 0;
+        mDeferredFrameCount = 0;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -198,7 +426,7 @@ namespace trManager
                 //Unregister the entity
                 if (msgRegistrantsPtr->at(i).first == &listeningEntity)
                 {
-                    msgRegistrantsPtr->erase(msgRegistrantsPtr->begin() + i);
+                    RemoveAboutListener(*msgRegistrantsPtr, i);
                     LOG_D("Unregistered Entity: " + listeningEntity.GetName() + " from listening to messages about an actor.")
                     break;
                 }
@@ -216,6 +444,72 @@ namespace trManager
         }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::RegisterForMessagesInArea(EntityBase& listeningEntity, double radius, const std::string& invokableName)
+    {
+        if (radius <= 0.0)
+        {
+            LOG_W("The Entity: " + listeningEntity.GetName() + " attempted to register for messages in an area with a radius that is not positive.")
+            return;
+        }
+
+        mInterestManager.AddSubscription(listeningEntity, radius, invokableName);
+        LOG_D("Registering Entity: " + listeningEntity.GetName() + " for messages about actors in an area through invokable: " + invokableName)
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::UnregisterFromMessagesInArea(EntityBase& listeningEntity)
+    {
+        if (mInterestManager.RemoveSubscription(listeningEntity.GetUUID()))
+        {
+            LOG_D("Unregistered Entity: " + listeningEntity.GetName() + " from listening to messages about actors in an area.")
+        }
+        else
+        {
+            LOG_W("Invalid attempt to unregister the Entity: " + listeningEntity.GetName() + " from listening to messages about actors in an area.")
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetEntityPosition(EntityBase& entity, const trBase::Vec3& position)
+    {
+        mSpatialIndex->Update(entity.GetUUID(), position);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::RemoveEntityPosition(EntityBase& entity)
+    {
+        mSpatialIndex->Remove(entity.GetUUID());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetSpatialIndex(trManager::SpatialIndex& spatialIndex)
+    {
+        //Move the published positions into the new index
+        mSpatialIndex->ApplyUpdates();
+        spatialIndex.CopyFrom(*mSpatialIndex);
+        spatialIndex.ApplyUpdates();
+
+        mSpatialIndex = &spatialIndex;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::SpatialIndex& SystemManager::GetSpatialIndex() const
+    {
+        return *mSpatialIndex;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::UpdateSpatialIndex()
+    {
+        mSpatialIndex->ApplyUpdates();
+
+        if (!mInterestManager.IsEmpty())
+        {
+            mInterestManager.Update(*mSpatialIndex);
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     bool SystemManager::RegisterActor(trManager::EntityBase& actor)
     {
@@ -233,6 +527,7 @@ namespace trManager
 
         mActorList.push_back(newActor);
         mActorIDMap[actor.GetUUID()] = newActor;
+        mActorCountGauge->Set(static_cast<double>(mActorList.size()));
         
         //Set the director registration status
         actor.SetSystemManager(this);
@@ -270,8 +565,12 @@ namespace trManager
             UnregisterActorFromGlobalMessages(*found->Get());   // Unregister the entity from all messages
             UnregisterEntityFromAboutMessages(*found->Get());   // Unregister the entity from all About messages
             
+            mTickScheduler.RemoveEntity((*found)->GetUUID());    // Remove the entity from the Tick schedule
+            mInterestManager.RemoveEntity((*found)->GetUUID()); // Remove the entity from all areas of interest
+            mSpatialIndex->Remove((*found)->GetUUID());         // Remove the entities position
             mActorIDMap.erase((*found)->GetUUID());             // Erase the node from the list by ID key
             mActorList.erase(found);                            // Erase the node from the list
+            mActorCountGauge->Set(static_cast<double>(mActorList.size()));
         
             //Notify everyone that an Entity was removed
             SendMessage(*new trManager::MessageEntityUnregistered(&GetUUID(), &actor.GetUUID(), &actor.GetType(), &actor.GetName()));
@@ -302,6 +601,25 @@ namespace trManager
         return true;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::SetTickRate(trManager::EntityBase& actor, unsigned int framesPerTick)
+    {
+        if (actor.GetEntityType() == EntityType::DIRECTOR)
+        {
+            LOG_W("The Director: " + actor.GetName() + " can not have a tick rate. Directors are ticked every frame.")
+            return;
+        }
+
+        mTickScheduler.SetTickRate(actor.GetUUID(), framesPerTick);
+        LOG_D("Tick rate of " + actor.GetName() + " set to every " + trUtil::StringUtils::ToString<unsigned int>(framesPerTick) + " frames.")
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int SystemManager::GetTickRate(trManager::EntityBase& actor) const
+    {
+        return mTickScheduler.GetTickRate(actor.GetUUID());
+    }
+
     //////////////////////////////////////////////////////////////////////////
     trManager::EntityBase* SystemManager::FindActor(const trBase::UniqueId& id)
     {
@@ -415,6 +733,9 @@ namespace trManager
         //Check if anyone registered for this message
         if (listenerIt != mEntityGlobalMsgRegistrationMap.end())
         {
+            //Tick messages go through the tick scheduler, if anyone has a tick rate set
+            bool isScheduledTick = !mTickScheduler.IsEmpty() && message.GetMessageType() == MessageTick::MESSAGE_TYPE;
+
             //Go through the listener list, and send the message to each listening actor 
             std::vector<EntityInvokablePair>* listenerList = &listenerIt->second;
             for (EntityInvokablePair ent : *listenerList)
@@ -422,7 +743,20 @@ namespace trManager
                 //Make sure the entity is not sending a message to itself
                 if (ent.first->GetUUID() != *message.GetFromActorID())
                 {
-                    CallInvokable(message, ent.second, *ent.first.Get());
+                    if (isScheduledTick)
+                    {
+                        //Skip the actor if it is not its frame, or send it the Tick with its accumulated time.
+                        //The scheduler only counts the first call for each actor and Tick.
+                        const trManager::MessageTick* tick = mTickScheduler.Schedule(static_cast<const trManager::MessageTick&>(message), ent.first->GetUUID());
+                        if (tick != nullptr)
+                        {
+                            CallInvokable(*tick, ent.second, *ent.first.Get());
+                        }
+                    }
+                    else
+                    {
+                        CallInvokable(message, ent.second, *ent.first.Get());
+                    }
                 }                
             }
         }
@@ -433,26 +767,102 @@ namespace trManager
     {
         if (message.GetAboutActorID() != nullptr)
         {
-            //Find this messages listener list
-            UUIDRegistrationVectorMap::iterator listenerIt = mListenerRegistrationMap.find(*message.GetAboutActorID());
+            //Invokables can change the registrations while we walk them. Removals only clear the
+            //entity until the walk ends, and entities registered during the walk get the next message.
+            ++mListenerWalkDepth;
+            mInterestManager.BeginWalk();
 
-            //Check if anyone registered for this message
+            std::vector<EntityInvokablePair>* listeners = nullptr;
+            size_t listenerCount = 0;
+            UUIDRegistrationVectorMap::iterator listenerIt = mListenerRegistrationMap.find(*message.GetAboutActorID());
             if (listenerIt != mListenerRegistrationMap.end())
             {
-                //Go through the listener list, and send the message to each listening actor 
-                std::vector<EntityInvokablePair>* listenerList = &listenerIt->second;
-                for (EntityInvokablePair ent : *listenerList)
+                listeners = &listenerIt->second;
+                listenerCount = listeners->size();
+            }
+
+            //Go through the listener list, and send the message to each listening actor
+            for (size_t i = 0; i < listenerCount; ++i)
+            {
+                //Hold the entity, the invokable can unregister it
+                trBase::SmrtPtr<trManager::EntityBase> entity = (*listeners)[i].first;
+
+                //Make sure the entity is not sending a message to itself
+                if (entity.Valid() && entity->GetUUID() != *message.GetFromActorID())
                 {
-                    //Make sure the entity is not sending a message to itself
-                    if (ent.first->GetUUID() != *message.GetFromActorID())
-                    {
-                        CallInvokable(message, ent.second, *ent.first.Get());
-                    }
+                    CallInvokable(message, (*listeners)[i].second, *entity);
+                }
+            }
+
+            //Send the message to everyone whose area of interest holds the entity
+            const std::vector<InterestManager::Subscription*>* subscriptions = mInterestManager.GetSubscriptions(*message.GetAboutActorID());
+            size_t subscriptionCount = subscriptions != nullptr ? subscriptions->size() : 0;
+            for (size_t i = 0; i < subscriptionCount; ++i)
+            {
+                const InterestManager::Subscription& subscription = *(*subscriptions)[i];
+                trBase::SmrtPtr<trManager::EntityBase> entity = subscription.listener;
+                if (entity.Valid() && entity->GetUUID() != *message.GetFromActorID() && !IsRegisteredAboutEntity(*entity, subscription.invokableName, listeners, listenerCount))
+                {
+                    CallInvokable(message, subscription.invokableName, *entity);
                 }
             }
+
+            mInterestManager.EndWalk();
+            if (--mListenerWalkDepth == 0 && mHasRemovedAboutListeners)
+            {
+                EraseRemovedAboutListeners();
+            }
         }        
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool SystemManager::IsRegisteredAboutEntity(const trManager::EntityBase& listeningEntity, const std::string& invokableName, const std::vector<EntityInvokablePair>* listeners, size_t listenerCount)
+    {
+        for (size_t i = 0; i < listenerCount; ++i)
+        {
+            const EntityInvokablePair& ent = (*listeners)[i];
+            if (ent.first == &listeningEntity && ent.second == invokableName)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::RemoveAboutListener(std::vector<EntityInvokablePair>& listeners, size_t index)
+    {
+        if (mListenerWalkDepth > 0)
+        {
+            //Keep the indexes of the walk valid, the empty entry is erased when the walk ends
+            listeners[index].first = nullptr;
+            mHasRemovedAboutListeners = true;
+        }
+        else
+        {
+            listeners.erase(listeners.begin() + index);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void SystemManager::EraseRemovedAboutListeners()
+    {
+        for (UUIDRegistrationVectorMap::iterator listenerIt = mListenerRegistrationMap.begin(); listenerIt != mListenerRegistrationMap.end();)
+        {
+            std::vector<EntityInvokablePair>& listeners = listenerIt->second;
+            listeners.erase(std::remove_if(listeners.begin(), listeners.end(), [](const EntityInvokablePair& ent) { return !ent.first.Valid(); }), listeners.end());
+            if (listeners.empty())
+            {
+                listenerIt = mListenerRegistrationMap.erase(listenerIt);
+            }
+            else
+            {
+                ++listenerIt;
+            }
+        }
+        mHasRemovedAboutListeners = false;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void SystemManager::SendGlobalyRegisteredMessage(const trManager::MessageBase & message)
     {
@@ -501,7 +911,8 @@ namespace trManager
         }
         else
         {
-            LOG_E("Invokable: " + invokableName + " was called, but the Entity: " + entity.GetName() + " does not have an invokable by that name.")
+            // A misbehaving entity can hit this every frame, so keep it from flooding the log.
+            LOG_E_RATE(5, "Invokable: " + invokableName + " was called, but the Entity: " + entity.GetName() + " does not have an invokable by that name.")
         }
     }
 
@@ -596,7 +1007,7 @@ namespace trManager
                 //If we found a matching entity registration, delete it
                 if (msgRegistrantsPtr->at(i).first == &listeningEntity)
                 {
-                    msgRegistrantsPtr->erase(msgRegistrantsPtr->begin() + i);
+                    RemoveAboutListener(*msgRegistrantsPtr, i);
                     break;
                 }
             }
@@ -799,6 +1210,8 @@ namespace trManager
 
                 UnregisterDirectorFromGlobalMessages(*found->Get());// Unregister the director from all messages
                 UnregisterEntityFromAboutMessages(*found->Get());   // Unregister the director from all About messages
+                mInterestManager.RemoveEntity((*found)->GetUUID()); // Remove the director from all areas of interest
+                mSpatialIndex->Remove((*found)->GetUUID());         // Remove the directors position
 
                 mDirectorIDMap.erase((*found)->GetUUID());          // Erase the node from the list by ID key
                 mDirectorNameMap.erase((*found)->GetName());        // Erase the node from the list by Name key
@@ -903,7 +1316,7 @@ namespace trManager
         LOG_D("Shutting down System Manager")
 
         LOG_D("Processing Last Messages")
-        ProcessMessages(); //Send all left over messages before shutting down
+        FlushMessages(); //Send all left over messages before shutting down
 
         LOG_D("Unregistering All Directors")
         UnregisterAllDirectors(); //Unregister all Directors
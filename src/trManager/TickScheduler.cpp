@@ -0,0 +1,138 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trManager/TickScheduler.h>
+
+namespace trManager
+{
+    //////////////////////////////////////////////////////////////////////////
+    TickScheduler::TickScheduler()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TickScheduler::~TickScheduler()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TickScheduler::SetTickRate(const trBase::UniqueId& id, unsigned int framesPerTick)
+    {
+        if (framesPerTick <= 1)
+        {
+            //Entities that tick every frame do not need scheduling
+            RemoveEntity(id);
+            return;
+        }
+
+        TickEntry& entry = mTickEntryMap[id];
+        if (entry.framesPerTick != framesPerTick)
+        {
+            //Hand out the buckets round-robin, so entities with the same rate tick on different frames
+            entry.framesPerTick = framesPerTick;
+            entry.bucket = mNextBucketMap[framesPerTick]++ % framesPerTick;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned int TickScheduler::GetTickRate(const trBase::UniqueId& id) const
+    {
+        TickEntryMap::const_iterator it = mTickEntryMap.find(id);
+        if (it != mTickEntryMap.end())
+        {
+            return it->second.framesPerTick;
+        }
+        else
+        {
+            return 1;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TickScheduler::RemoveEntity(const trBase::UniqueId& id)
+    {
+        mTickEntryMap.erase(id);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TickScheduler::Clear()
+    {
+        mTickEntryMap.clear();
+        mNextBucketMap.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool TickScheduler::IsEmpty() const
+    {
+        return mTickEntryMap.empty();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const trManager::MessageTick* TickScheduler::Schedule(const trManager::MessageTick& tick, const trBase::UniqueId& id)
+    {
+        TickEntryMap::iterator it = mTickEntryMap.find(id);
+        if (it == mTickEntryMap.end())
+        {
+            //Not scheduled, the entity gets the Tick every frame
+            return &tick;
+        }
+
+        TickEntry& entry = it->second;
+
+        //The entity was already scheduled for this Tick
+        if (entry.lastTick == &tick && entry.lastFrame == tick.GetFrameNumber())
+        {
+            return entry.ticked ? entry.tickMessage.Get() : nullptr;
+        }
+        entry.lastTick = &tick;
+        entry.lastFrame = tick.GetFrameNumber();
+
+        //Start a new accumulation if the entity got its Tick last time
+        if (entry.ticked)
+        {
+            entry.timeStruct.deltaSimTime = 0.;
+            entry.timeStruct.deltaRealTime = 0.;
+            entry.ticked = false;
+        }
+
+        entry.timeStruct.deltaSimTime += tick.GetDeltaSimTime();
+        entry.timeStruct.deltaRealTime += tick.GetDeltaRealTime();
+
+        //Check if this frame falls into the entities bucket
+        if (static_cast<unsigned int>(tick.GetFrameNumber()) % entry.framesPerTick != entry.bucket)
+        {
+            return nullptr;
+        }
+
+        entry.timeStruct.frameNumber = tick.GetFrameNumber();
+        entry.timeStruct.simTime = tick.GetSimTime();
+        entry.timeStruct.realTime = tick.GetRealTime();
+        entry.timeStruct.timeScale = tick.GetTimeScale();
+        entry.ticked = true;
+
+        //The Tick message points into the entries timing structure, so it only needs to be created once per sender
+        if (!entry.tickMessage.Valid() || entry.tickMessage->GetFromActorID() != tick.GetFromActorID())
+        {
+            entry.tickMessage = new trManager::MessageTick(tick.GetFromActorID(), entry.timeStruct);
+        }
+        return entry.tickMessage.Get();
+    }
+}
\ No newline at end of file
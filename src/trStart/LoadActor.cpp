@@ -0,0 +1,81 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trStart/LoadActor.h>
+
+#include <trStart/MessageLoad.h>
+#include <trManager/MessageTick.h>
+
+#include <cmath>
+
+namespace trStart
+{
+    const trUtil::RefStr LoadActor::CLASS_TYPE("trStart::LoadActor");
+
+    //////////////////////////////////////////////////////////////////////////
+    LoadActor::LoadActor(const std::string& name) : BaseClass(name)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    LoadActor::~LoadActor()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void LoadActor::OnTick(const trManager::MessageBase& msg)
+    {
+        //Burn some CPU time, and keep the result so the work is not optimized away
+        const trManager::MessageTick& tick = static_cast<const trManager::MessageTick&>(msg);
+        double value = tick.GetSimTime();
+        for (unsigned int i = 0; i < mWorkUnits; ++i)
+        {
+            value = std::sqrt(value * value + 1.0);
+        }
+        mWorkResult += value;
+
+        //Generate the message traffic
+        for (unsigned int i = 0; i < mMessagesPerTick; ++i)
+        {
+            SendMessage(*new MessageLoad(&GetUUID(), &GetUUID()));
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void LoadActor::OnAddedToSysMan()
+    {
+        BaseClass::OnAddedToSysMan();
+
+        RegisterForMessage(trManager::MessageTick::MESSAGE_TYPE, ON_TICK_INVOKABLE);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void LoadActor::SetWorkUnits(unsigned int workUnits)
+    {
+        mWorkUnits = workUnits;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void LoadActor::SetMessagesPerTick(unsigned int messagesPerTick)
+    {
+        mMessagesPerTick = messagesPerTick;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trStart/LoadDirector.h>
+
+namespace trStart
+{
+    const trUtil::RefStr LoadDirector::CLASS_TYPE("trStart::LoadDirector");
+
+    //////////////////////////////////////////////////////////////////////////
+    LoadDirector::LoadDirector(const std::string& name) : BaseClass(name)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    LoadDirector::~LoadDirector()
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void LoadDirector::OnMessage(const trManager::MessageBase& msg)
+    {
+        ++mMessageCount;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    unsigned long long LoadDirector::GetMessageCount() const
+    {
+        return mMessageCount;
+    }
+}
\ No newline at end of file
@@ -22,107 +22,88 @@
 #ifndef Main_CPP
 #define Main_CPP
 
-//#include <osgViewer/GraphicsWindow>
-
-//#include <dtGame/gameapplication.h>
-//#include <dtUtil/datapathutils.h>
-//#include <dtUtil/log.h>
-
-//#include <trUtil\WindowCtr.h>
+#include <trStart/ScenarioRunner.h>
+#include <trUtil/Logging/Log.h>
+#include <trUtil/Metrics/MetricsServer.h>
 
 #include <iostream>
+#include <cstdlib>
+#include <string>
 
-int main(int argc, char** argv)
+//////////////////////////////////////////////////////////////////////////
+static void PrintUsage()
 {
-    ////Set Log File Options (need to have this 2x...there is a bug)
-    //dtUtil::LogFile::SetFileName("VRSimLog.html");
-
-    //dtUtil::LogFile::SetTitle("VR-Sim Lab Log File");
-    //
-    ////Set the Maximum level of Log msg outputs
-    //#ifdef _DEBUG
-    //dtUtil::Log::GetInstance().SetAllLogLevels(dtUtil::Log::LOG_DEBUG);
-    //#else
-    //dtUtil::Log::GetInstance().SetAllLogLevels(dtUtil::Log::LOG_ERROR);
-    //#endif
-    //
-    //
-    //// Setup the aplicatin search paths...
-    //std::string dataPath = dtUtil::GetDeltaDataPathList();
-    //std::string deltaPath = dtUtil::GetDeltaRootPath();
-
-    //dtUtil::SetDataFilePathList(dataPath + ";" +
-    //                            //dtCore::GetDeltaRootPath() + "/examples/data;" +
-    //                            //dtCore::GetDeltaRootPath() + "/examples/data/gui/imagesets;" +
-    //                            //dtCore::GetDeltaRootPath() + "/examples/data/gui/schemes;" +
-    //                            //dtCore::GetDeltaRootPath() + "/examples/data/gui/fonts;" +
-    //                            //dtCore::GetDeltaRootPath() + "/examples/data/gui/looknfeel;" +
-    //                            deltaPath + "./;" +
-    //                            deltaPath + "/Bin;" +
-    //                            deltaPath + "/Bin/Data;" +
-    //                            deltaPath + "/Bin/Content;" +
-    //                            deltaPath + "/Bin/Content/Data;" +
-    //                            deltaPath + "/Bin/Content/maps;" +
-    //                            deltaPath + "/Bin/Content/Particles;" +
-    //                            deltaPath + "/Bin/Content/Prefabs;" +
-    //                            deltaPath + "/Bin/Content/StaticMeshes;" +
-    //                            deltaPath + "/Bin/Content/Terrains;" +
-    //                            deltaPath + "/Bin/Content/Textures");
-
-    //LOG_INFO("Path list is: " + dtUtil::GetDataFilePathList() );
-
-    ////Set the Config File name
-    //std::string configFileName(deltaPath + "/Bin/config.xml");
-
- //  ///////////////-----New-----/////////////
- //  /*
- //  dtCore::DeltaWin::DeltaWinTraits deltaTraits;
- //  deltaTraits.name = "My Huuuuuuge Window";
- //  deltaTraits.x = 100;
- //  deltaTraits.y = 100;
- //  deltaTraits.width = 800;
- //  deltaTraits.height = 800;
- //  deltaTraits.showCursor = true;
- //  deltaTraits.fullScreen = false;
- //  deltaTraits.realizeUponCreate = false;
- //  deltaTraits.inheritedWindowData = nullptr;
- //  deltaTraits.contextToShare = nullptr;
- //  deltaTraits.vsync = false;
-
-
- //  dtCore::RefPtr<dtCore::DeltaWin> mWin = new dtCore::DeltaWin(deltaTraits);
-
- //  //wglSwapIntervalEXT(0); */
- //  ///////////////-----New-----/////////////
-    //try
-    //{
-    //    //Create our Window Controller
-    //    osg::ref_ptr<trUtil::WindowCtr> WinCtr = trUtil::WindowCtr::GetInstance();
-
-    //    //Create our Application Class
-    //    osg::ref_ptr <dtGame::GameApplication> app = WinCtr->CreateApp(argc, argv, configFileName);
-
-    //    app->SetGameLibraryName("trCore");
-    //    app->Config();
-    //    app->Run();
-    //    app = nullptr;
-
-    //    std::cerr << "\n\nVR-Sim Lab is now shutting down ... " << std::endl;
-    //}
-    //catch (const dtUtil::Exception& ex)
-    //{
-    //    ex.LogException(dtUtil::Log::LOG_ERROR);
-
-    //    #ifdef _DEBUG
-    //        system("pause");
-    //    #endif
-
-    //    return -1;
-    //}
+    std::cerr << "Usage: trStart <scenario.json> [--frames N] [--sim-seconds S] [--dt D] [--metrics-port P]" << std::endl;
+}
 
-    //#ifdef _DEBUG
-    //    system("pause");
-    //#endif
+//////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    trStart::ScenarioRunner runner;
+    if (!runner.LoadScenario(argv[1]))
+    {
+        std::cerr << "Unable to load the scenario: " << argv[1] << std::endl;
+        return -1;
+    }
+
+    //Serves the engine metrics on localhost while the scenario runs, if asked for
+    trUtil::Metrics::MetricsServer metricsServer;
+
+    //Command line options override the scenario file, the limits together, so a scenario frame
+    //limit does not cut a --sim-seconds run short
+    bool hasRunLimit = false;
+    unsigned int frameLimit = 0;
+    double simTimeLimit = 0.;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            PrintUsage();
+            return -1;
+        }
+
+        if (arg == "--frames")
+        {
+            frameLimit = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            hasRunLimit = true;
+        }
+        else if (arg == "--sim-seconds")
+        {
+            simTimeLimit = std::strtod(argv[++i], nullptr);
+            hasRunLimit = true;
+        }
+        else if (arg == "--dt")
+        {
+            runner.SetFixedDeltaTime(std::strtod(argv[++i], nullptr));
+        }
+        else if (arg == "--metrics-port")
+        {
+            if (!metricsServer.Start(static_cast<unsigned short>(std::strtoul(argv[++i], nullptr, 10))))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    if (hasRunLimit)
+    {
+        runner.SetRunLimits(frameLimit, simTimeLimit);
+    }
+
+    trStart::ScenarioRunner::Report report = runner.Run();
+    trStart::ScenarioRunner::PrintReport(report, std::cout);
 
     return 0;
 }
@@ -0,0 +1,280 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trStart/ScenarioRunner.h>
+
+#include <trStart/LoadDirector.h>
+#include <trStart/LoadActor.h>
+#include <trManager/DirectorPriority.h>
+#include <trManager/DirectorBase.h>
+#include <trUtil/JSON/Array.h>
+#include <trUtil/JSON/File.h>
+#include <trUtil/StringUtils.h>
+#include <trUtil/Logging/Log.h>
+#include <trUtil/Timer.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <iomanip>
+
+namespace trStart
+{
+    const std::string ScenarioRunner::FRAMES_KEY = "Frames";
+    const std::string ScenarioRunner::SIM_SECONDS_KEY = "SimSeconds";
+    const std::string ScenarioRunner::FIXED_DELTA_TIME_KEY = "FixedDeltaTime";
+    const std::string ScenarioRunner::MESSAGE_TIME_BUDGET_KEY = "MessageTimeBudget";
+    const std::string ScenarioRunner::DIRECTORS_KEY = "Directors";
+    const std::string ScenarioRunner::ACTORS_KEY = "Actors";
+    const std::string ScenarioRunner::TYPE_KEY = "Type";
+    const std::string ScenarioRunner::NAME_KEY = "Name";
+    const std::string ScenarioRunner::COUNT_KEY = "Count";
+    const std::string ScenarioRunner::PRIORITY_KEY = "Priority";
+    const std::string ScenarioRunner::TICK_RATE_KEY = "TickRate";
+
+    const double ScenarioRunner::DEFAULT_FIXED_DELTA_TIME = 1. / 60.;
+    const unsigned int ScenarioRunner::DEFAULT_FRAMES = 1000;
+
+    //////////////////////////////////////////////////////////////////////////
+    ScenarioRunner::ScenarioRunner()
+    {
+        //The runner gets its own world, so it does not depend on the state of the default one
+        mSysMan = new trManager::SystemManager("ScenarioRunner");
+
+        mSysDirector = new trCore::SystemDirector();
+        mSysDirector->SetFixedDeltaTime(DEFAULT_FIXED_DELTA_TIME);
+        mSysMan->RegisterDirector(*mSysDirector, trManager::DirectorPriority::HIGHEST);
+
+        //Built in synthetic load types
+        RegisterEntityType(LoadDirector::CLASS_TYPE, [](const std::string& name, const trUtil::JSON::Object& settings) -> trManager::EntityBase*
+        {
+            return new LoadDirector(name);
+        });
+
+        RegisterEntityType(LoadActor::CLASS_TYPE, [](const std::string& name, const trUtil::JSON::Object& settings) -> trManager::EntityBase*
+        {
+            LoadActor* actor = new LoadActor(name);
+            if (settings.IsUInt("WorkUnits"))
+            {
+                actor->SetWorkUnits(settings.GetUInt("WorkUnits"));
+            }
+            if (settings.IsUInt("MessagesPerTick"))
+            {
+                actor->SetMessagesPerTick(settings.GetUInt("MessagesPerTick"));
+            }
+            return actor;
+        });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ScenarioRunner::~ScenarioRunner()
+    {
+        mSysMan->ShutDown();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ScenarioRunner::RegisterEntityType(const std::string& type, EntityCreator creator)
+    {
+        mEntityCreators[type] = creator;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ScenarioRunner::LoadScenario(const std::string& fileName)
+    {
+        //The JSON File class keeps the path and the name separately
+        trUtil::JSON::File file(osgDB::getSimpleFileName(fileName));
+        std::string filePath = osgDB::getFilePath(fileName);
+        file.SetFilePath(filePath.empty() ? "." : filePath);
+
+        if (!file.ReadFromFile())
+        {
+            LOG_E("Unable to read the scenario file: " + fileName)
+            return false;
+        }
+
+        //Run settings
+        if (file.IsUInt(FRAMES_KEY))
+        {
+            SetFrameLimit(file.GetUInt(FRAMES_KEY));
+        }
+        if (file.IsNumber(SIM_SECONDS_KEY))
+        {
+            SetSimTimeLimit(file.GetDouble(SIM_SECONDS_KEY));
+        }
+        if (file.IsNumber(FIXED_DELTA_TIME_KEY))
+        {
+            SetFixedDeltaTime(file.GetDouble(FIXED_DELTA_TIME_KEY));
+        }
+        if (file.IsNumber(MESSAGE_TIME_BUDGET_KEY))
+        {
+            mSysMan->SetMessageTimeBudget(file.GetDouble(MESSAGE_TIME_BUDGET_KEY));
+        }
+
+        //Create the Directors first, so they are in place when the Actors get registered
+        const std::string* keys[] = { &DIRECTORS_KEY, &ACTORS_KEY };
+        for (const std::string* key : keys)
+        {
+            if (file.IsArray(*key))
+            {
+                trUtil::JSON::Array entities = file.GetArray(*key);
+                for (int i = 0; i < entities.Size(); ++i)
+                {
+                    if (!entities.IsObject(i) || !CreateEntities(entities.GetObject(i), key == &DIRECTORS_KEY))
+                    {
+                        LOG_E("Invalid entry #" + trUtil::StringUtils::ToString<int>(i) + " in the " + *key + " list of scenario: " + fileName)
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ScenarioRunner::CreateEntities(const trUtil::JSON::Object& settings, bool isDirector)
+    {
+        if (!settings.IsString(TYPE_KEY))
+        {
+            return false;
+        }
+
+        std::string type = settings.GetString(TYPE_KEY);
+        std::map<std::string, EntityCreator>::const_iterator creatorIt = mEntityCreators.find(type);
+        if (creatorIt == mEntityCreators.end())
+        {
+            LOG_E("Unknown entity type in scenario: " + type)
+            return false;
+        }
+
+        std::string name = settings.IsString(NAME_KEY) ? settings.GetString(NAME_KEY) : type;
+        unsigned int count = settings.IsUInt(COUNT_KEY) ? settings.GetUInt(COUNT_KEY) : 1;
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            //Directors need unique names
+            std::string entityName = count > 1 ? name + trUtil::StringUtils::ToString<unsigned int>(i) : name;
+            trBase::SmrtPtr<trManager::EntityBase> entity = creatorIt->second(entityName, settings);
+            if (!entity.Valid())
+            {
+                return false;
+            }
+
+            if (isDirector)
+            {
+                if (entity->GetEntityType() != trManager::EntityType::DIRECTOR)
+                {
+                    LOG_E("The scenario Director: " + entityName + " is not a Director.")
+                    return false;
+                }
+
+                trManager::DirectorPriority* priority = &trManager::DirectorPriority::NORMAL;
+                if (settings.IsString(PRIORITY_KEY))
+                {
+                    priority = trManager::DirectorPriority::GetValueForName(settings.GetString(PRIORITY_KEY));
+                    if (priority == nullptr)
+                    {
+                        LOG_E("Unknown Director priority: " + settings.GetString(PRIORITY_KEY))
+                        return false;
+                    }
+                }
+                mSysMan->RegisterDirector(*entity, *priority);
+            }
+            else
+            {
+                mSysMan->RegisterActor(*entity);
+                if (settings.IsUInt(TICK_RATE_KEY))
+                {
+                    mSysMan->SetTickRate(*entity, settings.GetUInt(TICK_RATE_KEY));
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ScenarioRunner::SetFrameLimit(unsigned int frames)
+    {
+        mFrameLimit = frames;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ScenarioRunner::SetSimTimeLimit(double seconds)
+    {
+        mSimTimeLimit = seconds;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ScenarioRunner::SetRunLimits(unsigned int frames, double seconds)
+    {
+        SetFrameLimit(frames);
+        SetSimTimeLimit(seconds);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ScenarioRunner::SetFixedDeltaTime(double dt)
+    {
+        mSysDirector->SetFixedDeltaTime(dt > 0. ? dt : DEFAULT_FIXED_DELTA_TIME);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ScenarioRunner::Report ScenarioRunner::Run()
+    {
+        unsigned int frameLimit = mFrameLimit;
+        if (frameLimit == 0 && mSimTimeLimit <= 0.)
+        {
+            frameLimit = DEFAULT_FRAMES;
+        }
+
+        Report report;
+        trUtil::Timer timer;
+        double startSimTime = mSysDirector->GetTimeStructure().simTime;
+        unsigned long long startMessages = mSysMan->GetProcessedMessageCount();
+        trUtil::TimeTicks startTick = timer.Tick();
+
+        while ((frameLimit == 0 || report.frames < frameLimit) && 
+               (mSimTimeLimit <= 0. || report.simTime < mSimTimeLimit))
+        {
+            mSysDirector->RunOnce();
+            ++report.frames;
+            report.simTime = mSysDirector->GetTimeStructure().simTime - startSimTime;
+        }
+
+        report.realTime = timer.DeltaSec(startTick, timer.Tick());
+        report.messages = mSysMan->GetProcessedMessageCount() - startMessages;
+        return report;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ScenarioRunner::PrintReport(const Report& report, std::ostream& stream)
+    {
+        double realTime = report.realTime > 0. ? report.realTime : 1e-9;
+
+        stream << std::fixed << std::setprecision(3)
+            << "Frames:          " << report.frames << "\n"
+            << "Real time (s):   " << report.realTime << "\n"
+            << "Sim time (s):    " << report.simTime << "\n"
+            << "Messages:        " << report.messages << "\n"
+            << "Frames/s:        " << report.frames / realTime << "\n"
+            << "Sim/Real ratio:  " << report.simTime / realTime << "\n"
+            << "Messages/s:      " << report.messages / realTime << std::endl;
+    }
+}
\ No newline at end of file
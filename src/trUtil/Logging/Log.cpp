@@ -45,9 +45,63 @@ namespace trUtil
 {
     namespace Logging
     {
-        static osg::ref_ptr<LogManager> LOG_MANAGER(NULL);
+        // Never deleted, together with the Log instances it owns. The log macros keep a reference to
+        // their Log in a function local static, and can still run during and after static destruction.
+        static LogManager* LOG_MANAGER = nullptr;
+        static bool LOG_SHUT_DOWN = false;
         static LogLevel DEFAULT_LOG_LEVEL(LogLevel::LOG_WARNING);
 
+        //////////////////////////////////////////////////////////////////////////
+        // Writes out the asynchronous queue at exit, logging goes back to the calling thread after that.
+        // Created together with the Log Manager so it runs before the statics the writers depend on are destroyed.
+        // Messages logged after it ran only go to the console.
+        class LogShutdown
+        {
+        public:
+            ~LogShutdown()
+            {
+                LogRateLimiter::WriteSummaries(true);
+                LOG_MANAGER->StopLogQueue();
+                LOG_MANAGER->FlushWriters();
+                LOG_SHUT_DOWN = true;
+            }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        // Holds on to the log queue for a scope, so it can not be deleted while a message is pushed.
+        class ScopedLogQueue
+        {
+        public:
+            explicit ScopedLogQueue(LogManager& logManager)
+                : mLogManager(logManager)
+                , mLogQueue(logManager.AcquireLogQueue())
+            {
+            }
+
+            ~ScopedLogQueue()
+            {
+                mLogManager.ReleaseLogQueue();
+            }
+
+            LogQueue* Get() const
+            {
+                return mLogQueue;
+            }
+
+        private:
+            LogManager& mLogManager;
+            LogQueue* mLogQueue;
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        // Guards the creation and lookup of Log instances, so logs can be requested from several threads.
+        // Function local, so it is constructed before the first use, even during static initialization.
+        static OpenThreads::Mutex& GetInstanceMutex()
+        {
+            static OpenThreads::Mutex instanceMutex;
+            return instanceMutex;
+        }
+
         //////////////////////////////////////////////////////////////////////////
         class LogImpl //: std::stringbuf
         {
@@ -97,6 +151,15 @@ namespace trUtil
             }
 
 
+            {
+                ScopedLogQueue logQueue(*LOG_MANAGER);
+                if (logQueue.Get() != nullptr)
+                {
+                    logQueue.Get()->Push(*this, logQueue.Get()->Intern(cppFile), logQueue.Get()->Intern(method), line, msg, logLevel);
+                    return;
+                }
+            }
+
             OpenThreads::ScopedLock<OpenThreads::Mutex> lock(LOG_MANAGER->GetMutex());
             bool hasLogTimeProvider = LOG_MANAGER->IsLogTimeProviderValid();
 
@@ -118,26 +181,37 @@ namespace trUtil
             logData.line = line;
             logData.msg = msg;
 
-
-            if (trUtil::Bits::Has(mImpl->mOutputStreamBit, Log::TO_FILE))
+            if (LOG_SHUT_DOWN)
             {
-                LOG_MANAGER->LogMessageToFile(logData);
+                if (trUtil::Bits::Has(mImpl->mOutputStreamBit, Log::TO_CONSOLE))
+                {
+                    LOG_MANAGER->LogMessageToConsole(logData);
+                }
+                return;
             }
 
-            if (trUtil::Bits::Has(mImpl->mOutputStreamBit, Log::TO_CONSOLE))
+            LOG_MANAGER->LogMessage(*this, logData);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Log::LogMessage(const char* cppFile, const char* method, int line, const std::string& msg, LogLevel logLevel) const
+        {
+            if (mImpl->mOutputStreamBit == Log::NO_OUTPUT || logLevel < mImpl->mLevel)
             {
-                LOG_MANAGER->LogMessageToConsole(logData);
+                return;
             }
 
-            if (trUtil::Bits::Has(mImpl->mOutputStreamBit, Log::TO_WRITER) && !mImpl->mWriters.empty())
+            // Literals live for the whole run, so the queue can keep the pointers.
             {
-                Log::LogWriterContainer::iterator itr = mImpl->mWriters.begin();
-                while (itr != mImpl->mWriters.end())
+                ScopedLogQueue logQueue(*LOG_MANAGER);
+                if (logQueue.Get() != nullptr)
                 {
-                    (*itr)->LogMessage(logData);
-                    ++itr;
+                    logQueue.Get()->Push(*this, cppFile, method, line, msg, logLevel);
+                    return;
                 }
             }
+
+            LogMessage(std::string(cppFile), std::string(method), line, msg, logLevel);
         }
 
         //////////////////////////////////////////////////////////////////////////
@@ -184,8 +258,10 @@ namespace trUtil
                 return;
             }
 
-            if (trUtil::Bits::Has(mImpl->mOutputStreamBit, Log::TO_FILE))
+            if (trUtil::Bits::Has(mImpl->mOutputStreamBit, Log::TO_FILE) && !LOG_SHUT_DOWN)
             {
+                // Keep the rule in order with the queued messages.
+                Flush();
                 LOG_MANAGER->LogHorizRule();
             }
         }
@@ -193,9 +269,13 @@ namespace trUtil
         //////////////////////////////////////////////////////////////////////////
         Log& Log::GetInstance(const std::string& name)
         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(GetInstanceMutex());
+
             if (LOG_MANAGER == nullptr)
             {
                 LOG_MANAGER = new LogManager;
+                LOG_MANAGER->ref();
+                static LogShutdown logShutdown;
             }
 
             Log* l = LOG_MANAGER->GetInstance(name);
@@ -214,6 +294,48 @@ namespace trUtil
             return *LOG_MANAGER;
         }
 
+        //////////////////////////////////////////////////////////////////////////
+        void Log::SetAsync(bool async, AsyncOverflowPolicy policy, size_t queueSize, bool installCrashHandlers) //static
+        {
+            // Makes sure the manager exists.
+            GetInstance();
+
+            if (async)
+            {
+                LOG_MANAGER->StartLogQueue(policy, queueSize);
+                if (installCrashHandlers)
+                {
+                    LogQueue::InstallCrashHandlers();
+                }
+            }
+            else
+            {
+                LOG_MANAGER->StopLogQueue();
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool Log::IsAsync() //static
+        {
+            return LOG_MANAGER != nullptr && LOG_MANAGER->GetLogQueue() != nullptr;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Log::Flush() //static
+        {
+            // Without the log queue thread, the summaries of the rate limited call sites are written here.
+            LogRateLimiter::WriteSummaries();
+
+            if (LOG_MANAGER != nullptr)
+            {
+                ScopedLogQueue logQueue(*LOG_MANAGER);
+                if (logQueue.Get() != nullptr)
+                {
+                    logQueue.Get()->Flush();
+                }
+            }
+        }
+
         //////////////////////////////////////////////////////////////////////////
         void Log::SetDefaultLogLevel(LogLevel newLevel)
         {
@@ -241,7 +363,7 @@ namespace trUtil
         ///////////////////////////////////////////////////////////////////////////
         void Log::SetAllOutputStreamBits(unsigned int option)
         {
-            if (LOG_MANAGER.valid())
+            if (LOG_MANAGER != nullptr)
             {
                 LOG_MANAGER->SetAllOutputStreamBits(option);
             }
@@ -280,7 +402,7 @@ namespace trUtil
         ////////////////////////////////////////////////////////////////////////////////
         void Log::SetAllLogLevels(LogLevel newLevel) //static
         {
-            if (LOG_MANAGER.valid())
+            if (LOG_MANAGER != nullptr)
             {
                 LOG_MANAGER->SetAllLogLevels(newLevel);
             }
@@ -289,7 +411,7 @@ namespace trUtil
         ////////////////////////////////////////////////////////////////////////////////
         void Log::SetLogTimeProvider(LogTimeProvider* ltp)
         {
-            if (LOG_MANAGER.valid())
+            if (LOG_MANAGER != nullptr)
             {
                 LOG_MANAGER->SetLogTimeProvider(ltp);
 
@@ -42,6 +42,7 @@ namespace trUtil
 #endif
 
         const std::string LogFile::LOG_FILE_DEFAULT_NAME("TrueRealityLog.html");
+        const std::string LogFile::BINARY_FILE_EXTENSION(".trlog");
         std::string LogFile::mLogFileName = LOG_FILE_DEFAULT_NAME;
 
         //////////////////////////////////////////////////////////////////////////
@@ -63,6 +64,13 @@ namespace trUtil
             return mLogFileName;
         }
 
+        //////////////////////////////////////////////////////////////////////////
+        bool LogFile::IsBinary()
+        {
+            return mLogFileName.size() >= BINARY_FILE_EXTENSION.size() &&
+                mLogFileName.compare(mLogFileName.size() - BINARY_FILE_EXTENSION.size(), BINARY_FILE_EXTENSION.size(), BINARY_FILE_EXTENSION) == 0;
+        }
+
         //////////////////////////////////////////////////////////////////////////
         void LogFile::SetTitle(const std::string& title)
         {
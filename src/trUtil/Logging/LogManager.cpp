@@ -25,9 +25,13 @@
 */
 #include <trUtil/Logging/LogManager.h>
 
+#include <trUtil/Bits.h>
 #include <trUtil/Logging/LogWriterConsole.h>
 
+#include <OpenThreads/ScopedLock>
+
 #include <algorithm>
+#include <thread>
 
 namespace trUtil
 {
@@ -37,27 +41,34 @@ namespace trUtil
         LogManager::LogManager()
             : mLogWriterConsole(new LogWriterConsole())
             , mLogWriterFile(new LogWriterFile())
+            , mLogWriterBinary(new LogWriterBinary())
             , mLogTimeProvider(nullptr)
+            , mLogQueue(nullptr)
+            , mLogQueueUsers(0)
         {
         }
 
         ////////////////////////////////////////////////////////////////
         LogManager::~LogManager()
         {
+            StopLogQueue();
             mInstances.clear();
             mLogWriterConsole = nullptr;
             mLogWriterFile = nullptr;
+            mLogWriterBinary = nullptr;
         }
 
         ////////////////////////////////////////////////////////////////
         bool LogManager::AddInstance(const std::string& name, Log* log)
         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mInstancesMutex);
             return mInstances.insert(std::make_pair(name, osg::ref_ptr<Log>(log))).second;
         }
 
         ////////////////////////////////////////////////////////////////
         Log* LogManager::GetInstance(const std::string& name)
         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mInstancesMutex);
             trUtil::HashMap<std::string, osg::ref_ptr<Log> >::iterator i = mInstances.find(name);
             if (i == mInstances.end())
             {
@@ -69,6 +80,7 @@ namespace trUtil
         ////////////////////////////////////////////////////////////////
         void LogManager::SetAllLogLevels(const LogLevel& newLevel)
         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mInstancesMutex);
             std::for_each(mInstances.begin(), mInstances.end(), [this, &newLevel](trUtil::HashMap<std::string, osg::ref_ptr<Log> >::value_type& value)
             {
                 Log* log = value.second.get();
@@ -79,6 +91,7 @@ namespace trUtil
         ////////////////////////////////////////////////////////////////
         void LogManager::SetAllOutputStreamBits(unsigned int option)
         {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mInstancesMutex);
             std::for_each(mInstances.begin(), mInstances.end(), [this, option](trUtil::HashMap<std::string, osg::ref_ptr<Log> >::value_type& value)
             {
                 Log* log = value.second.get();
@@ -95,20 +108,42 @@ namespace trUtil
         ////////////////////////////////////////////////////////////////
         void LogManager::ReOpenFile()
         {
-            mLogWriterFile->ResetOpenFail();
-            mLogWriterFile->OpenFile();
+            if (LogFile::IsBinary())
+            {
+                mLogWriterBinary->ResetOpenFail();
+                mLogWriterBinary->OpenFile();
+            }
+            else
+            {
+                mLogWriterFile->ResetOpenFail();
+                mLogWriterFile->OpenFile();
+            }
         }
 
         ////////////////////////////////////////////////////////////////
         void LogManager::LogHorizRule()
         {
-            mLogWriterFile->LogHorizRule();
+            if (LogFile::IsBinary())
+            {
+                mLogWriterBinary->LogHorizRule();
+            }
+            else
+            {
+                mLogWriterFile->LogHorizRule();
+            }
         }
 
         ////////////////////////////////////////////////////////////////
         void LogManager::LogMessageToFile(const LogWriter::LogData& logData)
         {
-            mLogWriterFile->LogMessage(logData);
+            if (LogFile::IsBinary())
+            {
+                mLogWriterBinary->LogMessage(logData);
+            }
+            else
+            {
+                mLogWriterFile->LogMessage(logData);
+            }
         }
 
         ////////////////////////////////////////////////////////////////
@@ -117,6 +152,99 @@ namespace trUtil
             mLogWriterConsole->LogMessage(logData);
         }
 
+        ////////////////////////////////////////////////////////////////
+        void LogManager::LogMessage(const Log& log, const LogWriter::LogData& logData)
+        {
+            unsigned int outputStreamBit = log.GetOutputStreamBit();
+
+            if (trUtil::Bits::Has(outputStreamBit, Log::TO_FILE))
+            {
+                LogMessageToFile(logData);
+            }
+
+            if (trUtil::Bits::Has(outputStreamBit, Log::TO_CONSOLE))
+            {
+                LogMessageToConsole(logData);
+            }
+
+            if (trUtil::Bits::Has(outputStreamBit, Log::TO_WRITER))
+            {
+                const Log::LogWriterContainer& writers = log.GetWriters();
+                for (const osg::ref_ptr<LogWriter>& writer : writers)
+                {
+                    writer->LogMessage(logData);
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////
+        void LogManager::FlushWriters()
+        {
+            mLogWriterFile->Flush();
+            mLogWriterBinary->Flush();
+            mLogWriterConsole->Flush();
+
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mInstancesMutex);
+            for (auto& instance : mInstances)
+            {
+                for (const osg::ref_ptr<LogWriter>& writer : instance.second->GetWriters())
+                {
+                    writer->Flush();
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////
+        void LogManager::StartLogQueue(unsigned int overflowPolicy, size_t queueSize)
+        {
+            StopLogQueue();
+
+            // The queue flushes after every batch, and on a crash.
+            mLogWriterFile->SetFlushEachMessage(false);
+            mLogWriterBinary->SetFlushEachMessage(false);
+            mLogQueue.store(new LogQueue(*this, overflowPolicy, queueSize));
+        }
+
+        ////////////////////////////////////////////////////////////////
+        void LogManager::StopLogQueue()
+        {
+            LogQueue* logQueue = mLogQueue.exchange(nullptr);
+            if (logQueue != nullptr)
+            {
+                // Release the threads waiting on a full ring, then wait for every thread that got
+                // the queue before the exchange to be done with it.
+                logQueue->Stop();
+                while (mLogQueueUsers.load() != 0)
+                {
+                    std::this_thread::yield();
+                }
+
+                delete logQueue;
+                mLogWriterFile->SetFlushEachMessage(true);
+                mLogWriterBinary->SetFlushEachMessage(true);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////
+        LogQueue* LogManager::GetLogQueue() const
+        {
+            return mLogQueue.load(std::memory_order_acquire);
+        }
+
+        ////////////////////////////////////////////////////////////////
+        LogQueue* LogManager::AcquireLogQueue()
+        {
+            // Counted before the queue is read, so StopLogQueue either sees this thread or this thread sees null.
+            mLogQueueUsers.fetch_add(1);
+            return mLogQueue.load();
+        }
+
+        ////////////////////////////////////////////////////////////////
+        void LogManager::ReleaseLogQueue()
+        {
+            mLogQueueUsers.fetch_sub(1);
+        }
+
         ////////////////////////////////////////////////////////////////
         void LogManager::SetLogTimeProvider(LogTimeProvider* ltp)
         {
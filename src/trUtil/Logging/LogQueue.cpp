@@ -0,0 +1,475 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#include <trUtil/Logging/LogQueue.h>
+
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/Logging/Log.h>
+#include <trUtil/Logging/LogManager.h>
+
+#include <osgDB/FileNameUtils>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        const size_t LogQueue::INLINE_MESSAGE_SIZE;
+        const int LogQueue::WRITE_INTERVAL_MS;
+
+        static std::atomic<unsigned int> NEXT_GENERATION(1);
+
+        // The queue the terminate handler flushes. There is only one, owned by the Log Manager.
+        static std::atomic<LogQueue*> ACTIVE_QUEUE(nullptr);
+
+        static std::atomic<bool> CRASH_HANDLERS_INSTALLED(false);
+        static std::terminate_handler PREVIOUS_TERMINATE_HANDLER = nullptr;
+
+        //////////////////////////////////////////////////////////////////////////
+        // Takes the queue away first, so a crash inside the flush does not try again.
+        static void FlushActiveQueue()
+        {
+            LogQueue* queue = ACTIVE_QUEUE.exchange(nullptr);
+            if (queue != nullptr)
+            {
+                queue->FlushFromCrash();
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        static void OnTerminate()
+        {
+            FlushActiveQueue();
+
+            if (PREVIOUS_TERMINATE_HANDLER != nullptr)
+            {
+                PREVIOUS_TERMINATE_HANDLER();
+            }
+            std::abort();
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogQueue::LogQueue(LogManager& logManager, unsigned int overflowPolicy, size_t ringSize)
+            : mLogManager(logManager)
+            , mOverflowPolicy(overflowPolicy)
+            , mRingSize(ringSize)
+            , mGeneration(NEXT_GENERATION.fetch_add(1))
+            , mLastTime(0)
+            , mDrainThread(std::thread::id())
+            , mRunning(true)
+            , mDroppedCount(0)
+            , mWrittenCount(0)
+        {
+            // Calibrate the time stamps now, instead of stalling the writer on its first batch.
+            trUtil::Timer::GetFastTicksPerSecond();
+
+            mThread = std::thread(&LogQueue::Run, this);
+            ACTIVE_QUEUE.store(this);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogQueue::~LogQueue()
+        {
+            Stop();
+
+            std::lock_guard<std::mutex> lock(mDrainMutex);
+            Drain(true);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::Stop()
+        {
+            LogQueue* self = this;
+            ACTIVE_QUEUE.compare_exchange_strong(self, nullptr);
+
+            mRunning.store(false);
+            mWakeCondition.notify_all();
+            if (mThread.joinable())
+            {
+                mThread.join();
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::Push(const Log& log, const char* file, const char* method, int line, const std::string& msg, LogLevel logLevel)
+        {
+            ThreadRing& threadRing = GetThreadRing();
+
+            // The scratch record belongs to this thread, so filling it in does not allocate.
+            Record& record = threadRing.scratch;
+            record.log = &log;
+            record.file = file;
+            record.method = method;
+            record.line = line;
+            record.logLevel = logLevel;
+            record.ticks = trUtil::Timer::FastTick();
+            record.fromTimeProvider = mLogManager.IsLogTimeProviderValid();
+            if (record.fromTimeProvider)
+            {
+                record.frameNumber = mLogManager.GetFrameNumber();
+                record.providerTime = mLogManager.GetDateTime();
+            }
+            else
+            {
+                record.frameNumber = 0;
+            }
+
+            if (msg.size() <= INLINE_MESSAGE_SIZE)
+            {
+                std::memcpy(record.msg, msg.data(), msg.size());
+                record.msgLength = msg.size();
+                record.longMsg.clear();
+            }
+            else
+            {
+                record.msgLength = 0;
+                record.longMsg = msg;
+            }
+
+            if (threadRing.ring.TryPush(std::move(record)))
+            {
+                // The writer polls, only wake it early if the ring is filling up.
+                if (threadRing.ring.Size() > threadRing.ring.Capacity() / 2)
+                {
+                    mWakeCondition.notify_one();
+                }
+                return;
+            }
+
+            // The writer can not wait on itself, so it always drops. Once the queue stops no one
+            // makes room anymore, so a waiting record is dropped as well.
+            if (mOverflowPolicy == Log::ASYNC_BLOCK && mDrainThread.load() != std::this_thread::get_id())
+            {
+                while (mRunning.load())
+                {
+                    mWakeCondition.notify_one();
+                    std::this_thread::yield();
+                    if (threadRing.ring.TryPush(std::move(record)))
+                    {
+                        return;
+                    }
+                }
+            }
+
+            threadRing.dropped.fetch_add(1, std::memory_order_relaxed);
+            mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        const char* LogQueue::Intern(const std::string& text)
+        {
+            // Each thread remembers the strings it already interned, so the lock is only taken the
+            // first time a thread logs from a source.
+            struct InternCache
+            {
+                unsigned int generation = 0;
+                std::unordered_map<std::string, const char*> strings;
+            };
+            static thread_local InternCache cache;
+
+            if (cache.generation != mGeneration)
+            {
+                cache.strings.clear();
+                cache.generation = mGeneration;
+            }
+
+            std::unordered_map<std::string, const char*>::const_iterator found = cache.strings.find(text);
+            if (found != cache.strings.end())
+            {
+                return found->second;
+            }
+
+            const char* interned = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mInternMutex);
+                interned = mInterned.insert(text).first->c_str();
+            }
+            cache.strings.emplace(text, interned);
+            return interned;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::Flush()
+        {
+            if (mDrainThread.load() == std::this_thread::get_id())
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mDrainMutex);
+            mDrainThread.store(std::this_thread::get_id());
+            Drain(true);
+            mDrainThread.store(std::thread::id());
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::FlushFromCrash()
+        {
+            // Crashed while writing, the rings are in an unknown state.
+            if (mDrainThread.load() == std::this_thread::get_id())
+            {
+                return;
+            }
+
+            // Give the writer thread a moment to finish its batch.
+            bool locked = mDrainMutex.try_lock();
+            for (int i = 0; i < 100 && !locked; ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                locked = mDrainMutex.try_lock();
+            }
+
+            if (!locked)
+            {
+                return;
+            }
+
+            mDrainThread.store(std::this_thread::get_id());
+            Drain(false);
+            mDrainThread.store(std::thread::id());
+            mDrainMutex.unlock();
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        unsigned long long LogQueue::GetDroppedCount() const
+        {
+            return mDroppedCount.load(std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        unsigned long long LogQueue::GetWrittenCount() const
+        {
+            return mWrittenCount.load(std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::InstallCrashHandlers()
+        {
+            if (CRASH_HANDLERS_INSTALLED.exchange(true))
+            {
+                return;
+            }
+
+            PREVIOUS_TERMINATE_HANDLER = std::set_terminate(OnTerminate);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogQueue::ThreadRing& LogQueue::GetThreadRing()
+        {
+            // Marks the ring as closed when the thread exits, so the writer can drop it once it is empty.
+            struct ThreadRingCache
+            {
+                ~ThreadRingCache()
+                {
+                    if (ring != nullptr)
+                    {
+                        ring->closed.store(true, std::memory_order_release);
+                    }
+                }
+
+                unsigned int generation = 0;
+                std::shared_ptr<ThreadRing> ring;
+            };
+            static thread_local ThreadRingCache cache;
+
+            if (cache.generation != mGeneration || cache.ring == nullptr)
+            {
+                if (cache.ring != nullptr)
+                {
+                    cache.ring->closed.store(true, std::memory_order_release);
+                }
+
+                cache.ring = std::make_shared<ThreadRing>(mRingSize);
+                cache.generation = mGeneration;
+
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                mRings.push_back(cache.ring);
+            }
+            return *cache.ring;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::Run()
+        {
+            while (mRunning.load())
+            {
+                // Rate limited call sites whose storm stopped still report what they held back.
+                LogRateLimiter::WriteSummaries();
+
+                size_t written = 0;
+                {
+                    std::lock_guard<std::mutex> lock(mDrainMutex);
+                    mDrainThread.store(std::this_thread::get_id());
+                    written = Drain(true);
+                    mDrainThread.store(std::thread::id());
+                }
+
+                if (written == 0)
+                {
+                    std::unique_lock<std::mutex> lock(mWakeMutex);
+                    mWakeCondition.wait_for(lock, std::chrono::milliseconds(WRITE_INTERVAL_MS));
+                }
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        size_t LogQueue::Drain(bool lockManager)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                mDrainRings = mRings;
+            }
+
+            size_t count = 0;
+            unsigned long long dropped = 0;
+            bool hasClosedRings = false;
+            for (const std::shared_ptr<ThreadRing>& threadRing : mDrainRings)
+            {
+                // Read before popping, so a closed ring is known to be complete once it is empty.
+                hasClosedRings = threadRing->closed.load(std::memory_order_acquire) || hasClosedRings;
+
+                // Do not chase a thread that keeps logging, take what was there when we started.
+                size_t available = threadRing->ring.Size();
+                for (size_t i = 0; i < available; ++i)
+                {
+                    if (count == mBatch.size())
+                    {
+                        mBatch.emplace_back();
+                    }
+
+                    if (!threadRing->ring.TryPop(mBatch[count]))
+                    {
+                        break;
+                    }
+                    ++count;
+                }
+
+                unsigned long long ringDropped = threadRing->dropped.load(std::memory_order_relaxed);
+                dropped += ringDropped - threadRing->reportedDropped;
+                threadRing->reportedDropped = ringDropped;
+            }
+
+            if (hasClosedRings)
+            {
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                mRings.erase(std::remove_if(mRings.begin(), mRings.end(), [](const std::shared_ptr<ThreadRing>& threadRing)
+                {
+                    return threadRing->closed.load(std::memory_order_acquire) && threadRing->ring.IsEmpty();
+                }), mRings.end());
+            }
+            mDrainRings.clear();
+
+            if (count == 0 && dropped == 0)
+            {
+                return 0;
+            }
+
+            // Merge the threads back into the order the messages were logged in.
+            mBatchOrder.resize(count);
+            std::iota(mBatchOrder.begin(), mBatchOrder.end(), 0);
+            std::stable_sort(mBatchOrder.begin(), mBatchOrder.end(), [this](size_t lhs, size_t rhs)
+            {
+                return mBatch[lhs].ticks < mBatch[rhs].ticks;
+            });
+
+            std::unique_lock<OpenThreads::Mutex> lock(mLogManager.GetMutex(), std::defer_lock);
+            if (lockManager)
+            {
+                lock.lock();
+            }
+
+            for (size_t index : mBatchOrder)
+            {
+                WriteRecord(mBatch[index]);
+            }
+
+            if (dropped > 0)
+            {
+                std::ostringstream msg;
+                msg << "Dropped " << dropped << " log messages because the log queue was full.";
+
+                mLogData.logLevel = LogLevel::LOG_WARNING;
+                mLogData.time.SetToLocalTime();
+                mLogData.frameNumber = 0;
+                mLogData.logName = Log::LOG_DEFAULT_NAME;
+                mLogData.file.clear();
+                mLogData.method.clear();
+                mLogData.line = 0;
+                mLogData.msg = msg.str();
+                mLogManager.LogMessageToFile(mLogData);
+                mLogManager.LogMessageToConsole(mLogData);
+            }
+
+            mLogManager.FlushWriters();
+            mWrittenCount.fetch_add(count, std::memory_order_relaxed);
+            return count;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogQueue::WriteRecord(const Record& record)
+        {
+            if (record.fromTimeProvider)
+            {
+                mLogData.frameNumber = record.frameNumber;
+                mLogData.time = record.providerTime;
+            }
+            else
+            {
+                // Most of a batch shares the same second, so only convert when it changes.
+                double epochSeconds = trUtil::Timer::FastTickToEpochSeconds(record.ticks);
+                double wholeSeconds = std::floor(epochSeconds);
+                std::time_t recordTime = static_cast<std::time_t>(wholeSeconds);
+                if (recordTime != mLastTime)
+                {
+                    mLastLocalTime = trUtil::Timer::FastTickToDateTime(record.ticks);
+                    mLastTime = recordTime;
+                }
+                mLogData.frameNumber = 0;
+                mLogData.time = mLastLocalTime;
+                mLogData.time.SetSecond(std::floor(mLastLocalTime.GetSecond()) + static_cast<float>(epochSeconds - wholeSeconds));
+            }
+
+            mLogData.logLevel = record.logLevel;
+            mLogData.logName = record.log->GetName();
+            mLogData.file = osgDB::getSimpleFileName(record.file);
+            mLogData.method = record.method;
+            mLogData.line = record.line;
+            if (record.longMsg.empty())
+            {
+                mLogData.msg.assign(record.msg, record.msgLength);
+            }
+            else
+            {
+                mLogData.msg = record.longMsg;
+            }
+
+            mLogManager.LogMessage(*record.log, mLogData);
+        }
+    }
+}
\ No newline at end of file
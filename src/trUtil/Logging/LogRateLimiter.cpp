@@ -0,0 +1,191 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#include <trUtil/Logging/LogRateLimiter.h>
+
+#include <trUtil/Logging/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        const long long LogRateLimiter::WINDOW_LENGTH_MS;
+
+        // The limiters that write summaries. Never deleted, the log macros keep their limiters in
+        // function local statics, which can be destroyed after any other static.
+        static std::mutex& GetLimitersMutex()
+        {
+            static std::mutex* limitersMutex = new std::mutex();
+            return *limitersMutex;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        static std::vector<LogRateLimiter*>& GetLimiters()
+        {
+            static std::vector<LogRateLimiter*>* limiters = new std::vector<LogRateLimiter*>();
+            return *limiters;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogRateLimiter::LogRateLimiter(unsigned int maxPerSecond)
+            : mMaxPerSecond(maxPerSecond)
+            , mWindowStart(GetTimeMilliseconds())
+            , mWindowCount(0)
+            , mSuppressedCount(0)
+        {
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogRateLimiter::LogRateLimiter(unsigned int maxPerSecond, Log& log, LogLevel logLevel, const char* cppFile, const char* method, int line)
+            : LogRateLimiter(maxPerSecond)
+        {
+            mLog = &log;
+            mLogLevel = logLevel;
+            mFile = cppFile;
+            mMethod = method;
+            mLine = line;
+
+            std::lock_guard<std::mutex> lock(GetLimitersMutex());
+            GetLimiters().push_back(this);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogRateLimiter::~LogRateLimiter()
+        {
+            if (mLog != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(GetLimitersMutex());
+                std::vector<LogRateLimiter*>& limiters = GetLimiters();
+                limiters.erase(std::remove(limiters.begin(), limiters.end(), this), limiters.end());
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool LogRateLimiter::Allow(unsigned long long& suppressedCount)
+        {
+            return Allow(suppressedCount, GetTimeMilliseconds());
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool LogRateLimiter::Allow(unsigned long long& suppressedCount, long long now)
+        {
+            suppressedCount = 0;
+
+            // Whoever moves the window forward starts the new count. A few extra messages can get
+            // through while threads race on the reset, which is fine for a log.
+            long long windowStart = mWindowStart.load(std::memory_order_relaxed);
+            if (now - windowStart >= WINDOW_LENGTH_MS &&
+                mWindowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+            {
+                mWindowCount.store(0, std::memory_order_relaxed);
+            }
+
+            if (mWindowCount.fetch_add(1, std::memory_order_relaxed) < mMaxPerSecond)
+            {
+                suppressedCount = mSuppressedCount.exchange(0, std::memory_order_relaxed);
+                return true;
+            }
+
+            mSuppressedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        unsigned long long LogRateLimiter::TakeSuppressedCount(long long now)
+        {
+            // The count can only grow in the current window, so an over window has its final count.
+            if (now - mWindowStart.load(std::memory_order_relaxed) < WINDOW_LENGTH_MS || mSuppressedCount.load(std::memory_order_relaxed) == 0)
+            {
+                return 0;
+            }
+            return mSuppressedCount.exchange(0, std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogRateLimiter::WriteSummaries(bool endWindows) //static
+        {
+            // Logging a summary can wait on a full log queue, so the queue thread must never wait
+            // here for a thread that is doing the same.
+            std::unique_lock<std::mutex> lock(GetLimitersMutex(), std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                return;
+            }
+
+            long long now = GetTimeMilliseconds();
+            for (LogRateLimiter* limiter : GetLimiters())
+            {
+                unsigned long long suppressedCount = limiter->TakeSuppressedCount(endWindows ? now + WINDOW_LENGTH_MS : now);
+                if (suppressedCount > 0 && limiter->mLog->IsLevelEnabled(limiter->mLogLevel))
+                {
+                    std::ostringstream summary;
+                    summary << "Suppressed " << suppressedCount << " similar messages";
+                    limiter->mLog->LogMessage(limiter->mFile, limiter->mMethod, limiter->mLine, summary.str(), limiter->mLogLevel);
+                }
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        long long LogRateLimiter::GetTimeMilliseconds() //static
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        std::string LogRateLimiter::AddSuppressedNote(const std::string& msg, unsigned long long suppressedCount)
+        {
+            if (suppressedCount == 0)
+            {
+                return msg;
+            }
+
+            std::ostringstream note;
+            note << msg << " (suppressed " << suppressedCount << " similar messages)";
+            return note.str();
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        LogSampler::LogSampler(unsigned int sampleRate)
+            : mSampleRate(sampleRate == 0 ? 1 : sampleRate)
+            , mCount(0)
+        {
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool LogSampler::Allow(unsigned long long& suppressedCount)
+        {
+            unsigned long long count = mCount.fetch_add(1, std::memory_order_relaxed);
+            if (count % mSampleRate == 0)
+            {
+                suppressedCount = count == 0 ? 0 : mSampleRate - 1;
+                return true;
+            }
+
+            suppressedCount = 0;
+            return false;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#include <trUtil/Logging/LogReaderBinary.h>
+
+#include <trUtil/Logging/LogWriterBinary.h>
+
+#include <cstring>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        // Anything longer is treated as a broken file, rather than trying to allocate it.
+        static const uint64_t MAX_TEXT_SIZE = 64 * 1024 * 1024;
+
+        ////////////////////////////////////////////////////////////////////////////////
+        LogReaderBinary::LogReaderBinary()
+            : mDate(0)
+            , mLastMilliseconds(0)
+            , mCorrupt(false)
+        {
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogReaderBinary::Open(const std::string& filePath)
+        {
+            mFile.close();
+            mFile.clear();
+            mStrings.clear();
+            mTitle.clear();
+            mDate = 0;
+            mLastMilliseconds = 0;
+            mCorrupt = false;
+
+            mFile.open(filePath.c_str(), std::ios::in | std::ios::binary);
+            if (!mFile.is_open())
+            {
+                return false;
+            }
+
+            char magic[sizeof(LogWriterBinary::FILE_MAGIC)];
+            char version = 0;
+            if (!mFile.read(magic, sizeof(magic)) || std::memcmp(magic, LogWriterBinary::FILE_MAGIC, sizeof(magic)) != 0
+                || !mFile.get(version) || static_cast<uint8_t>(version) != LogWriterBinary::FILE_VERSION
+                || !ReadText(mTitle))
+            {
+                mFile.close();
+                return false;
+            }
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        const std::string& LogReaderBinary::GetTitle() const
+        {
+            return mTitle;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        LogReaderBinary::EntryType LogReaderBinary::ReadNext(LogWriter::LogData& logData)
+        {
+            char chunk = 0;
+            while (mFile.is_open() && mFile.get(chunk))
+            {
+                switch (chunk)
+                {
+                case LogWriterBinary::CHUNK_STRING:
+                {
+                    uint64_t id = 0;
+                    std::string text;
+                    if (!ReadVarint(id) || id != mStrings.size() || !ReadText(text))
+                    {
+                        mCorrupt = true;
+                        return ENTRY_END;
+                    }
+                    mStrings.push_back(text);
+                    break;
+                }
+
+                case LogWriterBinary::CHUNK_DATE:
+                {
+                    uint64_t date = 0;
+                    if (!ReadVarint(date))
+                    {
+                        mCorrupt = true;
+                        return ENTRY_END;
+                    }
+                    mDate = static_cast<uint32_t>(date);
+                    break;
+                }
+
+                case LogWriterBinary::CHUNK_HORIZ_RULE:
+                    return ENTRY_HORIZ_RULE;
+
+                case LogWriterBinary::CHUNK_MESSAGE:
+                {
+                    char level = 0;
+                    uint64_t frameNumber = 0;
+                    int64_t deltaMilliseconds = 0;
+                    uint64_t logNameId = 0;
+                    uint64_t fileId = 0;
+                    uint64_t methodId = 0;
+                    int64_t line = 0;
+                    uint64_t msgRef = 0;
+                    if (!mFile.get(level) || !ReadVarint(frameNumber) || !ReadSignedVarint(deltaMilliseconds)
+                        || !ReadVarint(logNameId) || !ReadVarint(fileId) || !ReadVarint(methodId)
+                        || !ReadSignedVarint(line) || !ReadVarint(msgRef)
+                        || !GetString(logNameId, logData.logName) || !GetString(fileId, logData.file)
+                        || !GetString(methodId, logData.method))
+                    {
+                        mCorrupt = true;
+                        return ENTRY_END;
+                    }
+
+                    if ((msgRef & 1) != 0)
+                    {
+                        if (!GetString(msgRef >> 1, logData.msg))
+                        {
+                            mCorrupt = true;
+                            return ENTRY_END;
+                        }
+                    }
+                    else
+                    {
+                        if ((msgRef >> 1) > MAX_TEXT_SIZE)
+                        {
+                            mCorrupt = true;
+                            return ENTRY_END;
+                        }
+                        logData.msg.resize(static_cast<size_t>(msgRef >> 1));
+                        if (!logData.msg.empty() && !mFile.read(&logData.msg[0], logData.msg.size()))
+                        {
+                            mCorrupt = true;
+                            return ENTRY_END;
+                        }
+                    }
+
+                    mLastMilliseconds += deltaMilliseconds;
+                    int64_t seconds = mLastMilliseconds / 1000;
+                    logData.time.SetTime(mDate / 10000, (mDate / 100) % 100, mDate % 100,
+                        static_cast<unsigned>(seconds / 3600), static_cast<unsigned>((seconds / 60) % 60),
+                        static_cast<float>(mLastMilliseconds % 60000) / 1000.0f);
+                    logData.logLevel = static_cast<LogLevel>(level);
+                    logData.frameNumber = static_cast<unsigned>(frameNumber);
+                    logData.line = static_cast<int>(line);
+                    return ENTRY_MESSAGE;
+                }
+
+                default:
+                    mCorrupt = true;
+                    return ENTRY_END;
+                }
+            }
+            return ENTRY_END;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogReaderBinary::IsCorrupt() const
+        {
+            return mCorrupt;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogReaderBinary::ReadVarint(uint64_t& value)
+        {
+            value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                char byte = 0;
+                if (!mFile.get(byte))
+                {
+                    return false;
+                }
+
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogReaderBinary::ReadSignedVarint(int64_t& value)
+        {
+            uint64_t zigZag = 0;
+            if (!ReadVarint(zigZag))
+            {
+                return false;
+            }
+            value = static_cast<int64_t>(zigZag >> 1) ^ -static_cast<int64_t>(zigZag & 1);
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogReaderBinary::ReadText(std::string& text)
+        {
+            uint64_t length = 0;
+            if (!ReadVarint(length) || length > MAX_TEXT_SIZE)
+            {
+                return false;
+            }
+
+            text.resize(static_cast<size_t>(length));
+            return text.empty() || mFile.read(&text[0], text.size());
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogReaderBinary::GetString(uint64_t id, std::string& text) const
+        {
+            if (id >= mStrings.size())
+            {
+                return false;
+            }
+            text = mStrings[static_cast<size_t>(id)];
+            return true;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+#include <trUtil/Logging/LogWriterBinary.h>
+
+#include <trUtil/Logging/LogFile.h>
+#include <trUtil/Logging/LogWriterFile.h>
+
+#include <iostream>
+
+namespace trUtil
+{
+    namespace Logging
+    {
+        const char LogWriterBinary::FILE_MAGIC[6] = { 'T', 'R', 'L', 'O', 'G', '\0' };
+
+        ////////////////////////////////////////////////////////////////////////////////
+        LogWriterBinary::LogWriterBinary()
+            : mOpenFailed(false)
+            , mFlushEachMessage(true)
+            , mInternedMessages(0)
+            , mDate(0)
+            , mLastMilliseconds(0)
+        {
+            mBuffer.reserve(BUFFER_SIZE);
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        LogWriterBinary::LogWriterBinary(const std::string& filePath)
+            : mFilePath(filePath)
+            , mOpenFailed(false)
+            , mFlushEachMessage(true)
+            , mInternedMessages(0)
+            , mDate(0)
+            , mLastMilliseconds(0)
+        {
+            mBuffer.reserve(BUFFER_SIZE);
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        LogWriterBinary::~LogWriterBinary()
+        {
+            CloseFile();
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::OpenFile()
+        {
+            if (mOpenFailed)
+            {
+                return;
+            }
+
+            CloseFile();
+
+            std::string fullLogPath = mFilePath.empty() ? LogWriterFile::GetLogFilePath(Logging::LogFile::GetFileName()) : mFilePath;
+            mLogFile.open(fullLogPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+            if (!mLogFile.is_open())
+            {
+                std::cerr << "Could not open the Log file \"" << fullLogPath << "\"" << std::endl;
+                mOpenFailed = true;
+                return;
+            }
+
+            // Ids are only valid within one file.
+            mStrings.clear();
+            mInternedMessages = 0;
+            mDate = 0;
+            mLastMilliseconds = 0;
+
+            mBuffer.insert(mBuffer.end(), FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+            mBuffer.push_back(static_cast<char>(FILE_VERSION));
+            WriteBytes(Logging::LogFile::GetTitle());
+            Flush();
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::LogMessage(const LogData& logData)
+        {
+            if (!mLogFile.is_open())
+            {
+                OpenFile();
+
+                if (!mLogFile.is_open())
+                {
+                    return;
+                }
+            }
+
+            // Strings have to be defined before the record that uses them.
+            uint32_t logNameId = 0;
+            uint32_t fileId = 0;
+            uint32_t methodId = 0;
+            uint32_t msgId = 0;
+            FindOrAddString(logData.logName, false, logNameId);
+            FindOrAddString(logData.file, false, fileId);
+            FindOrAddString(logData.method, false, methodId);
+            bool msgInterned = FindOrAddString(logData.msg, true, msgId);
+
+            uint32_t date = logData.time.GetYear() * 10000 + logData.time.GetMonth() * 100 + logData.time.GetDay();
+            if (date != mDate)
+            {
+                mBuffer.push_back(static_cast<char>(CHUNK_DATE));
+                WriteVarint(date);
+                mDate = date;
+            }
+
+            int64_t milliseconds = (logData.time.GetHour() * 3600 + logData.time.GetMinute() * 60) * 1000
+                + static_cast<int64_t>(logData.time.GetSecond() * 1000.0f);
+
+            mBuffer.push_back(static_cast<char>(CHUNK_MESSAGE));
+            mBuffer.push_back(static_cast<char>(logData.logLevel));
+            WriteVarint(logData.frameNumber);
+            WriteSignedVarint(milliseconds - mLastMilliseconds);
+            WriteVarint(logNameId);
+            WriteVarint(fileId);
+            WriteVarint(methodId);
+            WriteSignedVarint(logData.line);
+            if (msgInterned)
+            {
+                WriteVarint((static_cast<uint64_t>(msgId) << 1) | 1);
+            }
+            else
+            {
+                WriteVarint(static_cast<uint64_t>(logData.msg.size()) << 1);
+                mBuffer.insert(mBuffer.end(), logData.msg.begin(), logData.msg.end());
+            }
+            mLastMilliseconds = milliseconds;
+
+            //Make sure errors are written, in case of a crash.
+            if (mFlushEachMessage || logData.logLevel >= LogLevel::LOG_ERROR || mBuffer.size() >= BUFFER_SIZE)
+            {
+                Flush();
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::Flush()
+        {
+            if (!mLogFile.is_open())
+            {
+                return;
+            }
+
+            if (!mBuffer.empty())
+            {
+                mLogFile.write(mBuffer.data(), mBuffer.size());
+                mBuffer.clear();
+            }
+            mLogFile.flush();
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::SetFlushEachMessage(bool flush)
+        {
+            mFlushEachMessage = flush;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::LogHorizRule()
+        {
+            if (!mLogFile.is_open())
+            {
+                return;
+            }
+
+            mBuffer.push_back(static_cast<char>(CHUNK_HORIZ_RULE));
+            if (mFlushEachMessage)
+            {
+                Flush();
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogWriterBinary::IsOpenFailed()
+        {
+            return mOpenFailed;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::ResetOpenFail()
+        {
+            mOpenFailed = false;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        bool LogWriterBinary::FindOrAddString(const std::string& text, bool limited, uint32_t& id)
+        {
+            trUtil::HashMap<std::string, uint32_t>::const_iterator found = mStrings.find(text);
+            if (found != mStrings.end())
+            {
+                id = found->second;
+                return true;
+            }
+
+            if (limited)
+            {
+                if (mInternedMessages >= MAX_INTERNED_MESSAGES)
+                {
+                    return false;
+                }
+                ++mInternedMessages;
+            }
+
+            id = static_cast<uint32_t>(mStrings.size());
+            mStrings.insert(std::make_pair(text, id));
+
+            mBuffer.push_back(static_cast<char>(CHUNK_STRING));
+            WriteVarint(id);
+            WriteBytes(text);
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::WriteVarint(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                mBuffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            mBuffer.push_back(static_cast<char>(value));
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::WriteSignedVarint(int64_t value)
+        {
+            // Zig zag encoding keeps small negative numbers small.
+            WriteVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::WriteBytes(const std::string& text)
+        {
+            WriteVarint(text.size());
+            mBuffer.insert(mBuffer.end(), text.begin(), text.end());
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterBinary::CloseFile()
+        {
+            if (mLogFile.is_open())
+            {
+                Flush();
+                mLogFile.close();
+            }
+            mBuffer.clear();
+        }
+    }
+}
\ No newline at end of file
@@ -39,6 +39,15 @@ namespace trUtil
         ////////////////////////////////////////////////////////////////////////////////
         LogWriterFile::LogWriterFile()
             : mOpenFailed(false)
+            , mFlushEachMessage(true)
+        {
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        LogWriterFile::LogWriterFile(const std::string& filePath)
+            : mFilePath(filePath)
+            , mOpenFailed(false)
+            , mFlushEachMessage(true)
         {
         }
 
@@ -74,30 +83,7 @@ namespace trUtil
                 mLogFile.close();
             }
 
-            std::string fullLogPath = Logging::LogFile::GetFileName();
-            if (Logging::LogFile::GetFileName().find(trUtil::FileUtils::PATH_SEPARATOR) == std::string::npos)
-            {
-                //Store logs in a system dependent place.
-                std::string userLogPath = trUtil::PathUtils::GetLogPath();
-                if (!userLogPath.empty())
-                {
-                    std::string logDir = userLogPath + DEFAULT_LOG_FOLDER;
-
-                    try
-                    {
-                        trUtil::FileUtils::GetInstance().MakeDirectoryEX(logDir);
-                    }
-                    catch (const trUtil::Exception&)
-                    {
-                        std::cerr << "Unable to create the log directory : \"" << logDir << "\".  The log file will be written to the current working directory if possible." << std::endl;
-                        logDir.clear();
-                    }
-
-                    fullLogPath = logDir + "/" + Logging::LogFile::GetFileName();
-
-                }
-                //First attempt to create the log file.
-            }
+            std::string fullLogPath = mFilePath.empty() ? GetLogFilePath(Logging::LogFile::GetFileName()) : mFilePath;
             mLogFile.open(fullLogPath.c_str());
 
             if (!mLogFile.is_open())
@@ -212,9 +198,27 @@ namespace trUtil
                 }
             }
 
-            mLogFile << "]" << "</font></b><br>" << std::endl;
+            mLogFile << "]" << "</font></b><br>\n";
 
-            mLogFile.flush(); //Make sure everything is written, in case of a crash.
+            if (mFlushEachMessage)
+            {
+                mLogFile.flush(); //Make sure everything is written, in case of a crash.
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterFile::Flush()
+        {
+            if (mLogFile.is_open())
+            {
+                mLogFile.flush();
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        void LogWriterFile::SetFlushEachMessage(bool flush)
+        {
+            mFlushEachMessage = flush;
         }
 
         ////////////////////////////////////////////////////////////////////////////////
@@ -247,5 +251,34 @@ namespace trUtil
         {
             mOpenFailed = false;
         }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        std::string LogWriterFile::GetLogFilePath(const std::string& fileName)
+        {
+            std::string fullLogPath = fileName;
+            if (fileName.find(trUtil::FileUtils::PATH_SEPARATOR) == std::string::npos)
+            {
+                //Store logs in a system dependent place.
+                std::string userLogPath = trUtil::PathUtils::GetLogPath();
+                if (!userLogPath.empty())
+                {
+                    std::string logDir = userLogPath + DEFAULT_LOG_FOLDER;
+
+                    try
+                    {
+                        trUtil::FileUtils::GetInstance().MakeDirectoryEX(logDir);
+                    }
+                    catch (const trUtil::Exception&)
+                    {
+                        std::cerr << "Unable to create the log directory : \"" << logDir << "\".  The log file will be written to the current working directory if possible." << std::endl;
+                        logDir.clear();
+                    }
+
+                    fullLogPath = logDir + "/" + fileName;
+
+                }
+            }
+            return fullLogPath;
+        }
     }
-}
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trUtil/Metrics/Gauge.h>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        const std::string Gauge::TYPE_NAME("gauge");
+
+        //////////////////////////////////////////////////////////////////////////
+        Gauge::Gauge()
+            : mValue(0.0)
+        {
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Gauge::Add(double amount)
+        {
+            double value = mValue.load(std::memory_order_relaxed);
+            while (!mValue.compare_exchange_weak(value, value + amount, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        const std::string& Gauge::GetTypeName() const
+        {
+            return TYPE_NAME;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Gauge::Write(std::string& output, const std::string& name, const std::string& labels) const
+        {
+            WriteSample(output, name, labels, GetValue());
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trUtil/Metrics/Histogram.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        const std::string Histogram::TYPE_NAME("histogram");
+
+        const std::vector<double> Histogram::DEFAULT_TIME_BUCKETS = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0 };
+
+        //////////////////////////////////////////////////////////////////////////
+        Histogram::Histogram(const std::vector<double>& bucketBounds)
+            : mBucketBounds(bucketBounds)
+            , mCount(0)
+            , mSum(0.0)
+        {
+            std::sort(mBucketBounds.begin(), mBucketBounds.end());
+            mBucketBounds.erase(std::unique(mBucketBounds.begin(), mBucketBounds.end()), mBucketBounds.end());
+
+            mBucketCounts.reset(new std::atomic<unsigned long long>[mBucketBounds.size() + 1]);
+            for (size_t i = 0; i <= mBucketBounds.size(); ++i)
+            {
+                mBucketCounts[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Histogram::Observe(double value)
+        {
+            // Buckets are "less or equal" bounds, so the first bound that is not below the value.
+            size_t index = std::lower_bound(mBucketBounds.begin(), mBucketBounds.end(), value) - mBucketBounds.begin();
+            mBucketCounts[index].fetch_add(1, std::memory_order_relaxed);
+            mCount.fetch_add(1, std::memory_order_relaxed);
+
+            double sum = mSum.load(std::memory_order_relaxed);
+            while (!mSum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        const std::vector<double>& Histogram::GetBucketBounds() const
+        {
+            return mBucketBounds;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        unsigned long long Histogram::GetBucketCount(size_t index) const
+        {
+            if (index > mBucketBounds.size())
+            {
+                return 0;
+            }
+            return mBucketCounts[index].load(std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        unsigned long long Histogram::GetCount() const
+        {
+            return mCount.load(std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        double Histogram::GetSum() const
+        {
+            return mSum.load(std::memory_order_relaxed);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        const std::string& Histogram::GetTypeName() const
+        {
+            return TYPE_NAME;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Histogram::Write(std::string& output, const std::string& name, const std::string& labels) const
+        {
+            std::string bucketLabels = labels.empty() ? std::string() : labels + ",";
+
+            // Prometheus buckets are cumulative, and the +Inf bucket equals the count.
+            unsigned long long cumulative = 0;
+            for (size_t i = 0; i <= mBucketBounds.size(); ++i)
+            {
+                cumulative += GetBucketCount(i);
+                double bound = i < mBucketBounds.size() ? mBucketBounds[i] : std::numeric_limits<double>::infinity();
+                WriteSample(output, name + "_bucket", bucketLabels + "le=\"" + FormatValue(bound) + "\"", static_cast<double>(cumulative));
+            }
+            WriteSample(output, name + "_sum", labels, GetSum());
+            WriteSample(output, name + "_count", labels, static_cast<double>(cumulative));
+        }
+    }
+}
\ No newline at end of file
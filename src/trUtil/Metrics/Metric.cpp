@@ -0,0 +1,74 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trUtil/Metrics/Metric.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        //////////////////////////////////////////////////////////////////////////
+        Metric::~Metric()
+        {
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void Metric::WriteSample(std::string& output, const std::string& name, const std::string& labels, double value)
+        {
+            output += name;
+            if (!labels.empty())
+            {
+                output += '{';
+                output += labels;
+                output += '}';
+            }
+            output += ' ';
+            output += FormatValue(value);
+            output += '\n';
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        std::string Metric::FormatValue(double value)
+        {
+            if (std::isnan(value))
+            {
+                return "NaN";
+            }
+            if (std::isinf(value))
+            {
+                return value > 0 ? "+Inf" : "-Inf";
+            }
+
+            // Use the short form unless it does not read back as the same value.
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+            if (std::strtod(buffer, nullptr) != value)
+            {
+                std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+            }
+            return buffer;
+        }
+    }
+}
\ No newline at end of file
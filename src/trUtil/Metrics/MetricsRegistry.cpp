@@ -0,0 +1,254 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trUtil/Metrics/MetricsRegistry.h>
+
+#include <trUtil/ExceptionInvalidParameter.cpp.h>
+#include <trUtil/Logging/Log.h>
+
+#include <algorithm>
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        //////////////////////////////////////////////////////////////////////////
+        MetricsRegistry::MetricsRegistry()
+        {
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        MetricsRegistry::~MetricsRegistry()
+        {
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        MetricsRegistry& MetricsRegistry::GetInstance()
+        {
+            //Never destroyed, so static objects like the global System Manager can still remove
+            //their metrics while the process shuts down
+            static MetricsRegistry* sRegistry = new MetricsRegistry();
+            return *sRegistry;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        Counter& MetricsRegistry::GetCounter(const std::string& name, const std::string& help, const Labels& labels)
+        {
+            return static_cast<Counter&>(GetMetric(name, help, labels, Counter::TYPE_NAME, []() { return new Counter(); }));
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        Gauge& MetricsRegistry::GetGauge(const std::string& name, const std::string& help, const Labels& labels)
+        {
+            return static_cast<Gauge&>(GetMetric(name, help, labels, Gauge::TYPE_NAME, []() { return new Gauge(); }));
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        Histogram& MetricsRegistry::GetHistogram(const std::string& name, const std::string& help, const std::vector<double>& bucketBounds, const Labels& labels)
+        {
+            return static_cast<Histogram&>(GetMetric(name, help, labels, Histogram::TYPE_NAME, [&bucketBounds]() { return new Histogram(bucketBounds); }));
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        size_t MetricsRegistry::RemoveMetrics(const std::string& labelName, const std::string& labelValue)
+        {
+            //Quotes in values are escaped, so the rendered label can only match a whole label
+            std::string label = RenderLabels({ { labelName, labelValue } });
+            size_t removedCount = 0;
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto familyIt = mFamilies.begin(); familyIt != mFamilies.end();)
+            {
+                std::map<std::string, std::unique_ptr<Metric>>& metrics = familyIt->second.metrics;
+                for (auto metricIt = metrics.begin(); metricIt != metrics.end();)
+                {
+                    const std::string& labels = metricIt->first;
+                    size_t pos = labels.find(label);
+                    while (pos != std::string::npos && !((pos == 0 || labels[pos - 1] == ',') && (pos + label.size() == labels.size() || labels[pos + label.size()] == ',')))
+                    {
+                        pos = labels.find(label, pos + 1);
+                    }
+
+                    if (pos != std::string::npos)
+                    {
+                        metricIt = metrics.erase(metricIt);
+                        ++removedCount;
+                    }
+                    else
+                    {
+                        ++metricIt;
+                    }
+                }
+
+                //Drop families that lost their last metric, so they are not rendered without samples
+                if (metrics.empty())
+                {
+                    familyIt = mFamilies.erase(familyIt);
+                }
+                else
+                {
+                    ++familyIt;
+                }
+            }
+            return removedCount;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        Metric& MetricsRegistry::GetMetric(const std::string& name, const std::string& help, const Labels& labels, const std::string& typeName, const std::function<Metric*()>& create)
+        {
+            if (!IsValidName(name))
+            {
+                std::string errorText = "Invalid metric name: " + name;
+                LOG_E(errorText)
+                throw trUtil::ExceptionInvalidParameter(errorText, __FILE__, __LINE__);
+            }
+
+            std::string renderedLabels = RenderLabels(labels);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            Family& family = mFamilies[name];
+            if (family.typeName == nullptr)
+            {
+                family.help = help;
+                family.typeName = &typeName;
+            }
+            else if (*family.typeName != typeName)
+            {
+                std::string errorText = "The metric " + name + " is already registered as a " + *family.typeName + ", not a " + typeName;
+                LOG_E(errorText)
+                throw trUtil::ExceptionInvalidParameter(errorText, __FILE__, __LINE__);
+            }
+
+            std::unique_ptr<Metric>& metric = family.metrics[renderedLabels];
+            if (metric == nullptr)
+            {
+                metric.reset(create());
+            }
+            return *metric;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        std::string MetricsRegistry::GetPrometheusText() const
+        {
+            std::string output;
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (const auto& familyPair : mFamilies)
+            {
+                const Family& family = familyPair.second;
+                if (family.typeName == nullptr)
+                {
+                    continue;
+                }
+
+                // The help text escapes only backslashes and new lines.
+                std::string help;
+                for (char c : family.help)
+                {
+                    if (c == '\\')
+                    {
+                        help += "\\\\";
+                    }
+                    else if (c == '\n')
+                    {
+                        help += "\\n";
+                    }
+                    else
+                    {
+                        help += c;
+                    }
+                }
+
+                output += "# HELP " + familyPair.first + " " + help + "\n";
+                output += "# TYPE " + familyPair.first + " " + *family.typeName + "\n";
+                for (const auto& metricPair : family.metrics)
+                {
+                    metricPair.second->Write(output, familyPair.first, metricPair.first);
+                }
+            }
+            return output;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool MetricsRegistry::IsValidName(const std::string& name)
+        {
+            if (name.empty())
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < name.size(); ++i)
+            {
+                char c = name[i];
+                bool isLetter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+                bool isDigit = c >= '0' && c <= '9';
+                if (!isLetter && !(isDigit && i > 0))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        std::string MetricsRegistry::RenderLabels(const Labels& labels)
+        {
+            //Sort by name, so the order the labels were given in does not matter
+            Labels sortedLabels = labels;
+            std::sort(sortedLabels.begin(), sortedLabels.end());
+
+            std::string rendered;
+            for (const auto& label : sortedLabels)
+            {
+                if (!IsValidName(label.first))
+                {
+                    std::string errorText = "Invalid metric label name: " + label.first;
+                    LOG_E(errorText)
+                    throw trUtil::ExceptionInvalidParameter(errorText, __FILE__, __LINE__);
+                }
+
+                if (!rendered.empty())
+                {
+                    rendered += ',';
+                }
+                rendered += label.first + "=\"";
+                for (char c : label.second)
+                {
+                    if (c == '\\' || c == '"')
+                    {
+                        rendered += '\\';
+                        rendered += c;
+                    }
+                    else if (c == '\n')
+                    {
+                        rendered += "\\n";
+                    }
+                    else
+                    {
+                        rendered += c;
+                    }
+                }
+                rendered += '"';
+            }
+            return rendered;
+        }
+    }
+}
\ No newline at end of file
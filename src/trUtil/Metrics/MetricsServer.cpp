@@ -0,0 +1,284 @@
+/*
+* True Reality Open Source Game and Simulation Engine
+* Copyright  2018 Acid Rain Studios LLC
+*
+* This library is free software; you can redistribute it and/or modify it under
+* the terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; either version 3.0 of the License, or (at your option)
+* any later version.
+*
+* This library is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+* details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this library; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* @author Maxim Serebrennik
+*/
+
+#include <trUtil/Metrics/MetricsServer.h>
+
+#include <trUtil/PlatformMacros.h>
+#include <trUtil/StringUtils.h>
+#include <trUtil/Logging/Log.h>
+
+#include <cstring>
+
+#ifdef TR_WIN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using NativeSocket = SOCKET;
+#else
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    using NativeSocket = int;
+#endif
+
+namespace trUtil
+{
+    namespace Metrics
+    {
+        const unsigned short MetricsServer::DEFAULT_PORT = 9464;
+        const std::string MetricsServer::DEFAULT_ADDRESS("127.0.0.1");
+        const std::string MetricsServer::METRICS_PATH("/metrics");
+
+        //Value of a socket handle that is not open
+        static const std::intptr_t INVALID_SOCKET_HANDLE = -1;
+
+        //How often the server thread checks if it should stop
+        static const unsigned int ACCEPT_TIMEOUT_MS = 100;
+
+        //How long a client gets to send its request
+        static const unsigned int REQUEST_TIMEOUT_MS = 1000;
+
+        //Largest request that is read, the rest is ignored
+        static const size_t MAX_REQUEST_SIZE = 8192;
+
+        //A client that hangs up early should not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+        static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+        static const int SEND_FLAGS = 0;
+#endif
+
+        //////////////////////////////////////////////////////////////////////////
+        MetricsServer::MetricsServer(MetricsRegistry& registry)
+            : mRegistry(registry)
+            , mListenSocket(INVALID_SOCKET_HANDLE)
+            , mRunning(false)
+        {
+#ifdef TR_WIN
+            //WSAStartup is reference counted, so every server can call it
+            WSADATA wsaData;
+            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+            {
+                LOG_E("Unable to initialize Windows Sockets.")
+            }
+#endif
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        MetricsServer::~MetricsServer()
+        {
+            Stop();
+#ifdef TR_WIN
+            WSACleanup();
+#endif
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool MetricsServer::Start(unsigned short port, const std::string& address)
+        {
+            Stop();
+
+            sockaddr_in socketAddress;
+            std::memset(&socketAddress, 0, sizeof(socketAddress));
+            socketAddress.sin_family = AF_INET;
+            socketAddress.sin_port = htons(port);
+            if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+            {
+                LOG_E("Invalid metrics server address: " + address)
+                return false;
+            }
+
+            mListenSocket = static_cast<SocketHandle>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+            if (mListenSocket == INVALID_SOCKET_HANDLE)
+            {
+                LOG_E("Unable to create the metrics server socket.")
+                return false;
+            }
+
+            int reuse = 1;
+            setsockopt(static_cast<NativeSocket>(mListenSocket), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+            if (bind(static_cast<NativeSocket>(mListenSocket), reinterpret_cast<const sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0 ||
+                listen(static_cast<NativeSocket>(mListenSocket), SOMAXCONN) != 0)
+            {
+                LOG_E("Unable to start the metrics server on " + address + ":" + trUtil::StringUtils::ToString<unsigned short>(port))
+                CloseSocket(mListenSocket);
+                return false;
+            }
+
+            //Find out which port was picked, in case 0 was passed in
+            sockaddr_in boundAddress;
+            socklen_t addressSize = sizeof(boundAddress);
+            getsockname(static_cast<NativeSocket>(mListenSocket), reinterpret_cast<sockaddr*>(&boundAddress), &addressSize);
+            mPort = ntohs(boundAddress.sin_port);
+
+            mRunning = true;
+            mThread = std::thread(&MetricsServer::Run, this);
+
+            LOG_I("Serving metrics on http://" + address + ":" + trUtil::StringUtils::ToString<unsigned short>(mPort) + METRICS_PATH)
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void MetricsServer::Stop()
+        {
+            mRunning = false;
+            if (mThread.joinable())
+            {
+                mThread.join();
+            }
+            CloseSocket(mListenSocket);
+            mPort = 0;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        bool MetricsServer::IsRunning() const
+        {
+            return mRunning;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        unsigned short MetricsServer::GetPort() const
+        {
+            return mPort;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void MetricsServer::Run()
+        {
+            while (mRunning)
+            {
+                //Wait for a connection, but come back often enough to notice a Stop()
+                fd_set readSet;
+                FD_ZERO(&readSet);
+                FD_SET(static_cast<NativeSocket>(mListenSocket), &readSet);
+
+                timeval timeout;
+                timeout.tv_sec = 0;
+                timeout.tv_usec = ACCEPT_TIMEOUT_MS * 1000;
+
+                if (select(static_cast<int>(mListenSocket + 1), &readSet, nullptr, nullptr, &timeout) <= 0)
+                {
+                    continue;
+                }
+
+                SocketHandle connection = static_cast<SocketHandle>(accept(static_cast<NativeSocket>(mListenSocket), nullptr, nullptr));
+                if (connection != INVALID_SOCKET_HANDLE)
+                {
+                    HandleConnection(connection);
+                    CloseSocket(connection);
+                }
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void MetricsServer::HandleConnection(SocketHandle connection)
+        {
+            //Do not let a slow client hold up the server
+#ifdef TR_WIN
+            DWORD receiveTimeout = REQUEST_TIMEOUT_MS;
+#else
+            timeval receiveTimeout;
+            receiveTimeout.tv_sec = REQUEST_TIMEOUT_MS / 1000;
+            receiveTimeout.tv_usec = (REQUEST_TIMEOUT_MS % 1000) * 1000;
+#endif
+            setsockopt(static_cast<NativeSocket>(connection), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&receiveTimeout), sizeof(receiveTimeout));
+
+            //Read until the end of the request headers
+            std::string request;
+            char buffer[1024];
+            while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE)
+            {
+                int received = static_cast<int>(recv(static_cast<NativeSocket>(connection), buffer, sizeof(buffer), 0));
+                if (received <= 0)
+                {
+                    break;
+                }
+                request.append(buffer, received);
+            }
+
+            //Only the request line matters, e.g. "GET /metrics HTTP/1.1"
+            std::string requestLine = request.substr(0, request.find("\r\n"));
+            size_t pathStart = requestLine.find(' ');
+            size_t pathEnd = pathStart == std::string::npos ? std::string::npos : requestLine.find(' ', pathStart + 1);
+            std::string method = requestLine.substr(0, pathStart);
+            std::string path = pathEnd == std::string::npos ? std::string() : requestLine.substr(pathStart + 1, pathEnd - pathStart - 1);
+            path = path.substr(0, path.find('?'));
+
+            std::string status;
+            std::string contentType;
+            std::string body;
+            if (method != "GET")
+            {
+                status = "405 Method Not Allowed";
+                contentType = "text/plain";
+                body = "Only GET is supported.\n";
+            }
+            else if (path == METRICS_PATH || path == "/")
+            {
+                status = "200 OK";
+                contentType = "text/plain; version=0.0.4; charset=utf-8";
+                body = mRegistry.GetPrometheusText();
+            }
+            else
+            {
+                status = "404 Not Found";
+                contentType = "text/plain";
+                body = "Metrics are served on " + METRICS_PATH + "\n";
+            }
+
+            std::string response = "HTTP/1.1 " + status + "\r\n"
+                "Content-Type: " + contentType + "\r\n"
+                "Content-Length: " + trUtil::StringUtils::ToString<size_t>(body.size()) + "\r\n"
+                "Connection: close\r\n"
+                "\r\n" + body;
+
+            size_t sent = 0;
+            while (sent < response.size())
+            {
+                int result = static_cast<int>(send(static_cast<NativeSocket>(connection), response.data() + sent, static_cast<int>(response.size() - sent), SEND_FLAGS));
+                if (result <= 0)
+                {
+                    break;
+                }
+                sent += result;
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void MetricsServer::CloseSocket(SocketHandle& socket)
+        {
+            if (socket == INVALID_SOCKET_HANDLE)
+            {
+                return;
+            }
+
+#ifdef TR_WIN
+            closesocket(static_cast<NativeSocket>(socket));
+#else
+            close(static_cast<NativeSocket>(socket));
+#endif
+            socket = INVALID_SOCKET_HANDLE;
+        }
+    }
+}
\ No newline at end of file
@@ -20,9 +20,15 @@
 */
 
 #include <trUtil/Timer.h>
+#include <trUtil/DateTime.h>
+#include <trUtil/PlatformMacros.h>
 
 #include <OpenThreads/Thread>
 
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
 namespace trUtil
 {
 
@@ -39,6 +45,56 @@ namespace trUtil
        }
     }
 
+    namespace
+    {
+        /** @brief   How long the fast tick rate is measured for during calibration. */
+        const std::chrono::milliseconds FAST_TICK_CALIBRATION_TIME(20);
+
+        /**
+         * @struct  FastTickCalibration
+         *
+         * @brief   The measured fast tick rate and the wall clock time of one known fast tick.
+         */
+        struct FastTickCalibration
+        {
+            double ticksPerSecond = 1e9;
+            TimeTicks anchorTicks = 0;
+            double anchorEpochSeconds = 0.0;
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        FastTickCalibration CalibrateFastTicks()
+        {
+            FastTickCalibration calibration;
+
+#ifdef TR_FAST_TICK_TSC
+            // Spin instead of sleeping, so the measurement is not at the mercy of the scheduler.
+            std::chrono::steady_clock::time_point steadyStart = std::chrono::steady_clock::now();
+            TimeTicks ticksStart = Timer::FastTick();
+            std::chrono::steady_clock::time_point steadyEnd = steadyStart;
+            while (steadyEnd - steadyStart < FAST_TICK_CALIBRATION_TIME)
+            {
+                steadyEnd = std::chrono::steady_clock::now();
+            }
+            TimeTicks ticksEnd = Timer::FastTick();
+
+            double seconds = std::chrono::duration<double>(steadyEnd - steadyStart).count();
+            calibration.ticksPerSecond = static_cast<double>(ticksEnd - ticksStart) / seconds;
+#endif
+
+            calibration.anchorTicks = Timer::FastTick();
+            calibration.anchorEpochSeconds = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            return calibration;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        const FastTickCalibration& GetFastTickCalibration()
+        {
+            static const FastTickCalibration sCalibration = CalibrateFastTicks();
+            return sCalibration;
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////////////////
 
@@ -68,5 +124,43 @@ namespace trUtil
         mNewTicks = t;
         mCustomTicks = (mNewTicks - mTimer.tick());
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    double Timer::GetFastTicksPerSecond()
+    {
+        return GetFastTickCalibration().ticksPerSecond;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double Timer::FastDeltaSec(TimeTicks t1, TimeTicks t2)
+    {
+        // Wrap around in unsigned, then read it as signed so earlier ticks give a negative delta.
+        return static_cast<double>(static_cast<long long>(t2 - t1)) / GetFastTickCalibration().ticksPerSecond;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    double Timer::FastTickToEpochSeconds(TimeTicks ticks)
+    {
+        const FastTickCalibration& calibration = GetFastTickCalibration();
+        return calibration.anchorEpochSeconds + FastDeltaSec(calibration.anchorTicks, ticks);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    DateTime Timer::FastTickToDateTime(TimeTicks ticks)
+    {
+        double epochSeconds = FastTickToEpochSeconds(ticks);
+        double wholeSeconds = std::floor(epochSeconds);
+        std::time_t t = static_cast<std::time_t>(wholeSeconds);
+
+        struct tm timeParts;
+#ifdef TR_WIN
+        localtime_s(&timeParts, &t);
+#else
+        localtime_r(&t, &timeParts);
+#endif
+        DateTime dateTime(timeParts);
+        dateTime.SetSecond(static_cast<float>(timeParts.tm_sec + (epochSeconds - wholeSeconds)));
+        return dateTime;
+    }
 }
 